@@ -39,7 +39,11 @@ vpic_simulation** restore_main(void)
 }
 
 /**
- * @brief Main checkpoint function to trigger a full checkpointing
+ * @brief Main checkpoint function to trigger a full checkpointing.  The
+ * remap image of the checkpoint (fbase.tag.remap, see dump_remap) is
+ * written too when the simulation can be remapped on this step, so the
+ * run can also be restarted on a different number of ranks with
+ * "--remap fbase.tag.remap".
  *
  * @param fbase File name base for dumping
  * @param tag File tag to label what this checkpoint is (often used: time step)
@@ -51,6 +55,24 @@ void checkpt(const char* fbase, int tag)
     sprintf( fname, "%s.%i.%i", fbase, tag, world_rank );
     if( world_rank==0 ) log_printf( "*** Checkpointing to \"%s\"\n", fbase );
     checkpt_objects( fname );
+    sprintf( fname, "%s.%i.remap", fbase, tag );
+    simulation->checkpt_remap( fname );
+}
+
+/**
+ * @brief Partner checkpoint function, keeping the checkpoint in the cache
+ * directory given with --checkpt.cache of this node and of a partner node
+ * on another machine (see checkpt_objects_partner).  A run can be restarted
+ * from it with "--restore.partner fbase", even after losing a machine.
+ *
+ * @param fbase Name of the partner checkpoint (the latest one of a name is
+ * kept)
+ */
+void checkpt_partner(const char* fbase)
+{
+    if( !fbase ) ERROR(( "NULL filename base" ));
+    if( world_rank==0 ) log_printf( "*** Partner checkpointing to \"%s\"\n", fbase );
+    checkpt_objects_partner( fbase );
 }
 
 /**
@@ -69,9 +91,20 @@ int main(int argc, char** argv)
 
     // TODO: this would be better if it was bool-like in nature
     const char * fbase = strip_cmdline_string(&argc, &argv, "--restore", NULL);
+    const char * pbase = strip_cmdline_string(&argc, &argv, "--restore.partner", NULL);
+
+    // Try the partner checkpoint first and fall back to the one on disk
+    // (if given) when some node's image was lost
+    int restored = 0;
+    if( pbase )
+    {
+        if( world_rank==0 ) log_printf( "*** Restoring from partner checkpoint \"%s\"\n", pbase );
+        restored = restore_objects_partner( pbase );
+        if( !restored && !fbase ) ERROR(( "Unable to restore from \"%s\"", pbase ));
+    }
 
     // Detect if we should perform a restore as per the user request
-    if( fbase )
+    if( restored || fbase )
     {
 
         // We are restoring from a checkpoint.  Determine checkpt file
@@ -80,10 +113,13 @@ int main(int argc, char** argv)
         // that communication within reanimate functions is safe),
         // reanimate all the objects and issue a final barrier to
         // so that all processes come of a restore together.
-        if( world_rank==0 ) log_printf( "*** Restoring from \"%s\"\n", fbase );
-        char fname[256];
-        sprintf( fname, "%s.%i", fbase, world_rank );
-        restore_objects( fname );
+        if( !restored )
+        {
+            if( world_rank==0 ) log_printf( "*** Restoring from \"%s\"\n", fbase );
+            char fname[256];
+            sprintf( fname, "%s.%i", fbase, world_rank );
+            restore_objects( fname );
+        }
         mp_barrier();
         reanimate_objects();
         mp_barrier();
@@ -96,8 +132,16 @@ int main(int argc, char** argv)
         {
             log_printf( "*** Initializing\n" );
         }
+        // Detect if the deck should continue from a remap dump (which can
+        // be made on a different number of ranks, see dump_remap)
+        const char * rbase = strip_cmdline_string( &argc, &argv, "--remap", NULL );
+        if( rbase && world_rank==0 )
+        {
+            log_printf( "*** Remapping from \"%s\"\n", rbase );
+        }
+
         simulation = new vpic_simulation();
-        simulation->initialize( argc, argv );
+        simulation->initialize( argc, argv, rbase );
         REGISTER_OBJECT( &simulation, checkpt_main, restore_main, NULL );
     }
 
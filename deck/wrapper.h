@@ -38,6 +38,21 @@ vpic_simulation::user_initialization( int num_cmdline_arguments,  \
 void                      \
 vpic_simulation::user_diagnostics( void )
 
+// The user particle hooks (begin_diagnostics, begin_particle_injection,
+// begin_particle_collisions) see each species in whatever layout it was
+// given with set_species_layout.  A species in PARTICLE_LAYOUT_AOSOA
+// stores its particles in tiles of PARTICLE_BLOCK (see
+// species_advance_aosoa.h) and sp->p must not be indexed as a particle_t
+// array.  Read and write particle n with
+//   particle_t p;
+//   load_particle( sp->p, sp->layout, n, &p );
+//   ... modify p ...
+//   store_particle( sp->p, sp->layout, n, &p );
+// which work for either layout.  inject_particle handles both layouts.
+// A hook that does a lot of work on the particle array can instead switch
+// the species with set_species_layout( sp, PARTICLE_LAYOUT_AOS ) and put
+// back the returned layout when done.
+
 #define begin_particle_injection \
 void                             \
 vpic_simulation::user_particle_injection( void )
@@ -50,6 +65,8 @@ vpic_simulation::user_current_injection( void )
 void                          \
 vpic_simulation::user_field_injection( void )
 
+// See begin_particle_injection for accessing AoSoA species.
+
 #define begin_particle_collisions \
 void                              \
 vpic_simulation::user_particle_collisions( void )
@@ -133,7 +150,7 @@ vpic_simulation::user_particle_collisions( void )
     const double _dx = grid->dx, _dy = grid->dy, _dz = grid->dz;    \
     const int    _nx = grid->nx, _ny = grid->ny, _nz = grid->nz;    \
     for( int _k=0; _k<_nz+2; _k++ ) { const double _zn = _z0 + _dz*(_k-1), _zc = _z0 + _dz*(_k-0.5); \
-    for( int _j=0; _j<_ny+2; _j++ ) { const double _yn = _y0 + _dy*(_j-1), _yc = _y0 + _dy*(_j-0.5); field_t * _f = &field(0,_j,_k); \
+    for( int _j=0; _j<_ny+2; _j++ ) { const double _yn = _y0 + _dy*(_j-1), _yc = _y0 + _dy*(_j-0.5); field_material_t * _f = &field_material(0,_j,_k); \
     for( int _i=0; _i<_nx+2; _i++ ) { const double _xn = _x0 + _dx*(_i-1), _xc = _x0 + _dx*(_i-0.5); double x, y, z; \
           x = _xn; y = _yn; z = _zn; if( (rgn) ) _f->nmat  = _rmat; \
           x = _xc;                   if( (rgn) ) _f->ematx = _rmat; \
@@ -218,7 +235,7 @@ vpic_simulation::user_particle_collisions( void )
     const double _dx = grid->dx, _dy = grid->dy, _dz = grid->dz;       \
     const int    _nx = grid->nx, _ny = grid->ny, _nz = grid->nz;       \
     for( int _k=0; _k<_nz+2; _k++ ) { const double _zl = _z0 + _dz*(_k-1.5), _zc = _z0 + _dz*(_k-0.5); \
-    for( int _j=0; _j<_ny+2; _j++ ) { const double _yl = _y0 + _dy*(_j-1.5), _yc = _y0 + _dy*(_j-0.5); field_t *_f = &field(0,_j,_k); \
+    for( int _j=0; _j<_ny+2; _j++ ) { const double _yl = _y0 + _dy*(_j-1.5), _yc = _y0 + _dy*(_j-0.5); field_material_t *_f = &field_material(0,_j,_k); \
     for( int _i=0; _i<_nx+2; _i++ ) { const double _xl = _x0 + _dx*(_i-1.5), _xc = _x0 + _dx*(_i-0.5); double x, y, z; \
           int _rccc, _rlcc, _rclc, _rllc, _rccl, _rlcl, _rcll, _rlll;  \
           x = _xc; y = _yc; z = _zc; _rccc = (rgn);		       \
@@ -420,5 +437,8 @@ void
 checkpt( const char * fbase,
          int tag );
 
+void
+checkpt_partner( const char * fbase );
+
 //-----------------------------------------------------------------------------
 #endif // guard
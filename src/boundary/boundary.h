@@ -32,12 +32,27 @@ get_particle_bc_id( particle_bc_t * pbc );
 
 /* In boundary_p.cxx */
 
+/* The current of the particles injected by boundary_p is deposited
+   through the accumulator tiles of the pipelines and reduced into the
+   host accumulator.  The tiles must already have been reduced (as
+   advance does after advance_p) since boundary_p reuses them. */
+
 void
 boundary_p( particle_bc_t       * RESTRICT pbc_list,
             species_t           * RESTRICT sp_list,
             field_array_t       * RESTRICT fa,
             accumulator_array_t * RESTRICT aa );
 
+/* A particle migrating directly to a domain sharing an edge or a corner
+   with the local domain (see move_p) leaves the current of its move
+   outside the local domain in the ghost accumulators around its ghost
+   voxel v until boundary_p sends it.  This discards that current when
+   such a particle is dropped instead. */
+
+void
+discard_migrated_current( accumulator_array_t * RESTRICT aa,
+                          int v );
+
 /* In maxwellian_reflux.c */
 
 particle_bc_t *
@@ -0,0 +1,1666 @@
+#define IN_boundary
+
+#include "boundary_p_pipeline.h"
+
+#include "../../util/pipelines/pipelines_exec.h"
+
+// If this is defined particle and mover buffers will not resize dynamically.
+// This is the common case for the users.
+
+// #define DISABLE_DYNAMIC_RESIZING
+
+// FIXME: ARCHITECTURAL FLAW!  CUSTOM BCS AND SHARED FACES CANNOT
+// COEXIST ON THE SAME FACE!  THIS MEANS THAT CUSTOM BOUNDARYS MUST
+// REINJECT ALL ABSORBED PARTICLES IN THE SAME DOMAIN!
+
+// Updated by Scott V. Luedtke, XCP-6, December 6, 2018.
+// The mover array is now resized along with the particle array.  The mover
+// array is filled during advance_p and is most likely to overflow there, not
+// here.  Both arrays will now resize down as well.
+// 12/20/18: The mover array is no longer resized with the particle array, as
+// this actually uses more RAM than having static mover arrays.  The mover will
+// still size up if there are too many incoming particles, but this is rare.
+// Some hard-to-understand bit shifts have been replaced with cleaner code that
+// the compiler should have no trouble optimizing.
+
+#ifndef MIN_NP
+#define MIN_NP 128 // Default to 4kb (~1 page worth of memory)
+//#define MIN_NP 32768 // 32768 particles is 1 MiB of memory.
+#endif
+
+// Gives the axis associated with a local face.
+static const int axis[6]  = { 0, 1, 2, 0, 1, 2 };
+
+// Gives the location of sending face on the receiver.
+static const float dir[6] = { 1, 1, 1, -1, -1, -1 };
+
+// Gives the local mp port associated with a local face.
+static const int f2b[6]   = { BOUNDARY(-1, 0, 0),
+                              BOUNDARY( 0,-1, 0),
+                              BOUNDARY( 0, 0,-1),
+                              BOUNDARY( 1, 0, 0),
+                              BOUNDARY( 0, 1, 0),
+                              BOUNDARY( 0, 0, 1) };
+
+// Gives the local face associated with a local mp port (-1 if the port
+// is not that of a face).
+static const int b2f[N_PORT] = { -1, -1, -1, -1,  2, -1, -1, -1, -1,
+                                 -1,  1, -1,  0, -1,  3, -1,  4, -1,
+                                 -1, -1, -1, -1,  5, -1, -1, -1, -1 };
+
+// Coordinates (x,y,z) of the local voxel v.  Returns the port of the
+// neighboring domain v is a ghost voxel of (BOUNDARY(0,0,0) if v is not
+// a ghost voxel) and sets (i,j,k) to its position relative to the local
+// domain.
+
+static inline int
+ghost_port( int v,
+            int nx,
+            int ny,
+            int nz,
+            int * x,
+            int * y,
+            int * z,
+            int * i,
+            int * j,
+            int * k )
+{
+  *z = v / ( ( nx + 2 ) * ( ny + 2 ) );
+  v -= *z * ( ( nx + 2 ) * ( ny + 2 ) );
+  *y = v / ( nx + 2 );
+  *x = v - *y * ( nx + 2 );
+
+  *i = ( *x == 0 ) ? -1 : ( ( *x == nx + 1 ) ? 1 : 0 );
+  *j = ( *y == 0 ) ? -1 : ( ( *y == ny + 1 ) ? 1 : 0 );
+  *k = ( *z == 0 ) ? -1 : ( ( *z == nz + 1 ) ? 1 : 0 );
+
+  return BOUNDARY( *i, *j, *k );
+}
+
+// Voxel of the node of port BOUNDARY(i,j,k) that overlaps the ghost
+// voxel (x,y,z).  rn is the local resolution of that node.  The cuts are
+// rectilinear, so it has the local resolution along the axes it is not
+// offset along.
+
+static inline int
+receiver_voxel( const int * rn,
+                int x,
+                int y,
+                int z,
+                int i,
+                int j,
+                int k )
+{
+  return VOXEL( i < 0 ? rn[0] : ( i > 0 ? 1 : x ),
+                j < 0 ? rn[1] : ( j > 0 ? 1 : y ),
+                k < 0 ? rn[2] : ( k > 0 ? 1 : z ),
+                rn[0], rn[1], rn[2] );
+}
+
+// Words of a particle record sent through a port.  The face ports are
+// paired with face ports on the receiver.
+
+static inline int
+wire_words( int port )
+{
+  return b2f[ port ] >= 0 ? WIRE_FACE_WORDS : WIRE_MIGRATE_WORDS;
+}
+
+// Size of a message holding n particles in n_run species runs and n_acc
+// ghost accumulators sent through a port (see boundary_p_pipeline).
+
+static inline int
+wire_size( int port,
+           int n,
+           int n_run,
+           int n_acc )
+{
+  return 16 + n_acc * ( sizeof( accumulator_t ) + sizeof( int ) )
+            + n_run * 2 * sizeof( int )
+            + n * wire_words( port ) * sizeof( particle_wire_t );
+}
+
+//----------------------------------------------------------------------------//
+// Classify the movers of a species.  This strips the face a particle hit
+// from its voxel index and counts, for each pipeline, the particles sent
+// through each port and the particles left to the host.
+//----------------------------------------------------------------------------//
+
+void
+classify_movers_pipeline_scalar( boundary_p_movers_pipeline_args_t * args,
+                                 int pipeline_rank,
+                                 int n_pipeline )
+{
+  particle_t * RESTRICT ALIGNED(128) p0 = args->p0;
+
+  const particle_mover_t * RESTRICT ALIGNED(16)  pm       = args->pm;
+  const int64_t          * RESTRICT ALIGNED(128) neighbor = args->neighbor;
+  /**/  int8_t           * RESTRICT ALIGNED(128) code     = args->code;
+
+  const int64_t rangel = args->rangel;
+  const int64_t rangeh = args->rangeh;
+  const int64_t rangem = args->rangem;
+
+  const int layout = args->layout;
+  const int nm     = args->nm;
+
+  int32_t * pv;
+  int q, n, voxel, face, c, x, y, z, i, j, k;
+  int64_t nn;
+
+  // No straggler cleanup needed.
+  if ( pipeline_rank == n_pipeline )
+  {
+    return;
+  }
+
+  int * RESTRICT count = args->count + N_PORT*pipeline_rank;
+
+  CLEAR( count, N_PORT );
+
+  DISTRIBUTE( nm, 1, pipeline_rank, n_pipeline, q, n );
+
+  for( ; n; n--, q++ )
+  {
+    pv      = particle_voxel( p0, layout, pm[ nm - 1 - q ].i );
+
+    voxel   = *pv;
+    face    = voxel & 7;
+    voxel >>= 3;
+    *pv     = voxel;
+
+    // Migrating directly to the domain whose ghost voxel it is in?
+
+    if ( face == MIGRATE_FACE )
+    {
+      c = ghost_port( voxel, args->nx, args->ny, args->nz,
+                      &x, &y, &z, &i, &j, &k );
+
+      count[ c ]++;
+
+      code[ q ] = c;
+
+      continue;
+    }
+
+    nn      = neighbor[ 6 * voxel + face ];
+
+    // Send to a neighboring node?  Absorbing and user-defined boundaries
+    // are never in these ranges.
+
+    if ( ( ( nn >= 0      ) & ( nn <  rangel ) ) |
+         ( ( nn >  rangeh ) & ( nn <= rangem ) ) )
+    {
+      c = f2b[ face ];
+    }
+
+    else
+    {
+      c = LOCAL_MOVER | face;
+    }
+
+    count[ c & LOCAL_MOVER ? BOUNDARY(0,0,0) : c ]++;
+
+    code[ q ] = c;
+  }
+}
+
+//----------------------------------------------------------------------------//
+// Pack the particles sent to neighboring nodes.  On input, count holds
+// where each pipeline starts writing into each send buffer (in records).
+// The momentum, weight and displacement are copied as contiguous blocks.
+//----------------------------------------------------------------------------//
+
+void
+pack_movers_pipeline_scalar( boundary_p_movers_pipeline_args_t * args,
+                             int pipeline_rank,
+                             int n_pipeline )
+{
+  const particle_t       * RESTRICT ALIGNED(128) p0       = args->p0;
+  const particle_mover_t * RESTRICT ALIGNED(16)  pm       = args->pm;
+  const int64_t          * RESTRICT ALIGNED(128) neighbor = args->neighbor;
+  const int8_t           * RESTRICT ALIGNED(128) code     = args->code;
+  const int              * RESTRICT              rn       = args->migrate_n;
+
+  const int layout = args->layout;
+  const int nm     = args->nm;
+  const int nx     = args->nx;
+  const int ny     = args->ny;
+  const int nz     = args->nz;
+
+  DECLARE_ALIGNED_ARRAY( particle_t, 32, p, 1 );
+
+  const particle_mover_t * RESTRICT ALIGNED(16) m;
+  /**/  particle_wire_t  * RESTRICT            w;
+  int q, n, port, face, a, x, y, z, i, j, k;
+
+  // No straggler cleanup needed.
+  if ( pipeline_rank == n_pipeline )
+  {
+    return;
+  }
+
+  int * RESTRICT next = args->count + N_PORT*pipeline_rank;
+
+  DISTRIBUTE( nm, 1, pipeline_rank, n_pipeline, q, n );
+
+  for( ; n; n--, q++ )
+  {
+    port = code[ q ];
+
+    if ( port & LOCAL_MOVER ) continue;
+
+    m  = pm + nm - 1 - q;
+
+    load_particle( p0, layout, m->i, p );
+
+    face = b2f[ port ];
+
+    w  = args->wire_send[ port ] + wire_words( port ) * next[ port ]++;
+
+    if ( face >= 0 )
+    {
+      // The coordinate along the face normal is omitted.
+
+      a = axis[ face ];
+
+      w[0].f = ( &p->dx )[ a == 0 ? 1 : 0 ];
+      w[1].f = ( &p->dx )[ a == 2 ? 1 : 2 ];
+      w     += 2;
+
+      w[0].i = neighbor[ 6 * p->i + face ] - args->range[ face ];
+    }
+
+    else
+    {
+      w[0].f = p->dx;
+      w[1].f = p->dy;
+      w[2].f = p->dz;
+      w     += 3;
+
+      // A migrating particle is already in the ghost voxel of its
+      // receiver's voxel.
+
+      ghost_port( p->i, nx, ny, nz, &x, &y, &z, &i, &j, &k );
+
+      w[0].i = receiver_voxel( rn + 3 * port, x, y, z, i, j, k );
+    }
+
+    memcpy( w + 1, &p->ux,    4 * sizeof( float ) );
+    memcpy( w + 5, &m->dispx, 3 * sizeof( float ) );
+  }
+}
+
+//----------------------------------------------------------------------------//
+// Remove all the movers' particles from the particle array.  This gives
+// exactly the particle order of removing the particles one at a time in
+// reverse mover order, each time moving the last particle into the hole.
+//
+// When the k-th mover is removed that way, the particle at np-nm+k moves
+// into its hole.  If np-nm+k is itself the particle of a later removed
+// mover j, that particle was already replaced by the one from np-nm+j and
+// so on.  Only holes below np-nm (the first nh movers) remain in the
+// array.  Following each of their chains independently lets the holes be
+// filled in parallel.
+//----------------------------------------------------------------------------//
+
+// Index of the mover of particle i in pm[lo:hi-1] (-1 if none).
+
+static inline int
+find_mover( const particle_mover_t * RESTRICT ALIGNED(16) pm,
+            int lo,
+            int hi,
+            int i )
+{
+  const int n = hi;
+  int mid;
+
+  while( lo < hi )
+  {
+    mid = lo + ( ( hi - lo ) >> 1 );
+
+    if ( pm[ mid ].i < i ) lo = mid + 1;
+    else                   hi = mid;
+  }
+
+  return ( lo < n && pm[ lo ].i == i ) ? lo : -1;
+}
+
+void
+backfill_movers_pipeline_scalar( boundary_p_movers_pipeline_args_t * args,
+                                 int pipeline_rank,
+                                 int n_pipeline )
+{
+  particle_t * RESTRICT ALIGNED(128) p0 = args->p0;
+
+  const particle_mover_t * RESTRICT ALIGNED(16) pm = args->pm;
+
+  const int layout = args->layout;
+  const int nm     = args->nm;
+  const int nh     = args->nh;
+  const int np     = args->np - nm;
+
+  DECLARE_ALIGNED_ARRAY( particle_t, 32, p, 1 );
+
+  int k, n, i, j;
+
+  // No straggler cleanup needed.
+  if ( pipeline_rank == n_pipeline )
+  {
+    return;
+  }
+
+  DISTRIBUTE( nh, 1, pipeline_rank, n_pipeline, k, n );
+
+  for( ; n; n--, k++ )
+  {
+    i = np + k;
+
+    while( ( j = find_mover( pm, nh, nm, i ) ) >= 0 ) i = np + j;
+
+    if ( layout == PARTICLE_LAYOUT_AOSOA )
+    {
+      load_particle ( p0, layout, i,         p );
+      store_particle( p0, layout, pm[k].i, p );
+    }
+
+    else
+    {
+      p0[ pm[k].i ] = p0[ i ];
+    }
+  }
+}
+
+//----------------------------------------------------------------------------//
+// Unpack the received particle records to injectors.  A record received
+// through port p was sent through port N_PORT-1-p; if that is the port of
+// a face, the omitted coordinate is that of the receiver's side of the
+// face.
+//----------------------------------------------------------------------------//
+
+void
+unpack_injectors_pipeline_scalar( boundary_p_unpack_pipeline_args_t * args,
+                                  int pipeline_rank,
+                                  int n_pipeline )
+{
+  const particle_wire_t * RESTRICT w;
+  const int             * RESTRICT run;
+  /**/  particle_injector_t * RESTRICT ALIGNED(16) pi;
+
+  int n, n_unp, port, r, t, nw, face, a;
+
+  // No straggler cleanup needed.
+  if ( pipeline_rank == n_pipeline )
+  {
+    return;
+  }
+
+  DISTRIBUTE( args->n_inj, 1, pipeline_rank, n_pipeline, n, n_unp );
+
+  pi = args->pi + n;
+
+  // Port and record of the first record to unpack.
+
+  for( port = 0, r = n; port < N_PORT && r >= args->n[ port ]; port++ )
+  {
+    r -= args->n[ port ];
+  }
+
+  while( n_unp )
+  {
+    while( r == args->n[ port ] ) port++, r = 0;
+
+    nw   = wire_words( port );
+    face = b2f[ N_PORT - 1 - port ];
+    run  = args->run[ port ];
+    w    = args->wire[ port ] + nw * r;
+
+    // Run of the record.
+
+    for( t = r; t >= run[1]; run += 2 ) t -= run[1];
+
+    for( ; n_unp && r < args->n[ port ]; n_unp--, r++, t++, pi++, w += nw )
+    {
+      if ( t == run[1] ) run += 2, t = 0;
+
+      if ( face >= 0 )
+      {
+        a = axis[ face ];
+
+        ( &pi->dx )[ a              ] = dir[ face ];
+        ( &pi->dx )[ a == 0 ? 1 : 0 ] = w[0].f;
+        ( &pi->dx )[ a == 2 ? 1 : 2 ] = w[1].f;
+
+        memcpy( &pi->i, w + 2, WIRE_TAIL_WORDS * sizeof( particle_wire_t ) );
+      }
+
+      else
+      {
+        memcpy( &pi->dx, w, WIRE_MIGRATE_WORDS * sizeof( particle_wire_t ) );
+      }
+
+      pi->sp_id = run[0];
+    }
+  }
+}
+
+//----------------------------------------------------------------------------//
+// Injection of the local and received injectors.
+//----------------------------------------------------------------------------//
+
+// Segment s of injector n in injection order and its position r in that
+// segment.
+
+static inline void
+locate_injector( const boundary_p_inject_pipeline_args_t * args,
+                 int n,
+                 int * s,
+                 int * r )
+{
+  int t = 0;
+
+  while( t < N_PORT && n >= args->n[t] ) n -= args->n[t++];
+
+  *s = t;
+  *r = n;
+}
+
+void
+count_injectors_pipeline_scalar( boundary_p_inject_pipeline_args_t * args,
+                                 int pipeline_rank,
+                                 int n_pipeline )
+{
+  int n_inj, n, s, r;
+
+  // No straggler cleanup needed.
+  if ( pipeline_rank == n_pipeline )
+  {
+    return;
+  }
+
+  int * RESTRICT count = args->count + MAX_SP*pipeline_rank;
+
+  CLEAR( count, MAX_SP );
+
+  DISTRIBUTE( args->n_inj, 1, pipeline_rank, n_pipeline, n, n_inj );
+
+  locate_injector( args, n, &s, &r );
+
+  for( ; n_inj; n_inj-- )
+  {
+    while( r == args->n[s] ) s++, r = 0;
+
+    count[ args->pi[s][ args->n[s] - 1 - r++ ].sp_id ]++;
+  }
+}
+
+// Each injector gets a mover in pm.  Injectors whose particle is dropped
+// or completes its move have their mover index set to -1.  On input,
+// count holds where each pipeline starts appending to each species.
+
+void
+inject_particles_pipeline_scalar( boundary_p_inject_pipeline_args_t * args,
+                                  int pipeline_rank,
+                                  int n_pipeline )
+{
+  const grid_t * g = args->g;
+
+  DECLARE_ALIGNED_ARRAY( particle_t, 32, p, 1 );
+
+  const particle_injector_t * RESTRICT ALIGNED(16) pi;
+  /**/  particle_mover_t    * RESTRICT ALIGNED(16) m;
+  /**/  particle_t          * RESTRICT ALIGNED(128) p0;
+
+  int n_inj, n, s, r, id, np;
+
+  // No straggler cleanup needed.
+  if ( pipeline_rank == n_pipeline )
+  {
+    return;
+  }
+
+  int * RESTRICT next = args->count + MAX_SP*pipeline_rank;
+
+  accumulator_tiles_t * at = args->at + 1 + pipeline_rank;
+
+  DISTRIBUTE( args->n_inj, 1, pipeline_rank, n_pipeline, n, n_inj );
+
+  locate_injector( args, n, &s, &r );
+
+  for( m = args->pm + n; n_inj; n_inj--, m++ )
+  {
+    while( r == args->n[s] ) s++, r = 0;
+
+    pi = args->pi[s] + args->n[s] - 1 - r++;
+
+    id = pi->sp_id;
+    p0 = args->sp_p[id];
+    np = next[id]++;
+
+    if ( np >= args->sp_max_np[id] )
+    {
+      m->i = -1;
+
+      continue;
+    }
+
+    p->dx = pi->dx;
+    p->dy = pi->dy;
+    p->dz = pi->dz;
+    p->i  = pi->i;
+
+    p->ux = pi->ux;
+    p->uy = pi->uy;
+    p->uz = pi->uz;
+    p->w  = pi->w;
+
+    store_particle( p0, args->sp_layout[id], np, p );
+
+    m->dispx = pi->dispx;
+    m->dispy = pi->dispy;
+    m->dispz = pi->dispz;
+    m->i     = np;
+
+    if ( ! ( args->sp_layout[id] == PARTICLE_LAYOUT_AOSOA ?
+             move_p_aosoa_tiles( p0, m, at, g, args->sp_q[id] ) :
+             move_p_tiles      ( p0, m, at, g, args->sp_q[id] ) ) )
+    {
+      m->i = -1;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------//
+// Current of the migrating particles.  move_p deposits the current of the
+// part of the move of a migrating particle outside the local domain in
+// the ghost accumulators.  That part of the move spans at most two voxels
+// along each axis and ends in the ghost voxel the particle is left in.
+// So the nonzero ghost accumulators are all next to the ghost voxel of a
+// migrating particle.  boundary_p sends them to the nodes owning these
+// ghost voxels, which add them to their accumulators.
+//----------------------------------------------------------------------------//
+
+// Zero the nonzero ghost accumulators next to the ghost voxel v.  If acc
+// is not NULL, they and their voxels are first appended to acc and
+// acc_v.  Returns the number of accumulators appended.
+
+static int
+collect_ghost_current( accumulator_t * RESTRICT ALIGNED(128) a,
+                       const grid_t  *                       g,
+                       int                                   v,
+                       accumulator_t * RESTRICT              acc,
+                       int           * RESTRICT              acc_v )
+{
+  const int nx = g->nx;
+  const int ny = g->ny;
+  const int nz = g->nz;
+
+  const float * RESTRICT f;
+
+  int x, y, z, i, j, k, c, n = 0;
+
+  ghost_port( v, nx, ny, nz, &x, &y, &z, &i, &j, &k );
+
+  for( k = z - 1; k <= z + 1; k++ )
+  {
+    for( j = y - 1; j <= y + 1; j++ )
+    {
+      for( i = x - 1; i <= x + 1; i++ )
+      {
+        if ( i < 0 || i > nx + 1 || j < 0 || j > ny + 1 ||
+             k < 0 || k > nz + 1 ) continue;
+
+        if ( i >= 1 && i <= nx && j >= 1 && j <= ny &&
+             k >= 1 && k <= nz ) continue; // Not a ghost voxel
+
+        v = VOXEL( i, j, k, nx, ny, nz );
+        f = (const float *) ( a + v );
+
+        for( c = 0; c < (int) ( sizeof( accumulator_t ) / sizeof( float ) ) &&
+                    f[c] == 0; c++ );
+
+        if ( c == (int) ( sizeof( accumulator_t ) / sizeof( float ) ) ) continue;
+
+        if ( acc )
+        {
+          acc  [ n ] = a[ v ];
+          acc_v[ n ] = v;
+        }
+
+        n++;
+
+        CLEAR( a + v, 1 );
+      }
+    }
+  }
+
+  return n;
+}
+
+void
+discard_migrated_current( accumulator_array_t * RESTRICT aa,
+                          int v )
+{
+  collect_ghost_current( aa->a, aa->g, v, NULL, NULL );
+}
+
+//----------------------------------------------------------------------------//
+// Top level function.  The mover classification, the send buffer packing,
+// the particle array backfill and the injection are done by the pipelines.
+// The boundary interactions handled locally (absorption, user-defined
+// handlers) are done by the host in the same order as a serial exchange
+// so that they see the same particles in the same order (e.g. random
+// number draws and tallies are reproducible).  The particle order that
+// results is the same as a serial exchange and independent of the number
+// of pipelines.  boundary_p is reentrant; it has no static state.
+//
+// A message sent through a port holds a 16 byte header, the migrated
+// ghost accumulators and the receiver voxels they go to, then the run
+// table and the records of the particles (see boundary_p_pipeline.h).
+// The message is not sent if it would be empty.
+//----------------------------------------------------------------------------//
+
+void
+boundary_p_pipeline( particle_bc_t       * RESTRICT pbc_list,
+                     species_t           * RESTRICT sp_list,
+                     field_array_t       * RESTRICT fa,
+                     accumulator_array_t * RESTRICT aa )
+{
+  DECLARE_ALIGNED_ARRAY( boundary_p_movers_pipeline_args_t, 128, margs, 1 );
+  DECLARE_ALIGNED_ARRAY( boundary_p_unpack_pipeline_args_t, 128, uargs, 1 );
+  DECLARE_ALIGNED_ARRAY( boundary_p_inject_pipeline_args_t, 128, iargs, 1 );
+
+  DECLARE_ALIGNED_ARRAY( int, 128, count, MAX_SP * ( MAX_PIPELINE + 1 ) );
+
+  // Local particle injectors.
+  particle_injector_t * RESTRICT ALIGNED(16) ci = NULL;
+
+  int n_send[N_PORT], n_recv[N_PORT], n_ci;
+  int n_run [N_PORT], n_rrun[N_PORT];
+  int n_acc [N_PORT], n_racc[N_PORT];
+
+  species_t * sp;
+
+  int port, face, rank;
+
+  // Check input args.
+
+  if ( ! sp_list )
+  {
+    return; // Nothing to do if no species.
+  }
+
+  if ( ! fa                ||
+       ! aa                ||
+       sp_list->g != aa->g ||
+       fa->g      != aa->g )
+  {
+    ERROR( ( "Bad args." ) );
+  }
+
+  if ( num_species( sp_list ) > MAX_SP )
+  {
+    ERROR( ( "Update this to support more species." ) );
+  }
+
+  // Unpack the particle boundary conditions.
+
+  particle_bc_func_t pbc_interact[MAX_PBC];
+
+  void * pbc_params[MAX_PBC];
+
+  const int nb = num_particle_bc( pbc_list );
+
+  if ( nb > MAX_PBC )
+  {
+    ERROR( ( "Update this to support more particle boundary conditions." ) );
+  }
+
+  for( particle_bc_t * pbc = pbc_list; pbc; pbc = pbc->next )
+  {
+    pbc_interact[ -pbc->id - 3 ] = pbc->interact;
+    pbc_params  [ -pbc->id - 3 ] = pbc->params;
+  }
+
+  // Unpack fields.
+
+  field_t * RESTRICT ALIGNED(128) f = fa->f;
+  grid_t  * RESTRICT              g = fa->g;
+
+  // Unpack the grid.
+
+  const int64_t * RESTRICT ALIGNED(128) neighbor = g->neighbor;
+  /**/  mp_t    * RESTRICT              mp       = g->mp;
+
+  const int64_t rangel = g->rangel;
+  const int64_t rangeh = g->rangeh;
+  const int64_t rangem = g->range[world_size];
+
+  const int nx = g->nx;
+  const int ny = g->ny;
+  const int nz = g->nz;
+
+  // Particles are exchanged with the nodes joined through the faces and
+  // with the nodes particles migrate to directly.  Both sides of a port
+  // agree on whether it is shared.
+
+  /*const*/ int bc[N_PORT], shared[N_PORT];
+  /*const*/ int64_t range[6];
+
+  for( port = 0; port < N_PORT; port++ )
+  {
+    bc    [ port ] = b2f[ port ] >= 0 ? g->bc[ port ] : g->migrate[ port ];
+
+    shared[ port ] = ( port       != BOUNDARY(0,0,0) ) &&
+                     ( bc[ port ] >= 0               ) &&
+                     ( bc[ port ] <  world_size      ) &&
+                     ( bc[ port ] != world_rank      );
+  }
+
+  for( face = 0; face < 6; face++ )
+  {
+    range[ face ] = shared[ f2b[ face ] ] ? g->range[ bc[ f2b[ face ] ] ] : 0;
+  }
+
+  // Begin receiving the particle, run and accumulator counts (unless they
+  // are exchanged with a neighborhood collective, see
+  // setup_neighbor_collectives).
+
+  const int neighbors = mp_has_neighbors( mp );
+
+  for( port = 0; port < N_PORT; port++ )
+  {
+    if ( shared[ port ] && ! neighbors )
+    {
+      mp_size_recv_buffer( mp,
+                           port,
+                           3*sizeof( int ) );
+
+      mp_begin_recv( mp,
+                     port,
+                     3*sizeof( int ),
+                     bc[ port ],
+                     N_PORT - 1 - port );
+    }
+  }
+
+  // Load the particle send and local injection buffers.
+
+  do
+  {
+    // The movers of all the species are classified first so that the
+    // send buffers can be sized exactly.
+    //
+    // FIXME: This presizing of the local injection buffer assumes that
+    // custom boundary conditions inject at most one particle per
+    // incident particle.  Currently, the invocation of pbc_interact[*]
+    // insures that assumption will be satisfied, if the handlers conform
+    // that it.  We should be more flexible though in the future.
+
+    const int n_sp = num_species( sp_list );
+
+    int nm = 0, n_code = 0, n_mig = 0, q, k, n;
+
+    int n_local[ MAX_SP ], code_off[ MAX_SP ];
+
+    // Each species's mover codes start on a 128 byte boundary.
+
+    LIST_FOR_EACH( sp, sp_list )
+    {
+      nm += sp->nm;
+
+      code_off[ sp->id ] = n_code;
+
+      n_code += ( sp->nm + 127 ) & ~127;
+    }
+
+    MALLOC_ALIGNED( ci, nm + 1, 16 );
+
+    n_ci = 0;
+
+    int8_t * ALIGNED(128) code;
+    int    *              sp_count;
+
+    MALLOC_ALIGNED( code, n_code + 1, 128 );
+    MALLOC( sp_count, N_PORT * N_PIPELINE * n_sp );
+
+    margs->neighbor  = neighbor;
+    margs->migrate_n = g->migrate_n[0];
+    margs->rangel   = rangel;
+    margs->rangeh   = rangeh;
+    margs->rangem   = rangem;
+    margs->nx       = nx;
+    margs->ny       = ny;
+    margs->nz       = nz;
+
+    for( face = 0; face < 6; face++ )
+    {
+      margs->range[ face ] = range[ face ];
+    }
+
+    CLEAR( n_send, N_PORT );
+    CLEAR( n_run,  N_PORT );
+
+    // Note that particle movers for each species are processed in
+    // reverse order.  This allows us to backfill holes in the
+    // particle list created by boundary conditions and/or
+    // communication.  This assumes particles on the mover list are
+    // monotonically increasing.  That is: pm[n].i > pm[n-1].i for
+    // n=1...nm-1.  advance_p and inject_particle create movers with
+    // property if all aged particle injection occurs after
+    // advance_p and before this.
+
+    LIST_FOR_EACH( sp, sp_list )
+    {
+      int * RESTRICT c = sp_count + N_PORT * N_PIPELINE * sp->id;
+
+      n_local[ sp->id ] = 0;
+
+      if ( ! sp->nm ) continue;
+
+      margs->p0     = sp->p;
+      margs->pm     = sp->pm;
+      margs->code   = code + code_off[ sp->id ];
+      margs->count  = c;
+      margs->np     = sp->np;
+      margs->nm     = sp->nm;
+      margs->layout = sp->layout;
+
+      EXEC_PIPELINES( classify_movers, margs, 0 );
+
+      WAIT_PIPELINES();
+
+      for( port = 0; port < N_PORT; port++ )
+      {
+        for( rank = n = 0; rank < N_PIPELINE; rank++ )
+        {
+          n += c[ N_PORT*rank + port ];
+        }
+
+        if ( port == BOUNDARY(0,0,0) )
+        {
+          n_local[ sp->id ] += n;
+        }
+
+        else if ( n )
+        {
+          n_send[ port ] += n;
+          n_run [ port ]++;
+
+          if ( b2f[ port ] < 0 ) n_mig += n;
+        }
+      }
+    }
+
+    // Collect the current the migrating particles deposited in the ghost
+    // accumulators.  Ghost voxels of this node (periodic directions with
+    // a single domain) are added back to the local accumulators.
+
+    accumulator_t * ALIGNED(16) acc   = NULL;
+    int           *             acc_v = NULL;
+    int                         n_a   = 0;
+
+    CLEAR( n_acc, N_PORT );
+
+    if ( n_mig )
+    {
+      int x, y, z, i, j, m;
+
+      MALLOC_ALIGNED( acc, 27*n_mig, 16 );
+      MALLOC( acc_v, 27*n_mig );
+
+      LIST_FOR_EACH( sp, sp_list )
+      {
+        for( q = 0; q < sp->nm; q++ )
+        {
+          port = code[ code_off[ sp->id ] + q ];
+
+          if ( ( port & LOCAL_MOVER ) || b2f[ port ] >= 0 ) continue;
+
+          n_a += collect_ghost_current( aa->a,
+                                        g,
+                                        *particle_voxel( sp->p,
+                                                         sp->layout,
+                                                         sp->pm[ sp->nm - 1 - q ].i ),
+                                        acc   + n_a,
+                                        acc_v + n_a );
+        }
+      }
+
+      // Ghost accumulators go to the node owning the ghost voxel.
+
+      for( n = m = 0; n < n_a; n++ )
+      {
+        port = ghost_port( acc_v[n], nx, ny, nz, &x, &y, &z, &i, &j, &k );
+
+        if ( g->migrate[ port ] == world_rank )
+        {
+          accumulator_t * RESTRICT a = aa->a +
+            receiver_voxel( g->migrate_n[ port ], x, y, z, i, j, k );
+
+          for( q = 0; q < 4; q++ )
+          {
+            a->jx[q] += acc[n].jx[q];
+            a->jy[q] += acc[n].jy[q];
+            a->jz[q] += acc[n].jz[q];
+          }
+
+          continue;
+        }
+
+        if ( ! shared[ port ] ) continue; // Cannot happen
+
+        n_acc[ port ]++;
+
+        acc  [ m ] = acc  [ n ];
+        acc_v[ m ] = acc_v[ n ];
+
+        m++;
+      }
+
+      n_a = m;
+    }
+
+    // Size the send buffers and put the ghost accumulators and the run
+    // tables in them.  The runs are in species list order like the
+    // packing below.
+
+    int * run_send[ N_PORT ];
+
+    for( port = 0; port < N_PORT; port++ )
+    {
+      margs->wire_send[ port ] = NULL;
+
+      run_send[ port ] = NULL;
+
+      if ( shared[ port ] )
+      {
+        mp_size_send_buffer( mp,
+                             port,
+                             wire_size( port,
+                                        n_send[ port ],
+                                        n_run [ port ],
+                                        n_acc [ port ] ) );
+
+        run_send[ port ] = (int *)
+          ( ( (char *) mp_send_buffer( mp, port ) ) + 16
+            + n_acc[ port ] * ( sizeof( accumulator_t ) + sizeof( int ) ) );
+
+        margs->wire_send[ port ] = (particle_wire_t *)
+          ( run_send[ port ] + 2 * n_run[ port ] );
+      }
+    }
+
+    LIST_FOR_EACH( sp, sp_list )
+    {
+      int * RESTRICT c = sp_count + N_PORT * N_PIPELINE * sp->id;
+
+      if ( ! sp->nm ) continue;
+
+      for( port = 0; port < N_PORT; port++ )
+      {
+        if ( ! run_send[ port ] ) continue;
+
+        for( rank = n = 0; rank < N_PIPELINE; rank++ )
+        {
+          n += c[ N_PORT*rank + port ];
+        }
+
+        if ( n )
+        {
+          *run_send[ port ]++ = sp->id;
+          *run_send[ port ]++ = n;
+        }
+      }
+    }
+
+    if ( n_a )
+    {
+      int next[ N_PORT ], x, y, z, i, j;
+
+      CLEAR( next, N_PORT );
+
+      for( n = 0; n < n_a; n++ )
+      {
+        port = ghost_port( acc_v[n], nx, ny, nz, &x, &y, &z, &i, &j, &k );
+
+        accumulator_t * RESTRICT a = (accumulator_t *)
+          ( ( (char *) mp_send_buffer( mp, port ) ) + 16 );
+
+        int * RESTRICT v = (int *) ( a + n_acc[ port ] );
+
+        a[ next[ port ] ]   = acc[ n ];
+        v[ next[ port ]++ ] = receiver_voxel( g->migrate_n[ port ],
+                                              x, y, z, i, j, k );
+      }
+    }
+
+    FREE_ALIGNED( acc );
+    FREE( acc_v );
+
+    // For each species, pack the sends, handle the local movers and
+    // remove the movers' particles.
+
+    CLEAR( n_send, N_PORT );
+
+    LIST_FOR_EACH( sp, sp_list )
+    {
+      particle_mover_t * RESTRICT ALIGNED(16) pm = sp->pm;
+
+      int * RESTRICT c = sp_count + N_PORT * N_PIPELINE * sp->id;
+
+      const int np = sp->np;
+
+      int8_t * RESTRICT ALIGNED(128) sp_code = code + code_off[ sp->id ];
+
+      nm = sp->nm;
+
+      if ( ! nm ) continue;
+
+      margs->p0     = sp->p;
+      margs->pm     = pm;
+      margs->code   = sp_code;
+      margs->count  = c;
+      margs->np     = np;
+      margs->nm     = nm;
+      margs->sp_id  = sp->id;
+      margs->layout = sp->layout;
+
+      // Each pipeline appends its sends to the send buffers after those
+      // of the pipelines before it.
+
+      for( rank = 0; rank < N_PIPELINE; rank++ )
+      {
+        for( port = 0; port < N_PORT; port++ )
+        {
+          k = c[ N_PORT*rank + port ];
+
+          c[ N_PORT*rank + port ] = n_send[ port ];
+
+          n_send[ port ] += k;
+        }
+      }
+
+      EXEC_PIPELINES( pack_movers, margs, 0 );
+
+      // Meanwhile, handle the local boundary interactions.
+
+      if ( n_local[ sp->id ] )
+      {
+        particle_t * RESTRICT ALIGNED(128) p0 = sp->p;
+
+        const int layout = sp->layout;
+
+        DECLARE_ALIGNED_ARRAY( particle_t, 32, local_p, 1 );
+
+        particle_t * ALIGNED(32) p;
+
+        int64_t nn;
+
+        for( q = 0; q < nm; q++ )
+        {
+          if ( ! ( sp_code[ q ] & LOCAL_MOVER ) ) continue;
+
+          face = sp_code[ q ] & 7;
+          k    = nm - 1 - q;
+
+          if ( layout == PARTICLE_LAYOUT_AOSOA )
+          {
+            // The particle is removed below whatever happens to it, so
+            // the boundary interaction can work on a gathered copy.
+            p = local_p;
+
+            load_particle( p0, layout, pm[k].i, p );
+          }
+
+          else
+          {
+            p = p0 + pm[k].i;
+          }
+
+          nn = neighbor[ 6 * p->i + face ];
+
+          // Absorb.
+
+          if ( nn == absorb_particles )
+          {
+            // Ideally, we would batch all rhob accumulations together
+            // for efficiency.
+            accumulate_rhob( f, p, g, sp->q );
+
+            continue;
+          }
+
+          // User-defined handling.
+
+          // After a particle interacts with a boundary it is removed
+          // from the local particle list.  Thus, if a boundary handler
+          // does not want a particle destroyed,  it is the boundary
+          // handler's job to append the destroyed particle to the list
+          // of particles to inject.
+          //
+          // Note that these destruction and creation processes do _not_
+          // adjust rhob by default.  Thus, a boundary handler is
+          // responsible for insuring that the rhob is updated
+          // appropriate for the incident particle it destroys and for
+          // any particles it injects as a result too.
+          //
+          // Since most boundary handlers do local reinjection and are
+          // charge neutral, this means most boundary handlers do
+          // nothing to rhob.
+
+          nn = -nn - 3; // Assumes reflective/absorbing are -1, -2
+
+          if ( ( nn >= 0  ) &
+               ( nn <  nb ) )
+          {
+            n_ci += pbc_interact[ nn ]( pbc_params[ nn ],
+                                        sp,
+                                        p,
+                                        pm + k,
+                                        ci + n_ci,
+                                        1,
+                                        face );
+
+            continue;
+          }
+
+          // Uh-oh: We fell through.
+
+          WARNING( ( "Unknown boundary interaction ... dropping particle "
+                     "(species=%s)",
+                     sp->name ) );
+        }
+      }
+
+      WAIT_PIPELINES();
+
+      // Backfill the holes the movers leave in the particle array.
+
+      margs->nh = 0;
+
+      while( margs->nh < nm && pm[ margs->nh ].i < np - nm ) margs->nh++;
+
+      if ( margs->nh )
+      {
+        EXEC_PIPELINES( backfill_movers, margs, 0 );
+
+        WAIT_PIPELINES();
+      }
+
+      sp->np = np - nm;
+      sp->nm = 0;
+    }
+
+    FREE( sp_count );
+    FREE_ALIGNED( code );
+
+  } while(0);
+
+  // Finish exchanging particle, run and accumulator counts and start
+  // exchanging actual particles and accumulators.
+
+  // Note: This is wasteful of communications.  A better protocol
+  // would fuse the exchange of the counts with the exchange of the
+  // messages.  in a slightly more complex protocol.  However, the MP
+  // API prohibits such a model.  Unfortuantely, refining MP is not
+  // much help here.  Under the hood on Roadrunner, the DaCS API also
+  // prohibits such (specifically, in both, you can't do the
+  // equilvanet of a MPI_Getcount to determine how much data you
+  // actually received.
+
+  if ( neighbors )
+  {
+    int count[ 3*N_PORT ], rcount[ 3*N_PORT ];
+
+    for( port = 0; port < N_PORT; port++ )
+    {
+      count [ 3*port     ] = n_send[ port ];
+      count [ 3*port + 1 ] = n_run [ port ];
+      count [ 3*port + 2 ] = n_acc [ port ];
+      rcount[ 3*port     ] = 0;
+      rcount[ 3*port + 1 ] = 0;
+      rcount[ 3*port + 2 ] = 0;
+    }
+
+    mp_neighbor_alltoall_i( mp,
+                            count,
+                            rcount,
+                            3 );
+
+    for( port = 0; port < N_PORT; port++ )
+    {
+      n_recv[ port ] = shared[ port ] ? rcount[ 3*port     ] : 0;
+      n_rrun[ port ] = shared[ port ] ? rcount[ 3*port + 1 ] : 0;
+      n_racc[ port ] = shared[ port ] ? rcount[ 3*port + 2 ] : 0;
+    }
+  }
+
+  else
+  {
+    for( port = 0; port < N_PORT; port++ )
+    {
+      if ( shared[ port ] )
+      {
+        ( (int *) mp_send_buffer( mp, port ) )[0] = n_send[ port ];
+        ( (int *) mp_send_buffer( mp, port ) )[1] = n_run [ port ];
+        ( (int *) mp_send_buffer( mp, port ) )[2] = n_acc [ port ];
+
+        mp_begin_send( mp,
+                       port,
+                       3*sizeof( int ),
+                       bc[ port ],
+                       port );
+      }
+    }
+  }
+
+  for( port = 0; port < N_PORT; port++ )
+  {
+    if ( shared[ port ] && ! neighbors )
+    {
+      mp_end_recv( mp,
+                   port );
+
+      n_recv[ port ] = ( (int *) mp_recv_buffer( mp, port ) )[0];
+      n_rrun[ port ] = ( (int *) mp_recv_buffer( mp, port ) )[1];
+      n_racc[ port ] = ( (int *) mp_recv_buffer( mp, port ) )[2];
+    }
+
+    else if ( ! shared[ port ] )
+    {
+      n_recv[ port ] = 0;
+      n_rrun[ port ] = 0;
+      n_racc[ port ] = 0;
+    }
+
+    if ( shared[ port ] )
+    {
+      if ( n_recv[ port ] || n_racc[ port ] )
+      {
+        const int sz = wire_size( port,
+                                  n_recv[ port ],
+                                  n_rrun[ port ],
+                                  n_racc[ port ] );
+
+        mp_size_recv_buffer( mp,
+                             port,
+                             sz );
+
+        mp_begin_recv( mp,
+                       port,
+                       sz,
+                       bc[ port ],
+                       N_PORT - 1 - port );
+      }
+    }
+  }
+
+  for( port = 0; port < N_PORT; port++ )
+  {
+    if ( shared[ port ] )
+    {
+      if ( ! neighbors )
+      {
+        mp_end_send( mp,
+                     port );
+      }
+
+      // FIXME: ASSUMES MP WON'T MUCK WITH REST OF SEND BUFFER.
+
+      if ( n_send[ port ] || n_acc[ port ] )
+      {
+        mp_begin_send( mp,
+                       port,
+                       wire_size( port,
+                                  n_send[ port ],
+                                  n_run [ port ],
+                                  n_acc [ port ] ),
+                       bc[ port ],
+                       port );
+      }
+    }
+  }
+
+  // Total number of particles to inject.
+
+  int max_inj = n_ci;
+
+  for( port = 0; port < N_PORT; port++ )
+  {
+    max_inj += n_recv[ port ];
+  }
+
+  #ifndef DISABLE_DYNAMIC_RESIZING
+  // Resize particle storage to accomodate worst case inject.
+
+  do
+  {
+    int n, nm;
+
+    // Resize each species's particle and mover storage to be large
+    // enough to guarantee successful injection.  If we broke down
+    // the n_recv[face] by species before sending it, we could be
+    // tighter on memory footprint here.
+
+    LIST_FOR_EACH( sp, sp_list )
+    {
+      particle_mover_t * new_pm;
+      particle_t       * new_p;
+
+      n = sp->np + max_inj;
+
+      if ( n > sp->max_np )
+      {
+        n += 0.3125 * n; // Increase by 31.25% (~<"silver
+        /**/             // ratio") to minimize resizes (max
+        /**/             // rate that avoids excessive heap
+        /**/             // fragmentation)
+
+        if ( sp->layout == PARTICLE_LAYOUT_AOSOA )
+        {
+          n = PARTICLE_BLOCK_CEIL( n ); // Whole tiles only
+        }
+
+        //WARNING( ( "Resizing local %s particle storage from %i to %i",
+                   //sp->name,
+                   //sp->max_np,
+                   //n ) );
+
+        MALLOC_ALIGNED( new_p, n, 128 );
+
+        COPY( new_p, sp->p, sp->layout == PARTICLE_LAYOUT_AOSOA ?
+                            PARTICLE_BLOCK_CEIL( sp->np ) : sp->np );
+
+        FREE_ALIGNED( sp->p );
+
+        sp->p      = new_p;
+        sp->max_np = n;
+      }
+
+      else if( sp->max_np > MIN_NP          &&
+               n          < sp->max_np >> 1 )
+      {
+        n += 0.125 * n; // Overallocate by less since this rank is decreasing
+
+        if ( n < MIN_NP )
+        {
+          n = MIN_NP;
+        }
+
+        if ( sp->layout == PARTICLE_LAYOUT_AOSOA )
+        {
+          n = PARTICLE_BLOCK_CEIL( n ); // Whole tiles only
+        }
+
+        //WARNING( ( "Resizing (shrinking) local %s particle storage from "
+                   //"%i to %i",
+                   //sp->name,
+                   //sp->max_np,
+                   //n ) );
+
+        MALLOC_ALIGNED( new_p, n, 128 );
+
+        COPY( new_p, sp->p, sp->layout == PARTICLE_LAYOUT_AOSOA ?
+                            PARTICLE_BLOCK_CEIL( sp->np ) : sp->np );
+
+        FREE_ALIGNED( sp->p );
+
+        sp->p      = new_p;
+        sp->max_np = n;
+      }
+
+      // Mover arrays are resized up only.
+      // The mover arrays can also run out of space in advance_p, so the user
+      // still needs to think about how big to make the mover arrays.
+
+      nm = sp->nm + max_inj;
+
+      if ( nm > sp->max_nm )
+      {
+        nm += 0.3125 * nm; // See note above
+
+        //WARNING( ( "Resizing local %s mover storage from %i to %i based on "
+        //           "not enough movers for all the incoming particles",
+        //           sp->name,
+        //           sp->max_nm,
+        //           nm ) );
+
+        MALLOC_ALIGNED( new_pm, nm, 128 );
+
+        COPY( new_pm, sp->pm, sp->nm );
+
+        FREE_ALIGNED( sp->pm );
+
+        sp->pm     = new_pm;
+        sp->max_nm = nm;
+      }
+    }
+  } while(0);
+  #endif
+
+  // Inject particles.  Local injectors are injected first, then the
+  // injectors received through each port.  Reverse order injection is
+  // done to reduce thrashing of the particle list.  Particles are
+  // removed in reverse order so the overall impact of removal +
+  // injection is to keep injected particles in order.
+  //
+  // WARNING: THIS TRUSTS THAT THE INJECTORS, INCLUDING THOSE RECEIVED
+  // FROM OTHER NODES, HAVE VALID PARTICLE IDS.
+
+  // Unpack the received particles.
+
+  particle_injector_t * RESTRICT ALIGNED(16) ri = NULL;
+
+  int n_ri;
+
+  uargs->n_inj = 0;
+
+  for( port = 0; port < N_PORT; port++ )
+  {
+    uargs->wire[ port ] = NULL;
+    uargs->run [ port ] = NULL;
+    uargs->n   [ port ] = 0;
+
+    if ( shared[ port ] && ( n_recv[ port ] || n_racc[ port ] ) )
+    {
+      mp_end_recv( mp,
+                   port );
+
+      // Add the current of the particles that migrated here.
+
+      const accumulator_t * RESTRICT a = (const accumulator_t *)
+        ( ( (char *) mp_recv_buffer( mp, port ) ) + 16 );
+
+      const int * RESTRICT v = (const int *) ( a + n_racc[ port ] );
+
+      for( int n = 0; n < n_racc[ port ]; n++ )
+      {
+        accumulator_t * RESTRICT a0 = aa->a + v[n];
+
+        for( int q = 0; q < 4; q++ )
+        {
+          a0->jx[q] += a[n].jx[q];
+          a0->jy[q] += a[n].jy[q];
+          a0->jz[q] += a[n].jz[q];
+        }
+      }
+
+      uargs->run [ port ] = v + n_racc[ port ];
+      uargs->wire[ port ] = (const particle_wire_t *)
+        ( uargs->run[ port ] + 2 * n_rrun[ port ] );
+      uargs->n   [ port ] = n_recv[ port ];
+
+      uargs->n_inj += n_recv[ port ];
+    }
+  }
+
+  if ( uargs->n_inj )
+  {
+    MALLOC_ALIGNED( ri, uargs->n_inj, 16 );
+
+    uargs->pi = ri;
+
+    EXEC_PIPELINES( unpack_injectors, uargs, 0 );
+
+    WAIT_PIPELINES();
+  }
+
+  iargs->pi[0] = ci;
+  iargs->n [0] = n_ci;
+
+  for( port = 0, n_ri = 0; port < N_PORT; port++ )
+  {
+    iargs->pi[ port + 1 ] = n_recv[ port ] ? ri + n_ri : NULL;
+    iargs->n [ port + 1 ] = n_recv[ port ];
+
+    n_ri += n_recv[ port ];
+  }
+
+  if ( max_inj )
+  {
+    particle_mover_t * RESTRICT ALIGNED(16) pm;
+    particle_mover_t * RESTRICT ALIGNED(16) sp_pm[ MAX_SP ];
+
+    int sp_np[ MAX_SP ], sp_nm[ MAX_SP ], n, s, r;
+
+    #ifdef DISABLE_DYNAMIC_RESIZING
+    int sp_max_nm[ MAX_SP ];
+    int n_dropped_particles[ MAX_SP ], n_dropped_movers[ MAX_SP ];
+    #endif
+
+    MALLOC_ALIGNED( pm, max_inj, 16 );
+
+    iargs->pm    = pm;
+    iargs->count = count;
+    iargs->at    = aa->tiles;
+    iargs->g     = g;
+    iargs->n_inj = max_inj;
+
+    LIST_FOR_EACH( sp, sp_list )
+    {
+      iargs->sp_p     [ sp->id ] = sp->p;
+      iargs->sp_q     [ sp->id ] = sp->q;
+      iargs->sp_layout[ sp->id ] = sp->layout;
+      iargs->sp_max_np[ sp->id ] = sp->max_np;
+
+      sp_pm[ sp->id ] = sp->pm;
+      sp_np[ sp->id ] = sp->np;
+      sp_nm[ sp->id ] = sp->nm;
+
+      #ifdef DISABLE_DYNAMIC_RESIZING
+      sp_max_nm[ sp->id ] = sp->max_nm;
+
+      n_dropped_particles[ sp->id ] = 0;
+      n_dropped_movers   [ sp->id ] = 0;
+      #endif
+    }
+
+    EXEC_PIPELINES( count_injectors, iargs, 0 );
+
+    WAIT_PIPELINES();
+
+    // Each pipeline appends its particles to each species after those
+    // of the pipelines before it.
+
+    for( rank = 0; rank < N_PIPELINE; rank++ )
+    {
+      LIST_FOR_EACH( sp, sp_list )
+      {
+        n = count[ MAX_SP*rank + sp->id ];
+
+        count[ MAX_SP*rank + sp->id ] = sp_np[ sp->id ];
+
+        sp_np[ sp->id ] += n;
+      }
+    }
+
+    // The pipelines deposit the current of the injected particles in
+    // their accumulator tiles.  These were already reduced into the
+    // host accumulator after advance_p and are reused here.
+
+    for( rank = 1; rank <= aa->n_pipeline; rank++ )
+    {
+      release_accumulator_tiles( aa->tiles + rank );
+    }
+
+    EXEC_PIPELINES( inject_particles, iargs, 0 );
+
+    WAIT_PIPELINES();
+
+    reduce_accumulator_array( aa );
+
+    // Append the movers of the particles that did not complete their
+    // move in injection order.
+
+    locate_injector( iargs, 0, &s, &r );
+
+    for( n = 0; n < max_inj; n++ )
+    {
+      while( r == iargs->n[s] ) s++, r = 0;
+
+      const int id = iargs->pi[s][ iargs->n[s] - 1 - r++ ].sp_id;
+
+      if ( pm[n].i < 0 ) continue;
+
+      #ifdef DISABLE_DYNAMIC_RESIZING
+      if ( sp_nm[ id ] >= sp_max_nm[ id ] )
+      {
+        n_dropped_movers[ id ]++;
+
+        continue;
+      }
+      #endif
+
+      sp_pm[ id ][ sp_nm[ id ]++ ] = pm[n];
+    }
+
+    LIST_FOR_EACH( sp, sp_list )
+    {
+      #ifdef DISABLE_DYNAMIC_RESIZING
+      if ( sp_np[ sp->id ] > sp->max_np )
+      {
+        n_dropped_particles[ sp->id ] = sp_np[ sp->id ] - sp->max_np;
+
+        sp_np[ sp->id ] = sp->max_np;
+      }
+
+      if ( n_dropped_particles[ sp->id ] )
+      {
+        WARNING( ( "Dropped %i particles from species \"%s\".  Use a larger "
+                   "local particle allocation in your simulation setup for "
+                   "this species on this node.",
+                   n_dropped_particles[ sp->id ],
+                   sp->name ) );
+      }
+
+      if ( n_dropped_movers[ sp->id ] )
+      {
+        WARNING( ( "%i particles were not completed moved to their final "
+                   "location this timestep for species \"%s\".  Use a larger "
+                   "local particle mover buffer in your simulation setup "
+                   "for this species on this node.",
+                   n_dropped_movers[ sp->id ],
+                   sp->name ) );
+      }
+      #endif
+
+      sp->np = sp_np[ sp->id ];
+      sp->nm = sp_nm[ sp->id ];
+    }
+
+    FREE_ALIGNED( pm );
+  }
+
+  FREE_ALIGNED( ci );
+  FREE_ALIGNED( ri );
+
+  for( port = 0; port < N_PORT; port++ )
+  {
+    if ( shared[ port ] && ( n_send[ port ] || n_acc[ port ] ) )
+    {
+      mp_end_send( mp,
+                   port );
+    }
+  }
+}
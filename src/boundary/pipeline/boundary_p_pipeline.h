@@ -0,0 +1,182 @@
+#ifndef _boundary_p_pipeline_h_
+#define _boundary_p_pipeline_h_
+
+#ifndef IN_boundary
+#error "Do not include boundary_p_pipeline.h; include boundary.h"
+#endif
+
+#include "../boundary_private.h"
+
+enum { MAX_PBC = 32, MAX_SP = 32 };
+
+// Particles are sent to the neighboring nodes through the mp ports
+// BOUNDARY(i,j,k) of the 26 neighboring domains.  Particles leaving
+// through a face are sent through the port of that face; particles
+// migrating directly to a domain sharing only an edge or a corner with
+// the local one (see move_p) through the port of that domain.
+//
+// Mover codes set by classify_movers.  A mover whose particle is sent to
+// a neighboring node has the code of the port it is sent through.  All
+// other movers (absorbed, user-defined handling, unknown interaction)
+// are handled locally by the host and have the code LOCAL_MOVER | face.
+
+enum { N_PORT = 27, LOCAL_MOVER = 32 };
+
+// Particles are not sent as particle_injector_t.  The particles sent
+// through a port are grouped in runs of the same species, listed in a run
+// table of (species id, particle count) pairs, and each particle is sent
+// as a record of 32-bit words.  A record holds the particle position,
+// then the voxel index, momentum, weight and displacement in the order of
+// particle_injector_t.  For a particle crossing a face, the coordinate
+// normal to the face is known to the receiver (the particle is on the
+// receiver's side of that face) and is omitted.  A record is thus
+// WIRE_FACE_WORDS words for the face ports and WIRE_MIGRATE_WORDS words
+// for the other ports.
+//
+// Compared with the 48 byte particle_injector_t, a face record is 40
+// bytes (1/6 less) and a migration record 44 bytes (1/12 less), plus 8
+// bytes per species run and port.  The rest of the record is the same 8
+// words as particle_injector_t, so pack and unpack copy it as a block.
+// The voxel index is the receiver's full local index.  A face-local
+// index (the voxel in the plane of the face) would still take a 32-bit
+// word, so it would save nothing.  It would also tie the in-plane
+// resolutions of face neighbors together, which the neighbor table used
+// to address them does not require.
+
+typedef union particle_wire
+{
+  float   f;
+  int32_t i;
+} particle_wire_t;
+
+enum { WIRE_TAIL_WORDS    = 8,
+       WIRE_FACE_WORDS    = 2 + WIRE_TAIL_WORDS,
+       WIRE_MIGRATE_WORDS = 3 + WIRE_TAIL_WORDS };
+
+///////////////////////////////////////////////////////////////////////////////
+// boundary_p_movers_pipeline interface
+
+// The movers of a species are processed in reverse order (see
+// boundary_p_pipeline).  Mover q in processing order is pm[nm-1-q] and
+// pipelines are each assigned a contiguous range of q.
+
+typedef struct boundary_p_movers_pipeline_args
+{
+  MEM_PTR( particle_t,             128 ) p0;       // Particle array
+  MEM_PTR( const particle_mover_t,  16 ) pm;       // Movers (0:nm-1)
+  MEM_PTR( int8_t,                 128 ) code;     // Mover codes (0:nm-1)
+  MEM_PTR( int,                    128 ) count;    // Per pipeline sends per
+  /**/                                             // port and local movers
+  /**/                                             // (in the slot of the
+  /**/                                             // local domain port
+  /**/                                             // BOUNDARY(0,0,0))
+  /**/                                             // (0:N_PORT*n_pipeline-1)
+  MEM_PTR( const int64_t,          128 ) neighbor; // Voxel face neighbors
+  MEM_PTR( const int,                4 ) migrate_n; // Local resolution of
+  /**/                                              // the node of each port
+  /**/                                              // (3*port+axis, see
+  /**/                                              // grid_t::migrate_n)
+  MEM_PTR( particle_wire_t,          4 ) wire_send[N_PORT]; // Send records
+  int64_t rangel, rangeh, rangem; // Global voxel ranges (see boundary_p)
+  int64_t range[6];               // First global voxel of face neighbors
+  int np;                         // Number of particles
+  int nm;                         // Number of movers
+  int nh;                         // Number of movers with pm[k].i < np-nm
+  int sp_id;                      // Species id
+  int layout;                     // Layout of p0
+  int nx, ny, nz;                 // Local voxel mesh resolution
+
+  PAD_STRUCT( (6+N_PORT)*SIZEOF_MEM_PTR + 9*sizeof(int64_t) + 8*sizeof(int) )
+
+} boundary_p_movers_pipeline_args_t;
+
+void
+classify_movers_pipeline_scalar( boundary_p_movers_pipeline_args_t * args,
+                                 int pipeline_rank,
+                                 int n_pipeline );
+
+void
+pack_movers_pipeline_scalar( boundary_p_movers_pipeline_args_t * args,
+                             int pipeline_rank,
+                             int n_pipeline );
+
+void
+backfill_movers_pipeline_scalar( boundary_p_movers_pipeline_args_t * args,
+                                 int pipeline_rank,
+                                 int n_pipeline );
+
+///////////////////////////////////////////////////////////////////////////////
+// boundary_p_unpack_pipeline interface
+
+// The records received through ports 0:N_PORT-1 are unpacked to
+// consecutive injectors in port order.  Pipelines are each assigned a
+// contiguous range of the records.
+
+typedef struct boundary_p_unpack_pipeline_args
+{
+  MEM_PTR( const particle_wire_t,  4 ) wire[N_PORT]; // Received records
+  MEM_PTR( const int,              4 ) run[N_PORT];  // Received run tables
+  MEM_PTR( particle_injector_t,   16 ) pi;           // Unpacked injectors
+  /**/                                               // (0:n_inj-1)
+  int n[N_PORT];     // Records received through each port
+  int n_inj;         // Total number of records
+
+  PAD_STRUCT( (1+2*N_PORT)*SIZEOF_MEM_PTR + (1+N_PORT)*sizeof(int) )
+
+} boundary_p_unpack_pipeline_args_t;
+
+void
+unpack_injectors_pipeline_scalar( boundary_p_unpack_pipeline_args_t * args,
+                                  int pipeline_rank,
+                                  int n_pipeline );
+
+///////////////////////////////////////////////////////////////////////////////
+// boundary_p_inject_pipeline interface
+
+// The injectors are injected in the order of segment 0 (local injectors),
+// then segments 1:N_PORT (injectors received through ports 0:N_PORT-1),
+// each segment in reverse order.  Pipelines are each assigned a
+// contiguous range of this order.
+
+typedef struct boundary_p_inject_pipeline_args
+{
+  MEM_PTR( const particle_injector_t, 16 ) pi[1+N_PORT]; // Injector segments
+  MEM_PTR( particle_t,               128 ) sp_p[MAX_SP];  // Particles
+  MEM_PTR( particle_mover_t,          16 ) pm;    // Mover of each
+  /**/                                            // injector (0:n_inj-1)
+  MEM_PTR( int,                      128 ) count; // Per pipeline injections
+  /**/                                            // per species
+  /**/                                            // (0:MAX_SP*n_pipeline-1)
+  MEM_PTR( accumulator_tiles_t,        1 ) at;    // Accumulator tiles
+  MEM_PTR( const grid_t,               1 ) g;
+  float sp_q[MAX_SP];      // Species charges
+  int   sp_layout[MAX_SP]; // Species layouts
+  int   sp_max_np[MAX_SP]; // Species particle storage
+  int   n[1+N_PORT];       // Injectors in each segment
+  int   n_inj;             // Total number of injectors
+
+  PAD_STRUCT( (5+N_PORT+MAX_SP)*SIZEOF_MEM_PTR
+              + MAX_SP*(sizeof(float)+2*sizeof(int))
+              + (2+N_PORT)*sizeof(int) )
+
+} boundary_p_inject_pipeline_args_t;
+
+void
+count_injectors_pipeline_scalar( boundary_p_inject_pipeline_args_t * args,
+                                 int pipeline_rank,
+                                 int n_pipeline );
+
+void
+inject_particles_pipeline_scalar( boundary_p_inject_pipeline_args_t * args,
+                                  int pipeline_rank,
+                                  int n_pipeline );
+
+///////////////////////////////////////////////////////////////////////////////
+
+void
+boundary_p_pipeline( particle_bc_t       * RESTRICT pbc_list,
+                     species_t           * RESTRICT sp_list,
+                     field_array_t       * RESTRICT fa,
+                     accumulator_array_t * RESTRICT aa );
+
+#endif // _boundary_p_pipeline_h_
@@ -68,6 +68,17 @@ restore_binary_collision_model( void )
   return restore_collision_op_internal( cm );
 }
 
+// The pipelines use the generator of the pool with their rank.  The pool
+// is grown if there are more pipelines than at the checkpt.
+
+void
+reanimate_binary_collision_model( collision_op_t * cop )
+{
+  binary_collision_model_t * cm = ( binary_collision_model_t * ) cop->params;
+
+  resize_rng_pool( cm->rp, N_PIPELINE );
+}
+
 void
 delete_binary_collision_model( collision_op_t * cop )
 {
@@ -138,5 +149,5 @@ binary_collision_model( const char * RESTRICT name,
                                     delete_binary_collision_model,
                                     ( checkpt_func_t ) checkpt_binary_collision_model,
                                     ( restore_func_t ) restore_binary_collision_model,
-                                    NULL );
+                                    ( reanimate_func_t ) reanimate_binary_collision_model );
 }
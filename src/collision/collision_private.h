@@ -47,11 +47,11 @@ END_C_DECLS
 typedef struct langevin_pipeline_args
 {
   MEM_PTR( particle_t, 128 ) p;
-  MEM_PTR( rng_t,      128 ) rng[ MAX_PIPELINE ];
+  crng_t rng; // Streams of the species particles this step
   float decay; 
   float drive;
   int np;
-  PAD_STRUCT( (1+MAX_PIPELINE)*SIZEOF_MEM_PTR+2*sizeof(float)+sizeof(int) )
+  PAD_STRUCT( SIZEOF_MEM_PTR+sizeof(crng_t)+2*sizeof(float)+sizeof(int) )
 } langevin_pipeline_args_t;
 
 // PROTOTYPE_PIPELINE( langevin, langevin_pipeline_args_t );
@@ -76,6 +76,7 @@ langevin( float kT,
 
   l->sp       = sp;
   l->rp       = rp;
+  l->seed     = uirand( rp->rng[0] );
   l->kT       = kT;
   l->nu       = nu;
   l->interval = interval;
@@ -7,6 +7,7 @@ typedef struct langevin
 {
   species_t  * sp;
   rng_pool_t * rp;
+  uint32_t seed; // Seed of the particle streams (drawn from rp)
   float kT;
   float nu;
   int interval;
@@ -43,12 +43,18 @@ binary_pipeline_scalar( binary_collision_model_t * RESTRICT cm,
   float pr_norm, pr_coll, wk, wl, w_max, w_min;
   int v, v1, k, k0, nk, rk, l, l0, nl, rl, np, nc, type, n_large_pr = 0;
 
-  /* Stripe the (mostly non-ghost) voxels over threads for load balance */
-
-  v  = VOXEL( 0,0,0,             g->nx,g->ny,g->nz ) + pipeline_rank;
-  v1 = VOXEL( g->nx,g->ny,g->nz, g->nx,g->ny,g->nz ) + 1;
-
-  for( ; v<v1; v+=n_pipeline )
+  /* Give each thread a contiguous range of the (mostly non-ghost) voxels
+     holding about as many particles as the others (the candidate pairs of
+     a voxel go with the particles in it, which can be very uneven).
+     Voxels are visited in the order of the grid's space filling curve
+     (g->sfc), which is how the partitioning is indexed. */
+
+  collision_voxels( spi_partition, spi==spj ? NULL : spj_partition,
+                    VOXEL( 0,0,0,             g->nx,g->ny,g->nz ),
+                    VOXEL( g->nx,g->ny,g->nz, g->nx,g->ny,g->nz ) + 1,
+                    pipeline_rank, n_pipeline, &v, &v1 );
+
+  for( ; v<v1; v++ )
   {
     /* Find the species i computational particles, k, and the species j
        computational particles, l, in this voxel, determine the number
@@ -6,6 +6,47 @@
 #include "../unary.h"
 #include "../takizuka_abe.h"
 
+// Voxels v0:v1-1 of a collision pipeline.  The voxels vl:vh-1 are cut
+// into n_pipeline contiguous ranges holding about as many particles of
+// the species partitioned by pi and, if not NULL, pj each (the partitions
+// are prefix sums, so the cuts are found by bisection).  Voxels are not
+// split, so a voxel holding more than its share of the particles gets a
+// pipeline of its own.
+
+static inline void
+collision_voxels( const int * RESTRICT pi,
+                  const int * RESTRICT pj,
+                  int vl,
+                  int vh,
+                  int pipeline_rank,
+                  int n_pipeline,
+                  int * RESTRICT v0,
+                  int * RESTRICT v1 ) {
+  const int64_t w0 = (int64_t)pi[vl] + ( pj ? pj[vl] : 0 );
+  const int64_t w  = (int64_t)pi[vh] + ( pj ? pj[vh] : 0 ) - w0;
+  int r, lo, hi, mid, v[2];
+
+  for( int n=0; n<2; n++ ) {
+    r = pipeline_rank + n;
+    if( r==0          ) { v[n] = vl; continue; }
+    if( r>=n_pipeline ) { v[n] = vh; continue; }
+
+    // First voxel before which there are r/n_pipeline of the particles
+
+    const int64_t target = w0 + ( w*r + n_pipeline - 1 )/n_pipeline;
+    lo = vl, hi = vh;
+    while( lo<hi ) {
+      mid = lo + ( hi - lo )/2;
+      if( (int64_t)pi[mid] + ( pj ? pj[mid] : 0 )<target ) lo = mid + 1;
+      else                                                  hi = mid;
+    }
+    v[n] = lo;
+  }
+
+  *v0 = v[0];
+  *v1 = v[1];
+}
+
 void
 binary_pipeline_scalar( binary_collision_model_t * RESTRICT cm,
                         int pipeline_rank,
@@ -16,6 +57,41 @@ langevin_pipeline_scalar( langevin_pipeline_args_t * RESTRICT args,
                           int pipeline_rank,
                           int n_pipeline );
 
+void
+langevin_pipeline_v4( langevin_pipeline_args_t * RESTRICT args,
+                      int pipeline_rank,
+                      int n_pipeline );
+
+void
+langevin_pipeline_v8( langevin_pipeline_args_t * RESTRICT args,
+                      int pipeline_rank,
+                      int n_pipeline );
+
+void
+langevin_pipeline_v16( langevin_pipeline_args_t * RESTRICT args,
+                       int pipeline_rank,
+                       int n_pipeline );
+
+// Langevin update of the particles i:i1-1.  The normal rands of particle
+// i are the first block of its stream in r (so the update does not depend
+// on which pipeline does it).
+
+static inline void
+langevin_particles( particle_t * RESTRICT p,
+                    const crng_t * RESTRICT r,
+                    float decay,
+                    float drive,
+                    int i,
+                    int i1 ) {
+  float x[4];
+  for( ; i<i1; i++ ) {
+    crng_frandn( r, i, 0, x );
+    p[i].ux = decay * p[i].ux + drive * x[0];
+    p[i].uy = decay * p[i].uy + drive * x[1];
+    p[i].uz = decay * p[i].uz + drive * x[2];
+  }
+}
+
 void
 unary_pipeline_scalar( unary_collision_model_t * RESTRICT cm,
                        int pipeline_rank,
@@ -26,4 +102,163 @@ takizuka_abe_pipeline_scalar( takizuka_abe_t * RESTRICT cm,
                               int pipeline_rank,
                               int n_pipeline );
 
+void
+takizuka_abe_pipeline_v4( takizuka_abe_t * RESTRICT cm,
+                          int pipeline_rank,
+                          int n_pipeline );
+
+void
+takizuka_abe_pipeline_v8( takizuka_abe_t * RESTRICT cm,
+                          int pipeline_rank,
+                          int n_pipeline );
+
+void
+takizuka_abe_pipeline_v16( takizuka_abe_t * RESTRICT cm,
+                           int pipeline_rank,
+                           int n_pipeline );
+
+///////////////////////////////////////////////////////////////////////////////
+// Takizuka-Abe pair batches
+//
+// The pipelines shuffle the particles of their voxels and gather the pairs
+// to collide into batches.  The pairs of a batch never share a particle so
+// a batch can be collided in any order (in particular, several pairs at a
+// time across vector lanes).  The rands of a pair are the block j of the
+// stream i of rng, where i and j index the pair's particles in pi and pj,
+// so the result does not depend on how the pairs are batched.
+
+enum takizuka_abe_enums {
+  TAKIZUKA_ABE_MAX_PAIRS = 256 // Multiple of the widest vector
+};
+
+typedef struct takizuka_abe_pairs {
+  float std[ TAKIZUKA_ABE_MAX_PAIRS ]; // Collision angle std of each pair
+  int   i  [ TAKIZUKA_ABE_MAX_PAIRS ]; // Index of each pair's pi particle
+  int   j  [ TAKIZUKA_ABE_MAX_PAIRS ]; // Index of each pair's pj particle
+  int   n;                             // Number of pairs in the batch
+  particle_t * RESTRICT pi;            // Species i particles
+  particle_t * RESTRICT pj;            // Species j particles
+  crng_t rng;                          // Streams of the pairs this step
+  float mu_i, mu_j;                    // Momentum transfer mass ratios
+} takizuka_abe_pairs_t;
+
+typedef void
+(*takizuka_abe_pairs_func_t)( takizuka_abe_pairs_t * RESTRICT pairs );
+
+// Shuffle the voxels of this pipeline and collide their pairs, a batch at
+// a time, with collide.
+
+void
+takizuka_abe_pipeline_voxels( takizuka_abe_t * RESTRICT cm,
+                              int pipeline_rank,
+                              int n_pipeline,
+                              takizuka_abe_pairs_func_t collide );
+
+// The rands of the pair (i,j): x[0] is a normal rand (the collision angle
+// tangent scale), x[1] and x[2] the cosine and sine of a uniform azimuth
+// and x[3] a uniform rand on (0,1) (the unequal weight rejection).
+
+static inline void
+takizuka_abe_rands( const crng_t * RESTRICT r,
+                    int i,
+                    int j,
+                    float * RESTRICT x ) {
+  uint32_t u[4];
+  float t;
+  crng_u32( r, i, j, u );
+  t    = (float)( 2*M_PI )*crng_u32_to_f( u[1] );
+  x[0] = sqrtf( -2.f*logf( crng_u32_to_f( u[0] ) ) )*cosf( t );
+  t    = (float)( 2*M_PI )*crng_u32_to_f( u[2] );
+  x[1] = cosf( t );
+  x[2] = sinf( t );
+  x[3] = crng_u32_to_f( u[3] );
+}
+
+// Collide the particles pi and pj given the rands x of the pair.  This is
+// branchless and direction-agnostic.
+
+static inline void
+takizuka_abe_collide( particle_t * RESTRICT pi,
+                      particle_t * RESTRICT pj,
+                      float mu_i,
+                      float mu_j,
+                      float std,
+                      const float * RESTRICT x ) {
+# define CMOV(a,b) if(t0<t1) a=b
+  float dd, ur, urx, ury, urz, tx, ty, tz, t0, t1, t2, wi, wj, stack[3];
+  int d0, d1, d2;
+
+  urx = pi->ux - pj->ux;
+  ury = pi->uy - pj->uy;
+  urz = pi->uz - pj->uz;
+  wi  = pi->w;
+  wj  = pj->w;
+
+  /* There are lots of ways to formulate T vector formation    */
+  /* This has no branches (but uses L1 heavily)                */
+
+  t0 = urx*urx;      d0=0;       d1=1;       d2=2;       t1=t0;  ur  = t0;
+  t0 = ury*ury; CMOV(d0,1); CMOV(d1,2); CMOV(d2,0); CMOV(t1,t0); ur += t0;
+  t0 = urz*urz; CMOV(d0,2); CMOV(d1,0); CMOV(d2,1);              ur += t0;
+  ur = sqrtf( ur );
+
+  stack[0] = urx;
+  stack[1] = ury;
+  stack[2] = urz;
+  t1  = stack[d1];
+  t2  = stack[d2];
+  t0  = 1 / sqrtf( t1*t1 + t2*t2 + FLT_MIN );
+  stack[d0] =  0;
+  stack[d1] =  t0*t2;
+  stack[d2] = -t0*t1;
+  tx = stack[0];
+  ty = stack[1];
+  tz = stack[2];
+
+  t0 = 1;
+  t2 = 1/ur;
+  t1 = std*sqrtf(t2)*t2;
+  CMOV(t1,t0);
+  dd = t1*x[0];
+
+  t0 = 2*dd/(1+dd*dd);
+  t2 = t0*x[2];
+  t1 = t0*ur*x[1];
+  t0 *= -dd;
+
+  /* stack = (1 - cos theta) u + |u| sin theta Tperp */
+  stack[0] = (t0*urx + t1*tx) + t2*( ury*tz - urz*ty );
+  stack[1] = (t0*ury + t1*ty) + t2*( urz*tx - urx*tz );
+  stack[2] = (t0*urz + t1*tz) + t2*( urx*ty - ury*tx );
+
+  /* Handle unequal particle weights. */
+  t0 = x[3];
+  t1 = mu_i;
+  t2 = mu_j;
+  if(wj < wi && wi*t0 > wj) t1 = 0 ;
+  if(wi < wj && wj*t0 > wi) t2 = 0 ;
+
+  pi->ux += t1*stack[0];
+  pi->uy += t1*stack[1];
+  pi->uz += t1*stack[2];
+  pj->ux -= t2*stack[0];
+  pj->uy -= t2*stack[1];
+  pj->uz -= t2*stack[2];
+# undef CMOV
+}
+
+// Collide the pairs k:k1-1 of a batch one at a time.
+
+static inline void
+takizuka_abe_collide_pairs( takizuka_abe_pairs_t * RESTRICT pairs,
+                            int k,
+                            int k1 ) {
+  float x[4];
+  for( ; k<k1; k++ ) {
+    takizuka_abe_rands( &pairs->rng, pairs->i[k], pairs->j[k], x );
+    takizuka_abe_collide( pairs->pi + pairs->i[k], pairs->pj + pairs->j[k],
+                          pairs->mu_i, pairs->mu_j, pairs->std[k], x );
+  }
+}
+
 #endif /* _collision_pipeline_h_ */
@@ -1,5 +1,9 @@
 #define IN_collision
 
+#define HAS_V4_PIPELINE
+#define HAS_V8_PIPELINE
+#define HAS_V16_PIPELINE
+
 #include "collision_pipeline.h"
 
 #include "../langevin.h"
@@ -13,35 +17,14 @@ langevin_pipeline_scalar( langevin_pipeline_args_t * RESTRICT args,
                           int pipeline_rank,
                           int n_pipeline )
 {
-  if ( pipeline_rank == n_pipeline )
-  {
-    return; /* No host straggler cleanup */
-  }
-
-  particle_t * RESTRICT p     = args->p;
-  rng_t      * RESTRICT rng   = args->rng[ pipeline_rank ];
-  float                 decay = args->decay;
-  float                 drive = args->drive;
-
-  double n_target = (double)args->np / (double)n_pipeline;
+  int i, n;
 
-  /**/  int i  = (int)( 0.5 + n_target * (double)  pipeline_rank    );
-  const int i1 = (int)( 0.5 + n_target * (double) (pipeline_rank+1) );
+  DISTRIBUTE( args->np, 1, pipeline_rank, n_pipeline, i, n );
 
-  for( ; i < i1; i++ )
-  {
-    p[i].ux = decay * p[i].ux + drive * frandn(rng);
-    p[i].uy = decay * p[i].uy + drive * frandn(rng);
-    p[i].uz = decay * p[i].uz + drive * frandn(rng);
-  }
+  langevin_particles( args->p, &args->rng, args->decay, args->drive,
+                      i, i + n );
 }
 
-#if defined(V4_ACCELERATION) && defined(HAS_V4_PIPELINE)
-
-#error "V4 pipeline not implemented"
-
-#endif
-
 void
 apply_langevin_pipeline( langevin_t * l )
 {
@@ -100,7 +83,7 @@ apply_langevin_pipeline( langevin_t * l )
 
   args->p     = l->sp->p;
 
-  COPY( args->rng, l->rp->rng, N_PIPELINE );
+  args->rng   = crng_init( l->seed, world_rank, l->sp->id, l->sp->g->step );
 
   args->decay = exp( -nudt );
   args->drive = sqrt( ( -expm1( -2 * nudt ) * l->kT ) / ( l->sp->m * l->sp->g->cvac ) );
@@ -0,0 +1,88 @@
+#define IN_collision
+
+#include "collision_pipeline.h"
+
+#include "../langevin.h"
+
+#if defined(V16_ACCELERATION)
+
+using namespace v16;
+
+void
+langevin_pipeline_v16( langevin_pipeline_args_t * RESTRICT args,
+                       int pipeline_rank,
+                       int n_pipeline )
+{
+  particle_t * RESTRICT ALIGNED(128) p = args->p;
+  const v16float decay( args->decay );
+  const v16float drive( args->drive );
+  v16float ux, uy, uz, w, n0, n1, n2, n3;
+  int i, n;
+
+  DISTRIBUTE( args->np, 16, pipeline_rank, n_pipeline, i, n );
+
+  for( n+=i; i<n; i+=16 )
+  {
+    crng_frandn_v16( &args->rng, i, 0, n0, n1, n2, n3 );
+
+    load_16x4_tr( &p[i+ 0].ux,
+                  &p[i+ 1].ux,
+                  &p[i+ 2].ux,
+                  &p[i+ 3].ux,
+                  &p[i+ 4].ux,
+                  &p[i+ 5].ux,
+                  &p[i+ 6].ux,
+                  &p[i+ 7].ux,
+                  &p[i+ 8].ux,
+                  &p[i+ 9].ux,
+                  &p[i+10].ux,
+                  &p[i+11].ux,
+                  &p[i+12].ux,
+                  &p[i+13].ux,
+                  &p[i+14].ux,
+                  &p[i+15].ux,
+                  ux, uy, uz, w );
+
+    ux = decay * ux + drive * n0;
+    uy = decay * uy + drive * n1;
+    uz = decay * uz + drive * n2;
+
+    store_16x4_tr( ux, uy, uz, w,
+                   &p[i+ 0].ux,
+                   &p[i+ 1].ux,
+                   &p[i+ 2].ux,
+                   &p[i+ 3].ux,
+                   &p[i+ 4].ux,
+                   &p[i+ 5].ux,
+                   &p[i+ 6].ux,
+                   &p[i+ 7].ux,
+                   &p[i+ 8].ux,
+                   &p[i+ 9].ux,
+                   &p[i+10].ux,
+                   &p[i+11].ux,
+                   &p[i+12].ux,
+                   &p[i+13].ux,
+                   &p[i+14].ux,
+                   &p[i+15].ux );
+  }
+
+  // The last pipeline also updates the particles left over by the
+  // 16-particle blocks.
+
+  if( pipeline_rank==n_pipeline-1 )
+    langevin_particles( p, &args->rng, args->decay, args->drive,
+                        16*( args->np/16 ), args->np );
+}
+
+#else
+
+void
+langevin_pipeline_v16( langevin_pipeline_args_t * RESTRICT args,
+                       int pipeline_rank,
+                       int n_pipeline )
+{
+  // No v16 implementation.
+  ERROR( ( "No langevin_pipeline_v16 implementation." ) );
+}
+
+#endif
@@ -0,0 +1,64 @@
+#define IN_collision
+
+#include "collision_pipeline.h"
+
+#include "../langevin.h"
+
+#if defined(V4_ACCELERATION)
+
+using namespace v4;
+
+void
+langevin_pipeline_v4( langevin_pipeline_args_t * RESTRICT args,
+                      int pipeline_rank,
+                      int n_pipeline )
+{
+  particle_t * RESTRICT ALIGNED(128) p = args->p;
+  const v4float decay( args->decay );
+  const v4float drive( args->drive );
+  v4float ux, uy, uz, w, n0, n1, n2, n3;
+  int i, n;
+
+  DISTRIBUTE( args->np, 4, pipeline_rank, n_pipeline, i, n );
+
+  for( n+=i; i<n; i+=4 )
+  {
+    crng_frandn_v4( &args->rng, i, 0, n0, n1, n2, n3 );
+
+    load_4x4_tr( &p[i+ 0].ux,
+                 &p[i+ 1].ux,
+                 &p[i+ 2].ux,
+                 &p[i+ 3].ux,
+                 ux, uy, uz, w );
+
+    ux = decay * ux + drive * n0;
+    uy = decay * uy + drive * n1;
+    uz = decay * uz + drive * n2;
+
+    store_4x4_tr( ux, uy, uz, w,
+                  &p[i+ 0].ux,
+                  &p[i+ 1].ux,
+                  &p[i+ 2].ux,
+                  &p[i+ 3].ux );
+  }
+
+  // The last pipeline also updates the particles left over by the
+  // 4-particle blocks.
+
+  if( pipeline_rank==n_pipeline-1 )
+    langevin_particles( p, &args->rng, args->decay, args->drive,
+                        4*( args->np/4 ), args->np );
+}
+
+#else
+
+void
+langevin_pipeline_v4( langevin_pipeline_args_t * RESTRICT args,
+                      int pipeline_rank,
+                      int n_pipeline )
+{
+  // No v4 implementation.
+  ERROR( ( "No langevin_pipeline_v4 implementation." ) );
+}
+
+#endif
@@ -0,0 +1,72 @@
+#define IN_collision
+
+#include "collision_pipeline.h"
+
+#include "../langevin.h"
+
+#if defined(V8_ACCELERATION)
+
+using namespace v8;
+
+void
+langevin_pipeline_v8( langevin_pipeline_args_t * RESTRICT args,
+                      int pipeline_rank,
+                      int n_pipeline )
+{
+  particle_t * RESTRICT ALIGNED(128) p = args->p;
+  const v8float decay( args->decay );
+  const v8float drive( args->drive );
+  v8float ux, uy, uz, w, n0, n1, n2, n3;
+  int i, n;
+
+  DISTRIBUTE( args->np, 8, pipeline_rank, n_pipeline, i, n );
+
+  for( n+=i; i<n; i+=8 )
+  {
+    crng_frandn_v8( &args->rng, i, 0, n0, n1, n2, n3 );
+
+    load_8x4_tr( &p[i+ 0].ux,
+                 &p[i+ 1].ux,
+                 &p[i+ 2].ux,
+                 &p[i+ 3].ux,
+                 &p[i+ 4].ux,
+                 &p[i+ 5].ux,
+                 &p[i+ 6].ux,
+                 &p[i+ 7].ux,
+                 ux, uy, uz, w );
+
+    ux = decay * ux + drive * n0;
+    uy = decay * uy + drive * n1;
+    uz = decay * uz + drive * n2;
+
+    store_8x4_tr( ux, uy, uz, w,
+                  &p[i+ 0].ux,
+                  &p[i+ 1].ux,
+                  &p[i+ 2].ux,
+                  &p[i+ 3].ux,
+                  &p[i+ 4].ux,
+                  &p[i+ 5].ux,
+                  &p[i+ 6].ux,
+                  &p[i+ 7].ux );
+  }
+
+  // The last pipeline also updates the particles left over by the
+  // 8-particle blocks.
+
+  if( pipeline_rank==n_pipeline-1 )
+    langevin_particles( p, &args->rng, args->decay, args->drive,
+                        8*( args->np/8 ), args->np );
+}
+
+#else
+
+void
+langevin_pipeline_v8( langevin_pipeline_args_t * RESTRICT args,
+                      int pipeline_rank,
+                      int n_pipeline )
+{
+  // No v8 implementation.
+  ERROR( ( "No langevin_pipeline_v8 implementation." ) );
+}
+
+#endif
@@ -1,6 +1,8 @@
 #define IN_collision
 
-/* #define HAS_V4_PIPELINE */
+#define HAS_V4_PIPELINE
+#define HAS_V8_PIPELINE
+#define HAS_V16_PIPELINE
 
 #include "collision_pipeline.h"
 
@@ -8,84 +10,67 @@
 
 #include "../../util/pipelines/pipelines_exec.h"
 
-#define CMOV(a,b) if(t0<t1) a=b
-
-// Branchless and direction-agnositc method for computing momentum transfer.
-#define takizuka_abe_collision(PI,PJ,mu_i,mu_j,std,rng) do {            \
-    particle_t * const RESTRICT pi = (PI);                              \
-    particle_t * const RESTRICT pj = (PJ);                              \
-    float dd, ur, urx, ury, urz, tx, ty, tz, t0, t1, t2, wi, wj, stack[3]; \
-    int d0, d1, d2;                                                     \
-                                                                        \
-    urx = pi->ux - pj->ux;                                              \
-    ury = pi->uy - pj->uy;                                              \
-    urz = pi->uz - pj->uz;                                              \
-    wi  = pi->w;                                                        \
-    wj  = pj->w;                                                        \
-                                                                        \
-    /* There are lots of ways to formulate T vector formation    */     \
-    /* This has no branches (but uses L1 heavily)                */     \
-                                                                        \
-    t0 = urx*urx;      d0=0;       d1=1;       d2=2;       t1=t0;  ur  = t0; \
-    t0 = ury*ury; CMOV(d0,1); CMOV(d1,2); CMOV(d2,0); CMOV(t1,t0); ur += t0; \
-    t0 = urz*urz; CMOV(d0,2); CMOV(d1,0); CMOV(d2,1);              ur += t0; \
-    ur = sqrtf( ur );                                                   \
-                                                                        \
-    stack[0] = urx;                                                     \
-    stack[1] = ury;                                                     \
-    stack[2] = urz;                                                     \
-    t1  = stack[d1];                                                    \
-    t2  = stack[d2];                                                    \
-    t0  = 1 / sqrtf( t1*t1 + t2*t2 + FLT_MIN );                         \
-    stack[d0] =  0;                                                     \
-    stack[d1] =  t0*t2;                                                 \
-    stack[d2] = -t0*t1;                                                 \
-    tx = stack[0];                                                      \
-    ty = stack[1];                                                      \
-    tz = stack[2];                                                      \
-                                                                        \
-    t0 = 1;                                                             \
-    t2 = 1/ur;                                                          \
-    t1 = std*sqrtf(t2)*t2;                                              \
-    CMOV(t1,t0);                                                        \
-    dd = t1*frandn(rng);                                                \
-                                                                        \
-    t0 = 2*dd/(1+dd*dd);                                                \
-    t1 = 2*M_PI*frand_c0(rng);                                          \
-    t2 = t0*sin(t1);                                                    \
-    t1 = t0*ur*cos(t1);                                                 \
-    t0 *= -dd;                                                          \
-                                                                        \
-    /* stack = (1 - cos theta) u + |u| sin theta Tperp */               \
-    stack[0] = (t0*urx + t1*tx) + t2*( ury*tz - urz*ty );               \
-    stack[1] = (t0*ury + t1*ty) + t2*( urz*tx - urx*tz );               \
-    stack[2] = (t0*urz + t1*tz) + t2*( urx*ty - ury*tx );               \
-                                                                        \
-    /* Handle unequal particle weights. */                              \
-    t0 = frand_c0(rng);                                                 \
-    t1 = mu_i;                                                          \
-    t2 = mu_j;                                                          \
-    if(wj < wi && wi*t0 > wj) t1 = 0 ;                                  \
-    if(wi < wj && wj*t0 > wi) t2 = 0 ;                                  \
-                                                                        \
-    pi->ux += t1*stack[0];                                              \
-    pi->uy += t1*stack[1];                                              \
-    pi->uz += t1*stack[2];                                              \
-    pj->ux -= t2*stack[0];                                              \
-    pj->uy -= t2*stack[1];                                              \
-    pj->uz -= t2*stack[2];                                              \
-                                                                        \
-  } while(0)
+// Collide a batch of pairs and empty it.
+
+static inline void
+flush_pairs( takizuka_abe_pairs_t * RESTRICT pairs,
+             takizuka_abe_pairs_func_t collide ) {
+  if( pairs->n ) collide( pairs );
+  pairs->n = 0;
+}
+
+static inline void
+push_pair( takizuka_abe_pairs_t * RESTRICT pairs,
+           takizuka_abe_pairs_func_t collide,
+           int i,
+           int j,
+           float std ) {
+  if( pairs->n==TAKIZUKA_ABE_MAX_PAIRS ) flush_pairs( pairs, collide );
+  pairs->i  [ pairs->n ] = i;
+  pairs->j  [ pairs->n ] = j;
+  pairs->std[ pairs->n ] = std;
+  pairs->n++;
+}
+
+// Pair the nk particles k0:k0+nk-1 of pi with the nl particles
+// l0:l0+nl-1 of pj.  Each particle of the smaller set is paired with
+// consecutive particles of the larger one (the first few getting one
+// more).  The pairs are pushed round by round (round r holding the r-th
+// pair of each particle of the smaller set) and the batch is flushed
+// between rounds, so the pairs of a batch are disjoint and the collisions
+// of each particle still happen in order.
+
+static void
+push_pairs( takizuka_abe_pairs_t * RESTRICT pairs,
+            takizuka_abe_pairs_func_t collide,
+            int k0, int nk,
+            int l0, int nl,
+            float std ) {
+  int ns, nb, ii, rn, r, s, b;
+
+  if( nk>nl ) ns = nl, nb = nk;
+  else        ns = nk, nb = nl;
+
+  ii = nb/ns;
+  rn = nb - ii*ns;
+
+  for( r=0; r<ii || ( r==ii && rn ); r++ ) {
+    if( r ) flush_pairs( pairs, collide );
+    for( s=0; s<( r<ii ? ns : rn ); s++ ) {
+      b = ( s<rn ? s*(ii+1) : rn*(ii+1) + (s-rn)*ii ) + r;
+      if( nk>nl ) push_pair( pairs, collide, k0+b, l0+s, std );
+      else        push_pair( pairs, collide, k0+s, l0+b, std );
+    }
+  }
+}
 
 void
-takizuka_abe_pipeline_scalar( takizuka_abe_t * RESTRICT cm,
+takizuka_abe_pipeline_voxels( takizuka_abe_t * RESTRICT cm,
                               int pipeline_rank,
-                              int n_pipeline ) {
-  if( pipeline_rank==n_pipeline ) return; /* No host straggler cleanup */
-
+                              int n_pipeline,
+                              takizuka_abe_pairs_func_t collide ) {
   /**/  species_t    * RESTRICT spi           = cm->spi;
   /**/  species_t    * RESTRICT spj           = cm->spj;
-  /**/  rng_t        * RESTRICT rng           = cm->rp->rng[ pipeline_rank ];
   const grid_t       * RESTRICT g             = spi->g;
 
   /**/  particle_t   * RESTRICT ALIGNED(128) spi_p         = spi->p;
@@ -100,22 +85,41 @@ takizuka_abe_pipeline_scalar( takizuka_abe_t * RESTRICT cm,
   const float mu_j  = spi->m/(spi->m+spj->m);
   const double cvar = cm->cvar0 * (spi->q*spi->q*spj->q*spj->q) / (mu*mu);
 
-  particle_t ptemp;
-  float var, std, density_k, density_l;
-  int i, j, ii, rn, v, v1, k, k0, k1, nk, l, l0, nl, size_k, size_l;
+  // The shuffles draw from the even and the pairs from the odd stream
+  // families of this species pair (streams of the shuffles are indexed by
+  // voxel, those of the pairs by particle).
+
+  const uint32_t stream = 2*( (uint32_t)spi->id<<16 | (uint32_t)spj->id );
+  const crng_t shuffle = crng_init( cm->seed, world_rank, stream, g->step );
 
-  /* Stripe the (mostly non-ghost) voxels over threads for load balance */
+  DECLARE_ALIGNED_ARRAY( takizuka_abe_pairs_t, 128, pairs, 1 );
 
-  v  = VOXEL( 0,0,0,             g->nx,g->ny,g->nz ) + pipeline_rank;
-  v1 = VOXEL( g->nx,g->ny,g->nz, g->nx,g->ny,g->nz ) + 1;
-  for( ; v<v1; v+=n_pipeline ) {
+  particle_t ptemp;
+  float std, density_k, density_l, x[4];
+  uint32_t u[4], block;
+  int i, j, rn, nu, v, v1, k0, k1, nk, l0, nl;
+
+  pairs->n    = 0;
+  pairs->pi   = spi_p;
+  pairs->pj   = spj_p;
+  pairs->rng  = crng_init( cm->seed, world_rank, stream+1, g->step );
+  pairs->mu_i = mu_i;
+  pairs->mu_j = mu_j;
+
+  /* Give each thread a contiguous range of the (mostly non-ghost) voxels
+     holding about as many particles as the others (the work of a voxel
+     goes with the particles in it, which can be very uneven).  Voxels are
+     visited in the order of the grid's space filling curve (g->sfc),
+     which is how the partitioning is indexed. */
+
+  collision_voxels( spi_partition, spi==spj ? NULL : spj_partition,
+                    VOXEL( 0,0,0,             g->nx,g->ny,g->nz ),
+                    VOXEL( g->nx,g->ny,g->nz, g->nx,g->ny,g->nz ) + 1,
+                    pipeline_rank, n_pipeline, &v, &v1 );
+  for( ; v<v1; v++ ) {
 
     /* Find the species i computational particles, k, and the species j
-       computational particles, l, in this voxel, determine the number
-       of computational particle pairs, np and the number of candidate
-       pairs, nc, to test for collisions within this voxel.  Also,
-       split the range of the fastest integer rng into intervals
-       suitable for sampling pairs. */
+       computational particles, l, in this voxel and pair them up. */
 
     k0 = spi_partition[v  ];
     nk = spi_partition[v+1] - k0;
@@ -124,11 +128,18 @@ takizuka_abe_pipeline_scalar( takizuka_abe_t * RESTRICT cm,
     // Compute the species density for this cell while doing a Fisher-Yates
     // shuffle. NOTE: shuffling here instead of computing random indicies allows
     // for better optimization of the collision loop and an overall speedup.
+    // The shuffle draws from the voxel's stream (so does not depend on which
+    // pipeline does the voxel).
     density_k = 0;
     k1 = k0+nk;
+    block = 0;
+    nu = 4;
     for(i=k0 ; i < k1-1 ; ++i){
       rn = UINT32_MAX / (uint32_t)(k1-i);
-      do { j = i + (int)(uirand(rng)/rn); } while( j>=k1 );
+      do {
+        if( nu==4 ) crng_u32( &shuffle, v, block++, u ), nu = 0;
+        j = i + (int)(u[nu++]/rn);
+      } while( j>=k1 );
       ptemp = spi_p[j], spi_p[j] = spi_p[i], spi_p[i] = ptemp;
       density_k += spi_p[i].w;
     }
@@ -137,16 +148,18 @@ takizuka_abe_pipeline_scalar( takizuka_abe_t * RESTRICT cm,
     if( spi==spj ) {
 
       if( nk%2 && nk >= 3 ) {
+        // These particles are not in any other pair of this voxel so can
+        // be collided right away.
         std = sqrtf(0.5*density_k*cvar*dtinterval_dV);
-        takizuka_abe_collision( spi_p + k0,
-                                spi_p + k0 + 1,
-                                mu_i, mu_j, std, rng );
-        takizuka_abe_collision( spi_p + k0,
-                                spi_p + k0 + 2,
-                                mu_i, mu_j, std, rng );
-        takizuka_abe_collision( spi_p + k0 + 1,
-                                spi_p + k0 + 2,
-                                mu_i, mu_j, std, rng );
+        takizuka_abe_rands( &pairs->rng, k0, k0+1, x );
+        takizuka_abe_collide( spi_p + k0,     spi_p + k0 + 1,
+                              mu_i, mu_j, std, x );
+        takizuka_abe_rands( &pairs->rng, k0, k0+2, x );
+        takizuka_abe_collide( spi_p + k0,     spi_p + k0 + 2,
+                              mu_i, mu_j, std, x );
+        takizuka_abe_rands( &pairs->rng, k0+1, k0+2, x );
+        takizuka_abe_collide( spi_p + k0 + 1, spi_p + k0 + 2,
+                              mu_i, mu_j, std, x );
         nk -= 3;
         k0 += 3;
       }
@@ -175,49 +188,28 @@ takizuka_abe_pipeline_scalar( takizuka_abe_t * RESTRICT cm,
       std = sqrtf( cvar*(density_l > density_k ? density_k : density_l)*dtinterval_dV );
     }
 
-    if (nk > nl) {
-
-      ii = nk/nl;
-      rn = nk - ii*nl;
+    push_pairs( pairs, collide, k0, nk, l0, nl, std );
 
-      for( i=0 ; i < rn ; ++i, ++l0 )
-        for( j=0 ; j <= ii ; ++j, ++k0 )
-          takizuka_abe_collision( spi_p + k0,
-                                  spj_p + l0,
-                                  mu_i, mu_j, std, rng);
-
-      for( ; i < nl ; ++i, ++l0 )
-        for( j=0 ; j < ii ; ++j, ++k0 )
-          takizuka_abe_collision( spi_p + k0,
-                                  spj_p + l0,
-                                  mu_i, mu_j, std, rng);
-
-    } else {
-
-      ii = nl/nk;
-      rn = nl - ii*nk;
-
-      for( i=0 ; i < rn ; ++i, ++k0 )
-        for( j=0 ; j <= ii ; ++j, ++l0 )
-          takizuka_abe_collision( spi_p + k0,
-                                  spj_p + l0,
-                                  mu_i, mu_j, std, rng);
+  }
 
-      for( ; i < nk ; ++i, ++k0 )
-        for( j=0 ; j < ii ; ++j, ++l0 )
-          takizuka_abe_collision( spi_p + k0,
-                                  spj_p + l0,
-                                  mu_i, mu_j, std, rng);
+  flush_pairs( pairs, collide );
+}
 
-    }
+static void
+takizuka_abe_pairs_scalar( takizuka_abe_pairs_t * RESTRICT pairs ) {
+  takizuka_abe_collide_pairs( pairs, 0, pairs->n );
+}
 
-  }
+void
+takizuka_abe_pipeline_scalar( takizuka_abe_t * RESTRICT cm,
+                              int pipeline_rank,
+                              int n_pipeline ) {
+  if( pipeline_rank==n_pipeline ) return; /* No host straggler cleanup */
 
+  takizuka_abe_pipeline_voxels( cm, pipeline_rank, n_pipeline,
+                                takizuka_abe_pairs_scalar );
 }
 
-#undef CMOV
-#undef takizuka_abe_collision
-
 void
 apply_takizuka_abe_pipeline( takizuka_abe_t * cm ) {
   EXEC_PIPELINES( takizuka_abe, cm, 0 );
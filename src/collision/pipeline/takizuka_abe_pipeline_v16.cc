@@ -0,0 +1,202 @@
+#define IN_collision
+
+#include "collision_pipeline.h"
+
+#include "../takizuka_abe.h"
+
+#if defined(V16_ACCELERATION)
+
+using namespace v16;
+
+// Collide the pairs of a batch 16 at a time.  The pairs are disjoint so
+// the 16 pairs of a block can be gathered, collided across the lanes and
+// scattered back.  This is the same arithmetic as takizuka_abe_collide
+// (the CMOVs that form the T vector become merges).  The rands of the 16
+// pairs are drawn in bulk and filled lane by lane (see crng.h).  The
+// pairs left over by the blocks are collided one at a time.
+
+static void
+takizuka_abe_pairs_v16( takizuka_abe_pairs_t * RESTRICT pairs )
+{
+  particle_t * RESTRICT ALIGNED(128) pi = pairs->pi;
+  particle_t * RESTRICT ALIGNED(128) pj = pairs->pj;
+
+  const v16float mu_i( pairs->mu_i ), mu_j( pairs->mu_j );
+  const v16float one( 1.f ), zero( 0.f ), tiny( FLT_MIN );
+
+  v16float uix, uiy, uiz, wi, ujx, ujy, ujz, wj, std, rn, ct, st, rw;
+  v16float urx, ury, urz, ur, tx, ty, tz, t0, t1, t2, dd, sx, sy, sz;
+  v16float x2, y2, z2;
+  v16int   my, mz;
+
+  float x[4];
+
+  const int n = 16*( pairs->n/16 );
+  int k, l;
+
+  for( k=0; k<n; k+=16 )
+  {
+    const int * RESTRICT a = pairs->i + k;
+    const int * RESTRICT b = pairs->j + k;
+
+    for( l=0; l<16; l++ )
+    {
+      takizuka_abe_rands( &pairs->rng, a[l], b[l], x );
+      rn[l]  = x[0];
+      ct[l]  = x[1];
+      st[l]  = x[2];
+      rw[l]  = x[3];
+      std[l] = pairs->std[k+l];
+    }
+
+    load_16x4_tr( &pi[a[ 0]].ux,
+                  &pi[a[ 1]].ux,
+                  &pi[a[ 2]].ux,
+                  &pi[a[ 3]].ux,
+                  &pi[a[ 4]].ux,
+                  &pi[a[ 5]].ux,
+                  &pi[a[ 6]].ux,
+                  &pi[a[ 7]].ux,
+                  &pi[a[ 8]].ux,
+                  &pi[a[ 9]].ux,
+                  &pi[a[10]].ux,
+                  &pi[a[11]].ux,
+                  &pi[a[12]].ux,
+                  &pi[a[13]].ux,
+                  &pi[a[14]].ux,
+                  &pi[a[15]].ux,
+                  uix, uiy, uiz, wi );
+
+    load_16x4_tr( &pj[b[ 0]].ux,
+                  &pj[b[ 1]].ux,
+                  &pj[b[ 2]].ux,
+                  &pj[b[ 3]].ux,
+                  &pj[b[ 4]].ux,
+                  &pj[b[ 5]].ux,
+                  &pj[b[ 6]].ux,
+                  &pj[b[ 7]].ux,
+                  &pj[b[ 8]].ux,
+                  &pj[b[ 9]].ux,
+                  &pj[b[10]].ux,
+                  &pj[b[11]].ux,
+                  &pj[b[12]].ux,
+                  &pj[b[13]].ux,
+                  &pj[b[14]].ux,
+                  &pj[b[15]].ux,
+                  ujx, ujy, ujz, wj );
+
+    urx = uix - ujx;
+    ury = uiy - ujy;
+    urz = uiz - ujz;
+
+    // T is perpendicular to ur and to the axis of the smallest component
+    // of ur (the first one on ties).
+
+    x2 = urx*urx;
+    y2 = ury*ury;
+    z2 = urz*urz;
+    ur = sqrt( ( x2 + y2 ) + z2 );
+
+    my = y2 < x2;
+    mz = z2 < merge( my, y2, x2 );
+
+    t1 = merge( mz, urx, merge( my, urz, ury ) );
+    t2 = merge( mz, ury, merge( my, urx, urz ) );
+    t0 = one / sqrt( ( t1*t1 + t2*t2 ) + tiny );
+    t2 =  t0*t2;
+    t1 = -( t0*t1 );
+    tx = merge( mz, t2,   merge( my, t1,   zero ) );
+    ty = merge( mz, t1,   merge( my, zero, t2   ) );
+    tz = merge( mz, zero, merge( my, t2,   t1   ) );
+
+    t2 = one / ur;
+    t1 = std*sqrt( t2 )*t2;
+    t1 = merge( one < t1, one, t1 );
+    dd = t1*rn;
+
+    t0 = ( dd + dd ) / ( one + dd*dd );
+    t2 = t0*st;
+    t1 = t0*ur*ct;
+    t0 = t0*( -dd );
+
+    // s = (1 - cos theta) u + |u| sin theta Tperp
+
+    sx = ( t0*urx + t1*tx ) + t2*( ury*tz - urz*ty );
+    sy = ( t0*ury + t1*ty ) + t2*( urz*tx - urx*tz );
+    sz = ( t0*urz + t1*tz ) + t2*( urx*ty - ury*tx );
+
+    // Handle unequal particle weights.
+
+    t1 = czero( ( wj < wi ) && ( wi*rw > wj ), mu_i );
+    t2 = czero( ( wi < wj ) && ( wj*rw > wi ), mu_j );
+
+    uix += t1*sx;
+    uiy += t1*sy;
+    uiz += t1*sz;
+    ujx -= t2*sx;
+    ujy -= t2*sy;
+    ujz -= t2*sz;
+
+    store_16x4_tr( uix, uiy, uiz, wi,
+                   &pi[a[ 0]].ux,
+                   &pi[a[ 1]].ux,
+                   &pi[a[ 2]].ux,
+                   &pi[a[ 3]].ux,
+                   &pi[a[ 4]].ux,
+                   &pi[a[ 5]].ux,
+                   &pi[a[ 6]].ux,
+                   &pi[a[ 7]].ux,
+                   &pi[a[ 8]].ux,
+                   &pi[a[ 9]].ux,
+                   &pi[a[10]].ux,
+                   &pi[a[11]].ux,
+                   &pi[a[12]].ux,
+                   &pi[a[13]].ux,
+                   &pi[a[14]].ux,
+                   &pi[a[15]].ux );
+
+    store_16x4_tr( ujx, ujy, ujz, wj,
+                   &pj[b[ 0]].ux,
+                   &pj[b[ 1]].ux,
+                   &pj[b[ 2]].ux,
+                   &pj[b[ 3]].ux,
+                   &pj[b[ 4]].ux,
+                   &pj[b[ 5]].ux,
+                   &pj[b[ 6]].ux,
+                   &pj[b[ 7]].ux,
+                   &pj[b[ 8]].ux,
+                   &pj[b[ 9]].ux,
+                   &pj[b[10]].ux,
+                   &pj[b[11]].ux,
+                   &pj[b[12]].ux,
+                   &pj[b[13]].ux,
+                   &pj[b[14]].ux,
+                   &pj[b[15]].ux );
+  }
+
+  takizuka_abe_collide_pairs( pairs, n, pairs->n );
+}
+
+void
+takizuka_abe_pipeline_v16( takizuka_abe_t * RESTRICT cm,
+                           int pipeline_rank,
+                           int n_pipeline )
+{
+  if( pipeline_rank==n_pipeline ) return; /* No host straggler cleanup */
+
+  takizuka_abe_pipeline_voxels( cm, pipeline_rank, n_pipeline,
+                                takizuka_abe_pairs_v16 );
+}
+
+#else
+
+void
+takizuka_abe_pipeline_v16( takizuka_abe_t * RESTRICT cm,
+                           int pipeline_rank,
+                           int n_pipeline )
+{
+  // No v16 implementation.
+  ERROR( ( "No takizuka_abe_pipeline_v16 implementation." ) );
+}
+
+#endif
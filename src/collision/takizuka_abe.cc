@@ -63,6 +63,7 @@ takizuka_abe( const char       * RESTRICT name,
   cm->spi      = spi;
   cm->spj      = spj;
   cm->rp       = rp;
+  cm->seed     = uirand( rp->rng[0] );
   cm->cvar0      = cvar0;
   cm->interval = interval;
 
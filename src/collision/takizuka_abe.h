@@ -8,6 +8,7 @@ typedef struct takizuka_abe {
   species_t  * spi;
   species_t  * spj;
   rng_pool_t * rp;
+  uint32_t seed; // Seed of the shuffle and pair streams (drawn from rp)
   int interval;
   double cvar0; // Base cvar0, which will later be scaled by q and mu
 } takizuka_abe_t;
@@ -55,6 +55,17 @@ restore_unary_collision_model( void )
   return restore_collision_op_internal( cm );
 }
 
+// The pipelines use the generator of the pool with their rank.  The pool
+// is grown if there are more pipelines than at the checkpt.
+
+void
+reanimate_unary_collision_model( collision_op_t * cop )
+{
+  unary_collision_model_t * cm = ( unary_collision_model_t * ) cop->params;
+
+  resize_rng_pool( cm->rp, N_PIPELINE );
+}
+
 void
 delete_unary_collision_model( collision_op_t * cop )
 {
@@ -118,5 +129,5 @@ unary_collision_model( const char * RESTRICT name,
                                     delete_unary_collision_model,
                                     ( checkpt_func_t ) checkpt_unary_collision_model,
                                     ( restore_func_t ) restore_unary_collision_model,
-                                    NULL );
+                                    ( reanimate_func_t ) reanimate_unary_collision_model );
 }
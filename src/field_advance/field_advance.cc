@@ -19,6 +19,7 @@ checkpt_field_advance_kernels( const field_advance_kernels_t * kernel )
   CHECKPT_SYM( kernel->delete_fa                 );
   CHECKPT_SYM( kernel->advance_b                 );
   CHECKPT_SYM( kernel->advance_e                 );
+  CHECKPT_SYM( kernel->advance_b_e_b             );
   CHECKPT_SYM( kernel->energy_f                  );
   CHECKPT_SYM( kernel->clear_jf                  );
   CHECKPT_SYM( kernel->synchronize_jf            );
@@ -41,6 +42,7 @@ restore_field_advance_kernels( field_advance_kernels_t * kernel )
   RESTORE_SYM( kernel->delete_fa                 );
   RESTORE_SYM( kernel->advance_b                 );
   RESTORE_SYM( kernel->advance_e                 );
+  RESTORE_SYM( kernel->advance_b_e_b             );
   RESTORE_SYM( kernel->energy_f                  );
   RESTORE_SYM( kernel->clear_jf                  );
   RESTORE_SYM( kernel->synchronize_jf            );
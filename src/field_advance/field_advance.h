@@ -115,6 +115,7 @@
 //   advance_b( fields, grid, 0.5  );                  => B_0 to B_0.5
 //   advance_e( fields, material_coefficients, grid ); => E_0 to E_1
 //   advance_b( fields, grid, 0.5  );                  => B_0.5 to B_1
+//   (or, equivalently, advance_b_e_b( fields );       => B_0 to B_1, E_0 to E_1)
 //   if( should_clean_div_e ) {
 //     ... adjust rho_f, rho_b and/or rho_c as necessary
 //     do {
@@ -143,21 +144,43 @@
 // should be set in the ghost cells too. Further, these IDs should be
 // consistent with the neighboring domains (if any)!
 
-// FIXME: MATERIAL-LESS FIELD_T SHOULD EVENTUALLY USE ITS OWN FIELD_T
-// WITH MORE COMPACT LAYOUT.
-
 // FIXME: SHOULD HAVE DIFFERENT FIELD_T FOR CELL BUILDS AND USE NEW
 // INFRASTRUCTURE
 
+// The material ids are only read by the kernels of the general field
+// advance (and set up once by the user), so they are kept in a separate
+// field_material_t array indexed the same way as the field_t array.  A
+// field_t is then exactly 64 bytes and, as the field array is 128-byte
+// aligned, each voxel sits in a single cache line.  advance_b, the uniform
+// material kernels, the interpolator load and the current unload do not
+// stream the material ids through the cache.
+
 typedef struct field
 {
   float ex,   ey,   ez,   div_e_err;     // Electric field and div E error
   float cbx,  cby,  cbz,  div_b_err;     // Magnetic field and div B error
   float tcax, tcay, tcaz, rhob;          // TCA fields and bound charge density
   float jfx,  jfy,  jfz,  rhof;          // Free current and charge density
+} field_t;
+
+typedef struct field_material
+{
   material_id ematx, ematy, ematz, nmat; // Material at edge centers and nodes
   material_id fmatx, fmaty, fmatz, cmat; // Material at face and cell centers
-} field_t;
+} field_material_t;
+
+// A field_t together with its material ids.  This is the layout of the
+// voxels in field dumps (and what the post-processing tools read).
+
+typedef struct field_dump
+{
+  float ex,   ey,   ez,   div_e_err;
+  float cbx,  cby,  cbz,  div_b_err;
+  float tcax, tcay, tcaz, rhob;
+  float jfx,  jfy,  jfz,  rhof;
+  material_id ematx, ematy, ematz, nmat;
+  material_id fmatx, fmaty, fmatz, cmat;
+} field_dump_t;
 
 // field_advance_kernels holds all the function pointers to all the
 // kernels used by a specific field_advance instance.
@@ -181,6 +204,11 @@ typedef struct field_advance_kernels
   void (*advance_b)( struct field_array * RESTRICT fa, float frac );
   void (*advance_e)( struct field_array * RESTRICT fa, float frac );
 
+  // Equivalent to advance_b( fa, 0.5 ), advance_e( fa, 1 ) and
+  // advance_b( fa, 0.5 ) but done in one pass through the field array
+
+  void (*advance_b_e_b)( struct field_array * RESTRICT fa );
+
   // Diagnostic interface
   // FIXME: MAY NEED MORE CAREFUL THOUGHT FOR CURVILINEAR SYSTEMS
 
@@ -223,6 +251,7 @@ typedef struct field_advance_kernels
 typedef struct field_array
 {
   field_t * ALIGNED(128) f;          // Local field data
+  field_material_t * ALIGNED(128) fm; // Local material ids (same indexing)
   grid_t  * g;                       // Underlying grid
   void    * params;                  // Field advance specific parameters
   field_advance_kernels_t kernel[1]; // Field advance kernels
@@ -235,6 +264,12 @@ new_standard_field_array( grid_t           * RESTRICT g,
                           const material_t * RESTRICT m_list,
                           float                       damp );
 
+// Returns the damping new_standard_field_array made fa with or -1 if fa
+// is not a standard field array.
+
+float
+standard_field_array_damp( const field_array_t * fa );
+
 void
 delete_field_array( field_array_t * fa );
 
@@ -0,0 +1,19 @@
+#define IN_sfa
+
+#include "sfa_private.h"
+
+//----------------------------------------------------------------------------//
+// Top level function to select and call the proper advance_b_e_b function.
+//----------------------------------------------------------------------------//
+
+void
+advance_b_e_b( field_array_t * RESTRICT fa )
+{
+  if ( !fa )
+  {
+    ERROR( ( "Bad args" ) );
+  }
+
+  // Conditionally execute this when more abstractions are available.
+  advance_b_e_b_pipeline( fa, 0 );
+}
@@ -0,0 +1,222 @@
+#define IN_sfa
+#define IN_advance_b_e_b_pipeline
+
+#include "advance_b_e_b_pipeline.h"
+
+#include "../sfa_private.h"
+
+#include "../../../util/pipelines/pipelines_exec.h"
+
+//----------------------------------------------------------------------------//
+// The sweep is done in three passes over the voxels (1:nx,1:ny,1:nz) with
+// each pipeline owning the same contiguous range of voxels (in FORTRAN order)
+// in every pass.  Let S = nx*ny be the number of voxels in a z-plane and let i
+// be the index of a voxel within the range of the pipeline.
+//
+// Pass 0: For each voxel in order, half advance B.  If i >= S, the voxels
+// that voxel's interior E depend on have had their B half advanced by this
+// pipeline and no other pipeline still needs the old E in that voxel, so the
+// interior E is advanced.  If additionally i >= 2S and the voxel a z-plane
+// below is deep (x, y and z in 2:n-1), all the E the second half advance of B
+// in that voxel depends on are now known and none of them will be updated
+// again, so its B is advanced the second half step while still in cache.
+//
+// Pass 1: Once the tangential B ghosts are set up, the interior E of the
+// first S voxels of each range (which need the B of the previous range) are
+// advanced.
+//
+// Pass 2: Once the exterior E is known, the second half advance of B is done
+// in the voxels not already done in pass 0.
+//
+// Deep voxels do not touch the domain surface, so the ghost exchange, the
+// local boundary conditions and the exterior E all see the same B they
+// would see in the separate advance_b and advance_e.  Voxels are assigned
+// singly so the host never has stragglers.
+//----------------------------------------------------------------------------//
+
+static inline void
+advance_b_e_b_sweep( pipeline_args_t * args,
+                     int pipeline_rank,
+                     int n_pipeline,
+                     const int vacuum )
+{
+  DECLARE_STENCIL();
+
+  const int S = nx*ny;
+
+  int x, y, z, i, n_voxel;
+
+  DISTRIBUTE_VOXELS( 1,nx, 1,ny, 1,nz, 1,
+                     pipeline_rank, n_pipeline,
+                     x, y, z, n_voxel );
+
+  field_t * ALIGNED(16) f0 = &f( x, y, z );
+
+# define DEEP(x,y,z) ( (x) >= 2 && (x) < nx && \
+                       (y) >= 2 && (y) < ny && \
+                       (z) >= 2 && (z) < nz )
+
+# define NEXT_SWEEP_VOXEL()                     \
+  f0++; x++;                                    \
+  if ( x > nx )                                 \
+  {                                             \
+    x = 1, y++;                                 \
+    if ( y > ny ) y = 1, z++;                   \
+    f0 = &f( x, y, z );                         \
+  }
+
+  switch( args->phase )
+  {
+  case 0:
+    for( i = 0; i < n_voxel; i++ )
+    {
+      UPDATE_B( f0 );
+
+      if ( i >= S )
+      {
+        UPDATE_E( f0, y >= 2, x >= 2, x >= 2 && y >= 2 );
+
+        if ( i >= 2*S && DEEP( x, y, z-1 ) ) UPDATE_B( f0 - sz );
+      }
+
+      NEXT_SWEEP_VOXEL();
+    }
+    break;
+
+  case 1:
+    for( i = 0; i < n_voxel && i < S; i++ )
+    {
+      UPDATE_E( f0,
+                y >= 2 && z >= 2,
+                x >= 2 && z >= 2,
+                x >= 2 && y >= 2 );
+
+      NEXT_SWEEP_VOXEL();
+    }
+    break;
+
+  case 2:
+    for( i = 0; i < n_voxel; i++ )
+    {
+      if ( i < S || i >= n_voxel - S || !DEEP( x, y, z ) ) UPDATE_B( f0 );
+
+      NEXT_SWEEP_VOXEL();
+    }
+    break;
+
+  default:
+    ERROR( ( "Bad phase" ) );
+  }
+
+# undef NEXT_SWEEP_VOXEL
+# undef DEEP
+}
+
+void
+advance_b_e_b_pipeline_scalar( pipeline_args_t * args,
+                               int pipeline_rank,
+                               int n_pipeline )
+{
+  if ( args->vacuum ) advance_b_e_b_sweep( args, pipeline_rank, n_pipeline, 1 );
+  else                advance_b_e_b_sweep( args, pipeline_rank, n_pipeline, 0 );
+}
+
+//----------------------------------------------------------------------------//
+// Top level function to select and call the proper advance_b_e_b pipeline
+// function.
+//----------------------------------------------------------------------------//
+
+void
+advance_b_e_b_pipeline( field_array_t * RESTRICT fa,
+                        int vacuum )
+{
+  if ( !fa )
+  {
+    ERROR( ( "Bad args" ) );
+  }
+
+  // The absorbing boundary conditions set the tangential B ghosts from the E
+  // at the start of the step, some of which the sweep has already advanced.
+
+  for( int face = 0; face < 6; face++ )
+  {
+    int i = face == 0 ? -1 : face == 3 ? 1 : 0;
+    int j = face == 1 ? -1 : face == 4 ? 1 : 0;
+    int k = face == 2 ? -1 : face == 5 ? 1 : 0;
+
+    if ( fa->g->bc[ BOUNDARY( i, j, k ) ] == absorb_fields )
+    {
+      advance_b_pipeline( fa, 0.5 );
+
+      if ( vacuum ) vacuum_advance_e_pipeline( fa, 1 );
+      else          advance_e_pipeline( fa, 1 );
+
+      advance_b_pipeline( fa, 0.5 );
+
+      return;
+    }
+  }
+
+  pipeline_args_t args[1];
+
+  args->f      = fa->f;
+  args->fm     = fa->fm;
+  args->p      = (sfa_params_t *) fa->params;
+  args->g      = fa->g;
+  args->vacuum = vacuum;
+
+  //--------------------------------------------------------------------------//
+  // Half advance B, advance most of interior E and finish most of B
+  //--------------------------------------------------------------------------//
+
+  args->phase = 0;
+
+  EXEC_PIPELINES( advance_b_e_b, args, 0 );
+
+  // While the pipelines are busy, do surface B
+
+  advance_b_exterior( fa, 0.5 );
+
+  WAIT_PIPELINES();
+
+  local_adjust_norm_b( fa->f, fa->g );
+
+  //--------------------------------------------------------------------------//
+  // Tangential B ghost setup and the rest of interior E
+  //--------------------------------------------------------------------------//
+
+  begin_remote_ghost_tang_b( fa->f, fa->g );
+
+  local_ghost_tang_b( fa->f, fa->g );
+
+  args->phase = 1;
+
+  EXEC_PIPELINES( advance_b_e_b, args, 0 );
+
+  WAIT_PIPELINES();
+
+  end_remote_ghost_tang_b( fa->f, fa->g );
+
+  //--------------------------------------------------------------------------//
+  // Exterior E
+  //--------------------------------------------------------------------------//
+
+  if ( vacuum ) vacuum_advance_e_exterior( fa );
+  else          advance_e_exterior( fa );
+
+  local_adjust_tang_e( fa->f, fa->g );
+
+  //--------------------------------------------------------------------------//
+  // Rest of B
+  //--------------------------------------------------------------------------//
+
+  args->phase = 2;
+
+  EXEC_PIPELINES( advance_b_e_b, args, 0 );
+
+  advance_b_exterior( fa, 0.5 );
+
+  WAIT_PIPELINES();
+
+  local_adjust_norm_b( fa->f, fa->g );
+}
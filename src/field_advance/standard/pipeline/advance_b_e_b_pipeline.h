@@ -0,0 +1,137 @@
+#ifndef _advance_b_e_b_pipeline_h_
+#define _advance_b_e_b_pipeline_h_
+
+#ifndef IN_advance_b_e_b_pipeline
+#error "Only include advance_b_e_b_pipeline.h in advance_b_e_b_pipeline source files."
+#endif
+
+#include "../sfa_private.h"
+
+typedef struct pipeline_args
+{
+  field_t                * ALIGNED(128) f;
+  const field_material_t * ALIGNED(128) fm;
+  const sfa_params_t     *              p;
+  const grid_t           *              g;
+  int phase;                    // Which pass of the sweep to do (0, 1 or 2)
+  int vacuum;                   // Use the uniform material coefficients
+} pipeline_args_t;
+
+// The coefficients are computed exactly as in advance_b and in advance_e
+// (or vacuum_advance_e) such that the results are identical.
+
+#define DECLARE_STENCIL()                                                    \
+        field_t                * ALIGNED(128) f = args->f;                   \
+  const field_material_t       * ALIGNED(128) fm = args->fm;                 \
+  const material_coefficient_t * ALIGNED(128) m = args->p->mc;               \
+  const grid_t                 *              g = args->g;                   \
+  const int nx = g->nx, ny = g->ny, nz = g->nz;                              \
+  const int sy = nx+2, sz = sy*(ny+2);                                       \
+                                                                             \
+  const float frac = 0.5f;                                                   \
+  const float bpx  = (nx>1) ? frac*g->cvac*g->dt*g->rdx : 0;                 \
+  const float bpy  = (ny>1) ? frac*g->cvac*g->dt*g->rdy : 0;                 \
+  const float bpz  = (nz>1) ? frac*g->cvac*g->dt*g->rdz : 0;                 \
+                                                                             \
+  const float damp = args->p->damp;                                          \
+  const float px   = (nx>1) ? (1+damp)*g->cvac*g->dt*g->rdx : 0;             \
+  const float py   = (ny>1) ? (1+damp)*g->cvac*g->dt*g->rdy : 0;             \
+  const float pz   = (nz>1) ? (1+damp)*g->cvac*g->dt*g->rdz : 0;             \
+  const float cj   = g->dt/g->eps0;                                          \
+                                                                             \
+  const float decayx = m->decayx, drivex = m->drivex;                        \
+  const float decayy = m->decayy, drivey = m->drivey;                        \
+  const float decayz = m->decayz, drivez = m->drivez;                        \
+  const float px_muz = ((nx>1) ? (1+damp)*g->cvac*g->dt*g->rdx : 0)*m->rmuz; \
+  const float px_muy = ((nx>1) ? (1+damp)*g->cvac*g->dt*g->rdx : 0)*m->rmuy; \
+  const float py_mux = ((ny>1) ? (1+damp)*g->cvac*g->dt*g->rdy : 0)*m->rmux; \
+  const float py_muz = ((ny>1) ? (1+damp)*g->cvac*g->dt*g->rdy : 0)*m->rmuz; \
+  const float pz_muy = ((nz>1) ? (1+damp)*g->cvac*g->dt*g->rdz : 0)*m->rmuy; \
+  const float pz_mux = ((nz>1) ? (1+damp)*g->cvac*g->dt*g->rdz : 0)*m->rmux
+
+#define f(x,y,z) f[ VOXEL( x, y, z, nx, ny, nz ) ]
+
+// Half advance of B in the voxel f0.  This is UPDATE_CB[XYZ] of advance_b.
+
+#define UPDATE_B( f0 ) do {                                                 \
+    field_t * ALIGNED(16) _f0 = (f0);                                       \
+    const field_t * _fx = _f0 + 1, * _fy = _f0 + sy, * _fz = _f0 + sz;      \
+    _f0->cbx -= ( bpy*( _fy->ez-_f0->ez ) - bpz*( _fz->ey-_f0->ey ) );      \
+    _f0->cby -= ( bpz*( _fz->ex-_f0->ex ) - bpx*( _fx->ez-_f0->ez ) );      \
+    _f0->cbz -= ( bpx*( _fx->ey-_f0->ey ) - bpy*( _fy->ex-_f0->ex ) );      \
+  } while(0)
+
+// Advance of the E components of the voxel f0 selected by do_ex, do_ey and
+// do_ez.  This is UPDATE_E[XYZ] of advance_e or vacuum_advance_e.
+
+#define UPDATE_E( f0, do_ex, do_ey, do_ez ) do {                            \
+    field_t * ALIGNED(16) _f0 = (f0);                                       \
+    const field_t * _fx = _f0 - 1, * _fy = _f0 - sy, * _fz = _f0 - sz;      \
+    if ( vacuum )                                                           \
+    {                                                                       \
+      if ( do_ex )                                                          \
+      {                                                                     \
+        _f0->tcax = ( py_muz * ( _f0->cbz - _fy->cbz ) -                    \
+                      pz_muy * ( _f0->cby - _fz->cby ) ) -                  \
+                    damp * _f0->tcax;                                       \
+        _f0->ex   = decayx * _f0->ex +                                      \
+                    drivex * ( _f0->tcax - cj * _f0->jfx );                 \
+      }                                                                     \
+      if ( do_ey )                                                          \
+      {                                                                     \
+        _f0->tcay = ( pz_mux * ( _f0->cbx - _fz->cbx ) -                    \
+                      px_muz * ( _f0->cbz - _fx->cbz ) ) -                  \
+                    damp * _f0->tcay;                                       \
+        _f0->ey   = decayy * _f0->ey +                                      \
+                    drivey * ( _f0->tcay - cj * _f0->jfy );                 \
+      }                                                                     \
+      if ( do_ez )                                                          \
+      {                                                                     \
+        _f0->tcaz = ( px_muy * ( _f0->cby - _fx->cby ) -                    \
+                      py_mux * ( _f0->cbx - _fy->cbx ) ) -                  \
+                    damp * _f0->tcaz;                                       \
+        _f0->ez   = decayz * _f0->ez +                                      \
+                    drivez * ( _f0->tcaz - cj * _f0->jfz );                 \
+      }                                                                     \
+    }                                                                       \
+    else                                                                    \
+    {                                                                       \
+      if ( do_ex )                                                          \
+      {                                                                     \
+        _f0->tcax = ( py * ( _f0->cbz * m[MAT(_f0).fmatz].rmuz -            \
+                             _fy->cbz * m[MAT(_fy).fmatz].rmuz ) -          \
+                      pz * ( _f0->cby * m[MAT(_f0).fmaty].rmuy -            \
+                             _fz->cby * m[MAT(_fz).fmaty].rmuy ) ) -        \
+                    damp * _f0->tcax;                                       \
+        _f0->ex   = m[MAT(_f0).ematx].decayx * _f0->ex +                    \
+                    m[MAT(_f0).ematx].drivex * ( _f0->tcax - cj * _f0->jfx ); \
+      }                                                                     \
+      if ( do_ey )                                                          \
+      {                                                                     \
+        _f0->tcay = ( pz * ( _f0->cbx * m[MAT(_f0).fmatx].rmux -            \
+                             _fz->cbx * m[MAT(_fz).fmatx].rmux ) -          \
+                      px * ( _f0->cbz * m[MAT(_f0).fmatz].rmuz -            \
+                             _fx->cbz * m[MAT(_fx).fmatz].rmuz ) ) -        \
+                    damp * _f0->tcay;                                       \
+        _f0->ey   = m[MAT(_f0).ematy].decayy * _f0->ey +                    \
+                    m[MAT(_f0).ematy].drivey * ( _f0->tcay - cj * _f0->jfy ); \
+      }                                                                     \
+      if ( do_ez )                                                          \
+      {                                                                     \
+        _f0->tcaz = ( px * ( _f0->cby * m[MAT(_f0).fmaty].rmuy -            \
+                             _fx->cby * m[MAT(_fx).fmaty].rmuy ) -          \
+                      py * ( _f0->cbx * m[MAT(_f0).fmatx].rmux -            \
+                             _fy->cbx * m[MAT(_fy).fmatx].rmux ) ) -        \
+                    damp * _f0->tcaz;                                       \
+        _f0->ez   = m[MAT(_f0).ematz].decayz * _f0->ez +                    \
+                    m[MAT(_f0).ematz].drivez * ( _f0->tcaz - cj * _f0->jfz ); \
+      }                                                                     \
+    }                                                                       \
+  } while(0)
+
+void
+advance_b_e_b_pipeline_scalar( pipeline_args_t * args,
+                               int pipeline_rank,
+                               int n_pipeline );
+
+#endif // _advance_b_e_b_pipeline_h_
@@ -44,32 +44,20 @@ advance_b_pipeline_scalar( pipeline_args_t * args,
 }
 
 //----------------------------------------------------------------------------//
-// Top level function to select and call the proper advance_b pipeline
-// function.
+// Update the bx, by and bz on the x=nx+1, y=ny+1 and z=nz+1 faces.  These are
+// not done by the advance_b pipelines.
 //----------------------------------------------------------------------------//
 
 void
-advance_b_pipeline( field_array_t * RESTRICT fa,
+advance_b_exterior( field_array_t * RESTRICT fa,
                     float _frac )
 {
-  if ( !fa )
-  {
-    ERROR( ( "Bad args" ) );
-  }
-  
-  // Do the bulk of the magnetic fields in the pipelines.  The host
-  // handles stragglers.
-
   pipeline_args_t args[1];
 
   args->f    = fa->f;
   args->g    = fa->g;
   args->frac = _frac;
 
-  EXEC_PIPELINES( advance_b, args, 0 );
-
-  // While the pipelines are busy, do surface fields
-
   DECLARE_STENCIL();
 
   // Do left over bx
@@ -118,8 +106,38 @@ advance_b_pipeline( field_array_t * RESTRICT fa,
       fy++;
     }
   }
+}
+
+//----------------------------------------------------------------------------//
+// Top level function to select and call the proper advance_b pipeline
+// function.
+//----------------------------------------------------------------------------//
+
+void
+advance_b_pipeline( field_array_t * RESTRICT fa,
+                    float _frac )
+{
+  if ( !fa )
+  {
+    ERROR( ( "Bad args" ) );
+  }
+  
+  // Do the bulk of the magnetic fields in the pipelines.  The host
+  // handles stragglers.
+
+  pipeline_args_t args[1];
+
+  args->f    = fa->f;
+  args->g    = fa->g;
+  args->frac = _frac;
+
+  EXEC_PIPELINES( advance_b, args, 0 );
+
+  // While the pipelines are busy, do surface fields
+
+  advance_b_exterior( fa, _frac );
 
   WAIT_PIPELINES();
 
-  local_adjust_norm_b( f, g );
+  local_adjust_norm_b( fa->f, fa->g );
 }
@@ -25,9 +25,7 @@ advance_e_pipeline_scalar( pipeline_args_t * args,
 
   int n_voxel;
 
-  DISTRIBUTE_VOXELS( 2,nx, 2,ny, 2,nz, 16,
-                     pipeline_rank, n_pipeline,
-                     x, y, z, n_voxel );
+  DISTRIBUTE_STENCIL( 16, pipeline_rank, n_pipeline, n_voxel );
 
   INIT_STENCIL();
 
@@ -42,112 +40,24 @@ advance_e_pipeline_scalar( pipeline_args_t * args,
 }
 
 //----------------------------------------------------------------------------//
-// Top level function to select and call the proper advance_e pipeline
-// function.
+// Update the exterior tangential E.  These are not done by the advance_e
+// pipelines and need the tangential B ghosts.
 //----------------------------------------------------------------------------//
 
 void
-advance_e_pipeline( field_array_t * RESTRICT fa,
-                    float frac )
+advance_e_exterior( field_array_t * RESTRICT fa )
 {
-  if ( !fa  )
-  {
-    ERROR( ( "Bad args" ) );
-  }
-
-  if ( frac != 1 )
-  {
-    ERROR( ( "standard advance_e does not support frac != 1 yet" ) );
-  }
-
-  /***************************************************************************
-   * Begin tangential B ghost setup
-   ***************************************************************************/
-  
-  begin_remote_ghost_tang_b( fa->f, fa->g );
-
-  local_ghost_tang_b( fa->f, fa->g );
-
-  /***************************************************************************
-   * Update interior fields
-   * Note: ex all (1:nx,  1:ny+1,1,nz+1) interior (1:nx,2:ny,2:nz)
-   * Note: ey all (1:nx+1,1:ny,  1:nz+1) interior (2:nx,1:ny,2:nz)
-   * Note: ez all (1:nx+1,1:ny+1,1:nz  ) interior (1:nx,1:ny,2:nz)
-   ***************************************************************************/
-
-  // Do majority interior in a single pass.  The host handles
-  // stragglers.
-
   pipeline_args_t args[1];
-  args->f = fa->f;
-  args->p = (sfa_params_t *)fa->params;
-  args->g = fa->g;
 
-  EXEC_PIPELINES( advance_e, args, 0 );
-  
-  // While the pipelines are busy, do non-bulk interior fields
+  args->f      = fa->f;
+  args->fm     = fa->fm;
+  args->p      = (sfa_params_t *) fa->params;
+  args->g      = fa->g;
+  args->tile   = NULL;
+  args->n_tile = 0;
 
   DECLARE_STENCIL();
 
-  // Do left over interior ex
-  for( z = 2; z <= nz; z++ )
-  {
-    for( y = 2; y <= ny; y++ )
-    {
-      f0 = &f( 1, y,   z   );
-      fy = &f( 1, y-1, z   );
-      fz = &f( 1, y,   z-1 );
-
-      UPDATE_EX();
-    }
-  }
-
-  // Do left over interior ey
-  for( z = 2; z <= nz; z++ )
-  {
-    f0 = &f( 2, 1, z   );
-    fx = &f( 1, 1, z   );
-    fz = &f( 2, 1, z-1 );
-
-    for( x = 2; x <= nx; x++ )
-    {
-      UPDATE_EY();
-
-      f0++;
-      fx++;
-      fz++;
-    }
-  }
-
-  // Do left over interior ez
-  for( y = 2; y <= ny; y++ )
-  {
-    f0 = &f( 2, y,   1 );
-    fx = &f( 1, y,   1 );
-    fy = &f( 2, y-1, 1 );
-
-    for( x = 2; x <= nx; x++ )
-    {
-      UPDATE_EZ();
-
-      f0++;
-      fx++;
-      fy++;
-    }
-  }
-
-  WAIT_PIPELINES();
-  
-  /***************************************************************************
-   * Finish tangential B ghost setup
-   ***************************************************************************/
-
-  end_remote_ghost_tang_b( fa->f, fa->g );
-
-  /***************************************************************************
-   * Update exterior fields
-   ***************************************************************************/
-
   // Do exterior ex
   for( y = 1; y <= ny+1; y++ )
   {
@@ -326,6 +236,135 @@ advance_e_pipeline( field_array_t * RESTRICT fa,
       UPDATE_EZ();
     }
   }
+}
+
+//----------------------------------------------------------------------------//
+// Top level function to select and call the proper advance_e pipeline
+// function.
+//----------------------------------------------------------------------------//
+
+void
+advance_e_pipeline( field_array_t * RESTRICT fa,
+                    float frac )
+{
+  if ( !fa  )
+  {
+    ERROR( ( "Bad args" ) );
+  }
+
+  if ( frac != 1 )
+  {
+    ERROR( ( "standard advance_e does not support frac != 1 yet" ) );
+  }
+
+  /***************************************************************************
+   * Begin tangential B ghost setup
+   ***************************************************************************/
+  
+  begin_remote_ghost_tang_b( fa->f, fa->g );
+
+  local_ghost_tang_b( fa->f, fa->g );
+
+  /***************************************************************************
+   * Update interior fields
+   * Note: ex all (1:nx,  1:ny+1,1,nz+1) interior (1:nx,2:ny,2:nz)
+   * Note: ey all (1:nx+1,1:ny,  1:nz+1) interior (2:nx,1:ny,2:nz)
+   * Note: ez all (1:nx+1,1:ny+1,1:nz  ) interior (1:nx,1:ny,2:nz)
+   ***************************************************************************/
+
+  // Do majority interior in a single pass over the tiles with mixed
+  // materials.  The host handles stragglers.  The tiles of a uniform
+  // material are done afterward with the vacuum pipelines.
+
+  sfa_params_t * p = (sfa_params_t *) fa->params;
+
+  if ( !p->tile ) classify_sfa_tiles( p, fa->fm, fa->g );
+
+  int n_mixed = 0;
+
+  while( n_mixed < p->n_tile && p->tile[n_mixed].mat < 0 ) n_mixed++;
+
+  pipeline_args_t args[1];
+  args->f      = fa->f;
+  args->fm     = fa->fm;
+  args->p      = p;
+  args->g      = fa->g;
+  args->tile   = p->tile;
+  args->n_tile = n_mixed;
+
+  if ( n_mixed ) EXEC_PIPELINES( advance_e, args, 0 );
+  
+  // While the pipelines are busy, do non-bulk interior fields
+
+  DECLARE_STENCIL();
+
+  // Do left over interior ex
+  for( z = 2; z <= nz; z++ )
+  {
+    for( y = 2; y <= ny; y++ )
+    {
+      f0 = &f( 1, y,   z   );
+      fy = &f( 1, y-1, z   );
+      fz = &f( 1, y,   z-1 );
+
+      UPDATE_EX();
+    }
+  }
+
+  // Do left over interior ey
+  for( z = 2; z <= nz; z++ )
+  {
+    f0 = &f( 2, 1, z   );
+    fx = &f( 1, 1, z   );
+    fz = &f( 2, 1, z-1 );
+
+    for( x = 2; x <= nx; x++ )
+    {
+      UPDATE_EY();
+
+      f0++;
+      fx++;
+      fz++;
+    }
+  }
+
+  // Do left over interior ez
+  for( y = 2; y <= ny; y++ )
+  {
+    f0 = &f( 2, y,   1 );
+    fx = &f( 1, y,   1 );
+    fy = &f( 2, y-1, 1 );
+
+    for( x = 2; x <= nx; x++ )
+    {
+      UPDATE_EZ();
+
+      f0++;
+      fx++;
+      fy++;
+    }
+  }
+
+  if ( n_mixed ) WAIT_PIPELINES();
+
+  for( int t = n_mixed, t1; t < p->n_tile; t = t1 )
+  {
+    for( t1 = t + 1; t1 < p->n_tile && p->tile[t1].mat == p->tile[t].mat; t1++ );
+
+    vacuum_advance_e_tiles( fa, p->tile + t, t1 - t );
+  }
+  
+  /***************************************************************************
+   * Finish tangential B ghost setup
+   ***************************************************************************/
+
+  end_remote_ghost_tang_b( fa->f, fa->g );
+
+  /***************************************************************************
+   * Update exterior fields
+   ***************************************************************************/
+
+  advance_e_exterior( fa );
 
   local_adjust_tang_e( fa->f, fa->g );
 }
@@ -9,13 +9,17 @@
 
 typedef struct pipeline_args
 {
-  field_t            * ALIGNED(128) f;
-  const sfa_params_t *              p;
-  const grid_t       *              g;
+  field_t                * ALIGNED(128) f;
+  const field_material_t * ALIGNED(128) fm;
+  const sfa_params_t     *              p;
+  const grid_t           *              g;
+  const sfa_tile_t       *              tile;   // Tiles to update
+  int                                   n_tile;
 } pipeline_args_t;
 
 #define DECLARE_STENCIL()                                        \
         field_t                * ALIGNED(128) f = args->f;       \
+  const field_material_t       * ALIGNED(128) fm = args->fm;     \
   const material_coefficient_t * ALIGNED(128) m = args->p->mc;   \
   const grid_t                 *              g = args->g;       \
   const int nx = g->nx, ny = g->ny, nz = g->nz;                  \
@@ -26,6 +30,9 @@ typedef struct pipeline_args
   const float pz   = (nz>1) ? (1+damp)*g->cvac*g->dt*g->rdz : 0; \
   const float cj   = g->dt/g->eps0;                              \
                                                                  \
+  const sfa_tile_t * tile = args->tile;                          \
+  int n_tile = args->n_tile, ty0, ty1, tz1;                      \
+                                                                 \
   field_t * ALIGNED(16) f0;                                      \
   field_t * ALIGNED(16) fx, * ALIGNED(16) fy, * ALIGNED(16) fz;  \
   int x, y, z
@@ -38,41 +45,56 @@ typedef struct pipeline_args
   fy = &f( x,   y-1, z   ); \
   fz = &f( x,   y,   z-1 )
 
-#define NEXT_STENCIL()                      \
-  f0++; fx++; fy++; fz++; x++;              \
-  if ( x > nx )                             \
-  {                                         \
-                  y++;               x = 2; \
-    if ( y > ny ) z++; if ( y > ny ) y = 2; \
-    INIT_STENCIL();                         \
+// The voxels of the tiles are visited one tile after the other.
+
+#define DISTRIBUTE_STENCIL( b, pipeline_rank, n_pipeline, n_voxel ) \
+  n_voxel = distribute_sfa_tiles( &tile, &n_tile, nx, b,            \
+                                  pipeline_rank, n_pipeline,        \
+                                  &x, &y, &z );                     \
+  ty0 = tile->y0; ty1 = tile->y1; tz1 = tile->z1
+
+#define NEXT_STENCIL()                           \
+  f0++; fx++; fy++; fz++; x++;                   \
+  if ( x > nx )                                  \
+  {                                              \
+                   y++;                x = 2;    \
+    if ( y > ty1 ) z++; if ( y > ty1 ) y = ty0;  \
+    if ( z > tz1 && n_tile > 1 )                 \
+    {                                            \
+      tile++; n_tile--;                          \
+      ty0 = tile->y0; ty1 = tile->y1;            \
+      tz1 = tile->z1;                            \
+      y   = ty0;      z   = tile->z0;            \
+    }                                            \
+    INIT_STENCIL();                              \
   }
 
 #define UPDATE_EX()                                         \
-  f0->tcax = ( py * ( f0->cbz * m[f0->fmatz].rmuz -         \
-		      fy->cbz * m[fy->fmatz].rmuz ) -       \
-               pz * ( f0->cby * m[f0->fmaty].rmuy -         \
-		      fz->cby * m[fz->fmaty].rmuy ) ) -     \
+  f0->tcax = ( py * ( f0->cbz * m[MAT(f0).fmatz].rmuz -     \
+		      fy->cbz * m[MAT(fy).fmatz].rmuz ) -   \
+               pz * ( f0->cby * m[MAT(f0).fmaty].rmuy -     \
+		      fz->cby * m[MAT(fz).fmaty].rmuy ) ) - \
              damp * f0->tcax;                               \
-  f0->ex   = m[f0->ematx].decayx * f0->ex +                 \
-             m[f0->ematx].drivex * ( f0->tcax - cj * f0->jfx )
+  f0->ex   = m[MAT(f0).ematx].decayx * f0->ex +             \
+             m[MAT(f0).ematx].drivex * ( f0->tcax - cj * f0->jfx )
 
 #define UPDATE_EY()                                         \
-  f0->tcay = ( pz * ( f0->cbx * m[f0->fmatx].rmux -         \
-		      fz->cbx * m[fz->fmatx].rmux ) -       \
-               px * ( f0->cbz * m[f0->fmatz].rmuz -         \
-		      fx->cbz * m[fx->fmatz].rmuz ) ) -     \
+  f0->tcay = ( pz * ( f0->cbx * m[MAT(f0).fmatx].rmux -     \
+		      fz->cbx * m[MAT(fz).fmatx].rmux ) -   \
+               px * ( f0->cbz * m[MAT(f0).fmatz].rmuz -     \
+		      fx->cbz * m[MAT(fx).fmatz].rmuz ) ) - \
              damp * f0->tcay;                               \
-  f0->ey   = m[f0->ematy].decayy * f0->ey +                 \
-             m[f0->ematy].drivey * ( f0->tcay - cj * f0->jfy )
+  f0->ey   = m[MAT(f0).ematy].decayy * f0->ey +             \
+             m[MAT(f0).ematy].drivey * ( f0->tcay - cj * f0->jfy )
 
 #define UPDATE_EZ()                                         \
-  f0->tcaz = ( px * ( f0->cby * m[f0->fmaty].rmuy -         \
-		      fx->cby * m[fx->fmaty].rmuy ) -       \
-               py * ( f0->cbx * m[f0->fmatx].rmux -         \
-		      fy->cbx * m[fy->fmatx].rmux ) ) -     \
+  f0->tcaz = ( px * ( f0->cby * m[MAT(f0).fmaty].rmuy -     \
+		      fx->cby * m[MAT(fx).fmaty].rmuy ) -   \
+               py * ( f0->cbx * m[MAT(f0).fmatx].rmux -     \
+		      fy->cbx * m[MAT(fy).fmatx].rmux ) ) - \
              damp * f0->tcaz;                               \
-  f0->ez   = m[f0->ematz].decayz * f0->ez +                 \
-             m[f0->ematz].drivez * ( f0->tcaz - cj * f0->jfz )
+  f0->ez   = m[MAT(f0).ematz].decayz * f0->ez +             \
+             m[MAT(f0).ematz].drivez * ( f0->tcaz - cj * f0->jfz )
 
 void
 advance_e_pipeline_scalar( pipeline_args_t * args,
@@ -18,9 +18,7 @@ advance_e_pipeline_v16( pipeline_args_t * args,
 
   int n_voxel;
 
-  DISTRIBUTE_VOXELS( 2,nx, 2,ny, 2,nz, 16,
-                     pipeline_rank, n_pipeline,
-                     x, y, z, n_voxel );
+  DISTRIBUTE_STENCIL( 16, pipeline_rank, n_pipeline, n_voxel );
 
   const v16float vdamp( damp );
   const v16float vpx( px );
@@ -136,56 +134,56 @@ advance_e_pipeline_v16( pipeline_args_t * args,
                   &fz12->cbx, &fz13->cbx, &fz14->cbx, &fz15->cbx,
                   fz_cbx, fz_cby );
 
-#   define LOAD_RMU(V,D) m_f##V##_rmu##D=v16float( m[f##V##00->fmat##D].rmu##D, \
-                                                   m[f##V##01->fmat##D].rmu##D, \
-                                                   m[f##V##02->fmat##D].rmu##D, \
-                                                   m[f##V##03->fmat##D].rmu##D, \
-                                                   m[f##V##04->fmat##D].rmu##D, \
-                                                   m[f##V##05->fmat##D].rmu##D, \
-                                                   m[f##V##06->fmat##D].rmu##D, \
-                                                   m[f##V##07->fmat##D].rmu##D, \
-                                                   m[f##V##08->fmat##D].rmu##D, \
-                                                   m[f##V##09->fmat##D].rmu##D, \
-                                                   m[f##V##10->fmat##D].rmu##D, \
-                                                   m[f##V##11->fmat##D].rmu##D, \
-                                                   m[f##V##12->fmat##D].rmu##D, \
-                                                   m[f##V##13->fmat##D].rmu##D, \
-                                                   m[f##V##14->fmat##D].rmu##D, \
-                                                   m[f##V##15->fmat##D].rmu##D )
+#   define LOAD_RMU(V,D) m_f##V##_rmu##D=v16float( m[MAT(f##V##00).fmat##D].rmu##D, \
+                                                   m[MAT(f##V##01).fmat##D].rmu##D, \
+                                                   m[MAT(f##V##02).fmat##D].rmu##D, \
+                                                   m[MAT(f##V##03).fmat##D].rmu##D, \
+                                                   m[MAT(f##V##04).fmat##D].rmu##D, \
+                                                   m[MAT(f##V##05).fmat##D].rmu##D, \
+                                                   m[MAT(f##V##06).fmat##D].rmu##D, \
+                                                   m[MAT(f##V##07).fmat##D].rmu##D, \
+                                                   m[MAT(f##V##08).fmat##D].rmu##D, \
+                                                   m[MAT(f##V##09).fmat##D].rmu##D, \
+                                                   m[MAT(f##V##10).fmat##D].rmu##D, \
+                                                   m[MAT(f##V##11).fmat##D].rmu##D, \
+                                                   m[MAT(f##V##12).fmat##D].rmu##D, \
+                                                   m[MAT(f##V##13).fmat##D].rmu##D, \
+                                                   m[MAT(f##V##14).fmat##D].rmu##D, \
+                                                   m[MAT(f##V##15).fmat##D].rmu##D )
 
     LOAD_RMU(0,x); LOAD_RMU(0,y); LOAD_RMU(0,z);
                    LOAD_RMU(x,y); LOAD_RMU(x,z);
     LOAD_RMU(y,x);                LOAD_RMU(y,z);
     LOAD_RMU(z,x); LOAD_RMU(z,y);
 
-    load_16x2_tr( &m[f000->ematx].decayx, &m[f001->ematx].decayx,
-                  &m[f002->ematx].decayx, &m[f003->ematx].decayx,
-                  &m[f004->ematx].decayx, &m[f005->ematx].decayx,
-                  &m[f006->ematx].decayx, &m[f007->ematx].decayx,
-                  &m[f008->ematx].decayx, &m[f009->ematx].decayx,
-                  &m[f010->ematx].decayx, &m[f011->ematx].decayx,
-                  &m[f012->ematx].decayx, &m[f013->ematx].decayx,
-                  &m[f014->ematx].decayx, &m[f015->ematx].decayx,
+    load_16x2_tr( &m[MAT(f000).ematx].decayx, &m[MAT(f001).ematx].decayx,
+                  &m[MAT(f002).ematx].decayx, &m[MAT(f003).ematx].decayx,
+                  &m[MAT(f004).ematx].decayx, &m[MAT(f005).ematx].decayx,
+                  &m[MAT(f006).ematx].decayx, &m[MAT(f007).ematx].decayx,
+                  &m[MAT(f008).ematx].decayx, &m[MAT(f009).ematx].decayx,
+                  &m[MAT(f010).ematx].decayx, &m[MAT(f011).ematx].decayx,
+                  &m[MAT(f012).ematx].decayx, &m[MAT(f013).ematx].decayx,
+                  &m[MAT(f014).ematx].decayx, &m[MAT(f015).ematx].decayx,
                   m_f0_decayx, m_f0_drivex );
 
-    load_16x2_tr( &m[f000->ematy].decayy, &m[f001->ematy].decayy,
-                  &m[f002->ematy].decayy, &m[f003->ematy].decayy,
-                  &m[f004->ematy].decayy, &m[f005->ematy].decayy,
-                  &m[f006->ematy].decayy, &m[f007->ematy].decayy,
-                  &m[f008->ematy].decayy, &m[f009->ematy].decayy,
-                  &m[f010->ematy].decayy, &m[f011->ematy].decayy,
-                  &m[f012->ematy].decayy, &m[f013->ematy].decayy,
-                  &m[f014->ematy].decayy, &m[f015->ematy].decayy,
+    load_16x2_tr( &m[MAT(f000).ematy].decayy, &m[MAT(f001).ematy].decayy,
+                  &m[MAT(f002).ematy].decayy, &m[MAT(f003).ematy].decayy,
+                  &m[MAT(f004).ematy].decayy, &m[MAT(f005).ematy].decayy,
+                  &m[MAT(f006).ematy].decayy, &m[MAT(f007).ematy].decayy,
+                  &m[MAT(f008).ematy].decayy, &m[MAT(f009).ematy].decayy,
+                  &m[MAT(f010).ematy].decayy, &m[MAT(f011).ematy].decayy,
+                  &m[MAT(f012).ematy].decayy, &m[MAT(f013).ematy].decayy,
+                  &m[MAT(f014).ematy].decayy, &m[MAT(f015).ematy].decayy,
                   m_f0_decayy, m_f0_drivey );
 
-    load_16x2_tr( &m[f000->ematz].decayz, &m[f001->ematz].decayz,
-                  &m[f002->ematz].decayz, &m[f003->ematz].decayz,
-                  &m[f004->ematz].decayz, &m[f005->ematz].decayz,
-                  &m[f006->ematz].decayz, &m[f007->ematz].decayz,
-                  &m[f008->ematz].decayz, &m[f009->ematz].decayz,
-                  &m[f010->ematz].decayz, &m[f011->ematz].decayz,
-                  &m[f012->ematz].decayz, &m[f013->ematz].decayz,
-                  &m[f014->ematz].decayz, &m[f015->ematz].decayz,
+    load_16x2_tr( &m[MAT(f000).ematz].decayz, &m[MAT(f001).ematz].decayz,
+                  &m[MAT(f002).ematz].decayz, &m[MAT(f003).ematz].decayz,
+                  &m[MAT(f004).ematz].decayz, &m[MAT(f005).ematz].decayz,
+                  &m[MAT(f006).ematz].decayz, &m[MAT(f007).ematz].decayz,
+                  &m[MAT(f008).ematz].decayz, &m[MAT(f009).ematz].decayz,
+                  &m[MAT(f010).ematz].decayz, &m[MAT(f011).ematz].decayz,
+                  &m[MAT(f012).ematz].decayz, &m[MAT(f013).ematz].decayz,
+                  &m[MAT(f014).ematz].decayz, &m[MAT(f015).ematz].decayz,
                   m_f0_decayz, m_f0_drivez );
 
 #   undef LOAD_RMU
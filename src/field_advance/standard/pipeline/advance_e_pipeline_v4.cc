@@ -18,9 +18,7 @@ advance_e_pipeline_v4( pipeline_args_t * args,
 
   int n_voxel;
 
-  DISTRIBUTE_VOXELS( 2,nx, 2,ny, 2,nz, 16,
-                     pipeline_rank, n_pipeline,
-                     x, y, z, n_voxel );
+  DISTRIBUTE_STENCIL( 16, pipeline_rank, n_pipeline, n_voxel );
 
   const v4float vdamp( damp );
   const v4float vpx( px );
@@ -91,26 +89,26 @@ advance_e_pipeline_v4( pipeline_args_t * args,
     load_4x2_tr( &fz0->cbx, &fz1->cbx, &fz2->cbx, &fz3->cbx,
                  fz_cbx, fz_cby );
 
-#   define LOAD_RMU(V,D) m_f##V##_rmu##D=v4float( m[f##V##0->fmat##D].rmu##D, \
-                                                  m[f##V##1->fmat##D].rmu##D, \
-                                                  m[f##V##2->fmat##D].rmu##D, \
-                                                  m[f##V##3->fmat##D].rmu##D )
+#   define LOAD_RMU(V,D) m_f##V##_rmu##D=v4float( m[MAT(f##V##0).fmat##D].rmu##D, \
+                                                  m[MAT(f##V##1).fmat##D].rmu##D, \
+                                                  m[MAT(f##V##2).fmat##D].rmu##D, \
+                                                  m[MAT(f##V##3).fmat##D].rmu##D )
 
     LOAD_RMU(0,x); LOAD_RMU(0,y); LOAD_RMU(0,z);
                    LOAD_RMU(x,y); LOAD_RMU(x,z);
     LOAD_RMU(y,x);                LOAD_RMU(y,z);
     LOAD_RMU(z,x); LOAD_RMU(z,y);
 
-    load_4x2_tr( &m[f00->ematx].decayx, &m[f01->ematx].decayx,
-                 &m[f02->ematx].decayx, &m[f03->ematx].decayx,
+    load_4x2_tr( &m[MAT(f00).ematx].decayx, &m[MAT(f01).ematx].decayx,
+                 &m[MAT(f02).ematx].decayx, &m[MAT(f03).ematx].decayx,
                  m_f0_decayx, m_f0_drivex );
 
-    load_4x2_tr( &m[f00->ematy].decayy, &m[f01->ematy].decayy,
-                 &m[f02->ematy].decayy, &m[f03->ematy].decayy,
+    load_4x2_tr( &m[MAT(f00).ematy].decayy, &m[MAT(f01).ematy].decayy,
+                 &m[MAT(f02).ematy].decayy, &m[MAT(f03).ematy].decayy,
                  m_f0_decayy, m_f0_drivey );
 
-    load_4x2_tr( &m[f00->ematz].decayz, &m[f01->ematz].decayz,
-                 &m[f02->ematz].decayz, &m[f03->ematz].decayz,
+    load_4x2_tr( &m[MAT(f00).ematz].decayz, &m[MAT(f01).ematz].decayz,
+                 &m[MAT(f02).ematz].decayz, &m[MAT(f03).ematz].decayz,
                  m_f0_decayz, m_f0_drivez );
 
 #   undef LOAD_RMU
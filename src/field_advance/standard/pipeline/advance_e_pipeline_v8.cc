@@ -18,9 +18,7 @@ advance_e_pipeline_v8( pipeline_args_t * args,
 
   int n_voxel;
 
-  DISTRIBUTE_VOXELS( 2,nx, 2,ny, 2,nz, 16,
-                     pipeline_rank, n_pipeline,
-                     x, y, z, n_voxel );
+  DISTRIBUTE_STENCIL( 16, pipeline_rank, n_pipeline, n_voxel );
 
   const v8float vdamp( damp );
   const v8float vpx( px );
@@ -106,36 +104,36 @@ advance_e_pipeline_v8( pipeline_args_t * args,
                  &fz4->cbx, &fz5->cbx, &fz6->cbx, &fz7->cbx,
                  fz_cbx, fz_cby );
 
-#   define LOAD_RMU(V,D) m_f##V##_rmu##D=v8float( m[f##V##0->fmat##D].rmu##D, \
-                                                  m[f##V##1->fmat##D].rmu##D, \
-                                                  m[f##V##2->fmat##D].rmu##D, \
-                                                  m[f##V##3->fmat##D].rmu##D, \
-                                                  m[f##V##4->fmat##D].rmu##D, \
-                                                  m[f##V##5->fmat##D].rmu##D, \
-                                                  m[f##V##6->fmat##D].rmu##D, \
-                                                  m[f##V##7->fmat##D].rmu##D )
+#   define LOAD_RMU(V,D) m_f##V##_rmu##D=v8float( m[MAT(f##V##0).fmat##D].rmu##D, \
+                                                  m[MAT(f##V##1).fmat##D].rmu##D, \
+                                                  m[MAT(f##V##2).fmat##D].rmu##D, \
+                                                  m[MAT(f##V##3).fmat##D].rmu##D, \
+                                                  m[MAT(f##V##4).fmat##D].rmu##D, \
+                                                  m[MAT(f##V##5).fmat##D].rmu##D, \
+                                                  m[MAT(f##V##6).fmat##D].rmu##D, \
+                                                  m[MAT(f##V##7).fmat##D].rmu##D )
 
     LOAD_RMU(0,x); LOAD_RMU(0,y); LOAD_RMU(0,z);
                    LOAD_RMU(x,y); LOAD_RMU(x,z);
     LOAD_RMU(y,x);                LOAD_RMU(y,z);
     LOAD_RMU(z,x); LOAD_RMU(z,y);
 
-    load_8x2_tr( &m[f00->ematx].decayx, &m[f01->ematx].decayx,
-                 &m[f02->ematx].decayx, &m[f03->ematx].decayx,
-                 &m[f04->ematx].decayx, &m[f05->ematx].decayx,
-                 &m[f06->ematx].decayx, &m[f07->ematx].decayx,
+    load_8x2_tr( &m[MAT(f00).ematx].decayx, &m[MAT(f01).ematx].decayx,
+                 &m[MAT(f02).ematx].decayx, &m[MAT(f03).ematx].decayx,
+                 &m[MAT(f04).ematx].decayx, &m[MAT(f05).ematx].decayx,
+                 &m[MAT(f06).ematx].decayx, &m[MAT(f07).ematx].decayx,
                  m_f0_decayx, m_f0_drivex );
 
-    load_8x2_tr( &m[f00->ematy].decayy, &m[f01->ematy].decayy,
-                 &m[f02->ematy].decayy, &m[f03->ematy].decayy,
-                 &m[f04->ematy].decayy, &m[f05->ematy].decayy,
-                 &m[f06->ematy].decayy, &m[f07->ematy].decayy,
+    load_8x2_tr( &m[MAT(f00).ematy].decayy, &m[MAT(f01).ematy].decayy,
+                 &m[MAT(f02).ematy].decayy, &m[MAT(f03).ematy].decayy,
+                 &m[MAT(f04).ematy].decayy, &m[MAT(f05).ematy].decayy,
+                 &m[MAT(f06).ematy].decayy, &m[MAT(f07).ematy].decayy,
                  m_f0_decayy, m_f0_drivey );
 
-    load_8x2_tr( &m[f00->ematz].decayz, &m[f01->ematz].decayz,
-                 &m[f02->ematz].decayz, &m[f03->ematz].decayz,
-                 &m[f04->ematz].decayz, &m[f05->ematz].decayz,
-                 &m[f06->ematz].decayz, &m[f07->ematz].decayz,
+    load_8x2_tr( &m[MAT(f00).ematz].decayz, &m[MAT(f01).ematz].decayz,
+                 &m[MAT(f02).ematz].decayz, &m[MAT(f03).ematz].decayz,
+                 &m[MAT(f04).ematz].decayz, &m[MAT(f05).ematz].decayz,
+                 &m[MAT(f06).ematz].decayz, &m[MAT(f07).ematz].decayz,
                  m_f0_decayz, m_f0_drivez );
 
 #   undef LOAD_RMU
@@ -46,6 +46,7 @@ clean_div_e_pipeline( field_array_t * fa )
   pipeline_args_t args[1];
 
   args->f = fa->f;
+  args->fm = fa->fm;
   args->p = (sfa_params_t *)fa->params;
   args->g = fa->g;
 
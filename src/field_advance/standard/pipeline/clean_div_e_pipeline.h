@@ -9,13 +9,15 @@
 
 typedef struct pipeline_args
 {
-  field_t            * ALIGNED(128) f;
-  const sfa_params_t *              p;
-  const grid_t       *              g;
+  field_t                * ALIGNED(128) f;
+  const field_material_t * ALIGNED(128) fm;
+  const sfa_params_t     *              p;
+  const grid_t           *              g;
 } pipeline_args_t;
 
 #define DECLARE_STENCIL()                                                \
   field_t                      * ALIGNED(128) f = args->f;               \
+  const field_material_t       * ALIGNED(128) fm = args->fm;             \
   const material_coefficient_t * ALIGNED(128) m = args->p->mc;           \
   const grid_t                 *              g = args->g;               \
   const int nx = g->nx, ny = g->ny, nz = g->nz;                          \
@@ -49,11 +51,11 @@ typedef struct pipeline_args
   }
 
 #define MARDER_EX() \
-    f0->ex += m[f0->ematx].drivex*px*(fx->div_e_err-f0->div_e_err)
+    f0->ex += m[MAT(f0).ematx].drivex*px*(fx->div_e_err-f0->div_e_err)
 #define MARDER_EY() \
-    f0->ey += m[f0->ematy].drivey*py*(fy->div_e_err-f0->div_e_err)
+    f0->ey += m[MAT(f0).ematy].drivey*py*(fy->div_e_err-f0->div_e_err)
 #define MARDER_EZ() \
-    f0->ez += m[f0->ematz].drivez*pz*(fz->div_e_err-f0->div_e_err)
+    f0->ez += m[MAT(f0).ematz].drivez*pz*(fz->div_e_err-f0->div_e_err)
 
 static void
 clean_div_e_pipeline_scalar( pipeline_args_t * args,
@@ -9,13 +9,15 @@
 
 typedef struct pipeline_args
 {
-  field_t            * ALIGNED(128) f;
-  const sfa_params_t *              p;
-  const grid_t       *              g;
+  field_t                * ALIGNED(128) f;
+  const field_material_t * ALIGNED(128) fm;
+  const sfa_params_t     *              p;
+  const grid_t           *              g;
 } pipeline_args_t;
 
 #define DECLARE_STENCIL()                                        \
         field_t                * ALIGNED(128) f = args->f;       \
+  const field_material_t       * ALIGNED(128) fm = args->fm;     \
   const material_coefficient_t * ALIGNED(128) m = args->p->mc;   \
   const grid_t                 *              g = args->g;       \
   const int nx = g->nx, ny = g->ny, nz = g->nz;                  \
@@ -46,22 +48,22 @@ typedef struct pipeline_args
   }
 
 #define UPDATE_EX()                                     \
-  f0->tcax = ( py * ( f0->cbz * m[f0->fmatz].rmuz -     \
-		      fy->cbz * m[fy->fmatz].rmuz ) -   \
-               pz * ( f0->cby * m[f0->fmaty].rmuy -     \
-		      fz->cby * m[fz->fmaty].rmuy ) )
+  f0->tcax = ( py * ( f0->cbz * m[MAT(f0).fmatz].rmuz - \
+		      fy->cbz * m[MAT(fy).fmatz].rmuz ) - \
+               pz * ( f0->cby * m[MAT(f0).fmaty].rmuy - \
+		      fz->cby * m[MAT(fz).fmaty].rmuy ) )
 
 #define UPDATE_EY()                                     \
-  f0->tcay = ( pz * ( f0->cbx * m[f0->fmatx].rmux -     \
-		      fz->cbx * m[fz->fmatx].rmux ) -   \
-               px * ( f0->cbz * m[f0->fmatz].rmuz -     \
-		      fx->cbz * m[fx->fmatz].rmuz ) )
+  f0->tcay = ( pz * ( f0->cbx * m[MAT(f0).fmatx].rmux - \
+		      fz->cbx * m[MAT(fz).fmatx].rmux ) - \
+               px * ( f0->cbz * m[MAT(f0).fmatz].rmuz - \
+		      fx->cbz * m[MAT(fx).fmatz].rmuz ) )
 
 #define UPDATE_EZ()                                     \
-  f0->tcaz = ( px * ( f0->cby * m[f0->fmaty].rmuy -     \
-		      fx->cby * m[fx->fmaty].rmuy ) -   \
-               py * ( f0->cbx * m[f0->fmatx].rmux -     \
-		      fy->cbx * m[fy->fmatx].rmux ) )
+  f0->tcaz = ( px * ( f0->cby * m[MAT(f0).fmaty].rmuy - \
+		      fx->cby * m[MAT(fx).fmaty].rmuy ) - \
+               py * ( f0->cbx * m[MAT(f0).fmatx].rmux - \
+		      fy->cbx * m[MAT(fy).fmatx].rmux ) )
 
 void
 compute_curl_b_pipeline_scalar( pipeline_args_t * args,
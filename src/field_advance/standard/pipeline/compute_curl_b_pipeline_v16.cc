@@ -117,22 +117,22 @@ compute_curl_b_pipeline_v16( pipeline_args_t * args,
                   &fz12->cbx, &fz13->cbx, &fz14->cbx, &fz15->cbx,
                   fz_cbx, fz_cby );
 
-#   define LOAD_RMU(V,D) m_f##V##_rmu##D=v16float( m[f##V##00->fmat##D].rmu##D, \
-                                                   m[f##V##01->fmat##D].rmu##D, \
-                                                   m[f##V##02->fmat##D].rmu##D, \
-                                                   m[f##V##03->fmat##D].rmu##D, \
-                                                   m[f##V##04->fmat##D].rmu##D, \
-                                                   m[f##V##05->fmat##D].rmu##D, \
-                                                   m[f##V##06->fmat##D].rmu##D, \
-                                                   m[f##V##07->fmat##D].rmu##D, \
-                                                   m[f##V##08->fmat##D].rmu##D, \
-                                                   m[f##V##09->fmat##D].rmu##D, \
-                                                   m[f##V##10->fmat##D].rmu##D, \
-                                                   m[f##V##11->fmat##D].rmu##D, \
-                                                   m[f##V##12->fmat##D].rmu##D, \
-                                                   m[f##V##13->fmat##D].rmu##D, \
-                                                   m[f##V##14->fmat##D].rmu##D, \
-                                                   m[f##V##15->fmat##D].rmu##D )
+#   define LOAD_RMU(V,D) m_f##V##_rmu##D=v16float( m[MAT(f##V##00).fmat##D].rmu##D, \
+                                                   m[MAT(f##V##01).fmat##D].rmu##D, \
+                                                   m[MAT(f##V##02).fmat##D].rmu##D, \
+                                                   m[MAT(f##V##03).fmat##D].rmu##D, \
+                                                   m[MAT(f##V##04).fmat##D].rmu##D, \
+                                                   m[MAT(f##V##05).fmat##D].rmu##D, \
+                                                   m[MAT(f##V##06).fmat##D].rmu##D, \
+                                                   m[MAT(f##V##07).fmat##D].rmu##D, \
+                                                   m[MAT(f##V##08).fmat##D].rmu##D, \
+                                                   m[MAT(f##V##09).fmat##D].rmu##D, \
+                                                   m[MAT(f##V##10).fmat##D].rmu##D, \
+                                                   m[MAT(f##V##11).fmat##D].rmu##D, \
+                                                   m[MAT(f##V##12).fmat##D].rmu##D, \
+                                                   m[MAT(f##V##13).fmat##D].rmu##D, \
+                                                   m[MAT(f##V##14).fmat##D].rmu##D, \
+                                                   m[MAT(f##V##15).fmat##D].rmu##D )
 
     LOAD_RMU(0,x); LOAD_RMU(0,y); LOAD_RMU(0,z);
                    LOAD_RMU(x,y); LOAD_RMU(x,z);
@@ -78,10 +78,10 @@ compute_curl_b_pipeline_v4( pipeline_args_t * args,
     load_4x2_tr( &fz0->cbx, &fz1->cbx, &fz2->cbx, &fz3->cbx,
 		 fz_cbx, fz_cby );
 
-#   define LOAD_RMU(V,D) m_f##V##_rmu##D=v4float( m[f##V##0->fmat##D].rmu##D, \
-                                                  m[f##V##1->fmat##D].rmu##D, \
-                                                  m[f##V##2->fmat##D].rmu##D, \
-                                                  m[f##V##3->fmat##D].rmu##D )
+#   define LOAD_RMU(V,D) m_f##V##_rmu##D=v4float( m[MAT(f##V##0).fmat##D].rmu##D, \
+                                                  m[MAT(f##V##1).fmat##D].rmu##D, \
+                                                  m[MAT(f##V##2).fmat##D].rmu##D, \
+                                                  m[MAT(f##V##3).fmat##D].rmu##D )
 
     LOAD_RMU(0,x); LOAD_RMU(0,y); LOAD_RMU(0,z);
                    LOAD_RMU(x,y); LOAD_RMU(x,z);
@@ -91,14 +91,14 @@ compute_curl_b_pipeline_v8( pipeline_args_t * args,
 		 &fz4->cbx, &fz5->cbx, &fz6->cbx, &fz7->cbx,
 		 fz_cbx, fz_cby );
 
-#   define LOAD_RMU(V,D) m_f##V##_rmu##D=v8float( m[f##V##0->fmat##D].rmu##D, \
-                                                  m[f##V##1->fmat##D].rmu##D, \
-                                                  m[f##V##2->fmat##D].rmu##D, \
-                                                  m[f##V##3->fmat##D].rmu##D, \
-                                                  m[f##V##4->fmat##D].rmu##D, \
-                                                  m[f##V##5->fmat##D].rmu##D, \
-                                                  m[f##V##6->fmat##D].rmu##D, \
-                                                  m[f##V##7->fmat##D].rmu##D )
+#   define LOAD_RMU(V,D) m_f##V##_rmu##D=v8float( m[MAT(f##V##0).fmat##D].rmu##D, \
+                                                  m[MAT(f##V##1).fmat##D].rmu##D, \
+                                                  m[MAT(f##V##2).fmat##D].rmu##D, \
+                                                  m[MAT(f##V##3).fmat##D].rmu##D, \
+                                                  m[MAT(f##V##4).fmat##D].rmu##D, \
+                                                  m[MAT(f##V##5).fmat##D].rmu##D, \
+                                                  m[MAT(f##V##6).fmat##D].rmu##D, \
+                                                  m[MAT(f##V##7).fmat##D].rmu##D )
 
     LOAD_RMU(0,x); LOAD_RMU(0,y); LOAD_RMU(0,z);
                    LOAD_RMU(x,y); LOAD_RMU(x,z);
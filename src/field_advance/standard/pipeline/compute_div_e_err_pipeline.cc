@@ -57,6 +57,7 @@ compute_div_e_err_pipeline( field_array_t * RESTRICT fa )
   pipeline_args_t args[1];
 
   args->f = fa->f;
+  args->fm = fa->fm;
   args->p = (sfa_params_t *) fa->params;
   args->g = fa->g;
 
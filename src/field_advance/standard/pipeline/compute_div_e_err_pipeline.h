@@ -9,13 +9,15 @@
 
 typedef struct pipeline_args
 {
-  /**/  field_t      * ALIGNED(128) f;
-  const sfa_params_t *              p;
-  const grid_t       *              g;
+  /**/  field_t          * ALIGNED(128) f;
+  const field_material_t * ALIGNED(128) fm;
+  const sfa_params_t     *              p;
+  const grid_t           *              g;
 } pipeline_args_t;
 
 #define DECLARE_STENCIL()                                       \
   /**/  field_t                * ALIGNED(128) f = args->f;      \
+  const field_material_t       * ALIGNED(128) fm = args->fm;    \
   const material_coefficient_t * ALIGNED(128) m = args->p->mc;  \
   const grid_t                 *              g = args->g;      \
   const int nx = g->nx, ny = g->ny, nz = g->nz;                 \
@@ -45,10 +47,10 @@ typedef struct pipeline_args
     INIT_STENCIL();                   \
   }
 
-#define UPDATE_DERR_E() f0->div_e_err = m[f0->nmat].nonconductive * \
-  ( px*( m[f0->ematx].epsx*f0->ex - m[fx->ematx].epsx*fx->ex ) +    \
-    py*( m[f0->ematy].epsy*f0->ey - m[fy->ematy].epsy*fy->ey ) +    \
-    pz*( m[f0->ematz].epsz*f0->ez - m[fz->ematz].epsz*fz->ez ) -    \
+#define UPDATE_DERR_E() f0->div_e_err = m[MAT(f0).nmat].nonconductive * \
+  ( px*( m[MAT(f0).ematx].epsx*f0->ex - m[MAT(fx).ematx].epsx*fx->ex ) + \
+    py*( m[MAT(f0).ematy].epsy*f0->ey - m[MAT(fy).ematy].epsy*fy->ey ) + \
+    pz*( m[MAT(f0).ematz].epsz*f0->ez - m[MAT(fz).ematz].epsz*fz->ez ) - \
     cj*( f0->rhof + f0->rhob ) )
 
 void
@@ -58,6 +58,7 @@ energy_f_pipeline( double * global,
   pipeline_args_t args[1];
 
   args->f = fa->f;
+  args->fm = fa->fm;
   args->p = (sfa_params_t *) fa->params;
   args->g = fa->g;
 
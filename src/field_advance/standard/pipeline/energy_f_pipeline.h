@@ -9,14 +9,16 @@
 
 typedef struct pipeline_args
 {
-  const field_t      * ALIGNED(128) f;
-  const sfa_params_t *              p;
-  const grid_t       *              g;
+  const field_t          * ALIGNED(128) f;
+  const field_material_t * ALIGNED(128) fm;
+  const sfa_params_t     *              p;
+  const grid_t           *              g;
   double en[ MAX_PIPELINE + 1 ][ 6 ];
 } pipeline_args_t;
 
 #define DECLARE_STENCIL()                                                  \
   const field_t                * ALIGNED(128) f = args->f;                 \
+  const field_material_t       * ALIGNED(128) fm = args->fm;               \
   const material_coefficient_t * ALIGNED(128) m = args->p->mc;             \
   const grid_t                 *              g = args->g;                 \
   const int nx = g->nx, ny = g->ny, nz = g->nz;                            \
@@ -47,24 +49,24 @@ typedef struct pipeline_args
   }
 
 #define REDUCE_EN()                                       \
-  en_ex += 0.25*( m[ f0->ematx].epsx* f0->ex * f0->ex +   \
-                  m[ fy->ematx].epsx* fy->ex * fy->ex +   \
-                  m[ fz->ematx].epsx* fz->ex * fz->ex +   \
-                  m[fyz->ematx].epsx*fyz->ex *fyz->ex );  \
-  en_ey += 0.25*( m[ f0->ematy].epsy* f0->ey * f0->ey +   \
-                  m[ fz->ematy].epsy* fz->ey * fz->ey +   \
-                  m[ fx->ematy].epsy* fx->ey * fx->ey +   \
-                  m[fzx->ematy].epsy*fzx->ey *fzx->ey );  \
-  en_ez += 0.25*( m[ f0->ematz].epsz* f0->ez * f0->ez +   \
-                  m[ fx->ematz].epsz* fx->ez * fx->ez +   \
-                  m[ fy->ematz].epsz* fy->ez * fy->ez +   \
-                  m[fxy->ematz].epsz*fxy->ez *fxy->ez );  \
-  en_bx += 0.5 *( m[ f0->fmatx].rmux* f0->cbx* f0->cbx +  \
-                  m[ fx->fmatx].rmux* fx->cbx* fx->cbx ); \
-  en_by += 0.5 *( m[ f0->fmaty].rmuy* f0->cby* f0->cby +  \
-                  m[ fy->fmaty].rmuy* fy->cby* fy->cby ); \
-  en_bz += 0.5 *( m[ f0->fmatz].rmuz* f0->cbz* f0->cbz +  \
-                  m[ fz->fmatz].rmuz* fz->cbz* fz->cbz )
+  en_ex += 0.25*( m[ MAT(f0).ematx].epsx* f0->ex * f0->ex + \
+                  m[ MAT(fy).ematx].epsx* fy->ex * fy->ex + \
+                  m[ MAT(fz).ematx].epsx* fz->ex * fz->ex + \
+                  m[MAT(fyz).ematx].epsx*fyz->ex *fyz->ex ); \
+  en_ey += 0.25*( m[ MAT(f0).ematy].epsy* f0->ey * f0->ey + \
+                  m[ MAT(fz).ematy].epsy* fz->ey * fz->ey + \
+                  m[ MAT(fx).ematy].epsy* fx->ey * fx->ey + \
+                  m[MAT(fzx).ematy].epsy*fzx->ey *fzx->ey ); \
+  en_ez += 0.25*( m[ MAT(f0).ematz].epsz* f0->ez * f0->ez + \
+                  m[ MAT(fx).ematz].epsz* fx->ez * fx->ez + \
+                  m[ MAT(fy).ematz].epsz* fy->ez * fy->ez + \
+                  m[MAT(fxy).ematz].epsz*fxy->ez *fxy->ez ); \
+  en_bx += 0.5 *( m[ MAT(f0).fmatx].rmux* f0->cbx* f0->cbx + \
+                  m[ MAT(fx).fmatx].rmux* fx->cbx* fx->cbx ); \
+  en_by += 0.5 *( m[ MAT(f0).fmaty].rmuy* f0->cby* f0->cby + \
+                  m[ MAT(fy).fmaty].rmuy* fy->cby* fy->cby ); \
+  en_bz += 0.5 *( m[ MAT(f0).fmatz].rmuz* f0->cbz* f0->cbz + \
+                  m[ MAT(fz).fmatz].rmuz* fz->cbz* fz->cbz )
 
 void
 energy_f_pipeline_scalar( pipeline_args_t * args,
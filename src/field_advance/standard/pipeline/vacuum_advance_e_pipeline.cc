@@ -25,9 +25,7 @@ vacuum_advance_e_pipeline_scalar( pipeline_args_t * args,
 
   int n_voxel;
 
-  DISTRIBUTE_VOXELS( 2,nx, 2,ny, 2,nz, 16,
-                     pipeline_rank, n_pipeline,
-                     x, y, z, n_voxel );
+  DISTRIBUTE_STENCIL( 16, pipeline_rank, n_pipeline, n_voxel );
 
   INIT_STENCIL();
 
@@ -42,113 +40,27 @@ vacuum_advance_e_pipeline_scalar( pipeline_args_t * args,
 }
 
 //----------------------------------------------------------------------------//
-// Top level function to select and call the proper vacuum_advance_e pipeline
-// function.
+// Update the exterior tangential E.  These are not done by the vacuum_advance_e
+// pipelines and need the tangential B ghosts.
 //----------------------------------------------------------------------------//
 
 void
-vacuum_advance_e_pipeline( field_array_t * RESTRICT fa,
-                           float frac )
+vacuum_advance_e_exterior( field_array_t * RESTRICT fa )
 {
-  if ( !fa )
-  {
-    ERROR( ( "Bad args" ) );
-  }
-
-  if ( frac != 1 )
-  {
-    ERROR( ( "standard advance_e does not support frac != 1 yet" ) );
-  }
-
-  //--------------------------------------------------------------------------//
-  // Begin tangential B ghost setup
-  //--------------------------------------------------------------------------//
-
-  begin_remote_ghost_tang_b( fa->f, fa->g );
-
-  local_ghost_tang_b( fa->f, fa->g );
-
-  //--------------------------------------------------------------------------//
-  // Update interior fields
-  //--------------------------------------------------------------------------//
-  // Note: ex all (1:nx,  1:ny+1,1,nz+1) interior (1:nx,2:ny,2:nz)
-  // Note: ey all (1:nx+1,1:ny,  1:nz+1) interior (2:nx,1:ny,2:nz)
-  // Note: ez all (1:nx+1,1:ny+1,1:nz  ) interior (1:nx,1:ny,2:nz)
-  //--------------------------------------------------------------------------//
+  sfa_tile_t interior[1];
 
-  // Do majority of interior in a single pass.  The host handles stragglers.
+  interior_sfa_tile( interior, fa->g, 0 );
 
   pipeline_args_t args[1];
 
-  args->f = fa->f;
-  args->p = (sfa_params_t *) fa->params;
-  args->g = fa->g;
-
-  EXEC_PIPELINES( vacuum_advance_e, args, 0 );
-
-  // While the pipelines are busy, do non-bulk interior fields
+  args->f      = fa->f;
+  args->p      = (sfa_params_t *) fa->params;
+  args->g      = fa->g;
+  args->tile   = interior;
+  args->n_tile = 1;
 
   DECLARE_STENCIL();
 
-  // Do left over interior ex
-  for( z = 2; z <= nz; z++ )
-  {
-    for( y = 2; y <= ny; y++ )
-    {
-      f0 = &f( 1, y,   z   );
-      fy = &f( 1, y-1, z   );
-      fz = &f( 1, y,   z-1 );
-
-      UPDATE_EX();
-    }
-  }
-
-  // Do left over interior ey
-  for( z = 2; z <= nz; z++ )
-  {
-    f0 = &f( 2, 1, z   );
-    fx = &f( 1, 1, z   );
-    fz = &f( 2, 1, z-1 );
-
-    for( x = 2; x <= nx; x++ )
-    {
-      UPDATE_EY();
-
-      f0++;
-      fx++;
-      fz++;
-    }
-  }
-
-  // Do left over interior ez
-  for( y = 2; y <= ny; y++ )
-  {
-    f0 = &f( 2, y,   1 );
-    fx = &f( 1, y,   1 );
-    fy = &f( 2, y-1, 1 );
-
-    for( x = 2; x <= nx; x++ )
-    {
-      UPDATE_EZ();
-
-      f0++;
-      fx++;
-      fy++;
-    }
-  }
-
-  WAIT_PIPELINES();
-
-  //--------------------------------------------------------------------------//
-  // Finish tangential B ghost setup
-  //--------------------------------------------------------------------------//
-
-  end_remote_ghost_tang_b( fa->f, fa->g );
-
-  //--------------------------------------------------------------------------//
-  // Update exterior fields
-  //--------------------------------------------------------------------------//
-
   // Do exterior ex
   for( y = 1; y <= ny+1; y++ )
   {
@@ -327,6 +239,147 @@ vacuum_advance_e_pipeline( field_array_t * RESTRICT fa,
       UPDATE_EZ();
     }
   }
+}
+
+//----------------------------------------------------------------------------//
+// Update the interior E of a list of tiles of the same uniform material.
+// This is used by advance_e for the uniform parts of a domain with several
+// materials.
+//----------------------------------------------------------------------------//
+
+void
+vacuum_advance_e_tiles( field_array_t * RESTRICT fa,
+                        const sfa_tile_t * tile,
+                        int n_tile )
+{
+  pipeline_args_t args[1];
+
+  args->f      = fa->f;
+  args->p      = (sfa_params_t *) fa->params;
+  args->g      = fa->g;
+  args->tile   = tile;
+  args->n_tile = n_tile;
+
+  EXEC_PIPELINES( vacuum_advance_e, args, 0 );
+
+  WAIT_PIPELINES();
+}
+
+//----------------------------------------------------------------------------//
+// Top level function to select and call the proper vacuum_advance_e pipeline
+// function.
+//----------------------------------------------------------------------------//
+
+void
+vacuum_advance_e_pipeline( field_array_t * RESTRICT fa,
+                           float frac )
+{
+  if ( !fa )
+  {
+    ERROR( ( "Bad args" ) );
+  }
+
+  if ( frac != 1 )
+  {
+    ERROR( ( "standard advance_e does not support frac != 1 yet" ) );
+  }
+
+  //--------------------------------------------------------------------------//
+  // Begin tangential B ghost setup
+  //--------------------------------------------------------------------------//
+
+  begin_remote_ghost_tang_b( fa->f, fa->g );
+
+  local_ghost_tang_b( fa->f, fa->g );
+
+  //--------------------------------------------------------------------------//
+  // Update interior fields
+  //--------------------------------------------------------------------------//
+  // Note: ex all (1:nx,  1:ny+1,1,nz+1) interior (1:nx,2:ny,2:nz)
+  // Note: ey all (1:nx+1,1:ny,  1:nz+1) interior (2:nx,1:ny,2:nz)
+  // Note: ez all (1:nx+1,1:ny+1,1:nz  ) interior (1:nx,1:ny,2:nz)
+  //--------------------------------------------------------------------------//
+
+  // Do majority of interior in a single pass.  The host handles stragglers.
+
+  sfa_tile_t interior[1];
+
+  interior_sfa_tile( interior, fa->g, 0 );
+
+  pipeline_args_t args[1];
+
+  args->f      = fa->f;
+  args->p      = (sfa_params_t *) fa->params;
+  args->g      = fa->g;
+  args->tile   = interior;
+  args->n_tile = 1;
+
+  EXEC_PIPELINES( vacuum_advance_e, args, 0 );
+
+  // While the pipelines are busy, do non-bulk interior fields
+
+  DECLARE_STENCIL();
+
+  // Do left over interior ex
+  for( z = 2; z <= nz; z++ )
+  {
+    for( y = 2; y <= ny; y++ )
+    {
+      f0 = &f( 1, y,   z   );
+      fy = &f( 1, y-1, z   );
+      fz = &f( 1, y,   z-1 );
+
+      UPDATE_EX();
+    }
+  }
+
+  // Do left over interior ey
+  for( z = 2; z <= nz; z++ )
+  {
+    f0 = &f( 2, 1, z   );
+    fx = &f( 1, 1, z   );
+    fz = &f( 2, 1, z-1 );
+
+    for( x = 2; x <= nx; x++ )
+    {
+      UPDATE_EY();
+
+      f0++;
+      fx++;
+      fz++;
+    }
+  }
+
+  // Do left over interior ez
+  for( y = 2; y <= ny; y++ )
+  {
+    f0 = &f( 2, y,   1 );
+    fx = &f( 1, y,   1 );
+    fy = &f( 2, y-1, 1 );
+
+    for( x = 2; x <= nx; x++ )
+    {
+      UPDATE_EZ();
+
+      f0++;
+      fx++;
+      fy++;
+    }
+  }
+
+  WAIT_PIPELINES();
+
+  //--------------------------------------------------------------------------//
+  // Finish tangential B ghost setup
+  //--------------------------------------------------------------------------//
+
+  end_remote_ghost_tang_b( fa->f, fa->g );
+
+  //--------------------------------------------------------------------------//
+  // Update exterior fields
+  //--------------------------------------------------------------------------//
+
+  vacuum_advance_e_exterior( fa );
 
   local_adjust_tang_e( fa->f, fa->g );
 }
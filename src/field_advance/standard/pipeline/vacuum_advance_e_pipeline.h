@@ -12,11 +12,14 @@ typedef struct pipeline_args
         field_t      * ALIGNED(128) f;
   const sfa_params_t *              p;
   const grid_t       *              g;
+  const sfa_tile_t   *              tile;   // Tiles to update, all of
+  int                               n_tile; // material tile->mat
 } pipeline_args_t;
 
 #define DECLARE_STENCIL()                                                    \
         field_t                * ALIGNED(128) f = args->f;                   \
-  const material_coefficient_t * ALIGNED(128) m = args->p->mc;               \
+  const material_coefficient_t * ALIGNED(128) m = args->p->mc +              \
+                                                  args->tile->mat;           \
   const grid_t                 *              g = args->g;                   \
   const int nx = g->nx, ny = g->ny, nz = g->nz;                              \
                                                                              \
@@ -32,6 +35,9 @@ typedef struct pipeline_args
   const float pz_mux = ((nz>1) ? (1+damp)*g->cvac*g->dt*g->rdz : 0)*m->rmux; \
   const float cj     = g->dt/g->eps0;                                        \
                                                                              \
+  const sfa_tile_t * tile = args->tile;                                      \
+  int n_tile = args->n_tile, ty0, ty1, tz1;                                  \
+                                                                             \
   field_t * ALIGNED(16) f0;                                                  \
   field_t * ALIGNED(16) fx, * ALIGNED(16) fy, * ALIGNED(16) fz;              \
   int x, y, z
@@ -44,13 +50,28 @@ typedef struct pipeline_args
   fy = &f( x,   y-1, z   );   \
   fz = &f( x,   y,   z-1 )
 
-#define NEXT_STENCIL()                        \
-  f0++; fx++; fy++; fz++; x++;                \
-  if ( x > nx )                               \
-  {                                           \
-                  y++;               x = 2;   \
-    if ( y > ny ) z++; if ( y > ny ) y = 2;   \
-    INIT_STENCIL();                           \
+// The voxels of the tiles are visited one tile after the other.
+
+#define DISTRIBUTE_STENCIL( b, pipeline_rank, n_pipeline, n_voxel ) \
+  n_voxel = distribute_sfa_tiles( &tile, &n_tile, nx, b,            \
+                                  pipeline_rank, n_pipeline,        \
+                                  &x, &y, &z );                     \
+  ty0 = tile->y0; ty1 = tile->y1; tz1 = tile->z1
+
+#define NEXT_STENCIL()                           \
+  f0++; fx++; fy++; fz++; x++;                   \
+  if ( x > nx )                                  \
+  {                                              \
+                   y++;                x = 2;    \
+    if ( y > ty1 ) z++; if ( y > ty1 ) y = ty0;  \
+    if ( z > tz1 && n_tile > 1 )                 \
+    {                                            \
+      tile++; n_tile--;                          \
+      ty0 = tile->y0; ty1 = tile->y1;            \
+      tz1 = tile->z1;                            \
+      y   = ty0;      z   = tile->z0;            \
+    }                                            \
+    INIT_STENCIL();                              \
   }
 
 #define UPDATE_EX()                                                 \
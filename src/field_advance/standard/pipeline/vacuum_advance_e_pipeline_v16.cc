@@ -18,9 +18,7 @@ vacuum_advance_e_pipeline_v16( pipeline_args_t * args,
 
   int n_voxel;
 
-  DISTRIBUTE_VOXELS( 2,nx, 2,ny, 2,nz, 16,
-                     pipeline_rank, n_pipeline,
-                     x, y, z, n_voxel );
+  DISTRIBUTE_STENCIL( 16, pipeline_rank, n_pipeline, n_voxel );
 
   const v16float vdecayx( decayx ), vdrivex( drivex );
   const v16float vdecayy( decayy ), vdrivey( drivey );
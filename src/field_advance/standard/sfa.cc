@@ -12,6 +12,7 @@ static field_advance_kernels_t sfa_kernels = {
 
   advance_b,
   advance_e,
+  advance_b_e_b,
 
   // Diagnostic interfaces
 
@@ -104,6 +105,8 @@ create_sfa_params( grid_t * g,
   MALLOC_ALIGNED( p->mc, n_mc+2, 128 );
   p->n_mc = n_mc;
   p->damp = damp;
+  p->tile = NULL;
+  p->n_tile = 0;
 
   // Fill up the material coefficient array
   // FIXME: THIS IMPLICITLY ASSUMES MATERIALS ARE NUMBERED CONSECUTIVELY FROM
@@ -152,17 +155,161 @@ create_sfa_params( grid_t * g,
 
 void
 destroy_sfa_params( sfa_params_t * p ) {
+  FREE( p->tile );
   FREE_ALIGNED( p->mc );
   FREE( p );
 }
 
 /*****************************************************************************/
 
+void
+interior_sfa_tile( sfa_tile_t * t,
+                   const grid_t * g,
+                   int mat ) {
+  t->y0 = 2, t->y1 = g->ny;
+  t->z0 = 2, t->z1 = g->nz;
+  t->n_voxel = (g->nx-1)*(g->ny-1)*(g->nz-1);
+  t->mat = mat;
+}
+
+// Returns the material id if every material id read by the advance_e
+// stencil in the tile is the same and -1 otherwise.
+
+static int
+uniform_sfa_tile( const sfa_tile_t * t,
+                  const field_material_t * ALIGNED(128) f,
+                  const grid_t * g ) {
+  const int nx = g->nx, ny = g->ny, nz = g->nz;
+  const field_material_t *f0, *fx, *fy, *fz;
+  int x, y, z;
+  material_id m = f[ VOXEL(2,t->y0,t->z0, nx,ny,nz) ].ematx;
+  for( z=t->z0; z<=t->z1; z++ )
+    for( y=t->y0; y<=t->y1; y++ ) {
+      f0 = f + VOXEL(2,y,  z,   nx,ny,nz);
+      fx = f + VOXEL(1,y,  z,   nx,ny,nz);
+      fy = f + VOXEL(2,y-1,z,   nx,ny,nz);
+      fz = f + VOXEL(2,y,  z-1, nx,ny,nz);
+      for( x=2; x<=nx; x++ ) {
+        if( f0->ematx!=m || f0->ematy!=m || f0->ematz!=m ||
+            f0->fmatx!=m || f0->fmaty!=m || f0->fmatz!=m ||
+            fx->fmaty!=m || fx->fmatz!=m ||
+            fy->fmatx!=m || fy->fmatz!=m ||
+            fz->fmatx!=m || fz->fmaty!=m ) return -1;
+        f0++, fx++, fy++, fz++;
+      }
+    }
+  return m;
+}
+
+// Order tiles by material (mixed first) and then by position
+
+static int
+compare_sfa_tile( const void * _a,
+                  const void * _b ) {
+  const sfa_tile_t * a = (const sfa_tile_t *)_a;
+  const sfa_tile_t * b = (const sfa_tile_t *)_b;
+  if( a->mat!=b->mat ) return a->mat<b->mat ? -1 : 1;
+  if( a->z0 !=b->z0  ) return a->z0 <b->z0  ? -1 : 1;
+  if( a->y0 !=b->y0  ) return a->y0 <b->y0  ? -1 : 1;
+  return 0;
+}
+
+void
+classify_sfa_tiles( sfa_params_t * RESTRICT p,
+                    const field_material_t * RESTRICT ALIGNED(128) f,
+                    const grid_t * g ) {
+  const int nx = g->nx, ny = g->ny, nz = g->nz;
+  const int nty = (ny-1+SFA_TILE_LINES-1)/SFA_TILE_LINES;
+  const int ntz = (nz-1+SFA_TILE_LINES-1)/SFA_TILE_LINES;
+  sfa_tile_t * t;
+  int n;
+
+  if( !p || !f || !g ) ERROR(( "Bad args" ));
+
+  FREE( p->tile );
+
+  // Degenerate interiors are done as one (empty) mixed tile
+
+  if( nx<2 || nty<1 || ntz<1 ) {
+    MALLOC( p->tile, 1 );
+    interior_sfa_tile( p->tile, g, -1 );
+    p->n_tile = 1;
+    return;
+  }
+
+  MALLOC( p->tile, nty*ntz );
+  t = p->tile;
+  for( int tz=0; tz<ntz; tz++ )
+    for( int ty=0; ty<nty; ty++ ) {
+      t->y0 = 2 + ty*SFA_TILE_LINES, t->y1 = t->y0 + SFA_TILE_LINES - 1;
+      t->z0 = 2 + tz*SFA_TILE_LINES, t->z1 = t->z0 + SFA_TILE_LINES - 1;
+      if( t->y1>ny ) t->y1 = ny;
+      if( t->z1>nz ) t->z1 = nz;
+      t->n_voxel = (nx-1)*(t->y1-t->y0+1)*(t->z1-t->z0+1);
+      t->mat = uniform_sfa_tile( t, f, g );
+      t++;
+    }
+  n = nty*ntz;
+
+  qsort( p->tile, n, sizeof(sfa_tile_t), compare_sfa_tile );
+
+  // If all the tiles are alike, there is no point in tiling.
+
+  if( p->tile[0].mat==p->tile[n-1].mat ) {
+    interior_sfa_tile( p->tile, g, p->tile[0].mat );
+    n = 1;
+  }
+
+  p->n_tile = n;
+}
+
+int
+distribute_sfa_tiles( const sfa_tile_t ** tile,
+                      int * n_tile,
+                      int nx,
+                      int b,
+                      int pipeline_rank,
+                      int n_pipeline,
+                      int * x,
+                      int * y,
+                      int * z ) {
+  const sfa_tile_t * t = *tile;
+  int N = 0, n, i, nl, ny;
+
+  for( n=0; n<*n_tile; n++ ) N += t[n].n_voxel;
+
+  // Same as DISTRIBUTE_VOXELS
+
+  double _t = (double)( N/b ) / (double)n_pipeline;
+  i = b*(int)( _t*(double)pipeline_rank + 0.5 );
+  n = pipeline_rank<n_pipeline ? b*(int)( _t*(double)(pipeline_rank+1) + 0.5 )
+                               : N;
+  n -= i;
+
+  // Find the tile holding voxel i
+
+  while( *n_tile>1 && i>=t->n_voxel ) i -= t->n_voxel, t++, (*n_tile)--;
+  *tile = t;
+
+  nl = nx-1, ny = t->y1-t->y0+1;
+  *x = 2, *y = t->y0, *z = t->z0;
+  if( nl>0 && ny>0 ) {
+    *x += i%nl; i /= nl;
+    *y += i%ny; i /= ny;
+    *z += i;
+  }
+
+  return n;
+}
+
+/*****************************************************************************/
+
 void
 checkpt_standard_field_array( const field_array_t * fa ) {
   sfa_params_t * p = (sfa_params_t *)fa->params; 
   CHECKPT( fa, 1 );
   CHECKPT_ALIGNED( fa->f, fa->g->nv, 128 );
+  CHECKPT_ALIGNED( fa->fm, fa->g->nv, 128 );
   CHECKPT_PTR( fa->g );
   CHECKPT( p, 1 );
   CHECKPT_ALIGNED( p->mc, p->n_mc, 128 );
@@ -179,9 +326,12 @@ restore_standard_field_array( void ) {
   sfa_params_t * p;
   RESTORE( fa );
   RESTORE_ALIGNED( fa->f );
+  RESTORE_ALIGNED( fa->fm );
   RESTORE_PTR( fa->g );
   RESTORE( p );
   RESTORE_ALIGNED( p->mc );
+  p->tile = NULL; // Reclassified on the next advance_e
+  p->n_tile = 0;
   fa->params = p;
   restore_field_advance_kernels( fa->kernel );
   return fa;
@@ -196,6 +346,8 @@ new_standard_field_array( grid_t           * RESTRICT g,
   MALLOC( fa, 1 );
   MALLOC_ALIGNED( fa->f, g->nv, 128 );
   CLEAR( fa->f, g->nv );
+  MALLOC_ALIGNED( fa->fm, g->nv, 128 );
+  CLEAR( fa->fm, g->nv );
   fa->g = g;
   fa->params = create_sfa_params( g, m_list, damp );
   fa->kernel[0] = sfa_kernels;
@@ -203,6 +355,7 @@ new_standard_field_array( grid_t           * RESTRICT g,
     /* If there is only one material, then this material permeates all
        space and we can use high performance versions of some kernels. */
     fa->kernel->advance_e         = vacuum_advance_e;
+    fa->kernel->advance_b_e_b     = vacuum_advance_b_e_b;
     fa->kernel->energy_f          = vacuum_energy_f;
     fa->kernel->compute_rhob      = vacuum_compute_rhob;
     fa->kernel->compute_curl_b    = vacuum_compute_curl_b;
@@ -220,10 +373,18 @@ delete_standard_field_array( field_array_t * fa ) {
   if( !fa ) return;
   UNREGISTER_OBJECT( fa );
   destroy_sfa_params( (sfa_params_t *)fa->params );
+  FREE_ALIGNED( fa->fm );
   FREE_ALIGNED( fa->f );
   FREE( fa );
 }
 
+float
+standard_field_array_damp( const field_array_t * fa ) {
+  if( !fa ) ERROR(( "Bad args" ));
+  if( fa->kernel->delete_fa!=delete_standard_field_array ) return -1;
+  return ( (const sfa_params_t *)fa->params )->damp;
+}
+
 /*****************************************************************************/
 
 #define f(x,y,z) f[ VOXEL( x, y, z, nx, ny, nz ) ]
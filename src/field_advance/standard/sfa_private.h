@@ -22,11 +22,34 @@ typedef struct material_coefficient
   float pad[3];                 // For 64-byte alignment and future expansion
 } material_coefficient_t;
 
+// The material ids of the voxel the field_t pointer fp (into the field array
+// f) points to.  The kernels that need the material ids have fm, the
+// material id array of f, in scope.
+
+#define MAT(fp) fm[ (fp) - f ]
+
+// The interior voxels (2:nx,2:ny,2:nz) the advance_e pipelines update are
+// split into tiles of whole x-lines.  Where every material id the advance_e
+// stencil reads in a tile is the same, the tile can use the vacuum_advance_e
+// pipelines with that material's coefficients.
+
+#define SFA_TILE_LINES 4 // Max number of y-lines and z-lines in a tile
+
+typedef struct sfa_tile
+{
+  int y0, y1, z0, z1;           // Tile covers (2:nx,y0:y1,z0:z1)
+  int n_voxel;                  // Number of voxels in the tile
+  int mat;                      // Uniform material id or -1 if mixed
+} sfa_tile_t;
+
 typedef struct sfa_params
 {
   material_coefficient_t * mc;
   int n_mc;
   float damp;
+  sfa_tile_t * tile;            // Tiles with mixed tiles first, then the
+  int n_tile;                   // uniform tiles by material (NULL until
+                                // the first advance_e)
 } sfa_params_t;
 
 BEGIN_C_DECLS
@@ -36,6 +59,37 @@ BEGIN_C_DECLS
 void
 delete_standard_field_array( field_array_t * RESTRICT fa );
 
+// classify_sfa_tiles splits the interior into tiles and finds which are
+// uniform.  Material ids are assumed not to change after the first
+// advance_e.  If all tiles are alike, a single tile covering the whole
+// interior is made.
+
+void
+classify_sfa_tiles( sfa_params_t * RESTRICT p,
+                    const field_material_t * RESTRICT ALIGNED(128) fm,
+                    const grid_t * g );
+
+void
+interior_sfa_tile( sfa_tile_t * t,
+                   const grid_t * g,
+                   int mat );
+
+// distribute_sfa_tiles is DISTRIBUTE_VOXELS for the voxels of a list of
+// tiles taken one after the other.  It advances tile and n_tile to the tile
+// holding the first voxel of the pipeline and returns the number of voxels
+// to process.
+
+int
+distribute_sfa_tiles( const sfa_tile_t ** tile,
+                      int * n_tile,
+                      int nx,
+                      int b,
+                      int pipeline_rank,
+                      int n_pipeline,
+                      int * x,
+                      int * y,
+                      int * z );
+
 void
 clear_jf( field_array_t * RESTRICT fa );
 
@@ -55,6 +109,10 @@ void
 advance_b_pipeline( field_array_t * RESTRICT fa,
                     float _frac );
 
+void
+advance_b_exterior( field_array_t * RESTRICT fa,
+                    float _frac );
+
 // In advance_e.c
 
 // advance_e applies the following difference equations to the fields
@@ -82,6 +140,9 @@ void
 advance_e_pipeline( field_array_t * RESTRICT fa,
                     float frac );
 
+void
+advance_e_exterior( field_array_t * RESTRICT fa );
+
 void
 vacuum_advance_e( field_array_t * RESTRICT fa,
                   float frac );
@@ -90,6 +151,34 @@ void
 vacuum_advance_e_pipeline( field_array_t * RESTRICT fa,
                            float frac );
 
+void
+vacuum_advance_e_exterior( field_array_t * RESTRICT fa );
+
+void
+vacuum_advance_e_tiles( field_array_t * RESTRICT fa,
+                        const sfa_tile_t * tile,
+                        int n_tile );
+
+// In advance_b_e_b.c
+
+// advance_b_e_b does advance_b( fa, 0.5 ), advance_e( fa, 1 ) and
+// advance_b( fa, 0.5 ) in one sweep through the interior voxels.  The
+// second half advance of B in a voxel is done as soon as the E it
+// depends on is known, while the voxel is still in cache.  The results
+// are identical to the three separate calls with the scalar pipelines.
+//
+// vacuum_advance_b_e_b is the high performance version for uniform regions
+
+void
+advance_b_e_b( field_array_t * RESTRICT fa );
+
+void
+advance_b_e_b_pipeline( field_array_t * RESTRICT fa,
+                        int vacuum );
+
+void
+vacuum_advance_b_e_b( field_array_t * RESTRICT fa );
+
 // In energy_f.c
 
 // This computes 6 components of field energy of the system.  The
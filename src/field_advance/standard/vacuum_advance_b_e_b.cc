@@ -0,0 +1,20 @@
+#define IN_sfa
+
+#include "sfa_private.h"
+
+//----------------------------------------------------------------------------//
+// Top level function to select and call the proper vacuum_advance_b_e_b
+// function.
+//----------------------------------------------------------------------------//
+
+void
+vacuum_advance_b_e_b( field_array_t * RESTRICT fa )
+{
+  if ( !fa )
+  {
+    ERROR( ( "Bad args" ) );
+  }
+
+  // Conditionally execute this when more abstractions are available.
+  advance_b_e_b_pipeline( fa, 1 );
+}
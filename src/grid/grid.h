@@ -70,6 +70,23 @@ enum grid_enums {
 
 };
 
+// Partition functions a grid can be made by (see g->partition).
+
+enum partition_enums {
+  no_partition        = 0,
+  periodic_partition  = 1, // partition_periodic_box
+  absorbing_partition = 2, // partition_absorbing_box
+  metal_partition     = 3  // partition_metal_box
+};
+
+// Orders in which the particle sort can lay out voxels (see g->sfc).
+
+enum sfc_enums {
+  fortran_order = 0, // x fastest, then y, then z (the mesh array order)
+  morton_order  = 1, // Z-order curve
+  hilbert_order = 2  // Hilbert curve
+};
+
 typedef struct grid {
 
   // System of units
@@ -102,6 +119,33 @@ typedef struct grid {
   int gpx, gpy, gpz = -1; // Store global processor decomposition to let us figure
                      // out where we are in the global decomposition
 
+  // Global box the partition_*_box functions split (see repartition_box).
+  double gx0, gy0, gz0;     // Min corner of the global box
+  double gx1, gy1, gz1;     // Max corner of the global box
+  int   gnx, gny, gnz;      // Global voxel mesh resolution
+  int   partition;          // partition_enums value of the partition
+  int   partition_pbc;      // Particle bc of an absorbing box partition
+  int * cut;                // (0:gpx+gpy+gpz+2) indexed array of the
+                            // global voxel planes the domains are cut at
+                            // along x (cut[0:gpx]), then y and z.  The
+                            // domains in processor column px along x
+                            // hold the global voxels cut[px]+1:cut[px+1].
+                            // NULL unless made by a partition function.
+
+  int   migrate[27];        // (-1:1,-1:1,-1:1) FORTRAN indexed array of
+                            // the ranks owning the neighboring domains
+                            // particles can migrate to directly (-1 if
+                            // they cannot, see setup_particle_migration)
+  int   migrate_n[27][3];   // Local voxel mesh resolution of the nodes in
+                            // migrate (the cuts are rectilinear, so it
+                            // only differs from the local one along the
+                            // axes the neighboring domain is offset along)
+  int   migrate_all;        // Nonzero if particles can migrate directly to
+                            // all the neighboring domains of all domains
+                            // and no voxel has a particle boundary
+                            // condition (a move shorter than a voxel then
+                            // ends after a single boundary_p exchange)
+
   // Phase 3 grid data structures
   // NOTE: VOXEL INDEXING LIMITS NUMBER OF VOXELS TO 2^31 (INCLUDING
   // GHOSTS) PER NODE.  NEIGHBOR INDEXING FURTHER LIMITS TO
@@ -128,6 +172,18 @@ typedef struct grid {
                           //   rangeh = range[rank+1]-1.
                           // Note: rangeh-rangel <~ 2^26
 
+  int sfc_order;          // Voxel order used by the particle sort
+  int * ALIGNED(128) sfc; // (0:local_num_voxel-1) indexed array giving
+                          // the position of each voxel along the
+                          // space filling curve.  Particles in voxel v
+                          // are sorted into sp->partition[sfc[v]] to
+                          // sp->partition[sfc[v]+1]-1.  The non-ghost
+                          // voxels occupy positions VOXEL(1,1,1) to
+                          // VOXEL(1,1,1)+nx*ny*nz-1 and ghost voxels
+                          // the remaining ones in FORTRAN order.  The
+                          // mesh arrays themselves always use FORTRAN
+                          // order.
+
   // Nearest neighbor communications ports
   mp_t * mp;
 
@@ -188,6 +244,53 @@ set_fbc( grid_t *g, int bound, int fbc );
 void
 set_pbc( grid_t *g, int bound, int pbc );
 
+// Determine the neighboring domains, including those sharing only an
+// edge or a corner with the local domain, that particles can migrate
+// to directly (g->migrate).  A particle that leaves the local domain
+// through an edge or a corner is then moved through the ghost voxels
+// by move_p and sent straight to the domain it ends up in by
+// boundary_p, instead of hopping from face to face over several
+// exchanges.  This is only done when the voxels along the domain
+// boundaries have the standard neighbors join_grid and set_pbc give
+// them (e.g. no structures touching a domain boundary) and the domains
+// joined through a face have the same resolution along it (domains may
+// differ along the cut axes, as after a rebalance, g->migrate_n).  A
+// warning is printed when direct migration ends up disabled.  g->migrate_all tells
+// whether a single exchange completes all moves shorter than a voxel.
+// Must be called on all nodes after the grid and its boundary
+// conditions are set up.
+// size_grid, join_grid and set_pbc disable direct migration until it
+// is called again.
+
+void
+setup_particle_migration( grid_t *g );
+
+// Exchange the particle and accumulator counts in boundary_p with a
+// single MPI neighborhood collective over the nodes particles are
+// exchanged with instead of with a message pair per port.  Must be
+// called on all nodes after setup_particle_migration.  size_grid,
+// join_grid, set_pbc and setup_particle_migration turn it off.
+
+void
+setup_neighbor_collectives( grid_t *g );
+
+// Exchange ghosts and particles with the nodes on the same machine
+// through an MPI shared memory window rather than MPI messages (see
+// mp_share_node).  Must be called on all nodes after size_grid.
+
+void
+setup_shared_memory_comm( grid_t *g );
+
+// Set the voxel order used by the particle sort (one of sfc_enums).
+// Along a space filling curve, particles sorted next to each other
+// stay in a compact region of the local domain, which keeps the
+// interpolator and accumulator working set of a particle push small.
+// The partitioning of species sorted before the call is not valid
+// until they are sorted again.
+
+void
+set_sfc( grid_t *g, int order );
+
 // In partition.c
 
 // g->{n,d}{x,y,z} is _coherent_ on all nodes in the domain after
@@ -243,6 +346,31 @@ partition_metal_box( grid_t *g,
                      int gnx, int gny, int gnz,
                      int gpx, int gpy, int gpz );
 
+// The partition functions cut the global box into equal domains.
+// repartition_box cuts the box of a grid made by one of them again at
+// the voxel planes cut (indexed as g->cut) and restores the boundary
+// conditions the partition function set.  The domains can then have
+// different resolutions along each axis; domains next to each other
+// still share the same voxel planes along the two other axes.  Boundary
+// conditions set after the partition (e.g. set_pbc) are not restored.
+// Must be called on all nodes with the same cuts.  The grid is resized
+// as by size_grid.
+
+void
+repartition_box( grid_t *g,
+                 const int * cut );
+
+// Split the n voxel slabs of an axis into n_domain runs of consecutive
+// slabs (each at least one slab) with as equal a total load as possible.
+// load[0:n-1] is the load of each slab.  cut[0:n_domain] is set to the
+// slab boundaries (cut[0]=0, cut[n_domain]=n) in the format of g->cut.
+
+void
+balance_cuts( const double * load,
+              int n,
+              int n_domain,
+              int * cut );
+
 // In grid_comm.c
 
 // FIXME: SHOULD TAKE A RAW PORT INDEX INSTEAD OF A PORT COORDS
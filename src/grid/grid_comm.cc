@@ -13,6 +13,16 @@
 
 // Note: Messages are tagged by the port on the sender
 
+// Note: A port joined to the local node (e.g. periodic boundaries with
+// one node along a dimension) does not go through message passing.
+// begin_send_port hands the send buffer directly to the receive port
+// on the opposite side and the recv / send completions are no-ops.
+// This works whatever the order the sends and receives are begun in
+// as sizing the receive buffer preserves its contents.
+
+// Note: The ghost exchanges repeat the same messages every step so
+// they use persistent requests.
+
 void
 begin_recv_port( int i, int j, int k,
                  int size,
@@ -20,7 +30,8 @@ begin_recv_port( int i, int j, int k,
   int port = BOUNDARY(-i,-j,-k), src = g->bc[port];
   if( src<0 || src>=world_size ) return;
   mp_size_recv_buffer( g->mp, BOUNDARY(-i,-j,-k), size );
-  mp_begin_recv( g->mp, port, size, src, BOUNDARY(i,j,k) );
+  if( src==world_rank ) return;
+  mp_begin_recv_persistent( g->mp, port, size, src, BOUNDARY(i,j,k) );
 }
 
 void * ALIGNED(128)
@@ -28,7 +39,7 @@ end_recv_port( int i, int j, int k,
                const grid_t * g ) {
   int port = BOUNDARY(-i,-j,-k), src = g->bc[port];
   if( src<0 || src>=world_size ) return NULL;
-  mp_end_recv( g->mp, port );
+  if( src!=world_rank ) mp_end_recv( g->mp, port );
   return mp_recv_buffer( g->mp, port );
 }
 
@@ -48,14 +59,15 @@ begin_send_port( int i, int j, int k,
                  const grid_t * g ) {
   int port = BOUNDARY( i, j, k), dst = g->bc[port];
   if( dst<0 || dst>=world_size ) return;
-  mp_begin_send( g->mp, port, size, dst, port );
+  if( dst==world_rank ) mp_self_send( g->mp, port, size, BOUNDARY(-i,-j,-k) );
+  else                  mp_begin_send_persistent( g->mp, port, size, dst, port );
 }
 
 void
 end_send_port( int i, int j, int k,
                const grid_t * g ) {
   int port = BOUNDARY( i, j, k), dst = g->bc[port];
-  if( dst<0 || dst>=world_size ) return;
+  if( dst<0 || dst>=world_size || dst==world_rank ) return;
   mp_end_send( g->mp, BOUNDARY(i,j,k) );
 }
 
@@ -18,6 +18,8 @@ checkpt_grid( const grid_t * g ) {
   CHECKPT( g, 1 );
   if( g->range    ) CHECKPT_ALIGNED( g->range, world_size+1, 16 );
   if( g->neighbor ) CHECKPT_ALIGNED( g->neighbor, 6*g->nv, 128 );
+  if( g->sfc      ) CHECKPT_ALIGNED( g->sfc, g->nv, 128 );
+  if( g->cut      ) CHECKPT( g->cut, g->gpx+g->gpy+g->gpz+3 );
   CHECKPT_PTR( g->mp );
 }
 
@@ -27,6 +29,8 @@ restore_grid( void ) {
   RESTORE( g );
   if( g->range    ) RESTORE_ALIGNED( g->range );
   if( g->neighbor ) RESTORE_ALIGNED( g->neighbor );
+  if( g->sfc      ) RESTORE_ALIGNED( g->sfc );
+  if( g->cut      ) RESTORE( g->cut );
   RESTORE_PTR( g->mp );
   return g;
 }
@@ -38,6 +42,7 @@ new_grid( void ) {
   MALLOC( g, 1 );
   CLEAR( g, 1 );
   for( i=0; i<27; i++ ) g->bc[i] = anti_symmetric_fields;
+  for( i=0; i<27; i++ ) g->migrate[i] = -1;
   g->bc[BOUNDARY(0,0,0)] = world_rank;
   g->mp = new_mp( 27 );
   REGISTER_OBJECT( g, checkpt_grid, restore_grid, NULL );
@@ -48,6 +53,8 @@ void
 delete_grid( grid_t * g ) {
   if( !g ) return;
   UNREGISTER_OBJECT( g );
+  FREE( g->cut );
+  FREE_ALIGNED( g->sfc );
   FREE_ALIGNED( g->neighbor );
   FREE_ALIGNED( g->range );
   delete_mp( g->mp );
@@ -10,9 +10,100 @@
 
 #include "grid.h"
 
+#include <algorithm>
+#include <vector>
+
 #define LOCAL_CELL_ID(x,y,z)  VOXEL(x,y,z, lnx,lny,lnz)
 #define REMOTE_CELL_ID(x,y,z) VOXEL(x,y,z, rnx,rny,rnz)
 
+// Position of the voxel (x,y,z) along a space filling curve through a
+// 2^b x 2^b x 2^b cube.  The Hilbert index uses Skilling's transpose
+// algorithm (AIP Conf. Proc. 707, 381 (2004)).  Both curves are laid
+// out with x varying fastest on their finest scale.
+
+static uint64_t
+morton_index( uint32_t x, uint32_t y, uint32_t z, int b ) {
+  uint64_t h = 0;
+  for( int n=b-1; n>=0; n-- )
+    h = (h<<3) | (((z>>n)&1)<<2) | (((y>>n)&1)<<1) | ((x>>n)&1);
+  return h;
+}
+
+static uint64_t
+hilbert_index( uint32_t x, uint32_t y, uint32_t z, int b ) {
+  uint32_t X[3] = { z, y, x }, M = 1u<<(b-1), P, Q, t;
+  uint64_t h = 0;
+  int i, n;
+
+  // Inverse undo excess work
+  for( Q=M; Q>1; Q>>=1 ) {
+    P = Q-1;
+    for( i=0; i<3; i++ )
+      if( X[i] & Q ) X[0] ^= P;
+      else { t = (X[0]^X[i]) & P; X[0] ^= t; X[i] ^= t; }
+  }
+
+  // Gray encode
+  for( i=1; i<3; i++ ) X[i] ^= X[i-1];
+  t = 0;
+  for( Q=M; Q>1; Q>>=1 ) if( X[2] & Q ) t ^= Q-1;
+  for( i=0; i<3; i++ ) X[i] ^= t;
+
+  for( n=b-1; n>=0; n-- )
+    for( i=0; i<3; i++ ) h = (h<<1) | ((X[i]>>n)&1);
+  return h;
+}
+
+// Fill in g->sfc for g->sfc_order.  Non-ghost voxels are ranked by their
+// position along the curve through the smallest power of two cube
+// enclosing the local domain.
+
+static void
+setup_sfc( grid_t * g ) {
+  const int lnx = g->nx, lny = g->ny, lnz = g->nz;
+  const int vl = LOCAL_CELL_ID(1,1,1), nn = lnx*lny*lnz;
+  int x, y, z, v, n, k, b;
+  std::vector< std::pair<uint64_t,int> > key;
+
+  if( g->sfc_order==fortran_order ) {
+    for( v=0; v<g->nv; v++ ) g->sfc[v] = v;
+    return;
+  }
+
+  for( b=1; (1<<b)<lnx || (1<<b)<lny || (1<<b)<lnz; b++ );
+
+  key.reserve( nn );
+  for( z=1; z<=lnz; z++ )
+    for( y=1; y<=lny; y++ )
+      for( x=1; x<=lnx; x++ )
+        key.push_back( std::make_pair(
+          g->sfc_order==morton_order ? morton_index( x-1, y-1, z-1, b ) :
+                                       hilbert_index( x-1, y-1, z-1, b ),
+          LOCAL_CELL_ID(x,y,z) ) );
+  std::sort( key.begin(), key.end() );
+
+  for( n=0; n<nn; n++ ) g->sfc[ key[n].second ] = vl + n;
+
+  k = 0;
+  for( z=0; z<=lnz+1; z++ )
+    for( y=0; y<=lny+1; y++ )
+      for( x=0; x<=lnx+1; x++ )
+        if( x==0 || x==lnx+1 || y==0 || y==lny+1 || z==0 || z==lnz+1 ) {
+          g->sfc[ LOCAL_CELL_ID(x,y,z) ] = k;
+          if( ++k==vl ) k += nn;
+        }
+}
+
+// See setup_particle_migration.
+
+static void
+disable_migration( grid_t * g ) {
+  int b;
+  for( b=0; b<27; b++ ) g->migrate[b] = -1;
+  g->migrate_all = 0;
+  mp_set_neighbors( g->mp, NULL );
+}
+
 // Everybody must size their local grid in parallel
 
 void
@@ -35,6 +126,7 @@ size_grid( grid_t * g,
       for( i=-1; i<=1; i++ ) 
         g->bc[ BOUNDARY(i,j,k) ] = pec_fields;
   g->bc[ BOUNDARY(0,0,0) ] = world_rank;
+  disable_migration( g );
 
   // Setup phase 3 data structures.  This is an ugly kludge to
   // interface phase 2 and phase 3 data structures
@@ -85,34 +177,11 @@ size_grid( grid_t * g,
         }
       }
 
-# if 0
   // Setup the space filling curve
-  // FIXME: THIS IS A CRUDE HACK UNTIL A GOOD SFC CAN BE WRITTEN
-  // CURRENT SFC IS GOOD FOR THREADING WITH POWER-OF-TWO NUMBER OF THREADS.
-  // UP TO AND INCLUDING 8 THREADS.
 
   FREE_ALIGNED( g->sfc );
   MALLOC_ALIGNED( g->sfc, g->nv, 128 );
-
-  do {
-    int off;
-    int ox, oy, oz;
-    int nx, ny, nz;
-    int nx1 = (lnx+2)/2,   ny1 = (lny+2)/2,   nz1 = (lnz+2)/2;
-    int nx0 = (lnx+2)-nx1, ny0 = (lny+2)-ny1, nz0 = (lnz+2)-nz1;
-
-    for( z=0; z<=lnz+1; z++ )
-      for( y=0; y<=lny+1; y++ )
-        for( x=0; x<=lnx+1; x++ ) {
-          i = LOCAL_CELL_ID(x,y,z);
-          off = 0;
-          ox=x; nx=nx0; if(ox>=nx) ox-=nx, off+=nx,                 nx=nx1;
-          oy=y; ny=ny0; if(oy>=ny) oy-=ny, off+=ny*(lnx+2),         ny=ny1;
-          oz=z; nz=nz0; if(oz>=nz) oz-=nz, off+=nz*(lnx+2)*(lny+2), nz=nz1;
-          g->sfc[i] = off + ox + nx*( oy + ny*oz );
-        }
-  } while(0);
-# endif
+  setup_sfc( g );
 }
 
 void
@@ -126,6 +195,7 @@ join_grid( grid_t * g,
 
   // Join phase 2 data structures
   g->bc[boundary] = rank;
+  disable_migration( g );
 
   // Join phase 3 data structures
   lnx = g->nx;
@@ -186,6 +256,8 @@ set_pbc( grid_t * g,
   if( !g || boundary<0 || boundary>=27 || boundary==BOUNDARY(0,0,0) || pbc>=0 )
     ERROR(( "Bad args" ));
 
+  disable_migration( g );
+
   lnx = g->nx;
   lny = g->ny;
   lnz = g->nz;
@@ -210,3 +282,196 @@ set_pbc( grid_t * g,
 # undef SET_PBC
 }
 
+// Faces are numbered as in g->neighbor: 0:-x, 1:-y, 2:-z, 3:+x, 4:+y, 5:+z.
+
+void
+setup_particle_migration( grid_t * g ) {
+  static const int f2b[6] = { BOUNDARY(-1, 0, 0), BOUNDARY( 0,-1, 0),
+                              BOUNDARY( 0, 0,-1), BOUNDARY( 1, 0, 0),
+                              BOUNDARY( 0, 1, 0), BOUNDARY( 0, 0, 1) };
+  int lnx, lny, lnz, n[3], c[3], d[3], on[3], n_joined[6], n_bc[6];
+  int info[8], owner[8], i, j, k, a, f, m, r, ok = 1, no_bc = 1, all_ok;
+  int * all, * dims, * rn;
+  int64_t e;
+
+  if( !g || !g->neighbor ) ERROR(( "Bad args" ));
+
+  disable_migration( g );
+
+  lnx = n[0] = g->nx;
+  lny = n[1] = g->ny;
+  lnz = n[2] = g->nz;
+
+  // Domains may have different resolutions (e.g. after a rebalance)
+
+  MALLOC( dims, 3*world_size );
+  mp_allgather_i( n, dims, 3 );
+
+  // Check the neighbors of the voxels along the local domain boundary.
+  // These voxels are the ghost voxels particles migrating directly move
+  // through on the neighboring nodes.  Faces crossed moving along the
+  // boundary must join plain local voxels.  The faces on the domain
+  // boundary must either all join the matching voxel of the node in
+  // g->bc or all be boundary conditions.  A node joined through a face
+  // must have the local resolution along the face.
+
+  CLEAR( n_joined, 6 );
+  CLEAR( n_bc,     6 );
+
+  for( c[2]=1; c[2]<=lnz; c[2]++ )
+    for( c[1]=1; c[1]<=lny; c[1]++ )
+      for( c[0]=1; c[0]<=lnx; c[0]++ ) {
+        for( a=0; a<3; a++ ) on[a] = c[a]==1 || c[a]==n[a];
+        if( !on[0] && !on[1] && !on[2] ) continue;
+        for( f=0; f<6; f++ ) {
+          a = f%3;
+          d[0] = c[0]; d[1] = c[1]; d[2] = c[2];
+          d[a] += f<3 ? -1 : 1;
+          e = g->neighbor[ 6*LOCAL_CELL_ID(c[0],c[1],c[2]) + f ];
+          if( d[a]<1 || d[a]>n[a] ) {
+            r  = g->bc[ f2b[f] ];
+            rn = r>=0 && r<world_size ? dims + 3*r : NULL;
+            if( rn ) d[a] = f<3 ? rn[a] : 1;
+            if( rn && rn[(a+1)%3]==n[(a+1)%3] && rn[(a+2)%3]==n[(a+2)%3] &&
+                e==g->range[r] + VOXEL(d[0],d[1],d[2], rn[0],rn[1],rn[2]) )
+              n_joined[f]++;
+            else if( e<0 ) n_bc[f]++;
+            else           ok = 0;
+          } else if( on[(a+1)%3] || on[(a+2)%3] ) {
+            if( e!=g->rangel + LOCAL_CELL_ID(d[0],d[1],d[2]) ) ok = 0;
+          }
+        }
+      }
+
+  // Look for particle boundary conditions anywhere in the local domain
+
+  for( c[2]=1; c[2]<=lnz; c[2]++ )
+    for( c[1]=1; c[1]<=lny; c[1]++ )
+      for( c[0]=1; c[0]<=lnx; c[0]++ )
+        for( f=0; f<6; f++ )
+          if( g->neighbor[ 6*LOCAL_CELL_ID(c[0],c[1],c[2]) + f ]<0 ) no_bc = 0;
+
+  // Share the result of the check, the nodes joined through each face
+  // and whether there are boundary conditions.
+
+  info[0] = ok;
+  for( f=0; f<6; f++ ) {
+    if( n_joined[f] && n_bc[f] ) info[0] = 0;
+    info[1+f] = n_bc[f] ? -1 : g->bc[ f2b[f] ];
+  }
+  info[7] = no_bc;
+
+  MALLOC( all, 8*world_size );
+  mp_allgather_i( info, all, 8 );
+
+# define JOINED(rank,f) all[ 8*(rank) + 1 + (f) ]
+
+  for( r=0; r<world_size; r++ )
+    if( !all[8*r] ) {
+      if( world_rank==0 )
+        WARNING(( "Rank %i has domain boundaries particles cannot migrate "
+                  "directly through; direct particle migration disabled", r ));
+      FREE( all );
+      FREE( dims );
+      return;
+    }
+
+  // A particle leaving through region (i,j,k) crosses the domain faces
+  // of that region in any order.  Each partial crossing must lead to the
+  // same node whatever the order and the nodes must be joined both ways.
+  // The owner of each subset m of the faces of the region is found by
+  // crossing them in x, y, z order.
+
+  for( k=-1; k<=1; k++ )
+    for( j=-1; j<=1; j++ )
+      for( i=-1; i<=1; i++ ) {
+        int R[3] = { i, j, k }, valid = 1;
+        if( !i && !j && !k ) continue;
+        for( m=0; m<8; m++ ) {
+          owner[m] = -1;
+          if( ( (m&1) && !i ) || ( (m&2) && !j ) || ( (m&4) && !k ) ) continue;
+          r = world_rank;
+          for( a=0; a<3 && r>=0; a++ )
+            if( m & (1<<a) ) r = JOINED( r, R[a]<0 ? a : a+3 );
+          owner[m] = r;
+        }
+        for( m=0; m<8; m++ ) {
+          if( ( (m&1) && !i ) || ( (m&2) && !j ) || ( (m&4) && !k ) ) continue;
+          if( owner[m]<0 ) { valid = 0; continue; }
+          for( a=0; a<3; a++ ) {
+            if( !R[a] || (m & (1<<a)) ) continue;
+            f = R[a]<0 ? a : a+3;
+            r = owner[ m | (1<<a) ];
+            if( r<0 || JOINED( owner[m], f )!=r ||
+                JOINED( r, (f+3)%6 )!=owner[m] ) valid = 0;
+          }
+        }
+        if( !valid ) continue;
+        r = owner[ (i?1:0) | (j?2:0) | (k?4:0) ];
+        g->migrate[ BOUNDARY(i,j,k) ] = r;
+        for( a=0; a<3; a++ ) g->migrate_n[ BOUNDARY(i,j,k) ][a] = dims[3*r+a];
+      }
+
+  // All nodes must agree on migrate_all (it sets how many exchanges
+  // advance does)
+
+  for( ok=1, r=0; r<world_size; r++ ) ok &= all[8*r+7];
+  for( i=0; i<27; i++ )
+    if( i!=BOUNDARY(0,0,0) && g->migrate[i]<0 ) ok = 0;
+  mp_allsum_i( &ok, &all_ok, 1 );
+  g->migrate_all = all_ok==world_size;
+
+# undef JOINED
+
+  FREE( all );
+  FREE( dims );
+}
+
+void
+setup_neighbor_collectives( grid_t * g ) {
+  int peer[27], b, r;
+
+  if( !g ) ERROR(( "Bad args" ));
+
+  // These are the ports boundary_p exchanges particles over
+
+  for( b=0; b<27; b++ ) {
+    r = ( (b%3)!=1 ) + ( ((b/3)%3)!=1 ) + ( (b/9)!=1 )==1 ? g->bc[b] :
+                                                            g->migrate[b];
+    peer[b] = ( b!=BOUNDARY(0,0,0) && r>=0 && r<world_size &&
+                r!=world_rank ) ? r : -1;
+  }
+
+  mp_set_neighbors( g->mp, peer );
+}
+
+void
+setup_shared_memory_comm( grid_t * g ) {
+  int n, cap;
+
+  if( !g ) ERROR(( "Bad args" ));
+
+  // The slots hold the largest ghost exchange (the hydro sync sends 14
+  // floats per node of a face) and modest particle exchanges.
+
+  n = ( g->ny + 1 )*( g->nz + 1 );
+  if( n < ( g->nz + 1 )*( g->nx + 1 ) ) n = ( g->nz + 1 )*( g->nx + 1 );
+  if( n < ( g->nx + 1 )*( g->ny + 1 ) ) n = ( g->nx + 1 )*( g->ny + 1 );
+  cap = ( 1 + 16*n )*sizeof(float);
+  if( cap < 65536 ) cap = 65536;
+
+  mp_share_node( g->mp, cap );
+}
+
+
+void
+set_sfc( grid_t * g,
+         int order ) {
+
+  if( !g || ( order!=fortran_order && order!=morton_order &&
+              order!=hilbert_order ) )
+    ERROR(( "Bad args" ));
+
+  g->sfc_order = order;
+  if( g->sfc ) setup_sfc( g );
+}
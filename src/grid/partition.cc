@@ -32,14 +32,112 @@
     (rank) = _ix + gpx*( _iy + gpy*_iz );            \
   } while(0)
 
+// Cut the global box of g at the voxel planes g->cut and join the local
+// domain to its face neighbors (periodically).
+
+static void
+cut_box( grid_t * g ) {
+  const int gpx = g->gpx, gpy = g->gpy, gpz = g->gpz;
+  const int * cx = g->cut, * cy = cx + gpx + 1, * cz = cy + gpy + 1;
+  double f;
+  int rank, px, py, pz;
+
+  RANK_TO_INDEX( world_rank, px,py,pz );
+
+  g->dx = (g->gx1-g->gx0)/(double)g->gnx;
+  g->dy = (g->gy1-g->gy0)/(double)g->gny;
+  g->dz = (g->gz1-g->gz0)/(double)g->gnz;
+  g->dV = ((g->gx1-g->gx0)/(double)g->gnx)*
+          ((g->gy1-g->gy0)/(double)g->gny)*
+          ((g->gz1-g->gz0)/(double)g->gnz);
+
+  g->rdx =  (double)g->gnx/(g->gx1-g->gx0);
+  g->rdy =  (double)g->gny/(g->gy1-g->gy0);
+  g->rdz =  (double)g->gnz/(g->gz1-g->gz0);
+  g->r8V = ((double)g->gnx/(g->gx1-g->gx0))*
+           ((double)g->gny/(g->gy1-g->gy0))*
+           ((double)g->gnz/(g->gz1-g->gz0))*0.125;
+
+  // With equal domains, cx[px]/gnx is exactly px/gpx.
+
+  f = (double)cx[px  ]/(double)g->gnx; g->x0 = g->gx0*(1-f) + g->gx1*f;
+  f = (double)cy[py  ]/(double)g->gny; g->y0 = g->gy0*(1-f) + g->gy1*f;
+  f = (double)cz[pz  ]/(double)g->gnz; g->z0 = g->gz0*(1-f) + g->gz1*f;
+
+  f = (double)cx[px+1]/(double)g->gnx; g->x1 = g->gx0*(1-f) + g->gx1*f;
+  f = (double)cy[py+1]/(double)g->gny; g->y1 = g->gy0*(1-f) + g->gy1*f;
+  f = (double)cz[pz+1]/(double)g->gnz; g->z1 = g->gz0*(1-f) + g->gz1*f;
+
+  // Size the local grid
+  size_grid(g,cx[px+1]-cx[px],cy[py+1]-cy[py],cz[pz+1]-cz[pz]);
+
+  // Join the grid to neighbors
+  INDEX_TO_RANK(px-1,py,  pz,  rank); join_grid(g,BOUNDARY((-1), 0, 0),rank);
+  INDEX_TO_RANK(px,  py-1,pz,  rank); join_grid(g,BOUNDARY( 0,(-1), 0),rank);
+  INDEX_TO_RANK(px,  py,  pz-1,rank); join_grid(g,BOUNDARY( 0, 0,(-1)),rank);
+  INDEX_TO_RANK(px+1,py,  pz,  rank); join_grid(g,BOUNDARY( 1, 0, 0),rank);
+  INDEX_TO_RANK(px,  py+1,pz,  rank); join_grid(g,BOUNDARY( 0, 1, 0),rank);
+  INDEX_TO_RANK(px,  py,  pz+1,rank); join_grid(g,BOUNDARY( 0, 0, 1),rank);
+}
+
+// Override the periodic boundary conditions on the global box faces as
+// the partition function of g does.
+
+static void
+set_partition_bc( grid_t * g ) {
+  const int gpx = g->gpx, gpy = g->gpy, gpz = g->gpz;
+  int px, py, pz, fbc, pbc;
+
+  if( g->partition==absorbing_partition ) {
+    fbc = absorb_fields;
+    pbc = g->partition_pbc;
+  } else if( g->partition==metal_partition ) {
+    fbc = anti_symmetric_fields;
+    pbc = reflect_particles;
+  } else {
+    return;
+  }
+
+  RANK_TO_INDEX( world_rank, px,py,pz );
+
+  if( px==0 && g->gnx>1 ) {
+    set_fbc(g,BOUNDARY((-1),0,0),fbc);
+    set_pbc(g,BOUNDARY((-1),0,0),pbc);
+  }
+
+  if( px==gpx-1 && g->gnx>1 ) {
+    set_fbc(g,BOUNDARY( 1,0,0),fbc);
+    set_pbc(g,BOUNDARY( 1,0,0),pbc);
+  }
+
+  if( py==0 && g->gny>1 ) {
+    set_fbc(g,BOUNDARY(0,(-1),0),fbc);
+    set_pbc(g,BOUNDARY(0,(-1),0),pbc);
+  }
+
+  if( py==gpy-1 && g->gny>1 ) {
+    set_fbc(g,BOUNDARY(0, 1,0),fbc);
+    set_pbc(g,BOUNDARY(0, 1,0),pbc);
+  }
+
+  if( pz==0 && g->gnz>1 ) {
+    set_fbc(g,BOUNDARY(0,0,(-1)),fbc);
+    set_pbc(g,BOUNDARY(0,0,(-1)),pbc);
+  }
+
+  if( pz==gpz-1 && g->gnz>1 ) {
+    set_fbc(g,BOUNDARY(0,0, 1),fbc);
+    set_pbc(g,BOUNDARY(0,0, 1),pbc);
+  }
+}
+
 void
 partition_periodic_box( grid_t * g,
                         double gx0, double gy0, double gz0,
                         double gx1, double gy1, double gz1,
                         int gnx, int gny, int gnz,
                         int gpx, int gpy, int gpz ) {
-  double f;
-  int rank, px, py, pz;
+  int n;
 
   // Make sure the grid can be setup
 
@@ -52,46 +150,25 @@ partition_periodic_box( grid_t * g,
     ERROR(( "Bad resolution (%ix%ix%i) for domain decomposition",
             gnx, gny, gnz, gpx, gpy, gpz ));
 
-  // Setup basic variables
-  RANK_TO_INDEX( world_rank, px,py,pz );
-
   // Capture global processor decomposition
   g->gpx = gpx;
   g->gpy = gpy;
   g->gpz = gpz;
 
-  g->dx = (gx1-gx0)/(double)gnx;
-  g->dy = (gy1-gy0)/(double)gny;
-  g->dz = (gz1-gz0)/(double)gnz;
-  g->dV = ((gx1-gx0)/(double)gnx)*
-          ((gy1-gy0)/(double)gny)*
-          ((gz1-gz0)/(double)gnz);
-
-  g->rdx =  (double)gnx/(gx1-gx0);
-  g->rdy =  (double)gny/(gy1-gy0);
-  g->rdz =  (double)gnz/(gz1-gz0);
-  g->r8V = ((double)gnx/(gx1-gx0))*
-           ((double)gny/(gy1-gy0))*
-           ((double)gnz/(gz1-gz0))*0.125;
+  // Capture the global box and cut it into equal domains
+  g->gx0 = gx0; g->gy0 = gy0; g->gz0 = gz0;
+  g->gx1 = gx1; g->gy1 = gy1; g->gz1 = gz1;
+  g->gnx = gnx; g->gny = gny; g->gnz = gnz;
+  g->partition     = periodic_partition;
+  g->partition_pbc = 0;
 
-  f = (double) px   /(double)gpx; g->x0 = gx0*(1-f) + gx1*f;
-  f = (double) py   /(double)gpy; g->y0 = gy0*(1-f) + gy1*f;
-  f = (double) pz   /(double)gpz; g->z0 = gz0*(1-f) + gz1*f;
+  FREE( g->cut );
+  MALLOC( g->cut, gpx+gpy+gpz+3 );
+  for( n=0; n<=gpx; n++ ) g->cut[n]             = n*(gnx/gpx);
+  for( n=0; n<=gpy; n++ ) g->cut[gpx+1+n]       = n*(gny/gpy);
+  for( n=0; n<=gpz; n++ ) g->cut[gpx+gpy+2+n]   = n*(gnz/gpz);
 
-  f = (double)(px+1)/(double)gpx; g->x1 = gx0*(1-f) + gx1*f;
-  f = (double)(py+1)/(double)gpy; g->y1 = gy0*(1-f) + gy1*f;
-  f = (double)(pz+1)/(double)gpz; g->z1 = gz0*(1-f) + gz1*f;
-
-  // Size the local grid
-  size_grid(g,gnx/gpx,gny/gpy,gnz/gpz);
-
-  // Join the grid to neighbors
-  INDEX_TO_RANK(px-1,py,  pz,  rank); join_grid(g,BOUNDARY((-1), 0, 0),rank);
-  INDEX_TO_RANK(px,  py-1,pz,  rank); join_grid(g,BOUNDARY( 0,(-1), 0),rank);
-  INDEX_TO_RANK(px,  py,  pz-1,rank); join_grid(g,BOUNDARY( 0, 0,(-1)),rank);
-  INDEX_TO_RANK(px+1,py,  pz,  rank); join_grid(g,BOUNDARY( 1, 0, 0),rank);
-  INDEX_TO_RANK(px,  py+1,pz,  rank); join_grid(g,BOUNDARY( 0, 1, 0),rank);
-  INDEX_TO_RANK(px,  py,  pz+1,rank); join_grid(g,BOUNDARY( 0, 0, 1),rank);
+  cut_box( g );
 }
 
 void
@@ -101,8 +178,6 @@ partition_absorbing_box( grid_t * g,
                          int gnx, int gny, int gnz,
                          int gpx, int gpy, int gpz,
                          int pbc ) {
-  int px, py, pz;
-
   partition_periodic_box( g,
                           gx0, gy0, gz0,
                           gx1, gy1, gz1,
@@ -111,37 +186,9 @@ partition_absorbing_box( grid_t * g,
 
   // Override periodic boundary conditions
 
-  RANK_TO_INDEX( world_rank, px,py,pz );
-
-  if( px==0 && gnx>1 ) { 
-    set_fbc(g,BOUNDARY((-1),0,0),absorb_fields);
-    set_pbc(g,BOUNDARY((-1),0,0),pbc);
-  } 
-
-  if( px==gpx-1 && gnx>1 ) {
-    set_fbc(g,BOUNDARY( 1,0,0),absorb_fields);
-    set_pbc(g,BOUNDARY( 1,0,0),pbc);
-  }
-
-  if( py==0 && gny>1 ) { 
-    set_fbc(g,BOUNDARY(0,(-1),0),absorb_fields);
-    set_pbc(g,BOUNDARY(0,(-1),0),pbc);
-  } 
-
-  if( py==gpy-1 && gny>1 ) {
-    set_fbc(g,BOUNDARY(0, 1,0),absorb_fields);
-    set_pbc(g,BOUNDARY(0, 1,0),pbc);
-  }
-
-  if( pz==0 && gnz>1 ) { 
-    set_fbc(g,BOUNDARY(0,0,(-1)),absorb_fields);
-    set_pbc(g,BOUNDARY(0,0,(-1)),pbc);
-  } 
-
-  if( pz==gpz-1 && gnz>1 ) {
-    set_fbc(g,BOUNDARY(0,0, 1),absorb_fields);
-    set_pbc(g,BOUNDARY(0,0, 1),pbc);
-  }
+  g->partition     = absorbing_partition;
+  g->partition_pbc = pbc;
+  set_partition_bc( g );
 }
 
 // FIXME: HANDLE 1D and 2D SIMULATIONS IN PARTITION_METAL_BOX
@@ -153,8 +200,6 @@ partition_metal_box( grid_t * g,
                      double gx1, double gy1, double gz1,
                      int gnx, int gny, int gnz,
                      int gpx, int gpy, int gpz ) {
-  int px, py, pz;
-
   partition_periodic_box( g,
                           gx0, gy0, gz0,
                           gx1, gy1, gz1,
@@ -163,35 +208,54 @@ partition_metal_box( grid_t * g,
 
   // Override periodic boundary conditions
 
-  RANK_TO_INDEX( world_rank, px,py,pz );
+  g->partition = metal_partition;
+  set_partition_bc( g );
+}
 
-  if( px==0 && gnx>1 ) {
-    set_fbc(g,BOUNDARY((-1),0,0),anti_symmetric_fields);
-    set_pbc(g,BOUNDARY((-1),0,0),reflect_particles);
-  }
+void
+repartition_box( grid_t * g,
+                 const int * cut ) {
+  int gn[3], gp[3], a, n, c;
 
-  if( px==gpx-1 && gnx>1 ) {
-    set_fbc(g,BOUNDARY(1,0,0),anti_symmetric_fields);
-    set_pbc(g,BOUNDARY(1,0,0),reflect_particles);
-  }
+  if( !g || !cut || !g->cut ) ERROR(( "Bad args" ));
 
-  if( py==0 && gny>1 ) {
-    set_fbc(g,BOUNDARY(0,(-1),0),anti_symmetric_fields);
-    set_pbc(g,BOUNDARY(0,(-1),0),reflect_particles);
-  }
+  gn[0] = g->gnx; gn[1] = g->gny; gn[2] = g->gnz;
+  gp[0] = g->gpx; gp[1] = g->gpy; gp[2] = g->gpz;
 
-  if( py==gpy-1 && gny>1 ) {
-    set_fbc(g,BOUNDARY(0,1,0),anti_symmetric_fields);
-    set_pbc(g,BOUNDARY(0,1,0),reflect_particles);
+  for( a=c=0; a<3; c+=gp[a]+1, a++ ) {
+    if( cut[c]!=0 || cut[c+gp[a]]!=gn[a] ) ERROR(( "Bad cuts" ));
+    for( n=0; n<gp[a]; n++ )
+      if( cut[c+n+1]<=cut[c+n] ) ERROR(( "Bad cuts" ));
   }
 
-  if( pz==0 && gnz>1 ) {
-    set_fbc(g,BOUNDARY(0,0,(-1)),anti_symmetric_fields);
-    set_pbc(g,BOUNDARY(0,0,(-1)),reflect_particles);
-  }
+  COPY( g->cut, cut, c );
 
-  if( pz==gpz-1 && gnz>1 ) {
-    set_fbc(g,BOUNDARY(0,0,1),anti_symmetric_fields);
-    set_pbc(g,BOUNDARY(0,0,1),reflect_particles);
+  cut_box( g );
+  set_partition_bc( g );
+}
+
+void
+balance_cuts( const double * load,
+              int n,
+              int n_domain,
+              int * cut ) {
+  double total = 0, sum = 0;
+  int d, i;
+
+  if( !load || !cut || n_domain<1 || n<n_domain ) ERROR(( "Bad args" ));
+
+  for( i=0; i<n; i++ ) total += load[i];
+
+  // Cut d is put after the slab that brings the running load closest to
+  // the d/n_domain fraction of the total, leaving room for at least one
+  // slab per remaining domain.
+
+  cut[0] = 0;
+  for( d=1, i=0; d<n_domain; d++ ) {
+    const double target = total*(double)d/(double)n_domain;
+    sum += load[i++];
+    while( i<n-(n_domain-d) && sum+0.5*load[i]<target ) sum += load[i++];
+    cut[d] = i;
   }
+  cut[n_domain] = n;
 }
@@ -28,14 +28,99 @@ aa_n_pipeline(void)
   return n; // max( {serial,thread}.n_pipeline )
 }
 
+static void
+new_accumulator_tiles( accumulator_tiles_t * at,
+                       int n_tile )
+{
+  at->n_tile = n_tile;
+  at->n_used = 0;
+  at->n_pool = 0;
+
+  MALLOC( at->map,  n_tile );
+  MALLOC( at->used, n_tile );
+  MALLOC( at->pool, n_tile );
+
+  CLEAR( at->map, n_tile );
+}
+
+static void
+delete_accumulator_tiles( accumulator_tiles_t * at )
+{
+  release_accumulator_tiles( at );
+
+  while( at->n_pool ) FREE_ALIGNED( at->pool[ --at->n_pool ] );
+
+  FREE( at->pool );
+  FREE( at->used );
+  FREE( at->map  );
+}
+
+// The host tiles map the host accumulator.  They never own (or release)
+// any tile so the host accumulator is never put in a pool.
+
+static void
+map_host_tiles( accumulator_array_t * aa )
+{
+  int t;
+
+  for( t = 0; t < aa->tiles[0].n_tile; t++ )
+    aa->tiles[0].map[t] = aa->a + t * ACCUMULATOR_TILE;
+}
+
+static void
+new_tiles( accumulator_array_t * aa )
+{
+  int r, n_tile = aa->stride / ACCUMULATOR_TILE;
+
+  MALLOC( aa->tiles, aa->n_pipeline + 1 );
+
+  for( r = 0; r <= aa->n_pipeline; r++ )
+    new_accumulator_tiles( aa->tiles + r, n_tile );
+
+  map_host_tiles( aa );
+}
+
+accumulator_t *
+own_accumulator_tile( accumulator_tiles_t * at,
+                      int t )
+{
+  accumulator_t * a;
+
+  if ( at->n_pool ) a = at->pool[ --at->n_pool ];
+  else              MALLOC_ALIGNED( a, ACCUMULATOR_TILE, 128 );
+
+  CLEAR( a, ACCUMULATOR_TILE );
+
+  at->used[ at->n_used++ ] = t;
+  at->map[t] = a;
+
+  return a;
+}
+
+void
+release_accumulator_tiles( accumulator_tiles_t * at )
+{
+  int t;
+
+  for( ; at->n_used; at->n_used-- )
+  {
+    t = at->used[ at->n_used - 1 ];
+
+    at->pool[ at->n_pool++ ] = at->map[t];
+    at->map[t] = NULL;
+  }
+}
+
+// Only the host accumulator is checkpointed.  The pipeline tiles are
+// scratch space and are recreated on restore for the number of
+// pipelines in use then.
+
 void
 checkpt_accumulator_array( const accumulator_array_t * aa )
 {
   CHECKPT( aa, 1 );
 
-  CHECKPT_ALIGNED( aa->a,
-		   (size_t) ( aa->n_pipeline + 1 ) * (size_t) aa->stride,
-		   128 );
+  CHECKPT_ALIGNED( aa->a, aa->stride, 128 );
 
   CHECKPT_PTR( aa->g );
 }
@@ -51,12 +136,9 @@ restore_accumulator_array( void )
 
   RESTORE_PTR( aa->g );
 
-  if ( aa->n_pipeline != aa_n_pipeline() )
-  {
-    ERROR( ( "Number of accumulators restored is not the same as the number of "
-             "accumulators checkpointed.  Did you change the number of threads "
-             "per process between checkpt and restore?" ) );
-  }
+  aa->n_pipeline = aa_n_pipeline();
+
+  new_tiles( aa );
 
   return aa;
 }
@@ -75,16 +157,16 @@ new_accumulator_array( grid_t * g )
 
   aa->n_pipeline = aa_n_pipeline();
 
-  aa->stride     = POW2_CEIL( g->nv, 2 );
+  aa->stride     = ( ( g->nv + ACCUMULATOR_TILE - 1 ) >> ACCUMULATOR_TILE_SHIFT )
+                   << ACCUMULATOR_TILE_SHIFT;
 
   aa->g          = g;
 
-  MALLOC_ALIGNED( aa->a,
-		  (size_t) ( aa->n_pipeline + 1 ) * (size_t) aa->stride,
-		  128 );
+  MALLOC_ALIGNED( aa->a, aa->stride, 128 );
+
+  CLEAR( aa->a, aa->stride );
 
-  CLEAR( aa->a,
-	 (size_t) ( aa->n_pipeline + 1 ) * (size_t) aa->stride );
+  new_tiles( aa );
 
   REGISTER_OBJECT( aa,
 		   checkpt_accumulator_array,
@@ -97,6 +179,8 @@ new_accumulator_array( grid_t * g )
 void
 delete_accumulator_array( accumulator_array_t * aa )
 {
+  int r;
+
   if ( !aa )
   {
     return;
@@ -104,6 +188,11 @@ delete_accumulator_array( accumulator_array_t * aa )
 
   UNREGISTER_OBJECT( aa );
 
+  for( r = 0; r <= aa->n_pipeline; r++ )
+    delete_accumulator_tiles( aa->tiles + r );
+
+  FREE( aa->tiles );
+
   FREE_ALIGNED( aa->a );
 
   FREE( aa );
@@ -31,23 +31,29 @@ ha_n_pipeline(void)
 /* Though the checkpt/restore functions are not part of the public
    API, they must not be declared as static. */
 
+/* Only the host hydro array is checkpointed.  The pipeline hydro arrays
+   are scratch space and are recreated on restore for the number of
+   pipelines in use then. */
+
 void
 checkpt_hydro_array( const hydro_array_t * ha ) {
   CHECKPT( ha, 1 );
-  CHECKPT_ALIGNED( ha->h, (size_t)(ha->n_pipeline+1)*(size_t)ha->stride, 128 );
+  CHECKPT_ALIGNED( ha->h, ha->stride, 128 );
   CHECKPT_PTR( ha->g );
 }
 
 hydro_array_t *
 restore_hydro_array( void ) {
   hydro_array_t * ha;
+  hydro_t * h;
   RESTORE( ha );
-  RESTORE_ALIGNED( ha->h );
+  RESTORE_ALIGNED( h );
   RESTORE_PTR( ha->g );
-  if( ha->n_pipeline!=ha_n_pipeline() )
-    ERROR(( "Number of pipelines restored is not the same as the number of "
-            "pipelines checkpointed.  Did you change the number of threads "
-            "per process between checkpt and restore?" ));
+  ha->n_pipeline = ha_n_pipeline();
+  MALLOC_ALIGNED( ha->h, (size_t)(ha->n_pipeline+1)*(size_t)ha->stride, 128 );
+  CLEAR( ha->h + ha->stride, (size_t)ha->n_pipeline*(size_t)ha->stride );
+  COPY( ha->h, h, ha->stride );
+  FREE_ALIGNED( h );
   return ha;
 }
 
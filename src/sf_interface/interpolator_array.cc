@@ -131,3 +131,42 @@ load_interpolator_array( interpolator_array_t * RESTRICT ia,
   }
 # endif
 }
+
+//----------------------------------------------------------------------------//
+// Fold ia into avg such that avg, the average of n-1 interpolator arrays
+// on input, becomes the average of n interpolator arrays.  Since the
+// interpolation coefficients are linear in the fields, this is the
+// interpolator of the time averaged fields.
+//----------------------------------------------------------------------------//
+
+void
+average_interpolator_array( interpolator_array_t * RESTRICT avg,
+                            const interpolator_array_t * RESTRICT ia,
+                            int n )
+{
+  if ( !avg            ||
+       !ia             ||
+       avg->g != ia->g ||
+       n < 1 )
+  {
+    ERROR( ( "Bad args" ) );
+  }
+
+  if ( n == 1 )
+  {
+    COPY( avg->i, ia->i, ia->g->nv );
+
+    return;
+  }
+
+  /**/  float * RESTRICT ALIGNED(128) a = (float *) avg->i;
+  const float * RESTRICT ALIGNED(128) b = (const float *) ia->i;
+
+  const size_t nf = ia->g->nv * ( sizeof( interpolator_t ) / sizeof( float ) );
+  const float  rn = 1.0f / (float) n;
+
+  for( size_t j = 0; j < nf; j++ )
+  {
+    a[j] += rn * ( b[j] - a[j] );
+  }
+}
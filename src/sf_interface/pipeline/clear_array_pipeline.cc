@@ -41,7 +41,7 @@ clear_accumulator_array_pipeline( accumulator_array_t * RESTRICT aa )
 {
   DECLARE_ALIGNED_ARRAY( reduce_pipeline_args_t, 128, args, 1 );
 
-  int i0;
+  int i0, r;
   int na, nfloats;
 
   if ( ! aa )
@@ -57,12 +57,19 @@ clear_accumulator_array_pipeline( accumulator_array_t * RESTRICT aa )
 
   args->a       = (float *) ( aa->a + i0 );
   args->n       = na * nfloats;
-  args->n_array = aa->n_pipeline + 1;
+  args->n_array = 1;
   args->s_array = aa->stride * nfloats;
   args->n_block = accumulators_n_block;
 
   EXEC_PIPELINES( clear_array, args, 0 );
 
+  // The pipeline tiles are zeroed when they are next owned.
+
+  for( r = 1; r <= aa->n_pipeline; r++ )
+  {
+    release_accumulator_tiles( aa->tiles + r );
+  }
+
   WAIT_PIPELINES();
 }
 
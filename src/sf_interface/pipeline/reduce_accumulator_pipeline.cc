@@ -0,0 +1,64 @@
+#define IN_sf_interface
+
+#include "sf_interface_pipeline.h"
+
+#include "../sf_interface_private.h"
+
+#include "../../util/pipelines/pipelines_exec.h"
+
+// Each pipeline reduces a contiguous range of tiles.  For each tile,
+// the copies owned by the pipelines are added to the host accumulator
+// in pipeline order (a deterministic reduction).  Tiles no pipeline
+// owns are skipped, so the work is proportional to the number of tiles
+// owned rather than to the number of pipelines times the grid size.
+
+void
+reduce_accumulator_tiles_pipeline_scalar( reduce_accumulator_tiles_pipeline_args_t * args,
+                                          int pipeline_rank,
+                                          int n_pipeline )
+{
+  const accumulator_tiles_t * at = args->at;
+  const int n_tiles = args->n_tiles;
+  const int nfloats = ACCUMULATOR_TILE * sizeof(accumulator_t) / sizeof(float);
+
+  int t, t1, r, i;
+
+  DISTRIBUTE( args->n_tile, 1, pipeline_rank, n_pipeline, t, t1 );
+
+  t1 += t;
+
+  for( ; t < t1; t++ )
+  {
+    float * RESTRICT ALIGNED(128) a =
+      (float *) ( args->a + t * ACCUMULATOR_TILE );
+
+    for( r = 0; r < n_tiles; r++ )
+    {
+      const float * RESTRICT ALIGNED(128) b = (const float *) at[r].map[t];
+
+      if ( !b ) continue;
+
+      for( i = 0; i < nfloats; i++ ) a[i] += b[i];
+    }
+  }
+}
+
+void
+reduce_accumulator_array_pipeline( accumulator_array_t * RESTRICT aa )
+{
+  DECLARE_ALIGNED_ARRAY( reduce_accumulator_tiles_pipeline_args_t, 128, args, 1 );
+
+  if ( ! aa )
+  {
+    ERROR( ( "Bad args." ) );
+  }
+
+  args->a       = aa->a;
+  args->at      = aa->tiles + 1;
+  args->n_tiles = aa->n_pipeline;
+  args->n_tile  = aa->tiles[0].n_tile;
+
+  EXEC_PIPELINES( reduce_accumulator_tiles, args, 0 );
+
+  WAIT_PIPELINES();
+}
@@ -173,39 +173,6 @@ reduce_array_pipeline_scalar( reduce_pipeline_args_t * args,
   #undef LOOP
 }
 
-#define VOX( x, y, z ) VOXEL( x, y, z, aa->g->nx, aa->g->ny, aa->g->nz )
-
-void
-reduce_accumulator_array_pipeline( accumulator_array_t * RESTRICT aa )
-{
-  DECLARE_ALIGNED_ARRAY( reduce_pipeline_args_t, 128, args, 1 );
-
-  int i0, na, nfloats;
-
-  if ( ! aa )
-  {
-    ERROR( ( "Bad args." ) );
-  }
-
-  i0 = ( VOX( 1, 1, 1 ) / 2 ) * 2; // Round i0 down to even for 128 byte align.
-
-  na = ( ( ( VOX( aa->g->nx, aa->g->ny, aa->g->nz ) - i0 + 1 ) + 1 ) / 2 ) * 2;
-
-  nfloats       = sizeof(accumulator_t) / sizeof(float);
-
-  args->a       = (float *) ( aa->a + i0 );
-  args->n       = na * nfloats;
-  args->n_array = aa->n_pipeline + 1;
-  args->s_array = aa->stride * nfloats;
-  args->n_block = accumulators_n_block;
-
-  EXEC_PIPELINES( reduce_array, args, 0 );
-
-  WAIT_PIPELINES();
-}
-
-#undef VOX
-
 void
 reduce_hydro_array_pipeline( hydro_array_t * RESTRICT ha )
 {
@@ -104,4 +104,23 @@ reduce_array_pipeline_v16( reduce_pipeline_args_t * args,
                            int pipeline_rank,
                            int n_pipeline );
 
+///////////////////////////////////////////////////////////////////////////////
+// reduce_accumulator_tiles_pipeline interface
+
+typedef struct reduce_accumulator_tiles_pipeline_args
+{
+  MEM_PTR( accumulator_t, 128 ) a;             // Host accumulator
+  MEM_PTR( const accumulator_tiles_t, 1 ) at;  // Pipeline tiles to reduce
+  int n_tiles;                                 // Number of pipeline tiles
+  int n_tile;                                  // Number of tiles per array
+
+  PAD_STRUCT( 2*SIZEOF_MEM_PTR + 2*sizeof(int) )
+
+} reduce_accumulator_tiles_pipeline_args_t;
+
+void
+reduce_accumulator_tiles_pipeline_scalar( reduce_accumulator_tiles_pipeline_args_t * args,
+                                          int pipeline_rank,
+                                          int n_pipeline );
+
 #endif // _sf_interface_pipeline_h_
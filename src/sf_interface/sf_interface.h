@@ -22,10 +22,12 @@
 //----------------------------------------------------------------------------//
 
 //----------------------------------------------------------------------------//
-// 64-byte align
+// 64-byte align.  Builds carrying all the vector pipelines need the layout
+// of the widest one in every source file.
 
 #if defined(USE_V16_PORTABLE) || \
-    defined(USE_V16_AVX512)
+    defined(USE_V16_AVX512)   || \
+    defined(VPIC_ISA_DISPATCH)
 
 #define PAD_SIZE_INTERPOLATOR 14
 #define PAD_SIZE_ACCUMULATOR   4
@@ -100,17 +102,40 @@ void
 load_interpolator_array( /**/  interpolator_array_t * RESTRICT ia,
                          const field_array_t        * RESTRICT fa );
 
+// Fold ia into the running average avg of the last n-1 interpolator
+// arrays.  With n==1, avg becomes a copy of ia.  This is used to give
+// subcycled species the fields averaged over their subcycle.
+
+void
+average_interpolator_array( /**/  interpolator_array_t * RESTRICT avg,
+                            const interpolator_array_t * RESTRICT ia,
+                            int n );
+
 END_C_DECLS
 
 /*****************************************************************************/
 
-// Accumulator arrays shall be a
-//   POW2_CEIL((nx+2)x(ny+2)x(nz+2),2)x(1+n_pipeline)
-// allocation indexed FORTRAN style.  That is, the accumulator array
-// is a 4d array.  a(:,:,:,0) is the accumulator used by the host
-// processor.  a(:,:,:,1:n_pipeline) are the accumulators used by
-// pipelines during operations.  Like the interpolator, accumulators
-// on the surface of the local domain are not used.
+// Accumulator arrays shall be a (nx+2) x (ny+2) x (nz+2) allocation
+// (rounded up to a whole number of tiles, see below) indexed FORTRAN
+// style.  This is the accumulator used by the host processor.  Like
+// the interpolator, accumulators on the surface of the local domain
+// are not used.
+//
+// Pipelines do not get a full copy of the accumulator.  Instead, the
+// voxels are grouped into tiles of ACCUMULATOR_TILE consecutive
+// voxels and each pipeline accumulates into private copies of only
+// the tiles its particles touch.  A pipeline takes ownership of a
+// tile (and zeros it) the first time one of its particles deposits
+// current there.  Since the particles are kept sorted by voxel and
+// each pipeline pushes a contiguous range of them, a pipeline
+// typically owns the tiles of its range plus a thin halo of tiles
+// its particles cross into.  The accumulator memory and the
+// reduction work are then proportional to the grid size rather than
+// to the grid size times the number of pipelines.  Tile buffers are
+// kept in a per pipeline pool between steps.
+
+#define ACCUMULATOR_TILE_SHIFT 6
+#define ACCUMULATOR_TILE       (1<<ACCUMULATOR_TILE_SHIFT)
 
 typedef struct accumulator
 {
@@ -122,11 +147,23 @@ typedef struct accumulator
   #endif
 } accumulator_t;
 
+typedef struct accumulator_tiles
+{
+  accumulator_t ** map;  // map[t] is the accumulator of tile t (NULL if
+  /**/                   // tile t is not owned)
+  int * used;            // Tiles owned (n_used of them)
+  accumulator_t ** pool; // Free tile buffers (n_pool of them)
+  int n_used, n_pool;
+  int n_tile;            // Number of tiles in the local domain
+} accumulator_tiles_t;
+
 typedef struct accumulator_array
 {
   accumulator_t * ALIGNED(128) a;
+  accumulator_tiles_t * tiles; // tiles[0] maps the host accumulator,
+  /**/                         // tiles[1:n_pipeline] the pipelines' tiles
   int n_pipeline; // Number of pipelines supported by this accumulator
-  int stride;     // Stride be each pipeline's accumulator array
+  int stride;     // Number of accumulators in a
   grid_t * g;
 } accumulator_array_t;
 
@@ -134,6 +171,38 @@ BEGIN_C_DECLS
 
 // In accumulator_array.cc
 
+// Take ownership of tile t.  Use tile_accumulator instead.
+
+accumulator_t *
+own_accumulator_tile( accumulator_tiles_t * at,
+                      int t );
+
+// Release all the tiles owned by at back to its pool.
+
+void
+release_accumulator_tiles( accumulator_tiles_t * at );
+
+END_C_DECLS
+
+// Accumulator of voxel v in the tiles at, taking ownership of its tile
+// if necessary.
+
+static inline accumulator_t *
+tile_accumulator( accumulator_tiles_t * at,
+                  int v )
+{
+  const int t = v >> ACCUMULATOR_TILE_SHIFT;
+  accumulator_t * a = at->map[t];
+
+  if ( UNLIKELY( !a ) ) a = own_accumulator_tile( at, t );
+
+  return a + ( v & ( ACCUMULATOR_TILE - 1 ) );
+}
+
+BEGIN_C_DECLS
+
+// In accumulator_array.cc
+
 accumulator_array_t *
 new_accumulator_array( grid_t * g );
 
@@ -142,7 +211,8 @@ delete_accumulator_array( accumulator_array_t * a );
 
 // In clear_array.cc
 
-// This zeros out all the accumulator arrays in a pipelined fashion.
+// This zeros out the host accumulator in a pipelined fashion and
+// releases the tiles owned by the pipelines.
 
 void
 clear_accumulator_array( accumulator_array_t * RESTRICT a );
@@ -151,9 +221,9 @@ clear_accumulator_array( accumulator_array_t * RESTRICT a );
 
 // Going into reduce_accumulators, the host cores and the pipeline
 // cores have each accumulated values to their personal
-// accumulators.  This reduces the pipeline accumulators into the host
-// accumulator with a pipelined horizontal reduction (a deterministic
-// reduction).
+// accumulators.  This reduces the tiles owned by the pipelines into
+// the host accumulator with a pipelined reduction over the tiles (a
+// deterministic reduction).
 
 void
 reduce_accumulator_array( accumulator_array_t * RESTRICT a );
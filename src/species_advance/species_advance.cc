@@ -10,6 +10,8 @@
 
 #include "species_advance.h"
 
+#include <stddef.h> // For offsetof
+
 /* Private interface *********************************************************/
 
 void
@@ -17,13 +19,22 @@ checkpt_species( const species_t * sp )
 {
   CHECKPT( sp, 1 );
   CHECKPT_STR( sp->name );
-  checkpt_data( sp->p,
-                sp->np    *sizeof(particle_t),
-                sp->max_np*sizeof(particle_t), 1, 1, 128 );
+  // Sorted AoS particles compress better with their voxel indices
+  // delta coded.  An AoSoA array is checkpointed by whole tiles (the
+  // fields of the particles of the last tile extend past np).
+  if( sp->layout==PARTICLE_LAYOUT_AOSOA )
+    checkpt_data( sp->p,
+                  PARTICLE_BLOCK_CEIL( sp->np )*sizeof(particle_t),
+                  sp->max_np*sizeof(particle_t), 1, 1, 128 );
+  else
+    checkpt_records( sp->p, sizeof(particle_t), sizeof(particle_t),
+                     sp->np, sp->max_np, 128,
+                     1u << ( offsetof(particle_t,i)/4 ) );
   checkpt_data( sp->pm,
                 sp->nm    *sizeof(particle_mover_t),
                 sp->max_nm*sizeof(particle_mover_t), 1, 1, 128 );
   CHECKPT_ALIGNED( sp->partition, sp->g->nv+1, 128 );
+  CHECKPT_PTR( sp->subcycle_ia );
   CHECKPT_PTR( sp->g );
   CHECKPT_PTR( sp->next );
 }
@@ -37,6 +48,7 @@ restore_species( void )
   sp->p  = (particle_t *)      restore_data();
   sp->pm = (particle_mover_t *)restore_data();
   RESTORE_ALIGNED( sp->partition );
+  RESTORE_PTR( sp->subcycle_ia );
   RESTORE_PTR( sp->g );
   RESTORE_PTR( sp->next );
   return sp;
@@ -46,6 +58,7 @@ void
 delete_species( species_t * sp )
 {
   UNREGISTER_OBJECT( sp );
+  delete_interpolator_array( sp->subcycle_ia );
   FREE_ALIGNED( sp->partition );
   FREE_ALIGNED( sp->pm );
   FREE_ALIGNED( sp->p );
@@ -146,6 +159,8 @@ species( const char * name,
   sp->sort_out_of_place = sort_out_of_place;
   MALLOC_ALIGNED( sp->partition, g->nv+1, 128 );
 
+  sp->subcycle = 1;
+
   sp->g = g;   
 
   /* id, next are set by append species */
@@ -153,3 +168,114 @@ species( const char * name,
   REGISTER_OBJECT( sp, checkpt_species, restore_species, NULL );
   return sp;
 }
+
+void
+set_species_subcycle( species_t * sp,
+                      int subcycle )
+{
+  if( !sp || subcycle<1 ) ERROR(( "Bad args" ));
+
+  // The field average restarts with the next step and the species is
+  // next pushed subcycle steps from now, whatever the current step.
+
+  if( subcycle>1 && !sp->subcycle_ia )
+    sp->subcycle_ia = new_interpolator_array( sp->g );
+  if( subcycle==1 ) {
+    delete_interpolator_array( sp->subcycle_ia );
+    sp->subcycle_ia = NULL;
+  }
+  sp->subcycle = subcycle;
+  sp->subcycle_phase = 0;
+}
+
+void
+set_species_sort_incremental( species_t * sp,
+                              int incremental )
+{
+  if( !sp ) ERROR(( "Bad args" ));
+  sp->sort_incremental = incremental;
+}
+
+int
+set_species_layout( species_t * sp,
+                    int layout )
+{
+  DECLARE_ALIGNED_ARRAY( particle_t, 128, tile, PARTICLE_BLOCK );
+
+  particle_t * ALIGNED(128) p;
+  int old_layout, n, nl, l;
+
+  if( !sp ) ERROR(( "Bad args" ));
+  if( layout!=PARTICLE_LAYOUT_AOS && layout!=PARTICLE_LAYOUT_AOSOA )
+    ERROR(( "Unknown particle layout %i", layout ));
+
+  old_layout = sp->layout;
+  if( layout==old_layout ) return old_layout;
+
+  // An AoSoA particle array must hold a whole number of tiles.
+
+  if( layout==PARTICLE_LAYOUT_AOSOA &&
+      sp->max_np!=PARTICLE_BLOCK_CEIL( sp->max_np ) ) {
+    n = PARTICLE_BLOCK_CEIL( sp->max_np );
+    MALLOC_ALIGNED( p, n, 128 );
+    COPY( p, sp->p, sp->np );
+    FREE_ALIGNED( sp->p );
+    sp->p      = p;
+    sp->max_np = n;
+  }
+
+  // Transpose the particle array in place one tile at a time.
+
+  for( n=0; n<sp->np; n+=PARTICLE_BLOCK ) {
+    p  = sp->p + n;
+    nl = sp->np - n; if( nl>PARTICLE_BLOCK ) nl = PARTICLE_BLOCK;
+    for( l=0; l<nl; l++ ) load_particle( p, old_layout, l, tile + l );
+    for( l=0; l<nl; l++ ) store_particle( p, layout, l, tile + l );
+  }
+
+  sp->layout = layout;
+  return old_layout;
+}
+
+void
+set_species_list_layout( species_t * sp_list,
+                         int layout,
+                         int * old_layout )
+{
+  species_t * sp;
+  int n = 0;
+
+  if( sp_list && !old_layout ) ERROR(( "Bad args" ));
+  LIST_FOR_EACH( sp, sp_list )
+    old_layout[n++] = set_species_layout( sp, layout );
+}
+
+void
+restore_species_list_layout( species_t * sp_list,
+                             const int * old_layout )
+{
+  species_t * sp;
+  int n = 0;
+
+  if( sp_list && !old_layout ) ERROR(( "Bad args" ));
+  LIST_FOR_EACH( sp, sp_list )
+    set_species_layout( sp, old_layout[n++] );
+}
+
+void
+pad_particle_blocks( particle_t * ALIGNED(128) p0,
+                     int np )
+{
+  particle_block_t * ALIGNED(128) pb;
+  int l, voxel;
+
+  l = PARTICLE_BLOCK_LANE( np );
+  if( !l ) return; // No particles or last tile is full
+
+  pb    = PARTICLE_BLOCK_PTR( p0, np );
+  voxel = pb->i[l-1];
+  for( ; l<PARTICLE_BLOCK; l++ ) {
+    pb->dx[l] = 0; pb->dy[l] = 0; pb->dz[l] = 0; pb->i[l] = voxel;
+    pb->ux[l] = 0; pb->uy[l] = 0; pb->uz[l] = 0; pb->w[l] = 0;
+  }
+}
@@ -19,6 +19,7 @@
 //----------------------------------------------------------------------------//
 
 #include "species_advance_aos.h"
+#include "species_advance_aosoa.h"
 
 //----------------------------------------------------------------------------//
 // Declare methods.
@@ -56,6 +57,63 @@ species( const char * name,
          int sort_out_of_place,
          grid_t * g );
 
+// Push the species only every subcycle steps.  The push uses a time
+// step of subcycle*dt and the fields averaged over the subcycle steps
+// ending at the push.  The charge moved by the push is deposited to the
+// accumulators in the step of the push such that the current stays
+// charge conserving.  subcycle==1 (the default) pushes every step.
+//
+// The average is not time centered: it is centered (subcycle-1)/2 steps
+// before the push and so lags the fields a centered subcycle*dt push
+// would see.  The push is then only first order accurate in time (the
+// leapfrog push is second order), with an error that grows with how
+// much the fields change over subcycle*dt.  This is meant for species
+// (e.g. heavy ions) that barely respond over a subcycle.
+
+void
+set_species_subcycle( species_t * sp,
+                      int subcycle );
+
+// With incremental sorting, a sort only moves the particles that are
+// not in the partition of their voxel computed by the previous sort
+// (and particles added since).  The other particles keep their order.
+// This is much cheaper than a full sort when sorting often (e.g. every
+// step) and gives the same exact partitioning.  The first sort of a
+// species is always a full sort.
+
+void
+set_species_sort_incremental( species_t * sp,
+                              int incremental );
+
+// Convert the particle array of a species to the requested
+// PARTICLE_LAYOUT_*.  Returns the previous layout such that callers
+// which need the AoS layout can restore the species afterward.
+
+int
+set_species_layout( species_t * sp,
+                    int layout );
+
+// Convert all the species of a list to the requested PARTICLE_LAYOUT_*.
+// The previous layouts are stored in old_layout (one per species in list
+// order) such that restore_species_list_layout can put them back.
+
+void
+set_species_list_layout( species_t * sp_list,
+                         int layout,
+                         int * old_layout );
+
+void
+restore_species_list_layout( species_t * sp_list,
+                             const int * old_layout );
+
+// Fill the unused lanes of the last tile of an AoSoA particle array
+// with weightless copies of the last particle's voxel such that the
+// vector kernels can process whole tiles.
+
+void
+pad_particle_blocks( particle_t * ALIGNED(128) p0,
+                     int np );
+
 // FIXME: TEMPORARY HACK UNTIL THIS SPECIES_ADVANCE KERNELS
 // CAN BE CONSTRUCTED ANALOGOUS TO THE FIELD_ADVANCE KERNELS
 // (THESE FUNCTIONS ARE NECESSARY FOR HIGHER LEVEL CODE)
@@ -68,6 +126,9 @@ sort_p( species_t * RESTRICT sp );
 void
 sort_p_pipeline( species_t * sp );
 
+void
+sort_p_incremental_pipeline( species_t * sp );
+
 // In advance_p.cc
 
 void
@@ -151,6 +212,15 @@ accumulate_hydro_p_pipeline( hydro_array_t * RESTRICT ha,
 
 // In move_p.cc
 
+// A particle whose move move_p could not complete has its voxel index
+// set to 8*voxel + face, where face (0:5) is the face of the voxel it
+// stopped on.  A particle migrating directly to a domain that shares an
+// edge or a corner with the local domain (see setup_particle_migration)
+// has instead been moved to its final ghost voxel and has face
+// MIGRATE_FACE.
+
+enum { MIGRATE_FACE = 6 };
+
 int
 move_p( particle_t       * ALIGNED(128) p0,    // Particle array
         particle_mover_t * ALIGNED(16)  m,     // Particle mover to apply
@@ -158,6 +228,32 @@ move_p( particle_t       * ALIGNED(128) p0,    // Particle array
         const grid_t     *              g,     // Grid parameters
         const float                     qsp ); // Species particle charge
 
+// As move_p but for a particle array in the AoSoA layout.
+
+int
+move_p_aosoa( particle_t       * ALIGNED(128) p0,    // Particle array
+              particle_mover_t * ALIGNED(16)  m,     // Particle mover to apply
+              accumulator_t    * ALIGNED(128) a0,    // Accumulator to use
+              const grid_t     *              g,     // Grid parameters
+              const float                     qsp ); // Species particle charge
+
+// As move_p and move_p_aosoa but depositing into the accumulator tiles
+// of a pipeline.
+
+int
+move_p_tiles( particle_t          * ALIGNED(128) p0,    // Particle array
+              particle_mover_t    * ALIGNED(16)  m,     // Particle mover to apply
+              accumulator_tiles_t *              at,    // Accumulator tiles to use
+              const grid_t        *              g,     // Grid parameters
+              const float                        qsp ); // Species particle charge
+
+int
+move_p_aosoa_tiles( particle_t          * ALIGNED(128) p0,    // Particle array
+                    particle_mover_t    * ALIGNED(16)  m,     // Particle mover to apply
+                    accumulator_tiles_t *              at,    // Accumulator tiles to use
+                    const grid_t        *              g,     // Grid parameters
+                    const float                        qsp ); // Species particle charge
+
 END_C_DECLS
 
 #endif // _species_advance_h_
@@ -58,6 +58,8 @@ typedef struct species {
 
   int np, max_np;                     // Number and max local particles
   particle_t * ALIGNED(128) p;        // Array of particles for the species
+  int layout;                         // Storage layout of p (see
+  /**/                                // species_advance_aosoa.h)
 
   int nm, max_nm;                     // Number and max local movers in use
   particle_mover_t * ALIGNED(128) pm; // Particle movers
@@ -66,6 +68,15 @@ typedef struct species {
                                       // sorted.
   int sort_interval;                  // How often to sort the species
   int sort_out_of_place;              // Sort method
+  int sort_incremental;               // Only move the particles that left
+  /**/                                // their partition since the last sort
+
+  int subcycle;                       // Push the species only every subcycle
+  /**/                                // steps (with a subcycle*dt push)
+  interpolator_array_t * subcycle_ia; // Fields averaged over the steps since
+  /**/                                // the last push (NULL if subcycle==1)
+  int subcycle_phase;                 // Steps averaged into subcycle_ia
+  /**/                                // since the last push
   int * ALIGNED(128) partition;       // Static array indexed 0:
   /**/                                // (nx+2)*(ny+2)*(nz+2).  Each value
   /**/                                // corresponds to the associated particle
@@ -85,8 +96,8 @@ typedef struct species {
   /**/                                //          sp->partition[ j+1 ] ]
   /**/                                // are all the particles in voxel
   /**/                                // with space filling curve index j.
-  /**/                                // Note: SFC NOT IN USE RIGHT NOW THUS
-  /**/                                // g->sfc[i]=i ABOVE.
+  /**/                                // Note: g->sfc[i]=i unless the grid
+  /**/                                // order was changed with set_sfc.
 
   grid_t * g;                         // Underlying grid
   species_id id;                      // Unique identifier for a species
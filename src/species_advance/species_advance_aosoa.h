@@ -0,0 +1,116 @@
+#ifndef _species_advance_aosoa_h_
+#define _species_advance_aosoa_h_
+
+// AoSoA particle storage.  A species whose layout is PARTICLE_LAYOUT_AOSOA
+// stores its particles in tiles of PARTICLE_BLOCK particles.  A tile holds
+// the same data as PARTICLE_BLOCK consecutive particle_t but with each
+// particle_t field stored contiguously for all the particles in the tile
+// (i.e. a tile is the transpose of the corresponding AoS particle_t block).
+// As such, a tile occupies exactly the same storage as PARTICLE_BLOCK
+// particle_t and the particle array sp->p can switch between layouts in
+// place.  Particle n of the species lives in lane n%PARTICLE_BLOCK of tile
+// n/PARTICLE_BLOCK.  The last tile may be partially filled; its unused lanes
+// are scratch space for the vector kernels (see pad_particle_blocks).
+//
+// PARTICLE_BLOCK matches the v16 width.  The v8 and v4 kernels process half
+// and quarter tiles respectively.  Because the fields of a tile are already
+// in vector order, the particle load and store transposes done by the AoS
+// kernels become plain aligned vector loads and stores.
+//
+// While a species is in the AoSoA layout, sp->p must not be indexed as a
+// particle_t array.  Use load_particle / store_particle below, or switch
+// the species back with set_species_layout.  advance_p, center_p,
+// uncenter_p, energy_p, sort_p, boundary_p and inject_particle operate on
+// the AoSoA layout directly.  The collision operators, emitters, dumps
+// and checksums temporarily switch the species back to the AoS layout.
+// The user deck hooks get the species as is (see deck/wrapper.h).
+
+enum particle_layout {
+  PARTICLE_LAYOUT_AOS   = 0,
+  PARTICLE_LAYOUT_AOSOA = 1
+};
+
+#define PARTICLE_BLOCK 16
+
+#define PARTICLE_BLOCK_CEIL(n) \
+  ( ( (n) + PARTICLE_BLOCK - 1 ) & ~( PARTICLE_BLOCK - 1 ) )
+
+typedef struct particle_block {
+  float   dx[PARTICLE_BLOCK]; // See particle_t for the meaning of each field
+  float   dy[PARTICLE_BLOCK];
+  float   dz[PARTICLE_BLOCK];
+  int32_t i [PARTICLE_BLOCK];
+  float   ux[PARTICLE_BLOCK];
+  float   uy[PARTICLE_BLOCK];
+  float   uz[PARTICLE_BLOCK];
+  float   w [PARTICLE_BLOCK];
+} particle_block_t;
+
+// Tile containing particle n of an AoSoA particle array and the lane of
+// particle n in that tile.
+
+#define PARTICLE_BLOCK_PTR(p0,n) \
+  ( ( (particle_block_t *)(p0) ) + ( (n) / PARTICLE_BLOCK ) )
+
+#define PARTICLE_BLOCK_LANE(n) ( (n) & ( PARTICLE_BLOCK - 1 ) )
+
+// Gather particle n of a particle array stored with the given layout into p.
+
+static inline void
+load_particle( const particle_t * ALIGNED(128) p0,
+               int layout,
+               int n,
+               particle_t * p )
+{
+  if ( layout == PARTICLE_LAYOUT_AOSOA )
+  {
+    const particle_block_t * pb = PARTICLE_BLOCK_PTR( p0, n );
+    const int l = PARTICLE_BLOCK_LANE( n );
+
+    p->dx = pb->dx[l]; p->dy = pb->dy[l]; p->dz = pb->dz[l]; p->i = pb->i[l];
+    p->ux = pb->ux[l]; p->uy = pb->uy[l]; p->uz = pb->uz[l]; p->w = pb->w[l];
+  }
+
+  else
+  {
+    *p = p0[n];
+  }
+}
+
+// Scatter p into particle n of a particle array stored with the given
+// layout.
+
+static inline void
+store_particle( particle_t * ALIGNED(128) p0,
+                int layout,
+                int n,
+                const particle_t * p )
+{
+  if ( layout == PARTICLE_LAYOUT_AOSOA )
+  {
+    particle_block_t * pb = PARTICLE_BLOCK_PTR( p0, n );
+    const int l = PARTICLE_BLOCK_LANE( n );
+
+    pb->dx[l] = p->dx; pb->dy[l] = p->dy; pb->dz[l] = p->dz; pb->i[l] = p->i;
+    pb->ux[l] = p->ux; pb->uy[l] = p->uy; pb->uz[l] = p->uz; pb->w[l] = p->w;
+  }
+
+  else
+  {
+    p0[n] = *p;
+  }
+}
+
+// Voxel index of particle n of a particle array stored with the given
+// layout.
+
+static inline int32_t *
+particle_voxel( particle_t * ALIGNED(128) p0,
+                int layout,
+                int n )
+{
+  return layout == PARTICLE_LAYOUT_AOSOA ?
+    &PARTICLE_BLOCK_PTR( p0, n )->i[ PARTICLE_BLOCK_LANE( n ) ] : &p0[n].i;
+}
+
+#endif // _species_advance_aosoa_h_
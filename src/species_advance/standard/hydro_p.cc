@@ -14,7 +14,14 @@ accumulate_hydro_p( /**/  hydro_array_t        * RESTRICT ha,
                     const interpolator_array_t * RESTRICT ia,
                     const bool                            charge_weight)
 {
+  // The hydro pipelines only know about the AoS particle layout.  The
+  // species is converted there and back, leaving it logically unchanged.
+  species_t * sp_aos = (species_t *)sp;
+  int layout = sp_aos ? set_species_layout(sp_aos, PARTICLE_LAYOUT_AOS) : 0;
+
   // Once more options are available, this should be conditionally executed
   // based on user choice.
   accumulate_hydro_p_pipeline(ha, sp, ia, charge_weight);
+
+  if( sp_aos ) set_species_layout(sp_aos, layout);
 }
@@ -20,6 +20,187 @@
 //
 // Note: changes here likely need to be reflected in SPE accelerated
 // version as well.
+//
+// move_p_kernel deposits either into the accumulator array a0 (at is
+// NULL) or into the accumulator tiles at.  It is inlined into each
+// entry point below so each gets a specialized copy.  ACCUMULATOR may
+// branch, so it is used before the current arithmetic to keep that in
+// one basic block (FMA contraction does not cross blocks).
+
+#define ACCUMULATOR( v ) ( at ? tile_accumulator( at, v ) : a0 + (v) )
+
+// migrate_p is called by move_p_kernel when a particle stops on a face
+// of voxel p->i joined to a remote voxel.  pm holds the remaining
+// displacement.  If the move ends in a ghost voxel of a domain sharing
+// an edge or a corner with the local one that the particle can migrate
+// to directly (see setup_particle_migration), the move is finished here
+// through the ghost voxels and the particle is left in the final ghost
+// voxel with p->i = 8*voxel + MIGRATE_FACE.  boundary_p sends it along
+// with the current deposited in the ghost accumulators straight to that
+// domain instead of letting it hop through the intermediate domains
+// over several exchanges.  Otherwise, p->i = 8*voxel + face as usual.
+//
+// The straight line move through the ghost voxels needs no neighbor
+// lookup.  It is done twice, first without depositing current to find
+// where it ends.  As both passes do the same arithmetic as move_p_kernel,
+// the ghost voxel found is exactly where hopping would have left the
+// particle.  A move longer than a voxel (e.g. of a subcycled species)
+// can cross the faces along an axis more than once.  It could then leave
+// the one voxel ghost shell or deposit current in ghost voxels that are
+// not next to the final one (boundary_p only ships those), so such a
+// particle hops as usual.
+
+static void
+migrate_p( particle_t          * ALIGNED(32) p,
+           particle_mover_t    * ALIGNED(16) pm,
+           accumulator_t       * ALIGNED(128) a0,
+           accumulator_tiles_t *              at,
+           const grid_t        *              g,
+           const float                        qsp,
+           const int                          face )
+{
+  const int n[3]      = { g->nx, g->ny, g->nz };
+  const int stride[3] = { g->sx, g->sy, g->sz };
+
+  float r[3], d[3];
+  float s_mid[3], s_disp[3], s_dir[3];
+  float v0, v1, v2, v3, v4, v5, q;
+  int c[3], R[3], crossed[3], axis, b, pass, i;
+  float * a;
+
+  q = qsp * p->w;
+
+  for( pass = 0; pass < 2; pass++ )
+  {
+    // Cross the face the particle stopped on and move through the ghost
+    // voxels as in move_p_kernel.
+
+    r[0] = p->dx;     r[1] = p->dy;     r[2] = p->dz;
+    d[0] = pm->dispx; d[1] = pm->dispy; d[2] = pm->dispz;
+
+    axis  = face % 3;
+    i     = p->i + ( face < 3 ? -stride[axis] : stride[axis] );
+    r[axis] = -r[axis];
+
+    crossed[0] = crossed[1] = crossed[2] = 0;
+    crossed[axis] = 1;
+
+    for( ;; )
+    {
+      for( b = 0; b < 3; b++ )
+      {
+        s_mid [b] = r[b];
+        s_disp[b] = d[b];
+        s_dir [b] = ( s_disp[b] > 0.0f ) ? 1.0f : -1.0f;
+      }
+
+      v0 = ( s_disp[0] == 0.0f ) ? 3.4e38f : ( s_dir[0] - s_mid[0] ) / s_disp[0];
+      v1 = ( s_disp[1] == 0.0f ) ? 3.4e38f : ( s_dir[1] - s_mid[1] ) / s_disp[1];
+      v2 = ( s_disp[2] == 0.0f ) ? 3.4e38f : ( s_dir[2] - s_mid[2] ) / s_disp[2];
+
+      /**/           v3 = 2.0f, axis = 3;
+      if ( v0 < v3 ) v3 = v0,   axis = 0;
+      if ( v1 < v3 ) v3 = v1,   axis = 1;
+      if ( v2 < v3 ) v3 = v2,   axis = 2;
+      v3 *= 0.5f;
+
+      for( b = 0; b < 3; b++ )
+      {
+        s_disp[b] *= v3;
+        s_mid [b] += s_disp[b];
+      }
+
+      if ( pass )
+      {
+        a  = (float *) ACCUMULATOR( i );
+
+        v5 = q * s_disp[0] * s_disp[1] * s_disp[2] * ( 1.0 / 3.0 );
+
+        #define accumulate_j(X,Y,Z)                                       \
+        v4  = q*s_disp[X];    /* v2 = q ux                            */  \
+        v1  = v4*s_mid[Y];    /* v1 = q ux dy                         */  \
+        v0  = v4-v1;          /* v0 = q ux (1-dy)                     */  \
+        v1 += v4;             /* v1 = q ux (1+dy)                     */  \
+        v4  = 1+s_mid[Z];     /* v4 = 1+dz                            */  \
+        v2  = v0*v4;          /* v2 = q ux (1-dy)(1+dz)               */  \
+        v3  = v1*v4;          /* v3 = q ux (1+dy)(1+dz)               */  \
+        v4  = 1-s_mid[Z];     /* v4 = 1-dz                            */  \
+        v0 *= v4;             /* v0 = q ux (1-dy)(1-dz)               */  \
+        v1 *= v4;             /* v1 = q ux (1+dy)(1-dz)               */  \
+        v0 += v5;             /* v0 = q ux [ (1-dy)(1-dz) + uy*uz/3 ] */  \
+        v1 -= v5;             /* v1 = q ux [ (1+dy)(1-dz) - uy*uz/3 ] */  \
+        v2 -= v5;             /* v2 = q ux [ (1-dy)(1+dz) - uy*uz/3 ] */  \
+        v3 += v5;             /* v3 = q ux [ (1+dy)(1+dz) + uy*uz/3 ] */  \
+        a[0] += v0;                                                       \
+        a[1] += v1;                                                       \
+        a[2] += v2;                                                       \
+        a[3] += v3
+
+        accumulate_j(0,1,2); a += 4;
+        accumulate_j(1,2,0); a += 4;
+        accumulate_j(2,0,1);
+
+        #undef accumulate_j
+      }
+
+      for( b = 0; b < 3; b++ )
+      {
+        d[b] -= s_disp[b];
+        r[b] += s_disp[b] + s_disp[b];
+      }
+
+      if ( axis == 3 )
+      {
+        break;
+      }
+
+      // The ghost voxel on the other side of the face is next.
+
+      v0 = s_dir[axis];
+
+      i      += v0 > 0.0f ? stride[axis] : -stride[axis];
+      r[axis] = -v0;
+
+      if ( crossed[axis]++ )
+      {
+        p->i = 8 * p->i + face;
+
+        return;
+      }
+    }
+
+    if ( pass )
+    {
+      break;
+    }
+
+    // Find the domain the final ghost voxel belongs to.  Moves ending
+    // in a face neighbor complete in one hop; they are left to it.
+
+    c[2] = i / stride[2];
+    c[1] = ( i - c[2]*stride[2] ) / stride[1];
+    c[0] =   i - c[2]*stride[2] - c[1]*stride[1];
+
+    for( b = 0; b < 3; b++ )
+    {
+      R[b] = c[b] < 1 ? -1 : ( c[b] > n[b] ? 1 : 0 );
+    }
+
+    if ( ( !R[0] ) + ( !R[1] ) + ( !R[2] ) > 1 ||
+         g->migrate[ BOUNDARY( R[0], R[1], R[2] ) ] <  0 ||
+         g->migrate[ BOUNDARY( R[0], R[1], R[2] ) ] == world_rank )
+    {
+      p->i = 8 * p->i + face;
+
+      return;
+    }
+  }
+
+  p->dx     = r[0]; p->dy     = r[1]; p->dz     = r[2];
+  pm->dispx = d[0]; pm->dispy = d[1]; pm->dispz = d[2];
+
+  p->i = 8 * i + MIGRATE_FACE;
+}
 
 #if defined(V4_ACCELERATION)
 
@@ -27,12 +208,13 @@
 
 using namespace v4;
 
-int
-move_p( particle_t       * RESTRICT ALIGNED(128) p,
-        particle_mover_t * RESTRICT ALIGNED(16)  pm,
-        accumulator_t    * RESTRICT ALIGNED(128) a,
-        const grid_t     *                       g,
-        const float                              qsp )
+static inline int
+move_p_kernel( particle_t          * RESTRICT ALIGNED(128) p,
+               particle_mover_t    * RESTRICT ALIGNED(16)  pm,
+               accumulator_t       * RESTRICT ALIGNED(128) a0,
+               accumulator_tiles_t *                       at,
+               const grid_t        *                       g,
+               const float                                 qsp )
 {
   /*const*/ v4float one( 1.0f );
   /*const*/ v4float tiny( 1.0e-37f );
@@ -141,9 +323,11 @@ move_p( particle_t       * RESTRICT ALIGNED(128) p,
 
     transpose( v0, v1, v2, v3 );
 
-    increment_4x1( a[voxel].jx, v0 );
-    increment_4x1( a[voxel].jy, v1 );
-    increment_4x1( a[voxel].jz, v2 );
+    accumulator_t * ALIGNED(16) av = ACCUMULATOR( voxel );
+
+    increment_4x1( av->jx, v0 );
+    increment_4x1( av->jy, v1 );
+    increment_4x1( av->jz, v2 );
 
     // If streak ended at the end of the particle track, this mover
     // was succesfully processed.  Should be just under ~50% of the
@@ -195,8 +379,9 @@ move_p( particle_t       * RESTRICT ALIGNED(128) p,
       // particle position and update the remaining displacement in
       // the particle mover.
 
-      store_4x1( r, &p[n].dx );    p[n].i = 8*voxel + type;
+      store_4x1( r, &p[n].dx );    p[n].i = voxel;
       store_4x1( dr, &pm->dispx ); pm->i  = n;
+      migrate_p( p + n, pm, a0, at, g, qsp, type );
       return 1; // Mover still in use
     }
 
@@ -212,12 +397,13 @@ move_p( particle_t       * RESTRICT ALIGNED(128) p,
 
 #else
 
-int
-move_p( particle_t       * ALIGNED(128) p0,
-        particle_mover_t * ALIGNED(16)  pm,
-        accumulator_t    * ALIGNED(128) a0,
-        const grid_t     *              g,
-        const float                     qsp )
+static inline int
+move_p_kernel( particle_t          * ALIGNED(128) p0,
+               particle_mover_t    * ALIGNED(16)  pm,
+               accumulator_t       * ALIGNED(128) a0,
+               accumulator_tiles_t *              at,
+               const grid_t        *              g,
+               const float                        qsp )
 {
   float s_midx, s_midy, s_midz;
   float s_dispx, s_dispy, s_dispz;
@@ -274,9 +460,9 @@ move_p( particle_t       * ALIGNED(128) p0,
     // Accumulate the streak.  Note: accumulator values are 4 times
     // the total physical charge that passed through the appropriate
     // current quadrant in a time-step
-    v5 = q * s_dispx * s_dispy * s_dispz * ( 1.0 / 3.0 );
+    a  = (float *) ACCUMULATOR( p->i );
 
-    a  = (float *) ( a0 + p->i );
+    v5 = q * s_dispx * s_dispy * s_dispz * ( 1.0 / 3.0 );
 
     #define accumulate_j(X,Y,Z)                                       \
     v4  = q*s_disp##X;    /* v2 = q ux                            */  \
@@ -361,7 +547,7 @@ move_p( particle_t       * ALIGNED(128) p0,
       // Cannot handle the boundary condition here.  Save the updated
       // particle position, face it hit and update the remaining
       // displacement in the particle mover.
-      p->i = 8 * p->i + face;
+      migrate_p( p, pm, a0, at, g, qsp, face );
 
       return 1; // Return "mover still in use"
     }
@@ -378,3 +564,79 @@ move_p( particle_t       * ALIGNED(128) p0,
 }
 
 #endif
+
+#undef ACCUMULATOR
+
+int
+move_p( particle_t       * ALIGNED(128) p0,
+        particle_mover_t * ALIGNED(16)  pm,
+        accumulator_t    * ALIGNED(128) a0,
+        const grid_t     *              g,
+        const float                     qsp )
+{
+  return move_p_kernel( p0, pm, a0, NULL, g, qsp );
+}
+
+int
+move_p_tiles( particle_t          * ALIGNED(128) p0,
+              particle_mover_t    * ALIGNED(16)  pm,
+              accumulator_tiles_t *              at,
+              const grid_t        *              g,
+              const float                        qsp )
+{
+  return move_p_kernel( p0, pm, NULL, at, g, qsp );
+}
+
+// The AoSoA variants gather the particle into a temporary, move it with
+// the AoS move_p and scatter the result back.  This is only done for the
+// small fraction of particles that leave their voxel during a step.
+
+static inline int
+move_p_aosoa_kernel( particle_t          * ALIGNED(128) p0,
+                     particle_mover_t    * ALIGNED(16)  pm,
+                     accumulator_t       * ALIGNED(128) a0,
+                     accumulator_tiles_t *              at,
+                     const grid_t        *              g,
+                     const float                        qsp )
+{
+  DECLARE_ALIGNED_ARRAY( particle_t,       128, p, 1 );
+  DECLARE_ALIGNED_ARRAY( particle_mover_t, 16,  m, 1 );
+  int ret;
+
+  load_particle( p0, PARTICLE_LAYOUT_AOSOA, pm->i, p );
+
+  m->dispx = pm->dispx;
+  m->dispy = pm->dispy;
+  m->dispz = pm->dispz;
+  m->i     = 0;
+
+  ret = move_p_kernel( p, m, a0, at, g, qsp );
+
+  store_particle( p0, PARTICLE_LAYOUT_AOSOA, pm->i, p );
+
+  pm->dispx = m->dispx;
+  pm->dispy = m->dispy;
+  pm->dispz = m->dispz;
+
+  return ret;
+}
+
+int
+move_p_aosoa( particle_t       * ALIGNED(128) p0,
+              particle_mover_t * ALIGNED(16)  pm,
+              accumulator_t    * ALIGNED(128) a0,
+              const grid_t     *              g,
+              const float                     qsp )
+{
+  return move_p_aosoa_kernel( p0, pm, a0, NULL, g, qsp );
+}
+
+int
+move_p_aosoa_tiles( particle_t          * ALIGNED(128) p0,
+                    particle_mover_t    * ALIGNED(16)  pm,
+                    accumulator_tiles_t *              at,
+                    const grid_t        *              g,
+                    const float                        qsp )
+{
+  return move_p_aosoa_kernel( p0, pm, NULL, at, g, qsp );
+}
@@ -13,8 +13,8 @@
 
 //----------------------------------------------------------------------------//
 // Reference implementation for an advance_p pipeline function which does not
-// make use of explicit calls to vector intrinsic functions. This is the AoS
-// version.
+// make use of explicit calls to vector intrinsic functions. Particles stored
+// in the AoSoA layout are gathered into a temporary one at a time.
 //----------------------------------------------------------------------------//
 
 void
@@ -23,7 +23,7 @@ advance_p_pipeline_scalar( advance_p_pipeline_args_t * args,
                            int n_pipeline )
 {
   particle_t           * ALIGNED(128) p0 = args->p0;
-  accumulator_t        * ALIGNED(128) a0 = args->a0;
+  accumulator_tiles_t  *              at = args->at;
   const interpolator_t * ALIGNED(128) f0 = args->f0;
   const grid_t *                      g  = args->g;
 
@@ -46,15 +46,19 @@ advance_p_pipeline_scalar( advance_p_pipeline_args_t * args,
   float v0, v1, v2, v3, v4, v5;
   int   ii;
 
-  int itmp, n, nm, max_nm;
+  int itmp, n, nm, max_nm, ip;
+
+  const int layout = args->layout;
 
   DECLARE_ALIGNED_ARRAY( particle_mover_t, 16, local_pm, 1 );
 
+  DECLARE_ALIGNED_ARRAY( particle_t, 32, local_p, 1 );
+
   // Determine which quads of particles quads this pipeline processes.
 
-  DISTRIBUTE( args->np, 16, pipeline_rank, n_pipeline, itmp, n );
+  DISTRIBUTE( PIPELINE_NP( args ), 16, pipeline_rank, n_pipeline, itmp, n );
 
-  p = args->p0 + itmp;
+  ip = itmp;
 
   // Determine which movers are reserved for this pipeline.
   // Movers (16 bytes) should be reserved for pipelines in at least
@@ -75,19 +79,30 @@ advance_p_pipeline_scalar( advance_p_pipeline_args_t * args,
   nm   = 0;
   itmp = 0;
 
-  // Determine which accumulator array to use.
-  // The host gets the first accumulator array.
+  // Determine which accumulator tiles to use.
+  // The host gets the tiles mapping the host accumulator.
 
   if ( pipeline_rank != n_pipeline )
   {
-    a0 += ( 1 + pipeline_rank ) *
-          POW2_CEIL( (args->nx+2)*(args->ny+2)*(args->nz+2), 2 );
+    at += 1 + pipeline_rank;
   }
 
   // Process particles for this pipeline.
 
-  for( ; n; n--, p++ )
+  for( ; n; n--, ip++ )
   {
+    if ( layout == PARTICLE_LAYOUT_AOSOA )    // Gather from the tile
+    {
+      p = local_p;
+
+      load_particle( p0, layout, ip, p );
+    }
+
+    else
+    {
+      p = p0 + ip;
+    }
+
     dx   = p->dx;                             // Load position
     dy   = p->dy;
     dz   = p->dz;
@@ -175,14 +190,19 @@ advance_p_pipeline_scalar( advance_p_pipeline_args_t * args,
       p->dy = v4;
       p->dz = v5;
 
+      if ( layout == PARTICLE_LAYOUT_AOSOA )  // Scatter to the tile
+      {
+        store_particle( p0, layout, ip, p );
+      }
+
+      a  = (float *) tile_accumulator( at, ii ); // Get accumulator
+
       dx = v0;                                // Streak midpoint
       dy = v1;
       dz = v2;
 
       v5 = q*ux*uy*uz*one_third;              // Compute correction
 
-      a  = (float *)( a0 + ii );              // Get accumulator
-
       #define ACCUMULATE_J(X,Y,Z,offset)                                \
       v4  = q*u##X;   /* v4 = q ux                            */        \
       v1  = v4*d##Y;  /* v1 = q ux dy                         */        \
@@ -216,9 +236,17 @@ advance_p_pipeline_scalar( advance_p_pipeline_args_t * args,
       local_pm->dispy = uy;
       local_pm->dispz = uz;
 
-      local_pm->i     = p - p0;
+      local_pm->i     = ip;
+
+      if ( layout == PARTICLE_LAYOUT_AOSOA )  // Scatter to the tile
+      {
+        store_particle( p0, layout, ip, p );
+      }
 
-      if ( move_p( p0, local_pm, a0, g, qsp ) ) // Unlikely
+      if ( ip < args->np &&                   // Not tile padding
+           ( layout == PARTICLE_LAYOUT_AOSOA ?
+             move_p_aosoa_tiles( p0, local_pm, at, g, qsp ) :
+             move_p_tiles      ( p0, local_pm, at, g, qsp ) ) ) // Unlikely
       {
         if ( nm < max_nm )
         {
@@ -266,18 +294,23 @@ advance_p_pipeline( species_t * RESTRICT sp,
 
   args->p0      = sp->p;
   args->pm      = sp->pm;
-  args->a0      = aa->a;
+  args->at      = aa->tiles;
   args->f0      = ia->i;
   args->seg     = seg;
   args->g       = sp->g;
 
-  args->qdt_2mc = ( sp->q * sp->g->dt ) / ( 2 * sp->m * sp->g->cvac );
-  args->cdt_dx  = sp->g->cvac * sp->g->dt * sp->g->rdx;
-  args->cdt_dy  = sp->g->cvac * sp->g->dt * sp->g->rdy;
-  args->cdt_dz  = sp->g->cvac * sp->g->dt * sp->g->rdz;
+  // Subcycled species are pushed subcycle time steps at once.
+
+  const float dt = sp->g->dt * sp->subcycle;
+
+  args->qdt_2mc = ( sp->q * dt ) / ( 2 * sp->m * sp->g->cvac );
+  args->cdt_dx  = sp->g->cvac * dt * sp->g->rdx;
+  args->cdt_dy  = sp->g->cvac * dt * sp->g->rdy;
+  args->cdt_dz  = sp->g->cvac * dt * sp->g->rdz;
   args->qsp     = sp->q;
 
   args->np      = sp->np;
+  args->layout  = sp->layout;
   args->max_nm  = sp->max_nm;
   args->nx      = sp->g->nx;
   args->ny      = sp->g->ny;
@@ -294,6 +327,11 @@ advance_p_pipeline( species_t * RESTRICT sp,
   // However, it is worth reconsidering this at some point in the
   // future.
 
+  if ( sp->layout == PARTICLE_LAYOUT_AOSOA )
+  {
+    pad_particle_blocks( sp->p, sp->np );
+  }
+
   EXEC_PIPELINES( advance_p, args, 0 );
 
   WAIT_PIPELINES();
@@ -24,11 +24,12 @@ advance_p_pipeline_v16( advance_p_pipeline_args_t * args,
                         int n_pipeline )
 {
   particle_t           * ALIGNED(128) p0 = args->p0;
-  accumulator_t        * ALIGNED(128) a0 = args->a0;
+  accumulator_tiles_t  *              at = args->at;
   const interpolator_t * ALIGNED(128) f0 = args->f0;
   const grid_t         *              g  = args->g;
 
   particle_t           * ALIGNED(128) p;
+  particle_block_t     * ALIGNED(128) pb;
   particle_mover_t     * ALIGNED(16)  pm;
 
   float                * ALIGNED(64)  vp00;
@@ -69,11 +70,13 @@ advance_p_pipeline_v16( advance_p_pipeline_args_t * args,
 
   int itmp, nq, nm, max_nm;
 
+  const int layout = args->layout;
+
   DECLARE_ALIGNED_ARRAY( particle_mover_t, 16, local_pm, 1 );
 
   // Determine which blocks of particle quads this pipeline processes.
 
-  DISTRIBUTE( args->np, 16, pipeline_rank, n_pipeline, itmp, nq );
+  DISTRIBUTE( PIPELINE_NP( args ), 16, pipeline_rank, n_pipeline, itmp, nq );
 
   p = args->p0 + itmp;
 
@@ -98,13 +101,12 @@ advance_p_pipeline_v16( advance_p_pipeline_args_t * args,
   nm   = 0;
   itmp = 0;
 
-  // Determine which accumulator array to use.
-  // The host gets the first accumulator array.
+  // Determine which accumulator tiles to use.
+  // The host gets the tiles mapping the host accumulator.
 
   if ( pipeline_rank != n_pipeline )
   {
-    a0 += ( 1 + pipeline_rank ) *
-          POW2_CEIL( (args->nx+2)*(args->ny+2)*(args->nz+2), 2 );
+    at += 1 + pipeline_rank;
   }
 
   // Process the particle blocks for this pipeline.
@@ -112,11 +114,28 @@ advance_p_pipeline_v16( advance_p_pipeline_args_t * args,
   for( ; nq; nq--, p+=16 )
   {
     //--------------------------------------------------------------------------
-    // Load particle data.
+    // Load particle data.  An AoSoA tile is already in vector order.
     //--------------------------------------------------------------------------
-    load_16x8_tr_p( &p[ 0].dx, &p[ 2].dx, &p[ 4].dx, &p[ 6].dx,
-                    &p[ 8].dx, &p[10].dx, &p[12].dx, &p[14].dx,
-                    dx, dy, dz, ii, ux, uy, uz, q );
+    if ( layout == PARTICLE_LAYOUT_AOSOA )
+    {
+      pb = PARTICLE_BLOCK_PTR( p0, p - p0 );
+
+      load_16x1( pb->dx, dx );
+      load_16x1( pb->dy, dy );
+      load_16x1( pb->dz, dz );
+      load_16x1( pb->i,  ii );
+      load_16x1( pb->ux, ux );
+      load_16x1( pb->uy, uy );
+      load_16x1( pb->uz, uz );
+      load_16x1( pb->w,  q  );
+    }
+
+    else
+    {
+      load_16x8_tr_p( &p[ 0].dx, &p[ 2].dx, &p[ 4].dx, &p[ 6].dx,
+                      &p[ 8].dx, &p[10].dx, &p[12].dx, &p[14].dx,
+                      dx, dy, dz, ii, ux, uy, uz, q );
+    }
 
     //--------------------------------------------------------------------------
     // Set field interpolation pointers.
@@ -241,9 +260,44 @@ advance_p_pipeline_v16( advance_p_pipeline_args_t * args,
     //--------------------------------------------------------------------------
     // Store particle data, final.
     //--------------------------------------------------------------------------
-    store_16x8_tr_p( v03, v04, v05, ii, v06, v07, v08, q,
-                     &p[ 0].dx, &p[ 2].dx, &p[ 4].dx, &p[ 6].dx,
-                     &p[ 8].dx, &p[10].dx, &p[12].dx, &p[14].dx );
+    if ( layout == PARTICLE_LAYOUT_AOSOA )
+    {
+      store_16x1( v03, pb->dx );
+      store_16x1( v04, pb->dy );
+      store_16x1( v05, pb->dz );
+      store_16x1( v06, pb->ux );
+      store_16x1( v07, pb->uy );
+      store_16x1( v08, pb->uz );
+    }
+
+    else
+    {
+      store_16x8_tr_p( v03, v04, v05, ii, v06, v07, v08, q,
+                       &p[ 0].dx, &p[ 2].dx, &p[ 4].dx, &p[ 6].dx,
+                       &p[ 8].dx, &p[10].dx, &p[12].dx, &p[14].dx );
+    }
+
+    //--------------------------------------------------------------------------
+    // Set current density accumulation pointers.  Taking ownership of a
+    // tile branches, so this is done before the current arithmetic to keep
+    // that in one basic block (FMA contraction does not cross blocks).
+    //--------------------------------------------------------------------------
+    vp00 = ( float * ALIGNED(64) ) tile_accumulator( at, ii( 0) );
+    vp01 = ( float * ALIGNED(64) ) tile_accumulator( at, ii( 1) );
+    vp02 = ( float * ALIGNED(64) ) tile_accumulator( at, ii( 2) );
+    vp03 = ( float * ALIGNED(64) ) tile_accumulator( at, ii( 3) );
+    vp04 = ( float * ALIGNED(64) ) tile_accumulator( at, ii( 4) );
+    vp05 = ( float * ALIGNED(64) ) tile_accumulator( at, ii( 5) );
+    vp06 = ( float * ALIGNED(64) ) tile_accumulator( at, ii( 6) );
+    vp07 = ( float * ALIGNED(64) ) tile_accumulator( at, ii( 7) );
+    vp08 = ( float * ALIGNED(64) ) tile_accumulator( at, ii( 8) );
+    vp09 = ( float * ALIGNED(64) ) tile_accumulator( at, ii( 9) );
+    vp10 = ( float * ALIGNED(64) ) tile_accumulator( at, ii(10) );
+    vp11 = ( float * ALIGNED(64) ) tile_accumulator( at, ii(11) );
+    vp12 = ( float * ALIGNED(64) ) tile_accumulator( at, ii(12) );
+    vp13 = ( float * ALIGNED(64) ) tile_accumulator( at, ii(13) );
+    vp14 = ( float * ALIGNED(64) ) tile_accumulator( at, ii(14) );
+    vp15 = ( float * ALIGNED(64) ) tile_accumulator( at, ii(15) );
 
     // Accumulate current of inbnd particles.
     // Note: accumulator values are 4 times the total physical charge that
@@ -256,26 +310,6 @@ advance_p_pipeline_v16( advance_p_pipeline_args_t * args,
 
     v15 = q*ux*uy*uz*one_third;    // Charge conservation correction
 
-    //--------------------------------------------------------------------------
-    // Set current density accumulation pointers.
-    //--------------------------------------------------------------------------
-    vp00 = ( float * ALIGNED(64) ) ( a0 + ii( 0) );
-    vp01 = ( float * ALIGNED(64) ) ( a0 + ii( 1) );
-    vp02 = ( float * ALIGNED(64) ) ( a0 + ii( 2) );
-    vp03 = ( float * ALIGNED(64) ) ( a0 + ii( 3) );
-    vp04 = ( float * ALIGNED(64) ) ( a0 + ii( 4) );
-    vp05 = ( float * ALIGNED(64) ) ( a0 + ii( 5) );
-    vp06 = ( float * ALIGNED(64) ) ( a0 + ii( 6) );
-    vp07 = ( float * ALIGNED(64) ) ( a0 + ii( 7) );
-    vp08 = ( float * ALIGNED(64) ) ( a0 + ii( 8) );
-    vp09 = ( float * ALIGNED(64) ) ( a0 + ii( 9) );
-    vp10 = ( float * ALIGNED(64) ) ( a0 + ii(10) );
-    vp11 = ( float * ALIGNED(64) ) ( a0 + ii(11) );
-    vp12 = ( float * ALIGNED(64) ) ( a0 + ii(12) );
-    vp13 = ( float * ALIGNED(64) ) ( a0 + ii(13) );
-    vp14 = ( float * ALIGNED(64) ) ( a0 + ii(14) );
-    vp15 = ( float * ALIGNED(64) ) ( a0 + ii(15) );
-
     //--------------------------------------------------------------------------
     // Accumulate current density.
     //--------------------------------------------------------------------------
@@ -384,7 +418,10 @@ advance_p_pipeline_v16( advance_p_pipeline_args_t * args,
       local_pm->dispy = uy(N);                                          \
       local_pm->dispz = uz(N);                                          \
       local_pm->i     = ( p - p0 ) + N;                                 \
-      if ( move_p( p0, local_pm, a0, g, _qsp ) )    /* Unlikely */      \
+      if ( local_pm->i < args->np &&                /* Not padding */   \
+           ( layout == PARTICLE_LAYOUT_AOSOA ?                          \
+             move_p_aosoa_tiles( p0, local_pm, at, g, _qsp ) :          \
+             move_p_tiles( p0, local_pm, at, g, _qsp ) ) ) /* Unlikely */ \
       {                                                                 \
         if ( nm < max_nm )                                              \
         {                                                               \
@@ -12,11 +12,12 @@ advance_p_pipeline_v8( advance_p_pipeline_args_t * args,
                        int n_pipeline )
 {
   particle_t           * ALIGNED(128) p0 = args->p0;
-  accumulator_t        * ALIGNED(128) a0 = args->a0;
+  accumulator_tiles_t  *              at = args->at;
   const interpolator_t * ALIGNED(128) f0 = args->f0;
   const grid_t         *              g  = args->g;
 
   particle_t           * ALIGNED(128) p;
+  particle_block_t     * ALIGNED(128) pb;
   particle_mover_t     * ALIGNED(16)  pm;
 
   float                * ALIGNED(32)  vp00;
@@ -46,13 +47,15 @@ advance_p_pipeline_v8( advance_p_pipeline_args_t * args,
   v8float v00, v01, v02, v03, v04, v05, v06, v07, v08, v09;
   v8int   ii, outbnd;
 
-  int itmp, nq, nm, max_nm;
+  int itmp, nq, nm, max_nm, l;
+
+  const int layout = args->layout;
 
   DECLARE_ALIGNED_ARRAY( particle_mover_t, 16, local_pm, 1 );
 
   // Determine which quads of particle quads this pipeline processes.
 
-  DISTRIBUTE( args->np, 16, pipeline_rank, n_pipeline, itmp, nq );
+  DISTRIBUTE( PIPELINE_NP( args ), 16, pipeline_rank, n_pipeline, itmp, nq );
 
   p = args->p0 + itmp;
 
@@ -77,13 +80,12 @@ advance_p_pipeline_v8( advance_p_pipeline_args_t * args,
   nm   = 0;
   itmp = 0;
 
-  // Determine which accumulator array to use.
-  // The host gets the first accumulator array.
+  // Determine which accumulator tiles to use.
+  // The host gets the tiles mapping the host accumulator.
 
   if ( pipeline_rank != n_pipeline )
   {
-    a0 += ( 1 + pipeline_rank ) *
-          POW2_CEIL( (args->nx+2)*(args->ny+2)*(args->nz+2), 2 );
+    at += 1 + pipeline_rank;
   }
 
   // Process the particle blocks for this pipeline.
@@ -91,11 +93,29 @@ advance_p_pipeline_v8( advance_p_pipeline_args_t * args,
   for( ; nq; nq--, p+=8 )
   {
     //--------------------------------------------------------------------------
-    // Load particle data.
+    // Load particle data.  AoSoA tiles are already in vector order.
     //--------------------------------------------------------------------------
-    load_8x8_tr( &p[0].dx, &p[1].dx, &p[2].dx, &p[3].dx,
-                 &p[4].dx, &p[5].dx, &p[6].dx, &p[7].dx,
-                 dx, dy, dz, ii, ux, uy, uz, q );
+    if ( layout == PARTICLE_LAYOUT_AOSOA )
+    {
+      pb = PARTICLE_BLOCK_PTR( p0, p - p0 );
+      l  = PARTICLE_BLOCK_LANE( p - p0 );
+
+      load_8x1( &pb->dx[l], dx );
+      load_8x1( &pb->dy[l], dy );
+      load_8x1( &pb->dz[l], dz );
+      load_8x1( &pb->i [l], ii );
+      load_8x1( &pb->ux[l], ux );
+      load_8x1( &pb->uy[l], uy );
+      load_8x1( &pb->uz[l], uz );
+      load_8x1( &pb->w [l], q  );
+    }
+
+    else
+    {
+      load_8x8_tr( &p[0].dx, &p[1].dx, &p[2].dx, &p[3].dx,
+                   &p[4].dx, &p[5].dx, &p[6].dx, &p[7].dx,
+                   dx, dy, dz, ii, ux, uy, uz, q );
+    }
 
     //--------------------------------------------------------------------------
     // Set field interpolation pointers.
@@ -214,9 +234,36 @@ advance_p_pipeline_v8( advance_p_pipeline_args_t * args,
     //--------------------------------------------------------------------------
     // Store particle data, final.
     //--------------------------------------------------------------------------
-    store_8x8_tr( v03, v04, v05, ii, v06, v07, v08, q,
-                  &p[0].dx, &p[1].dx, &p[2].dx, &p[3].dx,
-                  &p[4].dx, &p[5].dx, &p[6].dx, &p[7].dx );
+    if ( layout == PARTICLE_LAYOUT_AOSOA )
+    {
+      store_8x1( v03, &pb->dx[l] );
+      store_8x1( v04, &pb->dy[l] );
+      store_8x1( v05, &pb->dz[l] );
+      store_8x1( v06, &pb->ux[l] );
+      store_8x1( v07, &pb->uy[l] );
+      store_8x1( v08, &pb->uz[l] );
+    }
+
+    else
+    {
+      store_8x8_tr( v03, v04, v05, ii, v06, v07, v08, q,
+                    &p[0].dx, &p[1].dx, &p[2].dx, &p[3].dx,
+                    &p[4].dx, &p[5].dx, &p[6].dx, &p[7].dx );
+    }
+
+    //--------------------------------------------------------------------------
+    // Set current density accumulation pointers.  Taking ownership of a
+    // tile branches, so this is done before the current arithmetic to keep
+    // that in one basic block (FMA contraction does not cross blocks).
+    //--------------------------------------------------------------------------
+    vp00 = ( float * ALIGNED(32) ) tile_accumulator( at, ii( 0) );
+    vp01 = ( float * ALIGNED(32) ) tile_accumulator( at, ii( 1) );
+    vp02 = ( float * ALIGNED(32) ) tile_accumulator( at, ii( 2) );
+    vp03 = ( float * ALIGNED(32) ) tile_accumulator( at, ii( 3) );
+    vp04 = ( float * ALIGNED(32) ) tile_accumulator( at, ii( 4) );
+    vp05 = ( float * ALIGNED(32) ) tile_accumulator( at, ii( 5) );
+    vp06 = ( float * ALIGNED(32) ) tile_accumulator( at, ii( 6) );
+    vp07 = ( float * ALIGNED(32) ) tile_accumulator( at, ii( 7) );
 
     // Accumulate current of inbnd particles.
     // Note: accumulator values are 4 times the total physical charge that
@@ -229,18 +276,6 @@ advance_p_pipeline_v8( advance_p_pipeline_args_t * args,
 
     v09 = q*ux*uy*uz*one_third;    // Charge conservation correction
 
-    //--------------------------------------------------------------------------
-    // Set current density accumulation pointers.
-    //--------------------------------------------------------------------------
-    vp00 = ( float * ALIGNED(32) ) ( a0 + ii( 0) );
-    vp01 = ( float * ALIGNED(32) ) ( a0 + ii( 1) );
-    vp02 = ( float * ALIGNED(32) ) ( a0 + ii( 2) );
-    vp03 = ( float * ALIGNED(32) ) ( a0 + ii( 3) );
-    vp04 = ( float * ALIGNED(32) ) ( a0 + ii( 4) );
-    vp05 = ( float * ALIGNED(32) ) ( a0 + ii( 5) );
-    vp06 = ( float * ALIGNED(32) ) ( a0 + ii( 6) );
-    vp07 = ( float * ALIGNED(32) ) ( a0 + ii( 7) );
-
     //--------------------------------------------------------------------------
     // Accumulate current density.
     //--------------------------------------------------------------------------
@@ -353,7 +388,10 @@ advance_p_pipeline_v8( advance_p_pipeline_args_t * args,
       local_pm->dispy = uy(N);                                          \
       local_pm->dispz = uz(N);                                          \
       local_pm->i     = ( p - p0 ) + N;                                 \
-      if ( move_p( p0, local_pm, a0, g, _qsp ) )    /* Unlikely */      \
+      if ( local_pm->i < args->np &&                /* Not padding */   \
+           ( layout == PARTICLE_LAYOUT_AOSOA ?                          \
+             move_p_aosoa_tiles( p0, local_pm, at, g, _qsp ) :          \
+             move_p_tiles( p0, local_pm, at, g, _qsp ) ) ) /* Unlikely */ \
       {                                                                 \
         if ( nm < max_nm )                                              \
         {                                                               \
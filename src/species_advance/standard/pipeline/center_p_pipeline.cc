@@ -10,7 +10,8 @@
 
 //----------------------------------------------------------------------------//
 // Reference implementation for a center_p pipeline function which does not
-// make use of explicit calls to vector intrinsic functions.
+// make use of explicit calls to vector intrinsic functions. Particles stored
+// in the AoSoA layout are gathered into a temporary one at a time.
 //----------------------------------------------------------------------------//
 
 void
@@ -37,16 +38,30 @@ center_p_pipeline_scalar( center_p_pipeline_args_t * args,
 
   int first, n;
 
-  // Determine which particles this pipeline processes.
+  const int layout = args->layout;
+
+  DECLARE_ALIGNED_ARRAY( particle_t, 32, local_p, 1 );
 
-  DISTRIBUTE( args->np, 16, pipeline_rank, n_pipeline, first, n );
+  // Determine which particles this pipeline processes.
 
-  p = args->p0 + first;
+  DISTRIBUTE( PIPELINE_NP( args ), 16, pipeline_rank, n_pipeline, first, n );
 
   // Process particles for this pipeline.
 
-  for( ; n; n--, p++ )
+  for( ; n; n--, first++ )
   {
+    if ( layout == PARTICLE_LAYOUT_AOSOA )   // Gather from the tile
+    {
+      p = local_p;
+
+      load_particle( args->p0, layout, first, p );
+    }
+
+    else
+    {
+      p = args->p0 + first;
+    }
+
     dx   = p->dx;                            // Load position
     dy   = p->dy;
     dz   = p->dz;
@@ -94,6 +109,11 @@ center_p_pipeline_scalar( center_p_pipeline_args_t * args,
     p->ux = ux;                              // Store momentum
     p->uy = uy;
     p->uz = uz;
+
+    if ( layout == PARTICLE_LAYOUT_AOSOA )   // Scatter to the tile
+    {
+      store_particle( args->p0, layout, first, p );
+    }
   }
 }
 
@@ -120,8 +140,15 @@ center_p_pipeline( species_t * RESTRICT sp,
 
   args->p0      = sp->p;
   args->f0      = ia->i;
-  args->qdt_2mc = ( sp->q * sp->g->dt ) / ( 2 * sp->m * sp->g->cvac );
+  args->qdt_2mc = ( sp->q * sp->g->dt * sp->subcycle ) /
+                  ( 2 * sp->m * sp->g->cvac );
   args->np      = sp->np;
+  args->layout  = sp->layout;
+
+  if ( sp->layout == PARTICLE_LAYOUT_AOSOA )
+  {
+    pad_particle_blocks( sp->p, sp->np );
+  }
 
   EXEC_PIPELINES( center_p, args, 0 );
 
@@ -14,6 +14,7 @@ center_p_pipeline_v16( center_p_pipeline_args_t * args,
   const interpolator_t * ALIGNED(128) f0 = args->f0;
 
   particle_t           * ALIGNED(128) p;
+  particle_block_t     * ALIGNED(128) pb;
 
   const float          * ALIGNED(64)  vp00;
   const float          * ALIGNED(64)  vp01;
@@ -45,9 +46,11 @@ center_p_pipeline_v16( center_p_pipeline_args_t * args,
 
   int itmp, nq;
 
+  const int layout = args->layout;
+
   // Determine which particle quads this pipeline processes.
 
-  DISTRIBUTE( args->np, 16, pipeline_rank, n_pipeline, itmp, nq );
+  DISTRIBUTE( PIPELINE_NP( args ), 16, pipeline_rank, n_pipeline, itmp, nq );
 
   p = args->p0 + itmp;
 
@@ -58,11 +61,28 @@ center_p_pipeline_v16( center_p_pipeline_args_t * args,
   for( ; nq; nq--, p+=16 )
   {
     //--------------------------------------------------------------------------
-    // Load particle position data.
+    // Load particle position data.  An AoSoA tile is already in vector order.
     //--------------------------------------------------------------------------
-    load_16x8_tr_p( &p[ 0].dx, &p[ 2].dx, &p[ 4].dx, &p[ 6].dx,
-                    &p[ 8].dx, &p[10].dx, &p[12].dx, &p[14].dx,
-		    dx, dy, dz, ii, ux, uy, uz, q );
+    if ( layout == PARTICLE_LAYOUT_AOSOA )
+    {
+      pb = PARTICLE_BLOCK_PTR( args->p0, p - args->p0 );
+
+      load_16x1( pb->dx, dx );
+      load_16x1( pb->dy, dy );
+      load_16x1( pb->dz, dz );
+      load_16x1( pb->i,  ii );
+      load_16x1( pb->ux, ux );
+      load_16x1( pb->uy, uy );
+      load_16x1( pb->uz, uz );
+      load_16x1( pb->w,  q  );
+    }
+
+    else
+    {
+      load_16x8_tr_p( &p[ 0].dx, &p[ 2].dx, &p[ 4].dx, &p[ 6].dx,
+                      &p[ 8].dx, &p[10].dx, &p[12].dx, &p[14].dx,
+                      dx, dy, dz, ii, ux, uy, uz, q );
+    }
 
     //--------------------------------------------------------------------------
     // Set field interpolation pointers.
@@ -140,9 +160,19 @@ center_p_pipeline_v16( center_p_pipeline_args_t * args,
     // Store particle momentum data.  Could use store_16x4_tr_p or
     // store_16x3_tr_p.
     //--------------------------------------------------------------------------
-    store_16x8_tr_p( dx, dy, dz, ii, ux, uy, uz, q,
-                     &p[ 0].dx, &p[ 2].dx, &p[ 4].dx, &p[ 6].dx,
-                     &p[ 8].dx, &p[10].dx, &p[12].dx, &p[14].dx );
+    if ( layout == PARTICLE_LAYOUT_AOSOA )
+    {
+      store_16x1( ux, pb->ux );
+      store_16x1( uy, pb->uy );
+      store_16x1( uz, pb->uz );
+    }
+
+    else
+    {
+      store_16x8_tr_p( dx, dy, dz, ii, ux, uy, uz, q,
+                       &p[ 0].dx, &p[ 2].dx, &p[ 4].dx, &p[ 6].dx,
+                       &p[ 8].dx, &p[10].dx, &p[12].dx, &p[14].dx );
+    }
   }
 }
 
@@ -14,6 +14,7 @@ center_p_pipeline_v8( center_p_pipeline_args_t * args,
   const interpolator_t * ALIGNED(128) f0 = args->f0;
 
   particle_t           * ALIGNED(128) p;
+  particle_block_t     * ALIGNED(128) pb;
 
   const float          * ALIGNED(32)  vp00;
   const float          * ALIGNED(32)  vp01;
@@ -35,11 +36,13 @@ center_p_pipeline_v8( center_p_pipeline_args_t * args,
   v8float v00, v01, v02, v03, v04, v05;
   v8int   ii;
 
-  int itmp, nq;
+  int itmp, nq, l;
+
+  const int layout = args->layout;
 
   // Determine which particle blocks this pipeline processes.
 
-  DISTRIBUTE( args->np, 16, pipeline_rank, n_pipeline, itmp, nq );
+  DISTRIBUTE( PIPELINE_NP( args ), 16, pipeline_rank, n_pipeline, itmp, nq );
 
   p = args->p0 + itmp;
 
@@ -52,9 +55,23 @@ center_p_pipeline_v8( center_p_pipeline_args_t * args,
     //--------------------------------------------------------------------------
     // Load particle position data.
     //--------------------------------------------------------------------------
-    load_8x4_tr( &p[0].dx, &p[1].dx, &p[2].dx, &p[3].dx,
-		 &p[4].dx, &p[5].dx, &p[6].dx, &p[7].dx,
-		 dx, dy, dz, ii );
+    if ( layout == PARTICLE_LAYOUT_AOSOA )
+    {
+      pb = PARTICLE_BLOCK_PTR( args->p0, p - args->p0 );
+      l  = PARTICLE_BLOCK_LANE( p - args->p0 );
+
+      load_8x1( &pb->dx[l], dx );
+      load_8x1( &pb->dy[l], dy );
+      load_8x1( &pb->dz[l], dz );
+      load_8x1( &pb->i [l], ii );
+    }
+
+    else
+    {
+      load_8x4_tr( &p[0].dx, &p[1].dx, &p[2].dx, &p[3].dx,
+                   &p[4].dx, &p[5].dx, &p[6].dx, &p[7].dx,
+                   dx, dy, dz, ii );
+    }
 
     //--------------------------------------------------------------------------
     // Set field interpolation pointers.
@@ -117,9 +134,19 @@ center_p_pipeline_v8( center_p_pipeline_args_t * args,
     //--------------------------------------------------------------------------
     // Load particle momentum data.  Could use load_8x3_tr.
     //--------------------------------------------------------------------------
-    load_8x4_tr( &p[0].ux, &p[1].ux, &p[2].ux, &p[3].ux,
-		 &p[4].ux, &p[5].ux, &p[6].ux, &p[7].ux,
-		 ux, uy, uz, q );
+    if ( layout == PARTICLE_LAYOUT_AOSOA )
+    {
+      load_8x1( &pb->ux[l], ux );
+      load_8x1( &pb->uy[l], uy );
+      load_8x1( &pb->uz[l], uz );
+    }
+
+    else
+    {
+      load_8x4_tr( &p[0].ux, &p[1].ux, &p[2].ux, &p[3].ux,
+                   &p[4].ux, &p[5].ux, &p[6].ux, &p[7].ux,
+                   ux, uy, uz, q );
+    }
 
     //--------------------------------------------------------------------------
     // Update momentum.
@@ -146,9 +173,19 @@ center_p_pipeline_v8( center_p_pipeline_args_t * args,
     //--------------------------------------------------------------------------
     // Store particle momentum data.  Could use store_8x3_tr.
     //--------------------------------------------------------------------------
-    store_8x4_tr( ux, uy, uz, q,
-		  &p[0].ux, &p[1].ux, &p[2].ux, &p[3].ux,
-		  &p[4].ux, &p[5].ux, &p[6].ux, &p[7].ux );
+    if ( layout == PARTICLE_LAYOUT_AOSOA )
+    {
+      store_8x1( ux, &pb->ux[l] );
+      store_8x1( uy, &pb->uy[l] );
+      store_8x1( uz, &pb->uz[l] );
+    }
+
+    else
+    {
+      store_8x4_tr( ux, uy, uz, q,
+                    &p[0].ux, &p[1].ux, &p[2].ux, &p[3].ux,
+                    &p[4].ux, &p[5].ux, &p[6].ux, &p[7].ux );
+    }
   }
 }
 
@@ -11,7 +11,8 @@
 //----------------------------------------------------------------------------//
 // Reference implementation for an energy_p pipeline function which does not
 // make use of explicit calls to vector intrinsic functions.  This function
-// calculates kinetic energy, normalized by c^2.
+// calculates kinetic energy, normalized by c^2.  Particles stored in the
+// AoSoA layout are gathered into a temporary one at a time.
 //----------------------------------------------------------------------------//
 
 void
@@ -20,7 +21,7 @@ energy_p_pipeline_scalar( energy_p_pipeline_args_t * RESTRICT args,
                           int n_pipeline )
 {
   const interpolator_t * RESTRICT ALIGNED(128) f = args->f;
-  const particle_t     * RESTRICT ALIGNED(32)  p = args->p;
+  const particle_t     * RESTRICT ALIGNED(32)  p;
 
   const float qdt_2mc = args->qdt_2mc;
   const float msp     = args->msp;
@@ -33,9 +34,13 @@ energy_p_pipeline_scalar( energy_p_pipeline_args_t * RESTRICT args,
 
   int i, n, n0, n1;
 
+  const int layout = args->layout;
+
+  DECLARE_ALIGNED_ARRAY( particle_t, 32, local_p, 1 );
+
   // Determine which particles this pipeline processes.
 
-  DISTRIBUTE( args->np, 16, pipeline_rank, n_pipeline, n0, n1 );
+  DISTRIBUTE( PIPELINE_NP( args ), 16, pipeline_rank, n_pipeline, n0, n1 );
 
   n1 += n0;
 
@@ -43,23 +48,35 @@ energy_p_pipeline_scalar( energy_p_pipeline_args_t * RESTRICT args,
 
   for( n = n0; n < n1; n++ )
   {
-    dx  = p[n].dx;
-    dy  = p[n].dy;
-    dz  = p[n].dz;
-    i   = p[n].i;
+    if ( layout == PARTICLE_LAYOUT_AOSOA )   // Gather from the tile
+    {
+      load_particle( args->p, layout, n, local_p );
+
+      p = local_p;
+    }
+
+    else
+    {
+      p = args->p + n;
+    }
 
-    v0  = p[n].ux + qdt_2mc*(    ( f[i].ex    + dy*f[i].dexdy    ) +
-                              dz*( f[i].dexdz + dy*f[i].d2exdydz ) );
+    dx  = p->dx;
+    dy  = p->dy;
+    dz  = p->dz;
+    i   = p->i;
 
-    v1  = p[n].uy + qdt_2mc*(    ( f[i].ey    + dz*f[i].deydz    ) +
-                              dx*( f[i].deydx + dz*f[i].d2eydzdx ) );
+    v0  = p->ux + qdt_2mc*(    ( f[i].ex    + dy*f[i].dexdy    ) +
+                            dz*( f[i].dexdz + dy*f[i].d2exdydz ) );
 
-    v2  = p[n].uz + qdt_2mc*(    ( f[i].ez    + dx*f[i].dezdx    ) +
-                              dy*( f[i].dezdy + dx*f[i].d2ezdxdy ) );
+    v1  = p->uy + qdt_2mc*(    ( f[i].ey    + dz*f[i].deydz    ) +
+                            dx*( f[i].deydx + dz*f[i].d2eydzdx ) );
+
+    v2  = p->uz + qdt_2mc*(    ( f[i].ez    + dx*f[i].dezdx    ) +
+                            dy*( f[i].dezdy + dx*f[i].d2ezdxdy ) );
 
     v0  = v0*v0 + v1*v1 + v2*v2;
 
-    v0  = (msp * p[n].w) * (v0 / (one + sqrtf(one + v0)));
+    v0  = (msp * p->w) * (v0 / (one + sqrtf(one + v0)));
 
     en += ( double ) v0;
   }
@@ -94,9 +111,15 @@ energy_p_pipeline( const species_t * RESTRICT sp,
   args->p       = sp->p;
   args->f       = ia->i;
   args->en      = en;
-  args->qdt_2mc = (sp->q*sp->g->dt)/(2*sp->m*sp->g->cvac);
+  args->qdt_2mc = (sp->q*sp->g->dt*sp->subcycle)/(2*sp->m*sp->g->cvac);
   args->msp     = sp->m;
   args->np      = sp->np;
+  args->layout  = sp->layout;
+
+  if ( sp->layout == PARTICLE_LAYOUT_AOSOA )
+  {
+    pad_particle_blocks( sp->p, sp->np );
+  }
 
   EXEC_PIPELINES( energy_p, args, 0 );
 
@@ -13,6 +13,7 @@ energy_p_pipeline_v16( energy_p_pipeline_args_t * args,
 {
   const interpolator_t * RESTRICT ALIGNED(128) f = args->f;
   const particle_t     * RESTRICT ALIGNED(128) p = args->p;
+  const particle_block_t * RESTRICT ALIGNED(128) pb;
 
   const float          * RESTRICT ALIGNED(64)  vp00;
   const float          * RESTRICT ALIGNED(64)  vp01;
@@ -47,9 +48,11 @@ energy_p_pipeline_v16( energy_p_pipeline_args_t * args,
 
   int n0, nq;
 
+  const int layout = args->layout;
+
   // Determine which particle blocks this pipeline processes.
 
-  DISTRIBUTE( args->np, 16, pipeline_rank, n_pipeline, n0, nq );
+  DISTRIBUTE( PIPELINE_NP( args ), 16, pipeline_rank, n_pipeline, n0, nq );
 
   p += n0;
 
@@ -62,11 +65,24 @@ energy_p_pipeline_v16( energy_p_pipeline_args_t * args,
     //--------------------------------------------------------------------------
     // Load particle position data.
     //--------------------------------------------------------------------------
-    load_16x4_tr( &p[ 0].dx, &p[ 1].dx, &p[ 2].dx, &p[ 3].dx,
-                  &p[ 4].dx, &p[ 5].dx, &p[ 6].dx, &p[ 7].dx,
-                  &p[ 8].dx, &p[ 9].dx, &p[10].dx, &p[11].dx,
-                  &p[12].dx, &p[13].dx, &p[14].dx, &p[15].dx,
-                  dx, dy, dz, i );
+    if ( layout == PARTICLE_LAYOUT_AOSOA )
+    {
+      pb = PARTICLE_BLOCK_PTR( args->p, p - args->p );
+
+      load_16x1( pb->dx, dx );
+      load_16x1( pb->dy, dy );
+      load_16x1( pb->dz, dz );
+      load_16x1( pb->i,  i  );
+    }
+
+    else
+    {
+      load_16x4_tr( &p[ 0].dx, &p[ 1].dx, &p[ 2].dx, &p[ 3].dx,
+                    &p[ 4].dx, &p[ 5].dx, &p[ 6].dx, &p[ 7].dx,
+                    &p[ 8].dx, &p[ 9].dx, &p[10].dx, &p[11].dx,
+                    &p[12].dx, &p[13].dx, &p[14].dx, &p[15].dx,
+                    dx, dy, dz, i );
+    }
 
     //--------------------------------------------------------------------------
     // Set field interpolation pointers.
@@ -124,11 +140,22 @@ energy_p_pipeline_v16( energy_p_pipeline_args_t * args,
     //--------------------------------------------------------------------------
     // Load particle momentum data.
     //--------------------------------------------------------------------------
-    load_16x4_tr( &p[ 0].ux, &p[ 1].ux, &p[ 2].ux, &p[ 3].ux,
-                  &p[ 4].ux, &p[ 5].ux, &p[ 6].ux, &p[ 7].ux,
-                  &p[ 8].ux, &p[ 9].ux, &p[10].ux, &p[11].ux,
-                  &p[12].ux, &p[13].ux, &p[14].ux, &p[15].ux,
-                  v00, v01, v02, w );
+    if ( layout == PARTICLE_LAYOUT_AOSOA )
+    {
+      load_16x1( pb->ux, v00 );
+      load_16x1( pb->uy, v01 );
+      load_16x1( pb->uz, v02 );
+      load_16x1( pb->w,  w   );
+    }
+
+    else
+    {
+      load_16x4_tr( &p[ 0].ux, &p[ 1].ux, &p[ 2].ux, &p[ 3].ux,
+                    &p[ 4].ux, &p[ 5].ux, &p[ 6].ux, &p[ 7].ux,
+                    &p[ 8].ux, &p[ 9].ux, &p[10].ux, &p[11].ux,
+                    &p[12].ux, &p[13].ux, &p[14].ux, &p[15].ux,
+                    v00, v01, v02, w );
+    }
 
     //--------------------------------------------------------------------------
     // Update momentum to half step. Note that Boris rotation does not change
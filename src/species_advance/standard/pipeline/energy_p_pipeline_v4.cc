@@ -13,6 +13,7 @@ energy_p_pipeline_v4( energy_p_pipeline_args_t * args,
 {
   const interpolator_t * RESTRICT ALIGNED(128) f = args->f;
   const particle_t     * RESTRICT ALIGNED(128) p = args->p;
+  const particle_block_t * RESTRICT ALIGNED(128) pb;
 
   const float          * RESTRICT ALIGNED(16)  vp00;
   const float          * RESTRICT ALIGNED(16)  vp01;
@@ -30,11 +31,13 @@ energy_p_pipeline_v4( energy_p_pipeline_args_t * args,
 
   double en00 = 0.0, en01 = 0.0, en02 = 0.0, en03 = 0.0;
 
-  int n0, nq;
+  int n0, nq, l;
+
+  const int layout = args->layout;
 
   // Determine which particle blocks this pipeline processes.
 
-  DISTRIBUTE( args->np, 16, pipeline_rank, n_pipeline, n0, nq );
+  DISTRIBUTE( PIPELINE_NP( args ), 16, pipeline_rank, n_pipeline, n0, nq );
 
   p += n0;
 
@@ -47,8 +50,22 @@ energy_p_pipeline_v4( energy_p_pipeline_args_t * args,
     //--------------------------------------------------------------------------
     // Load particle position data.
     //--------------------------------------------------------------------------
-    load_4x4_tr( &p[0].dx, &p[1].dx, &p[2].dx, &p[3].dx,
-                 dx, dy, dz, i );
+    if ( layout == PARTICLE_LAYOUT_AOSOA )
+    {
+      pb = PARTICLE_BLOCK_PTR( args->p, p - args->p );
+      l  = PARTICLE_BLOCK_LANE( p - args->p );
+
+      load_4x1( &pb->dx[l], dx );
+      load_4x1( &pb->dy[l], dy );
+      load_4x1( &pb->dz[l], dz );
+      load_4x1( &pb->i [l], i  );
+    }
+
+    else
+    {
+      load_4x4_tr( &p[0].dx, &p[1].dx, &p[2].dx, &p[3].dx,
+                   dx, dy, dz, i );
+    }
 
     //--------------------------------------------------------------------------
     // Set field interpolation pointers.
@@ -85,8 +102,19 @@ energy_p_pipeline_v4( energy_p_pipeline_args_t * args,
     //--------------------------------------------------------------------------
     // Load particle momentum data.
     //--------------------------------------------------------------------------
-    load_4x4_tr( &p[0].ux, &p[1].ux, &p[2].ux, &p[3].ux,
-                 v00, v01, v02, w );
+    if ( layout == PARTICLE_LAYOUT_AOSOA )
+    {
+      load_4x1( &pb->ux[l], v00 );
+      load_4x1( &pb->uy[l], v01 );
+      load_4x1( &pb->uz[l], v02 );
+      load_4x1( &pb->w [l], w   );
+    }
+
+    else
+    {
+      load_4x4_tr( &p[0].ux, &p[1].ux, &p[2].ux, &p[3].ux,
+                   v00, v01, v02, w );
+    }
 
     //--------------------------------------------------------------------------
     // Update momentum to half step. Note that Boris rotation does not change
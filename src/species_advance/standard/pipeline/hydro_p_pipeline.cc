@@ -240,7 +240,8 @@ accumulate_hydro_p_pipeline( hydro_array_t * RESTRICT ha,
   args->f       = ia->i;
   args->h       = ha->h;
   args->h_size  = ha->stride;
-  args->qdt_2mc = ( sp->q * sp->g->dt ) / ( 2 * sp->m * sp->g->cvac );
+  args->qdt_2mc = ( sp->q * sp->g->dt * sp->subcycle ) /
+                  ( 2 * sp->m * sp->g->cvac );
   args->msp     = sp->m;
   args->np      = sp->np;
   args->charge_weight = charge_weight;
@@ -14,7 +14,10 @@
 #include "../../../util/pipelines/pipelines_exec.h"
 
 //----------------------------------------------------------------------------//
-// This is the new thread parallel version of the particle sort.
+// This is the new thread parallel version of the particle sort.  The aux
+// particle array is always AoS.  For a species in the AoSoA layout, the
+// coarse sort gathers particles out of their tiles and the subsort scatters
+// them back into tiles in sorted order.
 //----------------------------------------------------------------------------//
 
 #if defined( __SSE__ )
@@ -23,6 +26,29 @@
 
 // FIXME: HOOK UP IN-PLACE / OUT-PLACE OPTIONS AGAIN.
 
+//----------------------------------------------------------------------------//
+// Scratch space shared by the full and incremental sorts.  Making this into a
+// static is done to avoid heap shredding.
+//----------------------------------------------------------------------------//
+
+static char * ALIGNED(128) scratch     = NULL;
+static size_t          max_scratch = 0;
+
+static char *
+sort_scratch( size_t sz_scratch )
+{
+  if ( sz_scratch > max_scratch )
+  {
+    FREE_ALIGNED( scratch );
+
+    MALLOC_ALIGNED( scratch, sz_scratch, 128 );
+
+    max_scratch = sz_scratch;
+  }
+
+  return scratch;
+}
+
 //----------------------------------------------------------------------------//
 // 
 //----------------------------------------------------------------------------//
@@ -34,8 +60,11 @@ coarse_count_pipeline_scalar( sort_p_pipeline_args_t * args,
 {
   const particle_t * RESTRICT ALIGNED(128) p_src = args->p;
 
+  const int * RESTRICT ALIGNED(128) sfc = args->sfc;
+
   int i, i1;
 
+  int layout    = args->layout;
   int n_subsort = args->n_subsort;
   int vl        = args->vl;
   int vh        = args->vh;
@@ -63,9 +92,20 @@ coarse_count_pipeline_scalar( sort_p_pipeline_args_t * args,
   CLEAR( count, n_subsort );
 
   // Local coarse count the input particles.
-  for( ; i < i1; i++ )
+  if ( layout == PARTICLE_LAYOUT_AOSOA )
   {
-    count[ V2P( p_src[i].i, n_subsort, vl, vh ) ]++;
+    for( ; i < i1; i++ )
+    {
+      count[ V2P( sfc[ *particle_voxel( args->p, layout, i ) ], n_subsort, vl, vh ) ]++;
+    }
+  }
+
+  else
+  {
+    for( ; i < i1; i++ )
+    {
+      count[ V2P( sfc[ p_src[i].i ], n_subsort, vl, vh ) ]++;
+    }
   }
 
   // Copy local coarse count to output.
@@ -86,7 +126,10 @@ coarse_sort_pipeline_scalar( sort_p_pipeline_args_t * args,
   const particle_t * RESTRICT ALIGNED(128) p_src = args->p;
   /**/  particle_t * RESTRICT ALIGNED(128) p_dst = args->aux_p;
 
+  const int * RESTRICT ALIGNED(128) sfc = args->sfc;
+
   int i, i1;
+  int layout    = args->layout;
   int n_subsort = args->n_subsort;
   int vl        = args->vl;
   int vh        = args->vh;
@@ -118,9 +161,21 @@ coarse_sort_pipeline_scalar( sort_p_pipeline_args_t * args,
 	n_subsort );
 
   // Copy particles into aux array in coarse sorted order.
+  if ( layout == PARTICLE_LAYOUT_AOSOA )
+  {
+    for( ; i < i1; i++ )
+    {
+      j = next[ V2P( sfc[ *particle_voxel( args->p, layout, i ) ], n_subsort, vl, vh ) ]++;
+
+      load_particle( p_src, layout, i, p_dst + j );
+    }
+
+    return;
+  }
+
   for( ; i < i1; i++ )
   {
-    j = next[ V2P( p_src[i].i, n_subsort, vl, vh ) ]++;
+    j = next[ V2P( sfc[ p_src[i].i ], n_subsort, vl, vh ) ]++;
 
 #   if defined( __SSE__ )
 
@@ -151,11 +206,14 @@ subsort_pipeline_scalar( sort_p_pipeline_args_t * args,
 
   int subsort;
 
+  int layout    = args->layout;
   int n_subsort = args->n_subsort;
 
   int * RESTRICT ALIGNED(128) partition = args->partition;
   int * RESTRICT ALIGNED(128) next      = args->next;
 
+  const int * RESTRICT ALIGNED(128) sfc = args->sfc;
+
   // No straggler cleanup needed.
   if ( pipeline_rank == n_pipeline )
   {
@@ -178,7 +236,7 @@ subsort_pipeline_scalar( sort_p_pipeline_args_t * args,
     // Fine grained count.
     for( i = i0; i < i1; i++ )
     {
-      next[ p_src[i].i ]++;
+      next[ sfc[ p_src[i].i ] ]++;
     }
 
     // Compute the partitioning.
@@ -196,9 +254,16 @@ subsort_pipeline_scalar( sort_p_pipeline_args_t * args,
     // Local fine grained sort.
     for( i = i0; i < i1; i++ )
     {
-      v = p_src[i].i;
+      v = sfc[ p_src[i].i ];
       j = next[v]++;
 
+      if ( layout == PARTICLE_LAYOUT_AOSOA )
+      {
+        store_particle( p_dst, layout, j, p_src + i );
+
+        continue;
+      }
+
 #     if defined( __SSE__ )
 
       _mm_store_ps( &p_dst[j].dx, _mm_load_ps( &p_src[i].dx ) );
@@ -227,8 +292,7 @@ sort_p_pipeline( species_t * sp )
 
   sp->last_sorted = sp->g->step;
 
-  static char * ALIGNED(128)     scratch = NULL;
-  static size_t              max_scratch = 0;
+  char * ALIGNED(128) scratch;
 
   size_t sz_scratch;
 
@@ -274,14 +338,7 @@ sort_p_pipeline( species_t * sp )
 		 128                            +
                  sizeof( *coarse_partition ) * ( cp_stride * n_pipeline + 1 ) );
 
-  if ( sz_scratch > max_scratch )
-  {
-    FREE_ALIGNED( scratch );
-
-    MALLOC_ALIGNED( scratch, sz_scratch, 128 );
-
-    max_scratch = sz_scratch;
-  }
+  scratch = sort_scratch( sz_scratch );
 
   aux_p            = ALIGN_PTR( particle_t, scratch,            128 );
   next             = ALIGN_PTR( int,        aux_p + n_particle, 128 );
@@ -292,8 +349,10 @@ sort_p_pipeline( species_t * sp )
   args->aux_p            = aux_p;
   args->coarse_partition = coarse_partition;
   args->next             = next;
+  args->sfc              = sp->g->sfc;
   args->partition        = partition;
   args->n                = n_particle;
+  args->layout           = sp->layout;
   args->n_subsort        = n_subsort;
   args->vl               = vl;
   args->vh               = vh;
@@ -342,6 +401,28 @@ sort_p_pipeline( species_t * sp )
     WAIT_PIPELINES();
   }
 
+  else if ( sp->layout == PARTICLE_LAYOUT_AOSOA )
+  {
+    // Gather the particles out of their tiles into the aux array and let the
+    // subsort scatter them back in sorted order.
+    for( i = 0; i < n_particle; i++ )
+    {
+      load_particle( p, sp->layout, i, aux_p + i );
+    }
+
+    coarse_partition[0] = 0;
+    coarse_partition[1] = n_particle;
+
+    subsort_pipeline_scalar( args, 0, 1 );
+
+    CLEAR( partition, vl );
+
+    for( i = vh + 1; i < n_voxel; i++ )
+    {
+      partition[i] = n_particle;
+    }
+  }
+
   else
   {
     // Just do the subsort when single threaded.  We need to hack the aux
@@ -369,3 +450,294 @@ sort_p_pipeline( species_t * sp )
     COPY( p, aux_p, n_particle );
   }
 }
+
+//----------------------------------------------------------------------------//
+// Incremental sort.  Going in, sp->partition holds the partitioning computed
+// by the last sort.  Particles whose voxel still matches the partition they
+// are in (usually the vast majority) are stayers.  All others, along with
+// any particles added since the last sort, are migrants.  The stayers are
+// streamed to their new positions in order and only the migrants are
+// scattered.  The resulting partitioning is exact.
+//----------------------------------------------------------------------------//
+
+// Range of voxels [v0,v1) a pipeline is responsible for and the range of
+// particles [i0,i1) the last sort put in these voxels.
+
+#define INCREMENTAL_RANGE( args, pipeline_rank, n_pipeline )              \
+  DISTRIBUTE( (args)->vh - (args)->vl + 1, 1, pipeline_rank, n_pipeline,  \
+              v0, v1 );                                                   \
+  v0 += (args)->vl;                                                       \
+  v1 += v0;                                                               \
+  i0 = ( v0 == (args)->vl     ) ? 0         : (args)->partition[v0];      \
+  i1 = ( v1 == (args)->vh + 1 ) ? (args)->n : (args)->partition[v1];      \
+  if ( i0 > (args)->n ) i0 = (args)->n;                                   \
+  if ( i1 > (args)->n ) i1 = (args)->n
+
+void
+find_migrants_pipeline_scalar( sort_p_incremental_pipeline_args_t * args,
+                               int pipeline_rank,
+                               int n_pipeline )
+{
+  particle_t * RESTRICT ALIGNED(128) p = args->p;
+
+  const int * RESTRICT ALIGNED(128) partition = args->partition;
+  const int * RESTRICT ALIGNED(128) sfc       = args->sfc;
+  /**/  int * RESTRICT ALIGNED(128) count     = args->count;
+  /**/  int * RESTRICT ALIGNED(128) migrant   = args->migrant;
+
+  int layout = args->layout;
+  int v0, v1, i0, i1, i, u, v, nm;
+
+  // No straggler cleanup needed.
+  if ( pipeline_rank == n_pipeline )
+  {
+    return;
+  }
+
+  INCREMENTAL_RANGE( args, pipeline_rank, n_pipeline );
+
+  CLEAR( count + v0, v1 - v0 );
+
+  // Walk the particles along with the partition they were sorted into.
+
+  for( u = v0, nm = 0, i = i0; i < i1; i++ )
+  {
+    while( u + 1 < v1 && partition[u+1] <= i ) u++;
+
+    v = sfc[ *particle_voxel( p, layout, i ) ];
+
+    if ( v == u && partition[u] <= i && i < partition[u+1] )
+    {
+      count[u]++;
+    }
+
+    else
+    {
+      migrant[ i0 + nm++ ] = i;
+    }
+  }
+
+  args->seg[ 2*pipeline_rank     ] = i0;
+  args->seg[ 2*pipeline_rank + 1 ] = nm;
+}
+
+void
+merge_stayers_pipeline_scalar( sort_p_incremental_pipeline_args_t * args,
+                               int pipeline_rank,
+                               int n_pipeline )
+{
+  const particle_t * RESTRICT ALIGNED(128) p_src = args->p;
+  /**/  particle_t * RESTRICT ALIGNED(128) p_dst = args->aux_p;
+
+  const int * RESTRICT ALIGNED(128) partition = args->partition;
+  const int * RESTRICT ALIGNED(128) next      = args->next;
+  const int * RESTRICT ALIGNED(128) sfc       = args->sfc;
+
+  int layout = args->layout;
+  int v0, v1, i0, i1, i, j, u, v;
+
+  // No straggler cleanup needed.
+  if ( pipeline_rank == n_pipeline )
+  {
+    return;
+  }
+
+  INCREMENTAL_RANGE( args, pipeline_rank, n_pipeline );
+
+  // Stayers keep their order and go first in their voxel.
+
+  for( u = v0, j = next[u], i = i0; i < i1; i++ )
+  {
+    while( u + 1 < v1 && partition[u+1] <= i ) j = next[++u];
+
+    v = sfc[ *particle_voxel( (particle_t *) p_src, layout, i ) ];
+
+    if ( v == u && partition[u] <= i && i < partition[u+1] )
+    {
+      load_particle( p_src, layout, i, p_dst + j++ );
+    }
+  }
+}
+
+void
+copy_sorted_pipeline_scalar( sort_p_incremental_pipeline_args_t * args,
+                             int pipeline_rank,
+                             int n_pipeline )
+{
+  const particle_t * RESTRICT ALIGNED(128) p_src = args->aux_p;
+  /**/  particle_t * RESTRICT ALIGNED(128) p_dst = args->p;
+
+  int layout = args->layout;
+  int v0, v1, i0, i1, i;
+
+  // No straggler cleanup needed.
+  if ( pipeline_rank == n_pipeline )
+  {
+    return;
+  }
+
+  // The partitioning of the last sort is not needed anymore.
+
+  DISTRIBUTE( args->vh - args->vl + 1, 1, pipeline_rank, n_pipeline, v0, v1 );
+
+  COPY( args->partition + args->vl + v0, args->next + args->vl + v0, v1 );
+
+  DISTRIBUTE( args->n, PARTICLE_BLOCK, pipeline_rank, n_pipeline, i0, i1 );
+
+  if ( pipeline_rank == n_pipeline - 1 ) i1 = args->n - i0;
+
+  if ( layout == PARTICLE_LAYOUT_AOSOA )
+  {
+    for( i = i0; i < i0 + i1; i++ )
+    {
+      store_particle( p_dst, layout, i, p_src + i );
+    }
+  }
+
+  else
+  {
+    COPY( p_dst + i0, p_src + i0, i1 );
+  }
+}
+
+#undef INCREMENTAL_RANGE
+
+void
+sort_p_incremental_pipeline( species_t * sp )
+{
+  if ( !sp )
+  {
+    ERROR( ( "Bad args" ) );
+  }
+
+  sp->last_sorted = sp->g->step;
+
+  char * ALIGNED(128) scratch;
+
+  size_t sz_scratch;
+
+  particle_t * RESTRICT ALIGNED(128) p = sp->p;
+  particle_t * RESTRICT ALIGNED(128) aux_p;
+
+  int n_particle = sp->np;
+  int layout     = sp->layout;
+
+  int * RESTRICT ALIGNED(128) partition = sp->partition;
+  int * RESTRICT ALIGNED(128) count;
+  int * RESTRICT ALIGNED(128) next;
+  int * RESTRICT ALIGNED(128) migrant;
+  int * RESTRICT ALIGNED(128) seg;
+
+  const int * RESTRICT ALIGNED(128) sfc = sp->g->sfc;
+
+  int vl = VOXEL( 1,
+		  1,
+		  1,
+		  sp->g->nx,
+		  sp->g->ny,
+		  sp->g->nz );
+
+  int vh = VOXEL( sp->g->nx,
+		  sp->g->ny,
+		  sp->g->nz,
+		  sp->g->nx,
+		  sp->g->ny,
+		  sp->g->nz );
+
+  int n_voxel = sp->g->nv;
+
+  int n_pipeline = N_PIPELINE;
+
+  int i, j, k, v, sum, c;
+
+  DECLARE_ALIGNED_ARRAY( sort_p_incremental_pipeline_args_t, 128, args, 1 );
+
+  // Ensure enough scratch space is allocated for the sorting.
+  sz_scratch = ( sizeof( *p ) * n_particle             +
+		 128                                   +
+                 sizeof( *count ) * ( n_voxel + 1 )    +
+		 128                                   +
+                 sizeof( *next ) * ( n_voxel + 1 )     +
+		 128                                   +
+                 sizeof( *migrant ) * n_particle       +
+		 128                                   +
+                 sizeof( *seg ) * 2 * ( n_pipeline + 1 ) );
+
+  scratch = sort_scratch( sz_scratch );
+
+  aux_p   = ALIGN_PTR( particle_t, scratch,                  128 );
+  count   = ALIGN_PTR( int,        aux_p   + n_particle,     128 );
+  next    = ALIGN_PTR( int,        count   + n_voxel + 1,    128 );
+  migrant = ALIGN_PTR( int,        next    + n_voxel + 1,    128 );
+  seg     = ALIGN_PTR( int,        migrant + n_particle,     128 );
+
+  // Setup pipeline arguments.
+  args->p         = p;
+  args->aux_p     = aux_p;
+  args->partition = partition;
+  args->count     = count;
+  args->next      = next;
+  args->migrant   = migrant;
+  args->seg       = seg;
+  args->sfc       = sfc;
+  args->n         = n_particle;
+  args->layout    = layout;
+  args->vl        = vl;
+  args->vh        = vh;
+
+  // Count the stayers in each voxel and find the migrants.
+  EXEC_PIPELINES( find_migrants, args, 0 );
+
+  CLEAR( next + vl, vh - vl + 1 );
+
+  WAIT_PIPELINES();
+
+  // Count the migrants in each voxel.
+  for( k = 0; k < n_pipeline; k++ )
+  {
+    for( i = seg[2*k]; i < seg[2*k] + seg[2*k+1]; i++ )
+    {
+      next[ sfc[ *particle_voxel( p, layout, migrant[i] ) ] ]++;
+    }
+  }
+
+  // Compute the new partitioning.  The migrants of a voxel go after its
+  // stayers, count becomes the position of the next migrant of a voxel.
+  sum = 0;
+  for( v = vl; v <= vh; v++ )
+  {
+    c        = count[v] + next[v];
+    next[v]  = sum;
+    count[v] = sum + count[v];
+    sum     += c;
+  }
+  next[vh+1] = sum;
+
+  // Stream the stayers into the aux array while scattering the migrants.
+  EXEC_PIPELINES( merge_stayers, args, 0 );
+
+  for( k = 0; k < n_pipeline; k++ )
+  {
+    for( i = seg[2*k]; i < seg[2*k] + seg[2*k+1]; i++ )
+    {
+      j = count[ sfc[ *particle_voxel( p, layout, migrant[i] ) ] ]++;
+
+      load_particle( p, layout, migrant[i], aux_p + j );
+    }
+  }
+
+  WAIT_PIPELINES();
+
+  // Copy the sorted particles back and update the partitioning.  While the
+  // copies are executing, set the ghost parts of the partitioning array.
+  EXEC_PIPELINES( copy_sorted, args, 0 );
+
+  CLEAR( partition, vl );
+
+  for( i = vh + 1; i < n_voxel; i++ )
+  {
+    partition[i] = n_particle;
+  }
+
+  WAIT_PIPELINES();
+}
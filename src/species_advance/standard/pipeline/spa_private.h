@@ -7,6 +7,13 @@
 
 #include "../../species_advance.h"
 
+// Number of particles a pipeline function has to process.  AoSoA particle
+// arrays are processed in whole tiles (see pad_particle_blocks).
+
+#define PIPELINE_NP( args )                                      \
+  ( (args)->layout == PARTICLE_LAYOUT_AOSOA ?                    \
+    PARTICLE_BLOCK_CEIL( (args)->np ) : (args)->np )
+
 ///////////////////////////////////////////////////////////////////////////////
 // advance_p_pipeline interface
 
@@ -25,7 +32,7 @@ typedef struct advance_p_pipeline_args
 {
   MEM_PTR( particle_t,           128 ) p0;       // Particle array
   MEM_PTR( particle_mover_t,     128 ) pm;       // Particle mover array
-  MEM_PTR( accumulator_t,        128 ) a0;       // Accumulator arrays
+  MEM_PTR( accumulator_tiles_t,  1   ) at;       // Accumulator tiles
   MEM_PTR( const interpolator_t, 128 ) f0;       // Interpolator array
   MEM_PTR( particle_mover_seg_t, 128 ) seg;      // Dest for return values
   MEM_PTR( const grid_t,         1   ) g;        // Local domain grid params
@@ -37,12 +44,13 @@ typedef struct advance_p_pipeline_args
   float                                qsp;      // Species particle charge
 
   int                                  np;       // Number of particles
+  int                                  layout;   // Particle array layout
   int                                  max_nm;   // Number of movers
   int                                  nx;       // x-mesh resolution
   int                                  ny;       // y-mesh resolution
   int                                  nz;       // z-mesh resolution
 
-  PAD_STRUCT( 6*SIZEOF_MEM_PTR + 5*sizeof(float) + 5*sizeof(int) )
+  PAD_STRUCT( 6*SIZEOF_MEM_PTR + 5*sizeof(float) + 6*sizeof(int) )
 } advance_p_pipeline_args_t;
 
 void
@@ -74,8 +82,9 @@ typedef struct center_p_pipeline_args
   MEM_PTR( const interpolator_t, 128 ) f0;      // Interpolator array
   float                                qdt_2mc; // Particle/field coupling
   int                                  np;      // Number of particles
+  int                                  layout;  // Particle array layout
 
-  PAD_STRUCT( 2*SIZEOF_MEM_PTR + sizeof(float) + sizeof(int) )
+  PAD_STRUCT( 2*SIZEOF_MEM_PTR + sizeof(float) + 2*sizeof(int) )
 } center_p_pipeline_args_t;
 
 void
@@ -128,8 +137,9 @@ typedef struct energy_p_pipeline_args
   float                                qdt_2mc; // Particle/field coupling
   float                                msp;     // Species particle rest mass
   int                                  np;      // Number of particles
+  int                                  layout;  // Particle array layout
 
-  PAD_STRUCT( 3*SIZEOF_MEM_PTR + 2*sizeof(float) + sizeof(int) )
+  PAD_STRUCT( 3*SIZEOF_MEM_PTR + 2*sizeof(float) + 2*sizeof(int) )
 } energy_p_pipeline_args_t;
 
 void
@@ -192,6 +202,10 @@ accumulate_hydro_p_pipeline_v16( accumulate_hydro_p_pipeline_args_t * args,
 ///////////////////////////////////////////////////////////////////////////////
 // sort_p_pipeline interface
 
+// The sorts order voxels along the grid's space filling curve.  Below,
+// "voxel" refers to the position of a voxel along the curve (g->sfc[v]
+// for mesh voxel v) and the partitioning is indexed by it.
+
 // Given the voxel index, compute which subsort is responsible for
 // sorting particles within that voxel.  This takes into account
 // that v*P might overflow 32-bits and that only voxels [vl,vh]
@@ -226,12 +240,14 @@ typedef struct sort_p_pipeline_args
   /**/ // (0:max_subsort-1,0:MAX_PIPELINE-1)
   MEM_PTR( int,        128 ) partition;        // Partitioning (0:n_voxel)
   MEM_PTR( int,        128 ) next;             // Aux partitioning (0:n_voxel)
+  MEM_PTR( const int,  128 ) sfc;              // Voxel order (0:n_voxel-1)
   int n;         // Number of particles
+  int layout;    // Layout of p (aux_p is always AoS)
   int n_subsort; // Number of pipelines to be used for subsorts
   int vl, vh;    // Particles may be contained in voxels [vl,vh].
   int n_voxel;   // Number of voxels total (including ghosts)
 
-  PAD_STRUCT( 5*SIZEOF_MEM_PTR + 5*sizeof(int) )
+  PAD_STRUCT( 6*SIZEOF_MEM_PTR + 6*sizeof(int) )
 } sort_p_pipeline_args_t;
 
 void
@@ -249,4 +265,48 @@ subsort_pipeline_scalar( sort_p_pipeline_args_t * args,
                          int pipeline_rank,
                          int n_pipeline );
 
+///////////////////////////////////////////////////////////////////////////////
+// sort_p_incremental_pipeline interface
+
+// Pipelines are each assigned a range of voxels [v0,v1).  A pipeline is
+// responsible for the particles the last sort put into its voxels.  The
+// first pipeline is also responsible for any particles before its voxels
+// and the last pipeline for any particles after its voxels (e.g. particles
+// injected since the last sort).
+
+typedef struct sort_p_incremental_pipeline_args
+{
+  MEM_PTR( particle_t, 128 ) p;         // Particles (0:n-1)
+  MEM_PTR( particle_t, 128 ) aux_p;     // Aux particle storage (0:n-1)
+  MEM_PTR( int,        128 ) partition; // Partitioning of the last sort
+  /**/                                  // (0:n_voxel)
+  MEM_PTR( int,        128 ) count;     // Particles staying in each voxel
+  /**/                                  // (0:n_voxel)
+  MEM_PTR( int,        128 ) next;      // New partitioning (0:n_voxel)
+  MEM_PTR( int,        128 ) migrant;   // Particles that have to move (0:n-1)
+  MEM_PTR( int,        128 ) seg;       // First migrant and number of
+  /**/                                  // migrants of each pipeline
+  MEM_PTR( const int,  128 ) sfc;       // Voxel order (0:n_voxel-1)
+  int n;         // Number of particles
+  int layout;    // Layout of p (aux_p is always AoS)
+  int vl, vh;    // Particles may be contained in voxels [vl,vh].
+
+  PAD_STRUCT( 8*SIZEOF_MEM_PTR + 4*sizeof(int) )
+} sort_p_incremental_pipeline_args_t;
+
+void
+find_migrants_pipeline_scalar( sort_p_incremental_pipeline_args_t * args,
+                               int pipeline_rank,
+                               int n_pipeline );
+
+void
+merge_stayers_pipeline_scalar( sort_p_incremental_pipeline_args_t * args,
+                               int pipeline_rank,
+                               int n_pipeline );
+
+void
+copy_sorted_pipeline_scalar( sort_p_incremental_pipeline_args_t * args,
+                             int pipeline_rank,
+                             int n_pipeline );
+
 #endif // _spa_private_h_
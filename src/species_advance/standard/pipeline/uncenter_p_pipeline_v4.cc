@@ -14,6 +14,7 @@ uncenter_p_pipeline_v4( center_p_pipeline_args_t * args,
   const interpolator_t * ALIGNED(128) f0 = args->f0;
 
   particle_t           * ALIGNED(128) p;
+  particle_block_t     * ALIGNED(128) pb;
 
   const float          * ALIGNED(16)  vp00;
   const float          * ALIGNED(16)  vp01;
@@ -31,11 +32,13 @@ uncenter_p_pipeline_v4( center_p_pipeline_args_t * args,
   v4float v00, v01, v02, v03, v04, v05;
   v4int   ii;
 
-  int first, nq;
+  int first, nq, l;
+
+  const int layout = args->layout;
 
   // Determine which particle quads this pipeline processes.
 
-  DISTRIBUTE( args->np, 16, pipeline_rank, n_pipeline, first, nq );
+  DISTRIBUTE( PIPELINE_NP( args ), 16, pipeline_rank, n_pipeline, first, nq );
 
   p = args->p0 + first;
 
@@ -48,8 +51,22 @@ uncenter_p_pipeline_v4( center_p_pipeline_args_t * args,
     //--------------------------------------------------------------------------
     // Load particle position data.
     //--------------------------------------------------------------------------
-    load_4x4_tr( &p[0].dx, &p[1].dx, &p[2].dx, &p[3].dx,
-    		 dx, dy, dz, ii );
+    if ( layout == PARTICLE_LAYOUT_AOSOA )
+    {
+      pb = PARTICLE_BLOCK_PTR( args->p0, p - args->p0 );
+      l  = PARTICLE_BLOCK_LANE( p - args->p0 );
+
+      load_4x1( &pb->dx[l], dx );
+      load_4x1( &pb->dy[l], dy );
+      load_4x1( &pb->dz[l], dz );
+      load_4x1( &pb->i [l], ii );
+    }
+
+    else
+    {
+      load_4x4_tr( &p[0].dx, &p[1].dx, &p[2].dx, &p[3].dx,
+      		 dx, dy, dz, ii );
+    }
 
     //--------------------------------------------------------------------------
     // Set field interpolation pointers.
@@ -103,8 +120,18 @@ uncenter_p_pipeline_v4( center_p_pipeline_args_t * args,
     //--------------------------------------------------------------------------
     // Load particle momentum data.  Could use load_4x3_tr.
     //--------------------------------------------------------------------------
-    load_4x4_tr( &p[0].ux, &p[1].ux, &p[2].ux, &p[3].ux,
-		 ux, uy, uz, q );
+    if ( layout == PARTICLE_LAYOUT_AOSOA )
+    {
+      load_4x1( &pb->ux[l], ux );
+      load_4x1( &pb->uy[l], uy );
+      load_4x1( &pb->uz[l], uz );
+    }
+
+    else
+    {
+      load_4x4_tr( &p[0].ux, &p[1].ux, &p[2].ux, &p[3].ux,
+                   ux, uy, uz, q );
+    }
 
     //--------------------------------------------------------------------------
     // Update momentum.
@@ -131,8 +158,18 @@ uncenter_p_pipeline_v4( center_p_pipeline_args_t * args,
     //--------------------------------------------------------------------------
     // Store particle data.  Could use store_4x3_tr.
     //--------------------------------------------------------------------------
-    store_4x4_tr( ux, uy, uz, q,
-		  &p[0].ux, &p[1].ux, &p[2].ux, &p[3].ux );
+    if ( layout == PARTICLE_LAYOUT_AOSOA )
+    {
+      store_4x1( ux, &pb->ux[l] );
+      store_4x1( uy, &pb->uy[l] );
+      store_4x1( uz, &pb->uz[l] );
+    }
+
+    else
+    {
+      store_4x4_tr( ux, uy, uz, q,
+                    &p[0].ux, &p[1].ux, &p[2].ux, &p[3].ux );
+    }
   }
 }
 
@@ -30,6 +30,7 @@ accumulate_rho_p( /**/  field_array_t * RESTRICT fa,
 
   const float q_8V = sp->q*sp->g->r8V;
   const int np = sp->np;
+  const int layout = sp->layout;
   const int sy = sp->g->sy;
   const int sz = sp->g->sz;
 
@@ -55,11 +56,14 @@ accumulate_rho_p( /**/  field_array_t * RESTRICT fa,
  
     // Load the particle data
 
-    w0 = p[n].dx;
-    w1 = p[n].dy;
-    dz = p[n].dz;
-    v  = p[n].i;
-    w7 = p[n].w*q_8V;
+    DECLARE_ALIGNED_ARRAY( particle_t, 32, pn, 1 );
+    load_particle( p, layout, n, pn );
+
+    w0 = pn->dx;
+    w1 = pn->dy;
+    dz = pn->dz;
+    v  = pn->i;
+    w7 = pn->w*q_8V;
 
     // Compute the trilinear weights
     // Though the PPE should have hardware fma/fmaf support, it was
@@ -29,7 +29,7 @@ sort_p( species_t * sp )
 
   sp->last_sorted = sp->g->step;
 
-  particle_t * ALIGNED(128) p = sp->p;
+  particle_t * ALIGNED(128) p;
 
   const int np                = sp->np; 
   const int nc                = sp->g->nv;
@@ -37,16 +37,23 @@ sort_p( species_t * sp )
 
   int * RESTRICT ALIGNED(128) partition = sp->partition;
 
+  const int * RESTRICT ALIGNED(128) sfc = sp->g->sfc;
+
   static int * RESTRICT ALIGNED(128) next = NULL;
 
   static int max_nc1 = 0;
 
-  int i, j;
+  int i, j, layout;
 
   // Do not need to sort.
   if ( np == 0 )
     return;
 
+  // The legacy sort only knows about the AoS layout.
+  layout = set_species_layout( sp, PARTICLE_LAYOUT_AOS );
+
+  p = sp->p;
+
   // Allocate the sorting intermediate. Making this into a static is done to
   // avoid heap shredding.
  
@@ -68,7 +75,7 @@ sort_p( species_t * sp )
 
   for( i = 0; i < np; i++ )
   {
-    next[ p[i].i ]++;
+    next[ sfc[ p[i].i ] ]++;
   }
 
   // Convert the count to a partitioning and save a copy in next.
@@ -95,7 +102,7 @@ sort_p( species_t * sp )
 
     for( i = 0; i < np; i++ )
     {
-      out_p[ next[ in_p[i].i ]++ ] = in_p[i];
+      out_p[ next[ sfc[ in_p[i].i ] ]++ ] = in_p[i];
     }
 
     FREE_ALIGNED( sp->p );
@@ -125,7 +132,7 @@ sort_p( species_t * sp )
 
         for( ; ; )
         {
-          dest = &p[ next[ src->i ]++ ];
+          dest = &p[ next[ sfc[ src->i ] ]++ ];
 
           if ( src == dest ) break;
 
@@ -136,6 +143,8 @@ sort_p( species_t * sp )
       }
     }
   }
+
+  set_species_layout( sp, layout );
 }
 
 //----------------------------------------------------------------------------//
@@ -147,7 +156,8 @@ sort_p( species_t * sp )
 //----------------------------------------------------------------------------//
 // Top level function to select and call the proper sort_p function using the
 // desired particle sort abstraction.  Currently, the only abstraction
-// available is the pipeline abstraction.
+// available is the pipeline abstraction.  An incremental sort needs the
+// partitioning of a previous sort.
 //----------------------------------------------------------------------------//
 
 void
@@ -159,7 +169,15 @@ sort_p( species_t * sp )
   }
 
   // Conditionally execute this when more abstractions are available.
-  sort_p_pipeline( sp );
+  if ( sp->sort_incremental && sp->last_sorted != INT64_MIN )
+  {
+    sort_p_incremental_pipeline( sp );
+  }
+
+  else
+  {
+    sort_p_pipeline( sp );
+  }
 }
 
 #endif
@@ -19,6 +19,10 @@ boot_services( int * pargc,
 
   boot_checkpt( pargc, pargv );
 
+  // Pick the instruction set of the pipelines before any of them run.
+
+  boot_pipeline_isa( pargc, pargv );
+
   // Start up the threads.  Note that some MPIs will bind threads to
   // cores if threads are booted _after_ MPI is initialized.  So we
   // start up the pipeline dispatchers _before_ starting up MPI.
@@ -58,6 +62,7 @@ boot_services( int * pargc,
   {
       printf("Booting with %d threads (pipelines) and %d (MPI) ranks \n",
               num_threads, _world_size);
+      printf("Using the %s pipelines\n", pipeline_isa_name( pipeline_isa ) );
   }
 }
 
@@ -12,6 +12,9 @@
 #define IN_checkpt
 #include "checkpt_private.h"
 
+#include <pthread.h>
+#include <stdio.h>
+
 /* Boolean flag indicating whether or not checkpoint is booted. */
 
 static int booted = 0;
@@ -44,6 +47,76 @@ static registry_t * registry = NULL;
 
 static size_t next_id = 1;
 
+/* In async mode, checkpt_objects serializes the objects to an image in
+   memory and a writer thread writes the image to disk while the
+   simulation goes on.  With a staging directory, the writer first
+   writes the image there (typically node-local storage), frees it and
+   then drains the staged file to the checkpt file.  At most one image
+   is in flight; the next checkpt, a restore and halt wait for it. */
+
+typedef struct checkpt_job {
+  char * image;  // Serialized objects
+  size_t sz;     // Bytes in image
+  char * name;   // Checkpt file
+  char * staged; // Staging file (NULL if not staging)
+} checkpt_job_t;
+
+static int async = 0;
+static const char * stage = NULL;
+
+/* With --checkpt.compress 1, data of at least CHECKPT_COMPRESS_MIN bytes
+   is written compressed (see checkpt_codec.cc). */
+
+#define CHECKPT_COMPRESS_MIN 4096
+
+static int compress = 0;
+
+/* With --checkpt.cache dir, partner checkpts are kept in dir. */
+
+static const char * cache = NULL;
+
+static checkpt_job_t * job = NULL;
+static pthread_t writer;
+
+static char *
+copy_str( const char * str ) {
+  char * copy;
+  MALLOC( copy, strlen( str ) + 1 );
+  strcpy( copy, str );
+  return copy;
+}
+
+static void *
+write_image( void * _job ) {
+  checkpt_job_t * job = (checkpt_job_t *)_job;
+  checkpt_t * in, * out;
+  char * buf;
+  size_t n, off;
+
+  out = checkpt_open_wronly( job->staged ? job->staged : job->name );
+  checkpt_write( out, job->image, job->sz );
+  checkpt_close( out );
+  FREE( job->image );
+
+  if( job->staged ) {
+    n = job->sz<((size_t)1<<24) ? job->sz : ((size_t)1<<24);
+    MALLOC( buf, n ? n : 1 );
+    in  = checkpt_open_rdonly( job->staged );
+    out = checkpt_open_wronly( job->name );
+    for( off=0; off<job->sz; off+=n ) {
+      if( n>job->sz-off ) n = job->sz-off;
+      checkpt_read(  in,  buf, n );
+      checkpt_write( out, buf, n );
+    }
+    checkpt_close( out );
+    checkpt_close( in );
+    FREE( buf );
+    remove( job->staged );
+  }
+
+  return NULL;
+}
+
 #ifdef VERBOSE_CHECKPOINTING
 
 static void
@@ -105,6 +178,22 @@ boot_checkpt( int * pargc,
   checkpt  = NULL;
   restore  = NULL;
   next_id  = 1;
+  job      = NULL;
+
+  /* "--checkpt.async 1" writes checkpts in the background.
+     "--checkpt.stage dir" does too and stages them in dir. */
+
+  async    = 0;
+  stage    = NULL;
+  compress = 0;
+  cache    = NULL;
+  if( pargc && pargv ) {
+    cache    = strip_cmdline_string( pargc, pargv, "--checkpt.cache", NULL );
+    compress = strip_cmdline_int( pargc, pargv, "--checkpt.compress", 0 );
+    async = strip_cmdline_int(    pargc, pargv, "--checkpt.async", 0    );
+    stage = strip_cmdline_string( pargc, pargv, "--checkpt.stage", NULL );
+    if( stage ) async = 1;
+  }
 
   /* Mark the service as booted */
 
@@ -117,6 +206,7 @@ halt_checkpt( void ) {
   /* Check input args */
 
   if( !booted  ) ERROR(( "checkpt service not booted." ));
+  wait_checkpt();
   if( registry ) {
     dump_registry();
     ERROR(( "halt called with some objects still registered" ));
@@ -236,19 +326,26 @@ unregister_object( void * obj ) {
   FREE( node );
 }
 
+const char *
+checkpt_cache( void ) {
+  return cache;
+}
+
 void
-checkpt_objects( const char * name ) {
-  registry_t * node;
+wait_checkpt( void ) {
+  if( !job ) return;
+  if( pthread_join( writer, NULL ) ) ERROR(( "Unable to join checkpt writer" ));
+  FREE( job->staged );
+  FREE( job->name );
+  FREE( job );
+}
 
-  /* Check input args */
+/* Serialize the registry and the objects to the open checkpt stream */
 
-  if( !booted ) ERROR(( "checkpt not booted" ));
-  if( checkpt ) ERROR(( "currently writing a checkpt" ));
-  if( restore ) ERROR(( "currently reading a checkpt" ));
-
-  /* Open the checkpt serialization stream */
+static void
+checkpt_registry( void ) {
+  registry_t * node;
 
-  checkpt = checkpt_open_wronly( name );
   CHECKPT_VAL( size_t, next_id );
 
   /* Checkpoint the objects */
@@ -263,26 +360,19 @@ checkpt_objects( const char * name ) {
     if( node->checkpt_func ) node->checkpt_func( node->obj );
   }
 
-  /* Mark that there are no more objects in the stream, close the
-     serialization stream and indicate that we are no longer writing a
-     checkpt */
-  
+  /* Mark that there are no more objects in the stream */
+
   CHECKPT_VAL( size_t, 0xBADF00D );
-  checkpt_close( checkpt );
-  checkpt = NULL;
 }
 
-void
-restore_objects( const char * name ) {
+/* Replace the registry with the one in the open restore stream and
+   restore the objects */
+
+static void
+restore_registry( void ) {
   registry_t * node, * prev;
   size_t prefix;
 
-  /* Check input args */
-
-  if( !booted ) ERROR(( "checkpt not booted" ));
-  if( checkpt ) ERROR(( "currently writing a checkpt" ));
-  if( restore ) ERROR(( "currently reading a checkpt" ));
-
   /* Delete all objects in the in favor of the checkpointed objects */
 
   node = registry;
@@ -294,9 +384,6 @@ restore_objects( const char * name ) {
   registry = NULL;
   next_id = 0;
 
-  /* Open the checkpt deserialization stream */
-
-  restore = checkpt_open_rdonly( name );
   RESTORE_VAL( size_t, next_id );
 
   /* Restore the objects */
@@ -319,10 +406,103 @@ restore_objects( const char * name ) {
     dump_node( node );
     if( node->restore_func ) node->obj = node->restore_func();
   }
+}
+
+void
+checkpt_objects( const char * name ) {
+  const char * base;
+
+  /* Check input args */
+
+  if( !booted ) ERROR(( "checkpt not booted" ));
+  if( checkpt ) ERROR(( "currently writing a checkpt" ));
+  if( restore ) ERROR(( "currently reading a checkpt" ));
+  if( !name   ) ERROR(( "NULL name" ));
+
+  /* Wait for the previous checkpt to be written and open the checkpt
+     serialization stream */
+
+  wait_checkpt();
+  checkpt = async ? checkpt_open_memory() : checkpt_open_wronly( name );
+  checkpt_registry();
+
+  /* In async mode, hand the image to the writer thread */
+
+  if( async ) {
+    MALLOC( job, 1 );
+    job->image  = checkpt_image( checkpt, &job->sz );
+    job->name   = copy_str( name );
+    job->staged = NULL;
+    if( stage ) {
+      base = strrchr( name, '/' );
+      base = base ? base+1 : name;
+      MALLOC( job->staged, strlen( stage ) + strlen( base ) + 2 );
+      sprintf( job->staged, "%s/%s", stage, base );
+    }
+    if( pthread_create( &writer, NULL, write_image, job ) )
+      ERROR(( "Unable to start checkpt writer" ));
+  }
 
-  /* Close the checkpt deserialization stream and indicate that we are
-     no longer reading a checkpt */
+  checkpt_close( checkpt );
+  checkpt = NULL;
+}
+
+void
+restore_objects( const char * name ) {
+
+  /* Check input args */
 
+  if( !booted ) ERROR(( "checkpt not booted" ));
+  if( checkpt ) ERROR(( "currently writing a checkpt" ));
+  if( restore ) ERROR(( "currently reading a checkpt" ));
+
+  /* A checkpt of this run might still be being written */
+
+  wait_checkpt();
+
+  /* Open the checkpt deserialization stream, restore the objects, close
+     the stream and indicate that we are no longer reading a checkpt */
+
+  restore = checkpt_open_rdonly( name );
+  restore_registry();
+  checkpt_close( restore );
+  restore = NULL;
+}
+
+char *
+checkpt_objects_image( size_t * sz ) {
+  char * image;
+
+  /* Check input args */
+
+  if( !booted ) ERROR(( "checkpt not booted" ));
+  if( checkpt ) ERROR(( "currently writing a checkpt" ));
+  if( restore ) ERROR(( "currently reading a checkpt" ));
+  if( !sz     ) ERROR(( "NULL sz" ));
+
+  checkpt = checkpt_open_memory();
+  checkpt_registry();
+  image = checkpt_image( checkpt, sz );
+  checkpt_close( checkpt );
+  checkpt = NULL;
+  return image;
+}
+
+void
+restore_objects_image( char * image,
+                       size_t sz ) {
+
+  /* Check input args */
+
+  if( !booted ) ERROR(( "checkpt not booted" ));
+  if( checkpt ) ERROR(( "currently writing a checkpt" ));
+  if( restore ) ERROR(( "currently reading a checkpt" ));
+  if( !image  ) ERROR(( "NULL image" ));
+
+  wait_checkpt();
+
+  restore = checkpt_open_image( image, sz );
+  restore_registry();
   checkpt_close( restore );
   restore = NULL;
 }
@@ -377,15 +557,28 @@ restore_raw( void * data,
 
 /* Composiite checkpt helpers */
 
-void
-checkpt_data( const void * _data,
-              size_t sz_ele,
-              size_t str_ele,
-              size_t n_ele,
-              size_t max_ele,
-              size_t align ) {
-  const char * data = (const char *)_data;
-  size_t n;
+/* The data header gives the layout of the data and how it was coded.
+   Coded data gives, after the header, the records that were coded (for
+   plain data, the contiguous bytes of the data are coded as records of
+   4 bytes), the delta coded fields and the records per block. */
+
+enum checkpt_data_codec {
+  CHECKPT_DATA_RAW = 0,
+  CHECKPT_DATA_LZ  = 1
+};
+
+static void
+checkpt_layout( const char * data,
+                size_t sz_ele,
+                size_t str_ele,
+                size_t n_ele,
+                size_t max_ele,
+                size_t align,
+                size_t sz_rec,
+                size_t str_rec,
+                size_t n_rec,
+                uint32_t delta ) {
+  size_t n, blk_rec;
 
   /* Check input args */
 
@@ -399,15 +592,65 @@ checkpt_data( const void * _data,
   CHECKPT_VAL( size_t, n_ele  ); CHECKPT_VAL( size_t, max_ele );
   CHECKPT_VAL( size_t, align  );
 
-  /* Write out the individual elements */
+  if( compress && sz_rec && n_rec*sz_rec>=CHECKPT_COMPRESS_MIN ) {
+    blk_rec = checkpt_codec_block( sz_rec );
+    CHECKPT_VAL( size_t, CHECKPT_DATA_LZ );
+    CHECKPT_VAL( size_t, sz_rec ); CHECKPT_VAL( size_t, str_rec );
+    CHECKPT_VAL( size_t, n_rec  ); CHECKPT_VAL( size_t, delta   );
+    CHECKPT_VAL( size_t, blk_rec );
+    checkpt_coded( data, sz_rec, str_rec, n_rec, delta, blk_rec );
+    return;
+  }
+
+  CHECKPT_VAL( size_t, CHECKPT_DATA_RAW );
+
+  /* Write out the elements (in one go if they are contiguous) */
+
+  if( sz_ele==str_ele ) checkpt_raw( data, n_ele*sz_ele );
+  else for( n=0; n<n_ele; n++ ) checkpt_raw( data+n*str_ele, sz_ele );
+}
+
+void
+checkpt_data( const void * _data,
+              size_t sz_ele,
+              size_t str_ele,
+              size_t n_ele,
+              size_t max_ele,
+              size_t align ) {
+  const char * data = (const char *)_data;
+
+  /* Contiguous data is coded as 4 byte words, small elements as they
+     are and anything else is not compressed. */
+
+  if( sz_ele==str_ele && (n_ele*sz_ele)%4==0 )
+    checkpt_layout( data, sz_ele, str_ele, n_ele, max_ele, align,
+                    4, 4, n_ele*sz_ele/4, 0 );
+  else if( sz_ele<=128 )
+    checkpt_layout( data, sz_ele, str_ele, n_ele, max_ele, align,
+                    sz_ele, str_ele, n_ele, 0 );
+  else
+    checkpt_layout( data, sz_ele, str_ele, n_ele, max_ele, align,
+                    0, 0, 0, 0 );
+}
 
-  for( n=0; n<n_ele; n++ ) checkpt_raw( data+n*str_ele, sz_ele );
+void
+checkpt_records( const void * data,
+                 size_t sz_ele,
+                 size_t str_ele,
+                 size_t n_ele,
+                 size_t max_ele,
+                 size_t align,
+                 uint32_t delta ) {
+  if( sz_ele%4 ) ERROR(( "records must be made of 4 byte fields" ));
+  checkpt_layout( (const char *)data, sz_ele, str_ele, n_ele, max_ele, align,
+                  sz_ele, str_ele, n_ele, delta );
 }
 
 void *
 restore_data( void ) {
   char * data;
-  size_t n, sz_ele, str_ele, n_ele, max_ele, align;
+  size_t n, sz_ele, str_ele, n_ele, max_ele, align, codec;
+  size_t sz_rec, str_rec, n_rec, delta, blk_rec;
 
   /* Read the data header */
 
@@ -418,6 +661,7 @@ restore_data( void ) {
   RESTORE_VAL( size_t, align  );
   if( n_ele>max_ele || sz_ele>str_ele )
     ERROR(( "malformed checkpt (invalid data layout)" ));
+  RESTORE_VAL( size_t, codec );
 
   /* Allocate the data according to the header */
 
@@ -426,7 +670,28 @@ restore_data( void ) {
 
   /* And read in the checkpointed elements */
 
-  for( n=0; n<n_ele; n++ ) restore_raw( data+n*str_ele, sz_ele );
+  switch( codec ) {
+
+  case CHECKPT_DATA_RAW:
+    if( sz_ele==str_ele ) restore_raw( data, n_ele*sz_ele );
+    else for( n=0; n<n_ele; n++ ) restore_raw( data+n*str_ele, sz_ele );
+    break;
+
+  case CHECKPT_DATA_LZ:
+    RESTORE_VAL( size_t, sz_rec ); RESTORE_VAL( size_t, str_rec );
+    RESTORE_VAL( size_t, n_rec  ); RESTORE_VAL( size_t, delta   );
+    RESTORE_VAL( size_t, blk_rec );
+    if( !sz_rec || sz_rec>str_rec || !blk_rec ||
+        ( n_rec && (n_rec-1)*str_rec+sz_rec>max_ele*str_ele ) )
+      ERROR(( "malformed checkpt (invalid coded layout)" ));
+    restore_coded( data, sz_rec, str_rec, n_rec, (uint32_t)delta, blk_rec );
+    break;
+
+  default:
+    ERROR(( "malformed checkpt (unknown data codec %lu)",
+            (unsigned long)codec ));
+  }
+
   return data;
 }
 
@@ -100,9 +100,44 @@ object_ptr( size_t id );
 void
 checkpt_objects( const char * name );
 
+/* When checkpts are written in the background (--checkpt.async), wait
+   until the last checkpt has been written.  This is done implicitly by
+   the next checkpt_objects, by restore_objects and by halt_checkpt. */
+
+void
+wait_checkpt( void );
+
 void
 restore_objects( const char * name );
 
+/* Checkpt all objects to an image in memory (MALLOC'd, *sz bytes, the
+   caller frees it) and restore all objects from such an image (which is
+   freed).  Otherwise these work like checkpt_objects and
+   restore_objects. */
+
+char *
+checkpt_objects_image( size_t * sz );
+
+void
+restore_objects_image( char * image,
+                       size_t sz );
+
+/* Partner checkpts (see checkpt_partner.cc).  Each node keeps the image
+   of its latest partner checkpt with the given name in the checkpt cache
+   directory (--checkpt.cache dir, e.g. the RAM backed /dev/shm) and sends
+   a copy to a partner node on another machine, which keeps it there too.
+   Without a cache directory, checkpt_objects_partner does nothing.  These
+   are collective.  restore_objects_partner gets the image of a node that
+   lost it back from its partner and returns 0 (with nothing restored) if
+   some node's image cannot be found or the images are not all of the
+   same partner checkpt. */
+
+void
+checkpt_objects_partner( const char * name );
+
+int
+restore_objects_partner( const char * name );
+
 /* Call the reanimate functions on all objects.  This is typically
    done after the restore process. */
 
@@ -150,6 +185,22 @@ checkpt_data( const void * data,
 void *
 restore_data( void );
 
+/* Same as checkpt_data for elements that are records of 4-byte fields
+   (sz_ele a multiple of 4).  Bit f of delta flags the integer field at
+   byte 4f as slowly varying from one record to the next (e.g. the voxel
+   index of sorted particles).  Compressed checkpts (--checkpt.compress)
+   store such fields as differences.  The result is restored by
+   restore_data. */
+
+void
+checkpt_records( const void * data,
+                 size_t sz_ele,
+                 size_t str_ele,
+                 size_t n_ele,
+                 size_t max_ele,
+                 size_t align,
+                 uint32_t delta );
+
 /* Checkpt(restore) a '\0'-terminated string.  The returned pointer of
    restore_str heap_allocated as:
      MALLOC( (char *)string, strlen_string+1 )
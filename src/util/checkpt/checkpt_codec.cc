@@ -0,0 +1,362 @@
+#define IN_checkpt
+#include "checkpt_private.h"
+
+#include "../pipelines/pipelines_exec.h"
+
+/* Compressed checkpt data.  The records are cut into blocks of about
+   CHECKPT_CODEC_BLOCK bytes that are coded independently (so the
+   pipelines can code different blocks at the same time):
+   - the records of the block are gathered and the integer fields
+     flagged in delta are replaced by their difference with the same
+     field of the previous record in the block
+   - the bytes are shuffled so that byte b of all the records comes
+     before byte b+1 of all the records (the high bytes of floats and
+     slowly varying integers then form long runs)
+   - the shuffled block is compressed with a small LZ77 codec (below);
+     a block that does not compress is stored as is.
+   In the stream, the blocks of a round of N_PIPELINE blocks are
+   written one after the other, each preceded by its coded size (0 for
+   a stored block). */
+
+enum checkpt_codec_enums {
+  CHECKPT_CODEC_BLOCK = 1 << 20,
+  CHECKPT_CODEC_HASH  = 16,       // log2 of the match finder table size
+  CHECKPT_CODEC_MIN_MATCH = 4,
+  CHECKPT_CODEC_MAX_OFFSET = 65535
+};
+
+/* LZ77 codec ****************************************************************/
+
+/* A coded block is a sequence of runs.  A run is a token byte (high
+   nibble: number of literals, low nibble: match length less
+   CHECKPT_CODEC_MIN_MATCH; a nibble of 15 is continued in the bytes
+   after it, 255 meaning more follows), the literals, and (unless the
+   literals end the block) the 2 byte little endian match offset. */
+
+static inline uint32_t
+read32( const unsigned char * p ) {
+  uint32_t u;
+  memcpy( &u, p, 4 );
+  return u;
+}
+
+static inline unsigned char *
+put_length( unsigned char * op,
+            size_t n ) {
+  for( ; n>=255; n-=255 ) *op++ = 255;
+  *op++ = (unsigned char)n;
+  return op;
+}
+
+static inline unsigned char *
+put_run( unsigned char * op,
+         const unsigned char * lit,
+         size_t n_lit,
+         size_t offset,
+         size_t n_match ) {
+  unsigned char * token = op++;
+  size_t m = n_match ? n_match - CHECKPT_CODEC_MIN_MATCH : 0;
+  *token = (unsigned char)( ( n_lit<15 ? n_lit : 15 )<<4 | ( m<15 ? m : 15 ) );
+  if( n_lit>=15 ) op = put_length( op, n_lit-15 );
+  memcpy( op, lit, n_lit ); op += n_lit;
+  if( n_match ) {
+    *op++ = (unsigned char)( offset    & 255 );
+    *op++ = (unsigned char)( offset>>8 & 255 );
+    if( m>=15 ) op = put_length( op, m-15 );
+  }
+  return op;
+}
+
+size_t
+checkpt_compress_bound( size_t n ) {
+  return n + n/255 + 16;
+}
+
+size_t
+checkpt_compress( const void * _src,
+                  size_t n,
+                  void * _dst,
+                  int * table ) {
+  const unsigned char * src = (const unsigned char *)_src;
+  unsigned char * dst = (unsigned char *)_dst, * op = dst;
+  size_t i, anchor, cand, len;
+  uint32_t h;
+  int c;
+
+  for( i=0; i<((size_t)1<<CHECKPT_CODEC_HASH); i++ ) table[i] = -1;
+
+  i = anchor = 0;
+  while( i+CHECKPT_CODEC_MIN_MATCH<=n ) {
+    h = ( read32( src+i )*2654435761u ) >> ( 32-CHECKPT_CODEC_HASH );
+    c = table[h];
+    table[h] = (int)i;
+    cand = (size_t)c;
+    if( c<0 || i-cand>CHECKPT_CODEC_MAX_OFFSET ||
+        read32( src+cand )!=read32( src+i ) ) { i++; continue; }
+    for( len=CHECKPT_CODEC_MIN_MATCH; i+len<n && src[cand+len]==src[i+len];
+         len++ ) ;
+    op = put_run( op, src+anchor, i-anchor, i-cand, len );
+    i += len;
+    anchor = i;
+    if( (size_t)( op-dst )>=n ) return 0; // Not worth it
+  }
+  op = put_run( op, src+anchor, n-anchor, 0, 0 );
+  return (size_t)( op-dst )<n ? (size_t)( op-dst ) : 0;
+}
+
+static inline const unsigned char *
+get_length( const unsigned char * ip,
+            const unsigned char * iend,
+            size_t * n ) {
+  unsigned char c;
+  do {
+    if( ip>=iend ) ERROR(( "malformed checkpt (truncated coded block)" ));
+    c = *ip++;
+    *n += c;
+  } while( c==255 );
+  return ip;
+}
+
+void
+checkpt_decompress( const void * _src,
+                    size_t n_src,
+                    void * _dst,
+                    size_t n_dst ) {
+  const unsigned char * ip = (const unsigned char *)_src, * iend = ip + n_src;
+  unsigned char * dst = (unsigned char *)_dst, * op = dst, * oend = op + n_dst;
+  size_t n_lit, n_match, offset;
+  unsigned char token;
+
+  while( ip<iend ) {
+    token = *ip++;
+
+    n_lit = token>>4;
+    if( n_lit==15 ) ip = get_length( ip, iend, &n_lit );
+    if( n_lit>(size_t)( iend-ip ) || n_lit>(size_t)( oend-op ) )
+      ERROR(( "malformed checkpt (bad literals in coded block)" ));
+    memcpy( op, ip, n_lit ); op += n_lit; ip += n_lit;
+    if( ip==iend ) break;
+
+    if( iend-ip<2 ) ERROR(( "malformed checkpt (truncated coded block)" ));
+    offset = (size_t)ip[0] | (size_t)ip[1]<<8; ip += 2;
+    n_match = token & 15;
+    if( n_match==15 ) ip = get_length( ip, iend, &n_match );
+    n_match += CHECKPT_CODEC_MIN_MATCH;
+    if( !offset || offset>(size_t)( op-dst ) || n_match>(size_t)( oend-op ) )
+      ERROR(( "malformed checkpt (bad match in coded block)" ));
+    for( ; n_match; n_match--, op++ ) *op = *( op-offset ); // May overlap
+  }
+
+  if( op!=oend ) ERROR(( "malformed checkpt (short coded block)" ));
+}
+
+/* Record shuffling **********************************************************/
+
+void
+checkpt_shuffle( const void * _src,
+                 void * _dst,
+                 size_t n_rec,
+                 size_t sz_rec,
+                 size_t str_rec,
+                 uint32_t delta ) {
+  const char * src = (const char *)_src;
+  unsigned char * dst = (unsigned char *)_dst;
+  unsigned char rec[ 4*32 ];
+  uint32_t prev[32], u;
+  size_t n, b, f, n_fld = sz_rec/4 < 32 ? sz_rec/4 : 32;
+
+  for( f=0; f<32; f++ ) prev[f] = 0;
+  for( n=0; n<n_rec; n++ ) {
+    for( b=0; b<sz_rec; b+=sizeof(rec) ) {
+      size_t nb = sz_rec-b < sizeof(rec) ? sz_rec-b : sizeof(rec);
+      memcpy( rec, src + n*str_rec + b, nb );
+      if( !b )
+        for( f=0; f<n_fld; f++ )
+          if( delta & ((uint32_t)1<<f) ) {
+            memcpy( &u, rec+4*f, 4 );
+            prev[f] = u - prev[f];
+            memcpy( rec+4*f, &prev[f], 4 );
+            prev[f] = u;
+          }
+      for( f=0; f<nb; f++ ) dst[ (b+f)*n_rec + n ] = rec[f];
+    }
+  }
+}
+
+void
+checkpt_unshuffle( const void * _src,
+                   void * _dst,
+                   size_t n_rec,
+                   size_t sz_rec,
+                   size_t str_rec,
+                   uint32_t delta ) {
+  const unsigned char * src = (const unsigned char *)_src;
+  char * dst = (char *)_dst;
+  unsigned char rec[ 4*32 ];
+  uint32_t prev[32], u;
+  size_t n, b, f, n_fld = sz_rec/4 < 32 ? sz_rec/4 : 32;
+
+  for( f=0; f<32; f++ ) prev[f] = 0;
+  for( n=0; n<n_rec; n++ ) {
+    for( b=0; b<sz_rec; b+=sizeof(rec) ) {
+      size_t nb = sz_rec-b < sizeof(rec) ? sz_rec-b : sizeof(rec);
+      for( f=0; f<nb; f++ ) rec[f] = src[ (b+f)*n_rec + n ];
+      if( !b )
+        for( f=0; f<n_fld; f++ )
+          if( delta & ((uint32_t)1<<f) ) {
+            memcpy( &u, rec+4*f, 4 );
+            prev[f] += u;
+            memcpy( rec+4*f, &prev[f], 4 );
+          }
+      memcpy( dst + n*str_rec + b, rec, nb );
+    }
+  }
+}
+
+/* Pipelined block coding ****************************************************/
+
+typedef struct checkpt_codec_args {
+  char * data;         // Records
+  size_t sz_rec;       // Bytes in a record
+  size_t str_rec;      // Bytes between records
+  size_t n_rec;        // Number of records
+  size_t blk_rec;      // Records per block
+  uint32_t delta;      // Delta coded fields
+  size_t b0;           // First block of the round
+  size_t n_blk;        // Blocks in the round
+  int decode;          // Non-zero to decode the blocks
+  char * shuffled[ MAX_PIPELINE+1 ]; // Shuffled block of each pipeline
+  char * coded   [ MAX_PIPELINE+1 ]; // Coded block of each pipeline
+  size_t n_coded [ MAX_PIPELINE+1 ]; // Bytes in the coded block (0: stored)
+  int * table    [ MAX_PIPELINE+1 ]; // Match finder of each pipeline
+} checkpt_codec_args_t;
+
+static void
+checkpt_codec_pipeline_scalar( checkpt_codec_args_t * args,
+                               int pipeline_rank,
+                               int n_pipeline ) {
+  size_t r0, nr, sz;
+  if( pipeline_rank==n_pipeline ) return; /* No host straggler cleanup */
+  if( (size_t)pipeline_rank>=args->n_blk ) return;
+
+  r0 = ( args->b0 + (size_t)pipeline_rank )*args->blk_rec;
+  nr = args->n_rec - r0; if( nr>args->blk_rec ) nr = args->blk_rec;
+  sz = nr*args->sz_rec;
+
+  if( args->decode ) {
+    if( args->n_coded[ pipeline_rank ] )
+      checkpt_decompress( args->coded[ pipeline_rank ],
+                          args->n_coded[ pipeline_rank ],
+                          args->shuffled[ pipeline_rank ], sz );
+    else
+      memcpy( args->shuffled[ pipeline_rank ], args->coded[ pipeline_rank ],
+              sz );
+    checkpt_unshuffle( args->shuffled[ pipeline_rank ],
+                       args->data + r0*args->str_rec, nr,
+                       args->sz_rec, args->str_rec, args->delta );
+  } else {
+    checkpt_shuffle( args->data + r0*args->str_rec,
+                     args->shuffled[ pipeline_rank ], nr,
+                     args->sz_rec, args->str_rec, args->delta );
+    args->n_coded[ pipeline_rank ] =
+      checkpt_compress( args->shuffled[ pipeline_rank ], sz,
+                        args->coded[ pipeline_rank ],
+                        args->table[ pipeline_rank ] );
+  }
+}
+
+static void
+new_codec_args( checkpt_codec_args_t * args,
+                const void * data,
+                size_t sz_rec,
+                size_t str_rec,
+                size_t n_rec,
+                uint32_t delta,
+                size_t blk_rec,
+                int decode ) {
+  int r;
+  CLEAR( args, 1 );
+  args->data    = (char *)data;
+  args->sz_rec  = sz_rec;
+  args->str_rec = str_rec;
+  args->n_rec   = n_rec;
+  args->blk_rec = blk_rec;
+  args->delta   = delta;
+  args->decode  = decode;
+  for( r=0; r<N_PIPELINE; r++ ) {
+    MALLOC( args->shuffled[r], blk_rec*sz_rec );
+    MALLOC( args->coded[r],    checkpt_compress_bound( blk_rec*sz_rec ) );
+    if( !decode ) MALLOC( args->table[r], (size_t)1<<CHECKPT_CODEC_HASH );
+  }
+}
+
+static void
+delete_codec_args( checkpt_codec_args_t * args ) {
+  int r;
+  for( r=0; r<N_PIPELINE; r++ ) {
+    FREE( args->table[r] );
+    FREE( args->coded[r] );
+    FREE( args->shuffled[r] );
+  }
+}
+
+size_t
+checkpt_codec_block( size_t sz_rec ) {
+  return sz_rec<CHECKPT_CODEC_BLOCK ? CHECKPT_CODEC_BLOCK/sz_rec : 1;
+}
+
+void
+checkpt_coded( const void * data,
+               size_t sz_rec,
+               size_t str_rec,
+               size_t n_rec,
+               uint32_t delta,
+               size_t blk_rec ) {
+  checkpt_codec_args_t args[1];
+  size_t n_blk = ( n_rec + blk_rec - 1 )/blk_rec, b, nr;
+  int r;
+
+  new_codec_args( args, data, sz_rec, str_rec, n_rec, delta, blk_rec, 0 );
+  for( b=0; b<n_blk; b+=args->n_blk ) {
+    args->b0    = b;
+    args->n_blk = n_blk-b < (size_t)N_PIPELINE ? n_blk-b : (size_t)N_PIPELINE;
+    EXEC_PIPELINES( checkpt_codec, args, 0 );
+    WAIT_PIPELINES();
+    for( r=0; r<(int)args->n_blk; r++ ) {
+      nr = n_rec - (b+r)*blk_rec; if( nr>blk_rec ) nr = blk_rec;
+      CHECKPT_VAL( size_t, args->n_coded[r] );
+      if( args->n_coded[r] ) checkpt_raw( args->coded[r], args->n_coded[r] );
+      else                   checkpt_raw( args->shuffled[r], nr*sz_rec );
+    }
+  }
+  delete_codec_args( args );
+}
+
+void
+restore_coded( void * data,
+               size_t sz_rec,
+               size_t str_rec,
+               size_t n_rec,
+               uint32_t delta,
+               size_t blk_rec ) {
+  checkpt_codec_args_t args[1];
+  size_t n_blk = ( n_rec + blk_rec - 1 )/blk_rec, b, nr;
+  int r;
+
+  new_codec_args( args, data, sz_rec, str_rec, n_rec, delta, blk_rec, 1 );
+  for( b=0; b<n_blk; b+=args->n_blk ) {
+    args->b0    = b;
+    args->n_blk = n_blk-b < (size_t)N_PIPELINE ? n_blk-b : (size_t)N_PIPELINE;
+    for( r=0; r<(int)args->n_blk; r++ ) {
+      nr = n_rec - (b+r)*blk_rec; if( nr>blk_rec ) nr = blk_rec;
+      RESTORE_VAL( size_t, args->n_coded[r] );
+      if( args->n_coded[r]>checkpt_compress_bound( nr*sz_rec ) )
+        ERROR(( "malformed checkpt (bad coded block size)" ));
+      restore_raw( args->coded[r],
+                   args->n_coded[r] ? args->n_coded[r] : nr*sz_rec );
+    }
+    EXEC_PIPELINES( checkpt_codec, args, 0 );
+    WAIT_PIPELINES();
+  }
+  delete_codec_args( args );
+}
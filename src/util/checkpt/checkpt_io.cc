@@ -12,21 +12,43 @@ checkpt_open_wronly( const char * name ) {
 	return CheckPtIO::checkpt_open_wronly(name);
 }
 
+checkpt_t *
+checkpt_open_memory( void ) {
+	return CheckPtMem::checkpt_open_memory();
+}
+
+checkpt_t *
+checkpt_open_image( char * image,
+                    size_t sz ) {
+	if( !image ) ERROR(( "NULL image" ));
+	return CheckPtMem::checkpt_open_image(image, sz);
+}
+
+char *
+checkpt_image( checkpt_t * checkpt,
+               size_t * sz ) {
+	if( !checkpt || checkpt->file || !sz ) ERROR(( "Bad args" ));
+	return CheckPtMem::checkpt_image(checkpt, sz);
+}
+
 void
 checkpt_close( checkpt_t * checkpt ) {
-	return CheckPtIO::checkpt_close(checkpt);
+	if( checkpt->file ) return CheckPtIO::checkpt_close(checkpt);
+	return CheckPtMem::checkpt_close(checkpt);
 }
 
 void
 checkpt_read( checkpt_t * checkpt,
               void * data,
               size_t sz ) {
-	return CheckPtIO::checkpt_read(checkpt, data, sz);
+	if( checkpt->file ) return CheckPtIO::checkpt_read(checkpt, data, sz);
+	return CheckPtMem::checkpt_read(checkpt, data, sz);
 }
 
 void
 checkpt_write( checkpt_t * checkpt,
                const void * data,
                size_t sz ) {
-	return CheckPtIO::checkpt_write(checkpt, data, sz);
+	if( checkpt->file ) return CheckPtIO::checkpt_write(checkpt, data, sz);
+	return CheckPtMem::checkpt_write(checkpt, data, sz);
 }
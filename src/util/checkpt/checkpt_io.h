@@ -4,8 +4,51 @@
 #include "checkpt_private.h"
 #include "../io/FileIO.h"
 
+/* A checkpt stream is either backed by a file or by an image in memory
+   (file is NULL).  A memory stream grows its image as it is written.  A
+   file stream uses its image as a write-behind (read-ahead) buffer of
+   CHECKPT_BUFFER bytes so that the many small writes (reads) of a
+   checkpt become a few large ones; transfers at least as large as the
+   buffer go straight to the file. */
+
+enum checkpt_io_enums {
+	CHECKPT_BUFFER = 1 << 23,
+	CHECKPT_BUFFER_ALIGN = 4096
+};
+
+struct checkpt {
+	FileIO * file; // File of a file stream
+	char * image;  // Image of a memory stream (buffer of a file stream)
+	size_t sz;     // Bytes in the image
+	size_t max;    // Bytes allocated for the image
+	size_t off;    // Read offset into the image
+	int writing;   // Non-zero if the stream is written
+}; // struct checkpt
+
 struct CheckPtIO {
 
+	static checkpt_t * open_buffer(FileIO * fileIO, int writing) {
+		checkpt_t * checkpt;
+		MALLOC(checkpt, 1);
+		CLEAR(checkpt, 1);
+		checkpt->file = fileIO;
+		checkpt->writing = writing;
+		checkpt->max = CHECKPT_BUFFER;
+		MALLOC_ALIGNED(checkpt->image, checkpt->max, CHECKPT_BUFFER_ALIGN);
+		return checkpt;
+	} // open_buffer
+
+	// Write out the buffered bytes (a read stream just drops them)
+
+	static void flush_buffer(checkpt_t * checkpt) {
+		if(checkpt->writing && checkpt->sz &&
+			checkpt->file->write(checkpt->image, checkpt->sz) != checkpt->sz) {
+			ERROR(("Unable to write checkpt"));
+		} // if
+
+		checkpt->sz = checkpt->off = 0;
+	} // flush_buffer
+
 	static checkpt_t * checkpt_open_rdonly(const char * name) {
 		if(!name) ERROR(("NULL name"));
 
@@ -15,7 +58,7 @@ struct CheckPtIO {
   			ERROR(( "Unable to open \"%s\" for checkpt read", name ));
 		} // if
 
-		return reinterpret_cast<checkpt_t *>(fileIO);
+		return open_buffer(fileIO, 0);
 	} // checkpt_open_rdonly
 
 	static checkpt_t * checkpt_open_wronly(const char * name) {
@@ -27,11 +70,13 @@ struct CheckPtIO {
   			ERROR(("Unable to open \"%s\" for checkpt read", name));
 		} // if
 
-		return reinterpret_cast<checkpt_t *>(fileIO);
+		return open_buffer(fileIO, 1);
 	} // checkpt_open_wronly
 
 	static void checkpt_close(checkpt_t * checkpt) {
-		FileIO * fileIO = reinterpret_cast<FileIO *>(checkpt);
+		FileIO * fileIO = checkpt->file;
+
+		flush_buffer(checkpt);
 
 		int32_t err = fileIO->close();
 
@@ -40,29 +85,132 @@ struct CheckPtIO {
 		} // if
 
 		delete fileIO;
+		FREE_ALIGNED(checkpt->image);
+		FREE(checkpt);
 	} // checkpt_close
 
+	// The buffer of a read stream holds the bytes off:sz-1 still to be
+	// read, that of a write stream the bytes 0:sz-1 still to be written.
+
 	static void checkpt_read(checkpt_t * checkpt, void * data, size_t sz) {
 		if(!sz) return;
 		if(!checkpt || !data) ERROR(("Invalid checkpt_read request"));
 
-		FileIO * fileIO = reinterpret_cast<FileIO *>(checkpt);
+		FileIO * fileIO = checkpt->file;
+		char * _data = reinterpret_cast<char *>(data);
+		size_t n = checkpt->sz - checkpt->off;
+
+		if(sz <= n) {
+			memcpy(_data, checkpt->image + checkpt->off, sz);
+			checkpt->off += sz;
+			return;
+		} // if
+
+		memcpy(_data, checkpt->image + checkpt->off, n);
+		_data += n, sz -= n;
+		checkpt->sz = checkpt->off = 0;
+
+		if(sz >= checkpt->max) {
+			if(fileIO->read(_data, sz) != sz) {
+				ERROR(("Read past the end of the checkpt"));
+			} // if
+			return;
+		} // if
 
-		// FIXME: add return values
-		fileIO->read(reinterpret_cast<char *>(data), sz);
+		checkpt->sz = fileIO->read(checkpt->image, checkpt->max);
+		if(checkpt->sz < sz) ERROR(("Read past the end of the checkpt"));
+		memcpy(_data, checkpt->image, sz);
+		checkpt->off = sz;
 	} // checkpt_read
 
 	static void checkpt_write(checkpt_t * checkpt, const void * data,
 		size_t sz) {
 		if(!sz) return;
-		if(!checkpt || !data) ERROR(("Invalid checkpt_read request"));
+		if(!checkpt || !data) ERROR(("Invalid checkpt_write request"));
+
+		FileIO * fileIO = checkpt->file;
 
-		FileIO * fileIO = reinterpret_cast<FileIO *>(checkpt);
+		if(sz > checkpt->max - checkpt->sz) flush_buffer(checkpt);
 
-		// FIXME: add return values
-		fileIO->write(reinterpret_cast<const char *>(data), sz);
+		if(sz >= checkpt->max) {
+			if(fileIO->write(reinterpret_cast<const char *>(data), sz) != sz) {
+				ERROR(("Unable to write checkpt"));
+			} // if
+			return;
+		} // if
+
+		memcpy(checkpt->image + checkpt->sz, data, sz);
+		checkpt->sz += sz;
 	} // checkpt_write
 
 }; // struct CheckPtIO
 
+struct CheckPtMem {
+
+	static checkpt_t * checkpt_open_memory() {
+		checkpt_t * checkpt;
+		MALLOC(checkpt, 1);
+		CLEAR(checkpt, 1);
+		return checkpt;
+	} // checkpt_open_memory
+
+	// Read the given image (MALLOC'd, sz bytes); the stream takes it over
+
+	static checkpt_t * checkpt_open_image(char * image, size_t sz) {
+		checkpt_t * checkpt = checkpt_open_memory();
+		checkpt->image = image;
+		checkpt->sz = checkpt->max = sz;
+		return checkpt;
+	} // checkpt_open_image
+
+	static void checkpt_close(checkpt_t * checkpt) {
+		FREE(checkpt->image);
+		FREE(checkpt);
+	} // checkpt_close
+
+	static char * checkpt_image(checkpt_t * checkpt, size_t * sz) {
+		char * image = checkpt->image;
+
+		*sz = checkpt->sz;
+		checkpt->image = NULL;
+		checkpt->sz = checkpt->max = checkpt->off = 0;
+		return image;
+	} // checkpt_image
+
+	static void checkpt_read(checkpt_t * checkpt, void * data, size_t sz) {
+		if(!sz) return;
+		if(!checkpt || !data) ERROR(("Invalid checkpt_read request"));
+		if(sz > checkpt->sz - checkpt->off) {
+			ERROR(("Read past the end of the checkpt image"));
+		} // if
+
+		memcpy(data, checkpt->image + checkpt->off, sz);
+		checkpt->off += sz;
+	} // checkpt_read
+
+	static void checkpt_write(checkpt_t * checkpt, const void * data,
+		size_t sz) {
+		if(!sz) return;
+		if(!checkpt || !data) ERROR(("Invalid checkpt_write request"));
+
+		// Grow the image geometrically so writing it is amortized O(sz)
+
+		if(sz > checkpt->max - checkpt->sz) {
+			size_t max = checkpt->max ? checkpt->max : (size_t)1 << 20;
+			while(sz > max - checkpt->sz) max *= 2;
+
+			char * image;
+			MALLOC(image, max);
+			if(checkpt->sz) memcpy(image, checkpt->image, checkpt->sz);
+			FREE(checkpt->image);
+			checkpt->image = image;
+			checkpt->max = max;
+		} // if
+
+		memcpy(checkpt->image + checkpt->sz, data, sz);
+		checkpt->sz += sz;
+	} // checkpt_write
+
+}; // struct CheckPtMem
+
 #endif // CheckPtIO_h
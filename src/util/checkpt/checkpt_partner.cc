@@ -0,0 +1,268 @@
+#define IN_checkpt
+#include "checkpt_private.h"
+#include "../mp/mp.h"
+
+#include <stdio.h>
+
+/* Partner checkpts (in the style of SCR).  A partner checkpt serializes
+   the objects to an image in memory and swaps images with the partner
+   nodes.  Each node then keeps its own image and the image of the node
+   it is the partner of in the checkpt cache directory.  In a RAM backed
+   directory (e.g. /dev/shm), the images outlive the processes but cost
+   no parallel file system traffic.  When a machine is lost, the
+   processes restarted on its replacement get their images back from
+   their partners.
+
+   The partner of a node is the node at the same position on the next
+   machine, assuming the ranks are laid out on the machines in blocks of
+   the same size.  The images are named <name>.<rank> and
+   <name>.<rank>.partner (for the image held for node rank).  The new
+   images replace the previous ones only once all nodes have them.
+
+   Each image starts with the generation of the partner checkpt (the
+   number of partner checkpts made before it, counting those of the run
+   it was restored from).  If a run died while the images were replaced,
+   the nodes can hold images of different checkpts; a restore checks
+   that all images have the same generation. */
+
+static int partner_shift = -1;
+static int64_t partner_generation = 0;
+
+static int
+shift( void ) {
+  int node[2], * nodes, r, n_near = 0;
+
+  if( partner_shift>=0 ) return partner_shift;
+
+  mp_node( &node[0], &node[1] );
+  MALLOC( nodes, 2*world_size );
+  mp_allgather_i( node, nodes, 2 );
+
+  partner_shift = world_size;
+  for( r=0; r<world_size; r++ )
+    if( nodes[2*r+1]<partner_shift ) partner_shift = nodes[2*r+1];
+  if( partner_shift>=world_size ) partner_shift = world_size>1 ? 1 : 0;
+
+  for( r=0; r<world_size; r++ )
+    if( nodes[ 2*( ( r + partner_shift ) % world_size ) ]==nodes[2*r] )
+      n_near++;
+  if( n_near && world_rank==0 )
+    WARNING(( "%i of %i nodes have their partner on the same machine; "
+              "their partner checkpts will not survive losing it",
+              n_near, world_size ));
+
+  FREE( nodes );
+  return partner_shift;
+}
+
+static char *
+cache_name( const char * name,
+            int rank,
+            const char * suffix ) {
+  const char * base = strrchr( name, '/' );
+  char * fname;
+  base = base ? base+1 : name;
+  MALLOC( fname, strlen( checkpt_cache() ) + strlen( base ) +
+                 strlen( suffix ) + 32 );
+  sprintf( fname, "%s/%s.%i%s", checkpt_cache(), base, rank, suffix );
+  return fname;
+}
+
+/* Write an image next to its place in the cache (commit_cache puts it
+   in place) */
+
+static void
+write_cache( const char * name,
+             int rank,
+             const char * suffix,
+             int64_t gen,
+             const char * image,
+             size_t sz ) {
+  char * tname = cache_name( name, rank, suffix );
+  FILE * file;
+
+  strcat( tname, ".tmp" );
+  file = fopen( tname, "wb" );
+  if( !file ) ERROR(( "Unable to open \"%s\" for partner checkpt", tname ));
+  if( fwrite( &gen, sizeof(gen), 1, file )!=1 ||
+      fwrite( image, 1, sz, file )!=sz || fclose( file ) )
+    ERROR(( "Unable to write partner checkpt \"%s\"", tname ));
+
+  FREE( tname );
+}
+
+static void
+commit_cache( const char * name,
+              int rank,
+              const char * suffix ) {
+  char * fname = cache_name( name, rank, suffix );
+  char * tname = cache_name( name, rank, suffix );
+
+  strcat( tname, ".tmp" );
+  if( rename( tname, fname ) )
+    ERROR(( "Unable to rename \"%s\" to \"%s\"", tname, fname ));
+
+  FREE( tname );
+  FREE( fname );
+}
+
+/* Returns NULL if there is no image (or only part of its generation) */
+
+static char *
+read_cache( const char * name,
+            int rank,
+            const char * suffix,
+            int64_t * gen,
+            size_t * sz ) {
+  char * fname = cache_name( name, rank, suffix ), * image = NULL;
+  FILE * file = fopen( fname, "rb" );
+  long n;
+
+  *gen = -1;
+  *sz  = 0;
+  if( file ) {
+    if( fseek( file, 0, SEEK_END ) || ( n = ftell( file ) )<0 ||
+        fseek( file, 0, SEEK_SET ) )
+      ERROR(( "Unable to size partner checkpt \"%s\"", fname ));
+    n -= sizeof(*gen);
+    if( n>=0 ) {
+      MALLOC( image, n ? n : 1 );
+      if( fread( gen, sizeof(*gen), 1, file )!=1 ||
+          fread( image, 1, n, file )!=(size_t)n )
+        ERROR(( "Unable to read partner checkpt \"%s\"", fname ));
+      *sz = n;
+    }
+    fclose( file );
+  }
+
+  FREE( fname );
+  return image;
+}
+
+void
+checkpt_objects_partner( const char * name ) {
+  static int warned = 0;
+  int s, partner, source;
+  int64_t n, m;
+  char * image, * copy;
+  size_t sz;
+
+  if( !name ) ERROR(( "NULL name" ));
+  if( !checkpt_cache() ) {
+    if( !warned && world_rank==0 )
+      MESSAGE(( "No --checkpt.cache given; partner checkpts are off" ));
+    warned = 1;
+    return;
+  }
+
+  s       = shift();
+  partner = ( world_rank + s ) % world_size;
+  source  = ( world_rank - s + world_size ) % world_size;
+
+  image = checkpt_objects_image( &sz );
+
+  n = sz;
+  mp_sendrecv_c( (char *)&n, sizeof(n), partner,
+                 (char *)&m, sizeof(m), source );
+  MALLOC( copy, m ? m : 1 );
+  mp_sendrecv_c( image, n, partner, copy, m, source );
+
+  // All nodes make the same partner checkpts, so the copy is of the same
+  // generation
+
+  write_cache( name, world_rank, "",         partner_generation, image, sz );
+  write_cache( name, source,     ".partner", partner_generation, copy,  m  );
+  partner_generation++;
+
+  // Only replace the previous images once all nodes have the new ones
+
+  mp_barrier();
+  commit_cache( name, world_rank, ""         );
+  commit_cache( name, source,     ".partner" );
+
+  FREE( copy );
+  FREE( image );
+}
+
+int
+restore_objects_partner( const char * name ) {
+  int s, partner, source, need, src_need, held, partner_held, bad, n_bad, r;
+  int64_t n[2], m[2], gen, copy_gen, * gens;
+  char * image, * copy;
+  size_t sz, copy_sz;
+
+  if( !name ) ERROR(( "NULL name" ));
+  if( !checkpt_cache() ) ERROR(( "No --checkpt.cache given" ));
+
+  s       = shift();
+  partner = ( world_rank + s ) % world_size;
+  source  = ( world_rank - s + world_size ) % world_size;
+
+  image = read_cache( name, world_rank, "",         &gen,      &sz      );
+  copy  = read_cache( name, source,     ".partner", &copy_gen, &copy_sz );
+
+  // Find which nodes need their image back and whether their partner
+  // still holds it
+
+  need = !image;
+  held = !!copy;
+  mp_sendrecv_c( (char *)&need, sizeof(int), partner,
+                 (char *)&src_need, sizeof(int), source );
+  mp_sendrecv_c( (char *)&held, sizeof(int), source,
+                 (char *)&partner_held, sizeof(int), partner );
+
+  bad = need && !partner_held;
+  mp_allsum_i( &bad, &n_bad, 1 );
+  if( n_bad ) {
+    if( world_rank==0 )
+      MESSAGE(( "%i nodes lost their partner checkpt \"%s\"", n_bad, name ));
+    if( image ) FREE( image );
+    if( copy  ) FREE( copy );
+    return 0;
+  }
+
+  // Send the images back (with their generation)
+
+  n[0] = src_need ? copy_sz : 0;
+  n[1] = copy_gen;
+  m[0] = 0;
+  m[1] = -1;
+  mp_sendrecv_c( (char *)n, sizeof(n), src_need ? source : -1,
+                 (char *)m, sizeof(m), need ? partner : -1 );
+  if( need ) {
+    MALLOC( image, m[0] ? m[0] : 1 );
+    sz  = m[0];
+    gen = m[1];
+  }
+  mp_sendrecv_c( copy, n[0], src_need ? source : -1,
+                 image, m[0], need ? partner : -1 );
+  if( copy ) FREE( copy );
+
+  // Check that the images are all of the same partner checkpt
+
+  MALLOC( gens, world_size );
+  mp_allgather_i64( &gen, gens, 1 );
+  for( bad=0, r=0; r<world_size; r++ ) bad |= gens[r]!=gens[0];
+  FREE( gens );
+  if( bad ) {
+    if( world_rank==0 )
+      MESSAGE(( "The images of partner checkpt \"%s\" are of different "
+                "checkpts", name ));
+    FREE( image );
+    return 0;
+  }
+
+  // Put the recovered images in the cache again
+
+  mp_allsum_i( &need, &n_bad, 1 );
+  if( n_bad && world_rank==0 )
+    MESSAGE(( "Recovered %i partner checkpt images", n_bad ));
+  if( need ) {
+    write_cache(  name, world_rank, "", gen, image, sz );
+    commit_cache( name, world_rank, "" );
+  }
+
+  partner_generation = gen + 1;
+  restore_objects_image( image, sz );
+  return 1;
+}
@@ -18,6 +18,22 @@ checkpt_open_rdonly( const char * name );
 checkpt_t *
 checkpt_open_wronly( const char * name );
 
+/* A memory stream writes to an image in memory.  checkpt_image hands
+   the image (MALLOC'd, sz bytes) to the caller; the stream still has to
+   be closed.  checkpt_open_image reads an image (MALLOC'd, sz bytes)
+   and frees it when closed. */
+
+checkpt_t *
+checkpt_open_memory( void );
+
+checkpt_t *
+checkpt_open_image( char * image,
+                    size_t sz );
+
+char *
+checkpt_image( checkpt_t * checkpt,
+               size_t * sz );
+
 void
 checkpt_close( checkpt_t * checkpt );
 
@@ -31,6 +47,71 @@ checkpt_write( checkpt_t * checkpt,
                const void * data,
                size_t sz );
 
+/* The directory partner checkpts are kept in (NULL if none was given
+   with --checkpt.cache, see checkpt_partner.cc). */
+
+const char *
+checkpt_cache( void );
+
+/* In checkpt_codec.cc.  checkpt_coded (restore_coded) writes (reads)
+   n_rec records compressed in blocks of blk_rec records (see
+   checkpt_codec_block) with the integer fields flagged in delta
+   delta-coded.  The blocks are coded by the pipelines.  The lower level
+   pieces are exposed for testing. */
+
+size_t
+checkpt_codec_block( size_t sz_rec );
+
+void
+checkpt_coded( const void * data,
+               size_t sz_rec,
+               size_t str_rec,
+               size_t n_rec,
+               uint32_t delta,
+               size_t blk_rec );
+
+void
+restore_coded( void * data,
+               size_t sz_rec,
+               size_t str_rec,
+               size_t n_rec,
+               uint32_t delta,
+               size_t blk_rec );
+
+size_t
+checkpt_compress_bound( size_t n );
+
+/* Returns the compressed size or 0 if n bytes do not compress.  dst
+   holds checkpt_compress_bound(n) bytes and table 2^16 ints. */
+
+size_t
+checkpt_compress( const void * src,
+                  size_t n,
+                  void * dst,
+                  int * table );
+
+void
+checkpt_decompress( const void * src,
+                    size_t n_src,
+                    void * dst,
+                    size_t n_dst );
+
+void
+checkpt_shuffle( const void * src,
+                 void * dst,
+                 size_t n_rec,
+                 size_t sz_rec,
+                 size_t str_rec,
+                 uint32_t delta );
+
+void
+checkpt_unshuffle( const void * src,
+                   void * dst,
+                   size_t n_rec,
+                   size_t sz_rec,
+                   size_t str_rec,
+                   uint32_t delta );
+
 END_C_DECLS
 
 #endif /* _checkpt_private_h_ */
@@ -2,6 +2,7 @@
 #define DMPPolicy_h
 
 #include <mpi.h>
+#include <sched.h>
 #include <cstdlib>
 #include <cstdlib>
 
@@ -17,14 +18,58 @@ struct collective {
   MPI_Comm comm;
 };
 
+/* A persistent request bound to a port for a given buffer, size, peer
+   and tag.  Each port keeps up to MP_N_BINDING of them (the ghost
+   exchanges of the different field quantities all go through the same
+   ports with different sizes). */
+
+#define MP_N_BINDING 8
+
+typedef struct mp_binding {
+  char * buf;
+  int sz, peer, tag;
+  MPI_Request req;
+} mp_binding_t;
+
 struct mp {
   int n_port;
   char * ALIGNED(128) * rbuf; char * ALIGNED(128) * sbuf;
   int * rbuf_sz;              int * sbuf_sz;
   int * rreq_sz;              int * sreq_sz;
   MPI_Request * rreq;         MPI_Request * sreq;
+
+  // Persistent requests (n_port*MP_N_BINDING of each).  rbound/sbound
+  // give the binding in flight on a port (-1 if none) and
+  // rvictim/svictim the binding to replace next.
+  mp_binding_t * rbind;       mp_binding_t * sbind;
+  int * rbound;               int * sbound;
+  int * rvictim;              int * svictim;
+
+  // Neighborhood collectives (enabled if neighbors is set).  peer[port]
+  // is the process joined to port (-1 if none).  The neighborhood
+  // communicator is created on first use (the handle does not survive a
+  // checkpoint).
+  int * peer;
+  int n_peer, neighbors;
+  MPI_Comm ncomm;
+
+  // Same node exchanges (see mp_share_node).  Each process exposes one
+  // slot of s_cap bytes (after a MP_SLOT_HDR byte header) per port in a
+  // shared memory window.  base[rank] is the window segment of world
+  // rank (NULL if rank is on another node).  rslot[port] is the slot
+  // the receive in flight on port reads (NULL if it goes through MPI)
+  // and sshared[port] is set if the send in flight on port went through
+  // the window.
+  int s_cap;
+  MPI_Comm scomm;
+  MPI_Win swin;
+  char ** base;
+  char ** rslot;
+  int * sshared;
 };
 
+#define MP_SLOT_HDR 128
+
 /* Create the world collective */
 
 static collective_t __world = { NULL, 0, 0, MPI_COMM_SELF };
@@ -59,6 +104,10 @@ restore_collective( void ) {
 
 /* mp checkpointer */
 
+static void
+share_node_mp( mp_t * mp,
+               int cap );
+
 void
 checkpt_mp( mp_t * mp ) {
   int port;
@@ -67,6 +116,12 @@ checkpt_mp( mp_t * mp ) {
   CHECKPT( mp->rbuf_sz, mp->n_port ); CHECKPT( mp->sbuf_sz, mp->n_port );
   CHECKPT( mp->rreq_sz, mp->n_port ); CHECKPT( mp->sreq_sz, mp->n_port );
   CHECKPT( mp->rreq,    mp->n_port ); CHECKPT( mp->sreq,    mp->n_port );
+  CHECKPT( mp->rbind,   mp->n_port*MP_N_BINDING );
+  CHECKPT( mp->sbind,   mp->n_port*MP_N_BINDING );
+  CHECKPT( mp->rbound,  mp->n_port ); CHECKPT( mp->sbound,  mp->n_port );
+  CHECKPT( mp->rvictim, mp->n_port ); CHECKPT( mp->svictim, mp->n_port );
+  CHECKPT( mp->peer,    mp->n_port );
+  CHECKPT( mp->rslot,   mp->n_port ); CHECKPT( mp->sshared, mp->n_port );
   for( port=0; port<mp->n_port; port++ ) {
     CHECKPT_ALIGNED( mp->rbuf[port], mp->rbuf_sz[port], 128 );
     CHECKPT_ALIGNED( mp->sbuf[port], mp->sbuf_sz[port], 128 );
@@ -82,13 +137,41 @@ restore_mp( void ) {
   RESTORE( mp->rbuf_sz ); RESTORE( mp->sbuf_sz );
   RESTORE( mp->rreq_sz ); RESTORE( mp->sreq_sz );
   RESTORE( mp->rreq    ); RESTORE( mp->sreq    );
+  RESTORE( mp->rbind   ); RESTORE( mp->sbind   );
+  RESTORE( mp->rbound  ); RESTORE( mp->sbound  );
+  RESTORE( mp->rvictim ); RESTORE( mp->svictim );
+  RESTORE( mp->peer    );
+  RESTORE( mp->rslot   ); RESTORE( mp->sshared );
   for( port=0; port<mp->n_port; port++ ) {
     RESTORE_ALIGNED( mp->rbuf[port] );
     RESTORE_ALIGNED( mp->sbuf[port] );
   }
+
+  // The MPI handles are meaningless in this process.  The persistent
+  // requests and the neighborhood communicator are recreated on demand.
+
+  for( port=0; port<mp->n_port*MP_N_BINDING; port++ ) {
+    mp->rbind[port].buf = NULL; mp->rbind[port].req = MPI_REQUEST_NULL;
+    mp->sbind[port].buf = NULL; mp->sbind[port].req = MPI_REQUEST_NULL;
+  }
+  for( port=0; port<mp->n_port; port++ ) mp->rbound[port] = mp->sbound[port] = -1;
+  mp->ncomm = MPI_COMM_NULL;
+
+  // The shared memory window is recreated when mp is reanimated (all
+  // processes have restored their objects by then).
+
+  for( port=0; port<mp->n_port; port++ ) mp->rslot[port] = NULL, mp->sshared[port] = 0;
+  mp->scomm = MPI_COMM_NULL;
+  mp->swin  = MPI_WIN_NULL;
+  mp->base  = NULL;
   return mp;
 }
 
+void
+reanimate_mp( mp_t * mp ) {
+  if( mp->s_cap ) share_node_mp( mp, mp->s_cap );
+}
+
 struct DMPPolicy {
 
   // FIXME-KJB: The whole sizing process in here is kinda silly and should
@@ -175,7 +258,114 @@ struct DMPPolicy {
     if( !sbuf || (!rbuf && world_rank==0) || n<1 ) ERROR(( "Bad args" ));
     TRAP( MPI_Gather( sbuf, n, MPI_CHAR, rbuf, n, MPI_CHAR, 0, world->comm ) );
   }
+
+  inline void
+  mp_alltoall_i64( int64_t * sbuf,
+                   int64_t * rbuf,
+                   int n ) {
+    if( !sbuf || !rbuf || n<1 ) ERROR(( "Bad args" ));
+    TRAP( MPI_Alltoall( sbuf, n, MPI_LONG_LONG, rbuf, n, MPI_LONG_LONG, world->comm ) );
+  }
+
+  inline void
+  mp_alltoallv_c( char * sbuf,
+                  const int64_t * scount,
+                  char * rbuf,
+                  const int64_t * rcount ) {
+    const int64_t limit = ( (int64_t)1 << 31 ) - 1;
+    int64_t * sdisp, * rdisp, total[2], max[2];
+    int * sc, * sd, * rc, * rd, r, s;
+    if( !scount || !rcount ) ERROR(( "Bad args" ));
+    MALLOC( sdisp, world_size+1 );
+    MALLOC( rdisp, world_size+1 );
+    sdisp[0] = rdisp[0] = 0;
+    for( r=0; r<world_size; r++ ) {
+      if( scount[r]<0 || rcount[r]<0 ) ERROR(( "Bad args" ));
+      sdisp[r+1] = sdisp[r] + scount[r];
+      rdisp[r+1] = rdisp[r] + rcount[r];
+    }
+    total[0] = sdisp[world_size];
+    total[1] = rdisp[world_size];
+    TRAP( MPI_Allreduce( total, max, 2, MPI_LONG_LONG, MPI_MAX, world->comm ) );
+
+    if( max[0]<=limit && max[1]<=limit ) {
+
+      // The counts and displacements of all nodes fit in an int
+
+      MALLOC( sc, 4*world_size );
+      sd = sc +   world_size;
+      rc = sc + 2*world_size;
+      rd = sc + 3*world_size;
+      for( r=0; r<world_size; r++ ) {
+        sc[r] = (int)scount[r]; sd[r] = (int)sdisp[r];
+        rc[r] = (int)rcount[r]; rd[r] = (int)rdisp[r];
+      }
+      TRAP( MPI_Alltoallv( sbuf, sc, sd, MPI_BYTE,
+                           rbuf, rc, rd, MPI_BYTE, world->comm ) );
+      FREE( sc );
+
+    } else {
+
+      // Exchange with one node after the other instead.  In round s, a
+      // node sends to the node s ranks up and receives from the node s
+      // ranks down.  mp_sendrecv_c splits the messages into chunks and
+      // skips the empty ones.
+
+      for( s=0; s<world_size; s++ ) {
+        int dst = ( world_rank + s ) % world_size;
+        int src = ( world_rank - s + world_size ) % world_size;
+        mp_sendrecv_c( sbuf + sdisp[dst], scount[dst], dst,
+                       rbuf + rdisp[src], rcount[src], src );
+      }
+
+    }
+
+    FREE( rdisp );
+    FREE( sdisp );
+  }
   
+  inline void
+  mp_sendrecv_c( const char * sbuf,
+                 int64_t scount,
+                 int dst,
+                 char * rbuf,
+                 int64_t rcount,
+                 int src ) {
+    const int64_t chunk = (int64_t)1 << 30;
+    int64_t off;
+    int ns, nr;
+    if( scount<0 || rcount<0 || ( scount && !sbuf ) || ( rcount && !rbuf ) ||
+        dst<-1 || dst>=world_size || src<-1 || src>=world_size )
+      ERROR(( "Bad args" ));
+    if( dst<0 ) scount = 0;
+    if( src<0 ) rcount = 0;
+
+    // Both ends of a transfer split it into the same chunks
+
+    for( off=0; off<scount || off<rcount; off+=chunk ) {
+      ns = off<scount ? (int)( scount-off<chunk ? scount-off : chunk ) : 0;
+      nr = off<rcount ? (int)( rcount-off<chunk ? rcount-off : chunk ) : 0;
+      TRAP( MPI_Sendrecv( (void *)( sbuf + off ), ns, MPI_BYTE,
+                          ns ? dst : MPI_PROC_NULL, 0,
+                          rbuf + off, nr, MPI_BYTE,
+                          nr ? src : MPI_PROC_NULL, 0,
+                          world->comm, MPI_STATUS_IGNORE ) );
+    }
+  }
+
+  inline void
+  mp_node( int * leader,
+           int * size ) {
+    MPI_Comm ncomm;
+    int rank = world_rank;
+    if( !leader || !size ) ERROR(( "Bad args" ));
+    TRAP( MPI_Comm_split_type( world->comm, MPI_COMM_TYPE_SHARED, world_rank,
+                               MPI_INFO_NULL, &ncomm ) );
+    TRAP( MPI_Comm_size( ncomm, size ) );
+    TRAP( MPI_Allreduce( &rank, leader, 1, MPI_INT, MPI_MIN, ncomm ) );
+    TRAP( MPI_Comm_free( &ncomm ) );
+  }
+
   inline void
   mp_send_i( int * buf,
              int n,
@@ -206,7 +396,30 @@ struct DMPPolicy {
     CLEAR(  mp->rbuf_sz, n_port ); CLEAR(  mp->sbuf_sz, n_port ); 
     CLEAR(  mp->rreq_sz, n_port ); CLEAR(  mp->sreq_sz, n_port ); 
     CLEAR(  mp->rreq,    n_port ); CLEAR(  mp->sreq,    n_port ); 
-    REGISTER_OBJECT( mp, checkpt_mp, restore_mp, NULL );
+    MALLOC( mp->rbind,   n_port*MP_N_BINDING );
+    MALLOC( mp->sbind,   n_port*MP_N_BINDING );
+    MALLOC( mp->rbound,  n_port ); MALLOC( mp->sbound,  n_port );
+    MALLOC( mp->rvictim, n_port ); MALLOC( mp->svictim, n_port );
+    MALLOC( mp->peer,    n_port );
+    for( int b=0; b<n_port*MP_N_BINDING; b++ ) {
+      mp->rbind[b].buf = NULL; mp->rbind[b].req = MPI_REQUEST_NULL;
+      mp->sbind[b].buf = NULL; mp->sbind[b].req = MPI_REQUEST_NULL;
+    }
+    for( int port=0; port<n_port; port++ ) {
+      mp->rbound [port] = mp->sbound [port] = -1;
+      mp->rvictim[port] = mp->svictim[port] =  0;
+      mp->peer   [port] = -1;
+    }
+    mp->n_peer    = 0;
+    mp->neighbors = 0;
+    mp->ncomm     = MPI_COMM_NULL;
+    MALLOC( mp->rslot,   n_port ); CLEAR( mp->rslot,   n_port );
+    MALLOC( mp->sshared, n_port ); CLEAR( mp->sshared, n_port );
+    mp->s_cap = 0;
+    mp->scomm = MPI_COMM_NULL;
+    mp->swin  = MPI_WIN_NULL;
+    mp->base  = NULL;
+    REGISTER_OBJECT( mp, checkpt_mp, restore_mp, reanimate_mp );
     return mp;
   }
   
@@ -215,6 +428,19 @@ struct DMPPolicy {
     int port;
     if( !mp ) return;
     UNREGISTER_OBJECT( mp );
+    for( port=0; port<mp->n_port*MP_N_BINDING; port++ ) {
+      if( mp->rbind[port].req!=MPI_REQUEST_NULL )
+        TRAP( MPI_Request_free( &mp->rbind[port].req ) );
+      if( mp->sbind[port].req!=MPI_REQUEST_NULL )
+        TRAP( MPI_Request_free( &mp->sbind[port].req ) );
+    }
+    if( mp->ncomm!=MPI_COMM_NULL ) TRAP( MPI_Comm_free( &mp->ncomm ) );
+    share_node_mp( mp, 0 );
+    FREE( mp->sshared ); FREE( mp->rslot );
+    FREE( mp->peer    );
+    FREE( mp->rvictim ); FREE( mp->svictim );
+    FREE( mp->rbound  ); FREE( mp->sbound  );
+    FREE( mp->rbind   ); FREE( mp->sbind   );
     for( port=0; port<mp->n_port; port++ ) {
       FREE_ALIGNED( mp->rbuf[port] ); FREE_ALIGNED( mp->sbuf[port] ); 
     }
@@ -300,6 +526,52 @@ struct DMPPolicy {
     mp->sbuf_sz[port] = sz;
   }
   
+  // Messages between processes on the same node go through the slot of
+  // the sending process for the message tag (the grid exchanges tag
+  // their messages with the sending port) when they fit in it.  Both
+  // sides make the same choice from the peer, size and tag.  A slot
+  // holds one message at a time: the sender waits until the receiver
+  // has copied out the previous one.
+
+  inline char *
+  mp_slot( mp_t * mp,
+           int peer,
+           int owner,
+           int sz,
+           int tag ) {
+    if( !mp->base || !mp->base[peer] || sz>mp->s_cap ||
+        tag<0 || tag>=mp->n_port ) return NULL;
+    return mp->base[owner] + (size_t)tag*( MP_SLOT_HDR + mp->s_cap );
+  }
+
+  inline int
+  mp_slot_send( mp_t * mp,
+                int port,
+                int sz,
+                int dst,
+                int tag ) {
+    char * slot = mp_slot( mp, dst, world_rank, sz, tag );
+    int * hdr = (int *)slot;
+    if( !slot ) return 0;
+    while( __atomic_load_n( hdr, __ATOMIC_ACQUIRE ) ) sched_yield();
+    COPY( slot + MP_SLOT_HDR, mp->sbuf[port], sz );
+    hdr[1] = sz;
+    __atomic_store_n( hdr, 1, __ATOMIC_RELEASE );
+    mp->sshared[port] = 1;
+    return 1;
+  }
+
+  inline void
+  mp_slot_recv( mp_t * mp,
+                int port ) {
+    int * hdr = (int *)mp->rslot[port];
+    while( !__atomic_load_n( hdr, __ATOMIC_ACQUIRE ) ) sched_yield();
+    if( mp->rreq_sz[port]!=hdr[1] ) ERROR(( "Sizes do not match" ));
+    COPY( mp->rbuf[port], mp->rslot[port] + MP_SLOT_HDR, hdr[1] );
+    __atomic_store_n( hdr, 0, __ATOMIC_RELEASE );
+    mp->rslot[port] = NULL;
+  }
+
   inline void
   mp_begin_recv( mp_t * mp,
                  int port,
@@ -309,6 +581,7 @@ struct DMPPolicy {
     if( !mp || port<0 || port>=mp->n_port || sz<1 || sz>mp->rbuf_sz[port] ||
         src<0 || src>=world_size ) ERROR(( "Bad args" ));
     mp->rreq_sz[port] = sz;
+    if( ( mp->rslot[port] = mp_slot( mp, src, src, sz, tag ) ) ) return;
     TRAP(MPI_Irecv(mp->rbuf[port], sz, MPI_BYTE, src, tag, world->comm, &mp->rreq[port]));
   }
   
@@ -321,16 +594,88 @@ struct DMPPolicy {
     if( !mp || port<0 || port>=mp->n_port || dst<0 || dst>=world_size ||
         sz<1 || mp->sbuf_sz[port]<sz ) ERROR(( "Bad args" ));
     mp->sreq_sz[port] = sz;
+    if( mp_slot_send( mp, port, sz, dst, tag ) ) return;
     TRAP(MPI_Issend(mp->sbuf[port],sz, MPI_BYTE, dst, tag, world->comm, &mp->sreq[port]));
   }
   
+  // Find the persistent request of the port matching the buffer, size,
+  // peer and tag or, if there is none, replace one of the port's
+  // bindings with a new persistent request.
+
+  inline int
+  mp_bind( mp_binding_t * bind,
+           int * victim,
+           char * buf,
+           int sz,
+           int peer,
+           int tag,
+           int send ) {
+    mp_binding_t * b;
+    int n;
+    for( n=0; n<MP_N_BINDING; n++ ) {
+      b = bind + n;
+      if( b->buf==buf && b->sz==sz && b->peer==peer && b->tag==tag ) return n;
+    }
+    n = *victim; *victim = (n+1) % MP_N_BINDING;
+    b = bind + n;
+    if( b->req!=MPI_REQUEST_NULL ) TRAP( MPI_Request_free( &b->req ) );
+    b->buf = buf, b->sz = sz, b->peer = peer, b->tag = tag;
+    if( send ) TRAP( MPI_Ssend_init( buf, sz, MPI_BYTE, peer, tag, world->comm, &b->req ) );
+    else       TRAP( MPI_Recv_init(  buf, sz, MPI_BYTE, peer, tag, world->comm, &b->req ) );
+    return n;
+  }
+
+  inline void
+  mp_begin_recv_persistent( mp_t * mp,
+                            int port,
+                            int sz,
+                            int src,
+                            int tag ) {
+    mp_binding_t * bind;
+    if( !mp || port<0 || port>=mp->n_port || sz<1 || sz>mp->rbuf_sz[port] ||
+        src<0 || src>=world_size ) ERROR(( "Bad args" ));
+    bind = mp->rbind + port*MP_N_BINDING;
+    mp->rreq_sz[port] = sz;
+    if( ( mp->rslot[port] = mp_slot( mp, src, src, sz, tag ) ) ) return;
+    mp->rbound[port]  = mp_bind( bind, mp->rvictim + port,
+                                 mp->rbuf[port], sz, src, tag, 0 );
+    TRAP( MPI_Start( &bind[ mp->rbound[port] ].req ) );
+  }
+
+  inline void
+  mp_begin_send_persistent( mp_t * mp,
+                            int port,
+                            int sz,
+                            int dst,
+                            int tag ) {
+    mp_binding_t * bind;
+    if( !mp || port<0 || port>=mp->n_port || dst<0 || dst>=world_size ||
+        sz<1 || mp->sbuf_sz[port]<sz ) ERROR(( "Bad args" ));
+    bind = mp->sbind + port*MP_N_BINDING;
+    mp->sreq_sz[port] = sz;
+    if( mp_slot_send( mp, port, sz, dst, tag ) ) return;
+    mp->sbound[port]  = mp_bind( bind, mp->svictim + port,
+                                 mp->sbuf[port], sz, dst, tag, 1 );
+    TRAP( MPI_Start( &bind[ mp->sbound[port] ].req ) );
+  }
+
   inline void
   mp_end_recv( mp_t * mp,
                int port ) {
+    MPI_Request * req;
     MPI_Status status;
     int sz;
     if( !mp || port<0 || port>=mp->n_port ) ERROR(( "Bad args" ));
-    TRAP( MPI_Wait( &mp->rreq[port], &status ) );
+    if( mp->rslot[port] ) {
+      mp_slot_recv( mp, port );
+      return;
+    }
+    req = &mp->rreq[port];
+    if( mp->rbound[port]>=0 ) {
+      req = &mp->rbind[ port*MP_N_BINDING + mp->rbound[port] ].req;
+      mp->rbound[port] = -1;
+    }
+    TRAP( MPI_Wait( req, &status ) );
     TRAP( MPI_Get_count( &status, MPI_BYTE, &sz ) );
     if( mp->rreq_sz[port]!=sz ) ERROR(( "Sizes do not match" ));
   }
@@ -338,14 +683,143 @@ struct DMPPolicy {
   inline void
   mp_end_send( mp_t * mp,
                int port ) {
+    MPI_Request * req;
     if( !mp || port<0 || port>=mp->n_port ) ERROR(( "Bad args" ));
-    TRAP( MPI_Wait( &mp->sreq[port], MPI_STATUS_IGNORE ) );
+    if( mp->sshared[port] ) {
+      mp->sshared[port] = 0;
+      return;
+    }
+    req = &mp->sreq[port];
+    if( mp->sbound[port]>=0 ) {
+      req = &mp->sbind[ port*MP_N_BINDING + mp->sbound[port] ].req;
+      mp->sbound[port] = -1;
+    }
+    TRAP( MPI_Wait( req, MPI_STATUS_IGNORE ) );
+  }
+
+  inline void
+  mp_share_node( mp_t * mp,
+                 int cap ) {
+    if( !mp || cap<0 ) ERROR(( "Bad args" ));
+    share_node_mp( mp, cap );
+  }
+
+  inline void
+  mp_set_neighbors( mp_t * mp,
+                    const int * peer ) {
+    int port;
+    if( !mp ) ERROR(( "Bad args" ));
+    if( mp->ncomm!=MPI_COMM_NULL ) TRAP( MPI_Comm_free( &mp->ncomm ) );
+    mp->n_peer    = 0;
+    mp->neighbors = peer!=NULL;
+    for( port=0; port<mp->n_port; port++ ) {
+      mp->peer[port] = peer ? peer[port] : -1;
+      if( mp->peer[port]<-1 || mp->peer[port]>=world_size ) ERROR(( "Bad args" ));
+      if( mp->peer[port]>=0 ) mp->n_peer++;
+    }
+  }
+
+  inline int
+  mp_has_neighbors( const mp_t * mp ) {
+    if( !mp ) ERROR(( "Bad args" ));
+    return mp->neighbors;
+  }
+
+  inline void
+  mp_neighbor_alltoall_i( mp_t * mp,
+                          const int * sbuf,
+                          int * rbuf,
+                          int n ) {
+    int * src, * dst, * s, * r;
+    int port, k;
+
+    if( !mp || !sbuf || !rbuf || n<1 || !mp->neighbors ) ERROR(( "Bad args" ));
+
+    // The edges to a peer joined through several ports are matched in
+    // order.  The message sent on port p arrives on the peer's port
+    // n_port-1-p, so the sources are listed in decreasing port order
+    // and the destinations in increasing port order.
+
+    MALLOC( src, mp->n_peer ); MALLOC( dst, mp->n_peer );
+    MALLOC( s, n*mp->n_peer ); MALLOC( r, n*mp->n_peer );
+
+    for( port=0, k=0; port<mp->n_port; port++ )
+      if( mp->peer[port]>=0 ) dst[k++] = mp->peer[port];
+    for( port=mp->n_port-1, k=0; port>=0; port-- )
+      if( mp->peer[port]>=0 ) src[k++] = mp->peer[port];
+
+    if( mp->ncomm==MPI_COMM_NULL )
+      TRAP( MPI_Dist_graph_create_adjacent( world->comm,
+                                            mp->n_peer, src, MPI_UNWEIGHTED,
+                                            mp->n_peer, dst, MPI_UNWEIGHTED,
+                                            MPI_INFO_NULL, 0, &mp->ncomm ) );
+
+    for( port=0, k=0; port<mp->n_port; port++ )
+      if( mp->peer[port]>=0 ) COPY( s + n*(k++), sbuf + n*port, n );
+
+    TRAP( MPI_Neighbor_alltoall( s, n, MPI_INT, r, n, MPI_INT, mp->ncomm ) );
+
+    for( port=mp->n_port-1, k=0; port>=0; port-- )
+      if( mp->peer[port]>=0 ) COPY( rbuf + n*port, r + n*(k++), n );
+
+    FREE( r ); FREE( s );
+    FREE( dst ); FREE( src );
   }
-  
-# undef RESIZE_FACTOR
-# undef TRAP
 
 }; // struct DMPPolicy
 
+// Tear down the shared memory window of mp if any and, if cap is
+// nonzero, create one with a slot of cap bytes per port over the
+// processes of this node.
+
+static void
+share_node_mp( mp_t * mp,
+               int cap ) {
+  MPI_Group world_group, node_group;
+  MPI_Aint sz;
+  char * seg;
+  int disp_unit, n_node, q, r, port;
+
+  if( mp->swin!=MPI_WIN_NULL ) {
+    TRAP( MPI_Win_unlock_all( mp->swin ) );
+    TRAP( MPI_Win_free( &mp->swin ) );
+    TRAP( MPI_Comm_free( &mp->scomm ) );
+  }
+  FREE( mp->base );
+  mp->s_cap = 0;
+  if( !cap ) return;
+
+  cap = ( ( cap + 127 ) / 128 ) * 128;
+  TRAP( MPI_Comm_split_type( world->comm, MPI_COMM_TYPE_SHARED, world_rank,
+                             MPI_INFO_NULL, &mp->scomm ) );
+  TRAP( MPI_Win_allocate_shared( (MPI_Aint)mp->n_port*( MP_SLOT_HDR + cap ),
+                                 1, MPI_INFO_NULL, mp->scomm,
+                                 &seg, &mp->swin ) );
+  TRAP( MPI_Win_lock_all( MPI_MODE_NOCHECK, mp->swin ) );
+  for( port=0; port<mp->n_port; port++ )
+    CLEAR( seg + (size_t)port*( MP_SLOT_HDR + cap ), MP_SLOT_HDR );
+
+  MALLOC( mp->base, world_size );
+  CLEAR( mp->base, world_size );
+  TRAP( MPI_Comm_size( mp->scomm, &n_node ) );
+  TRAP( MPI_Comm_group( world->comm, &world_group ) );
+  TRAP( MPI_Comm_group( mp->scomm, &node_group ) );
+  for( q=0; q<n_node; q++ ) {
+    TRAP( MPI_Group_translate_ranks( node_group, 1, &q, world_group, &r ) );
+    TRAP( MPI_Win_shared_query( mp->swin, q, &sz, &disp_unit, &mp->base[r] ) );
+  }
+  TRAP( MPI_Group_free( &node_group ) );
+  TRAP( MPI_Group_free( &world_group ) );
+  mp->s_cap = cap;
+
+  // Nobody may use the slots before all of them are cleared
+
+  TRAP( MPI_Win_sync( mp->swin ) );
+  TRAP( MPI_Barrier( mp->scomm ) );
+}
+
+# undef RESIZE_FACTOR
+# undef TRAP
+
 
 #endif // DMPPolicy_h
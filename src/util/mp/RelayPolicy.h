@@ -194,6 +194,41 @@ struct RelayPolicy {
       p2p.recv( rbuf, request.count*world_size, request.tag, request.id );
   }
 
+  // The relay has no all-to-all exchanges.
+
+  inline void
+  mp_alltoall_i64( int64_t * sbuf,
+                   int64_t * rbuf,
+                   int n ) {
+    ERROR(( "All-to-all exchanges are not supported by the relay" ));
+  }
+
+  inline void
+  mp_alltoallv_c( char * sbuf,
+                  const int64_t * scount,
+                  char * rbuf,
+                  const int64_t * rcount ) {
+    ERROR(( "All-to-all exchanges are not supported by the relay" ));
+  }
+
+  inline void
+  mp_sendrecv_c( const char * sbuf,
+                 int64_t scount,
+                 int dst,
+                 char * rbuf,
+                 int64_t rcount,
+                 int src ) {
+    ERROR(( "Bulk exchanges are not supported by the relay" ));
+  }
+
+  inline void
+  mp_node( int * leader,
+           int * size ) {
+    if( !leader || !size ) ERROR(( "Bad args" ));
+    *leader = world_rank;
+    *size   = 1;
+  }
+
   inline void
   mp_send_i( int * buf,
              int n,
@@ -383,6 +418,53 @@ struct RelayPolicy {
     p2p.wait_send( port );
   }
 
+  // The relay has no persistent requests, neighborhood collectives or
+  // shared memory exchanges.
+
+  inline void
+  mp_begin_recv_persistent( mp_t * mp,
+                            int port,
+                            int sz,
+                            int src,
+                            int tag ) {
+    mp_begin_recv( mp, port, sz, src, tag );
+  }
+
+  inline void
+  mp_begin_send_persistent( mp_t * mp,
+                            int port,
+                            int sz,
+                            int dst,
+                            int tag ) {
+    mp_begin_send( mp, port, sz, dst, tag );
+  }
+
+  inline void
+  mp_set_neighbors( mp_t * mp,
+                    const int * peer ) {
+    if( !mp ) ERROR(( "Bad args" ));
+  }
+
+  inline int
+  mp_has_neighbors( const mp_t * mp ) {
+    if( !mp ) ERROR(( "Bad args" ));
+    return 0;
+  }
+
+  inline void
+  mp_neighbor_alltoall_i( mp_t * mp,
+                          const int * sbuf,
+                          int * rbuf,
+                          int n ) {
+    ERROR(( "Neighborhood collectives are not supported by the relay" ));
+  }
+
+  inline void
+  mp_share_node( mp_t * mp,
+                 int cap ) {
+    if( !mp || cap<0 ) ERROR(( "Bad args" ));
+  }
+
 # undef RESIZE_FACTOR
 
 }; // struct RelayPolicy
@@ -41,6 +41,22 @@ void mp_gather_uc( unsigned char * sbuf, unsigned char * rbuf, int n ) {
   return MPWrapper::instance().mp_gather_uc( sbuf, rbuf, n );
 }
 
+void mp_alltoall_i64( int64_t * sbuf, int64_t * rbuf, int n ) {
+  return MPWrapper::instance().mp_alltoall_i64( sbuf, rbuf, n );
+}
+
+void mp_alltoallv_c( char * sbuf, const int64_t * scount, char * rbuf, const int64_t * rcount ) {
+  return MPWrapper::instance().mp_alltoallv_c( sbuf, scount, rbuf, rcount );
+}
+
+void mp_sendrecv_c( const char * sbuf, int64_t scount, int dst, char * rbuf, int64_t rcount, int src ) {
+  return MPWrapper::instance().mp_sendrecv_c( sbuf, scount, dst, rbuf, rcount, src );
+}
+
+void mp_node( int * leader, int * size ) {
+  return MPWrapper::instance().mp_node( leader, size );
+}
+
 void mp_send_i( int *buf, int n, int dst ) {
   return MPWrapper::instance().mp_send_i( buf, n, dst );
 }
@@ -85,3 +101,45 @@ void mp_end_send( mp_t * mp, int sbuf ) {
   MPWrapper::instance().mp_end_send( mp, sbuf );
 }
 
+// This does not pass messages so it is the same for all policies (their
+// mp_t hold the buffers the same way)
+
+void mp_self_send( mp_t * mp, int sport, int sz, int rport ) {
+  char * ALIGNED(128) buf;
+  int buf_sz;
+  if( !mp || sport<0 || sport>=mp->n_port || rport<0 ||
+      rport>=mp->n_port || sport==rport || sz<1 ||
+      mp->sbuf_sz[sport]<sz ) ERROR(( "Bad args" ));
+  buf                = mp->rbuf[rport];
+  mp->rbuf[rport]    = mp->sbuf[sport];
+  mp->sbuf[sport]    = buf;
+  buf_sz             = mp->rbuf_sz[rport];
+  mp->rbuf_sz[rport] = mp->sbuf_sz[sport];
+  mp->sbuf_sz[sport] = buf_sz;
+  mp->sreq_sz[sport] = sz;
+  mp->rreq_sz[rport] = sz;
+}
+
+void mp_begin_recv_persistent( mp_t * mp, int rbuf, int size, int sender, int tag ) {
+  MPWrapper::instance().mp_begin_recv_persistent( mp, rbuf, size, sender, tag );
+}
+
+void mp_begin_send_persistent( mp_t * mp, int sbuf, int size, int receiver, int tag ) {
+  MPWrapper::instance().mp_begin_send_persistent( mp, sbuf, size, receiver, tag );
+}
+
+void mp_set_neighbors( mp_t * mp, const int * peer ) {
+  MPWrapper::instance().mp_set_neighbors( mp, peer );
+}
+
+int mp_has_neighbors( const mp_t * mp ) {
+  return MPWrapper::instance().mp_has_neighbors( mp );
+}
+
+void mp_neighbor_alltoall_i( mp_t * mp, const int * sbuf, int * rbuf, int n ) {
+  MPWrapper::instance().mp_neighbor_alltoall_i( mp, sbuf, rbuf, n );
+}
+
+void mp_share_node( mp_t * mp, int cap ) {
+  MPWrapper::instance().mp_share_node( mp, cap );
+}
@@ -88,6 +88,44 @@ mp_gather_uc( unsigned char * sbuf,
               unsigned char * rbuf,
               int n );
 
+/* Send n int64s to each node (sbuf[n*rank:n*rank+n-1] goes to node
+   rank) and receive n int64s from each node in rbuf the same way. */
+
+void
+mp_alltoall_i64( int64_t * sbuf,
+                 int64_t * rbuf,
+                 int n );
+
+/* Send scount[rank] bytes to each node and receive rcount[rank] bytes
+   from each node.  The bytes for (from) each node are packed in node
+   order in sbuf (rbuf).  The counts and their totals can exceed what MPI
+   can move in one exchange.  Used to redistribute whole domains. */
+
+void
+mp_alltoallv_c( char * sbuf,
+                const int64_t * scount,
+                char * rbuf,
+                const int64_t * rcount );
+
+/* Send scount bytes to node dst while receiving rcount bytes from node
+   src (either can be -1 for none).  The counts can exceed what MPI can
+   move in one message.  Used to move whole checkpts between nodes. */
+
+void
+mp_sendrecv_c( const char * sbuf,
+               int64_t scount,
+               int dst,
+               char * rbuf,
+               int64_t rcount,
+               int src );
+
+/* Give the lowest world rank of the processes on the same machine as
+   this one and how many processes there are on it. */
+
+void
+mp_node( int * leader,
+         int * size );
+
 /* Turnstile communication primitives */
 // FIXME: MESSAGE TAGGING ISSUES?
 
@@ -150,6 +188,75 @@ void
 mp_end_send( mp_t * mp,
              int sbuf );
 
+/* As mp_begin_recv and mp_begin_send but using persistent requests
+   bound to the port.  The requests are created the first time a port
+   is used with a given buffer, size, peer and tag and restarted
+   afterward.  Use these for exchanges repeated with the same sizes
+   (e.g. the ghost updates).  Complete them with mp_end_recv and
+   mp_end_send. */
+
+void
+mp_begin_recv_persistent( mp_t * mp,
+                          int port,
+                          int sz,
+                          int src,
+                          int tag );
+
+void
+mp_begin_send_persistent( mp_t * mp,
+                          int port,
+                          int sz,
+                          int dst,
+                          int tag );
+
+/* Deliver the first sz bytes of the send buffer of port sport to the
+   receive buffer of port rport of the same mp without message
+   passing.  This is for messages a process sends to itself (e.g.
+   periodic boundaries with one process along a dimension).  The
+   buffers are swapped, not copied, so the send buffer of sport must
+   be refilled before its next use. */
+
+void
+mp_self_send( mp_t * mp,
+              int sport,
+              int sz,
+              int rport );
+
+/* Neighborhood collectives.  mp_set_neighbors gives the process joined
+   to each port of mp (-1 if none) and enables the neighborhood
+   collectives; NULL disables them.  The process joined to port must
+   have this process joined to its port n_port-1-port (as with the 27
+   ports of a grid).  mp_neighbor_alltoall_i sends the n ints at
+   sbuf+n*port on each joined port and receives the n ints the process
+   joined to port sent in rbuf+n*port (the entries of other ports are
+   left untouched).  Both are collective over all processes and
+   mp_neighbor_alltoall_i must be called by all processes with
+   neighborhood collectives enabled. */
+
+void
+mp_set_neighbors( mp_t * mp,
+                  const int * peer );
+
+int
+mp_has_neighbors( const mp_t * mp );
+
+void
+mp_neighbor_alltoall_i( mp_t * mp,
+                        const int * sbuf,
+                        int * rbuf,
+                        int n );
+
+/* Exchange the messages with the processes on the same node through a
+   shared memory window instead of MPI when they fit in cap bytes (cap
+   0 turns this off).  Messages with peers on other nodes or too large
+   still go through MPI.  Messages must be tagged with the sending port
+   (as the grid exchanges do).  This is collective over all
+   processes. */
+
+void
+mp_share_node( mp_t * mp,
+               int cap );
+
 END_C_DECLS
 
 #endif /* mp_h */
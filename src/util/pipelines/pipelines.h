@@ -12,6 +12,35 @@ enum { MAX_PIPELINE = 272 };
 // Is this even related to pipelines.  Maybe this should be in util_base.h.
 # define PAD_STRUCT( sz )
 
+//----------------------------------------------------------------------------//
+// Instruction set tiers of the pipeline functions.  EXEC_PIPELINES runs the
+// highest tier not above pipeline_isa that a pipeline provides.
+// pipeline_isa is set by boot_pipeline_isa to the highest tier both built
+// into the binary and supported by the processor, unless lowered with the
+// --isa command line option.  Builds configured with USE_ISA_DISPATCH carry
+// all the tiers; other builds only carry those selected at configure time.
+//----------------------------------------------------------------------------//
+
+enum pipeline_isa_tiers {
+  PIPELINE_ISA_SCALAR = 0,
+  PIPELINE_ISA_V4     = 1,
+  PIPELINE_ISA_V8     = 2,
+  PIPELINE_ISA_V16    = 3
+};
+
+BEGIN_C_DECLS
+
+extern int pipeline_isa;
+
+void
+boot_pipeline_isa( int * pargc,
+                   char *** pargv );
+
+const char *
+pipeline_isa_name( int isa );
+
+END_C_DECLS
+
 //----------------------------------------------------------------------------//
 // Make sure that pipelines_pthreads.h and pipelines_openmp.h can only be
 // included via this header file.
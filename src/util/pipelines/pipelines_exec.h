@@ -11,6 +11,56 @@
 #include "../v8/v8.h"
 #include "../v16/v16.h"
 
+//----------------------------------------------------------------------------//
+// Pipeline variants a source file provides to EXEC_PIPELINES.  A source file
+// advertises a vector variant by defining HAS_V*_PIPELINE before including
+// this header.  The variant is only linked in when the matching vector
+// implementation is built, either because it was selected at configure time
+// or because the build carries all of them (VPIC_ISA_DISPATCH).
+//----------------------------------------------------------------------------//
+
+#if ( defined(V4_ACCELERATION) || defined(VPIC_ISA_DISPATCH) ) && \
+    defined(HAS_V4_PIPELINE)
+# define PIPELINE_V4(name) name##_pipeline_v4
+#else
+# define PIPELINE_V4(name) 0
+#endif
+
+#if ( defined(V8_ACCELERATION) || defined(VPIC_ISA_DISPATCH) ) && \
+    defined(HAS_V8_PIPELINE)
+# define PIPELINE_V8(name) name##_pipeline_v8
+#else
+# define PIPELINE_V8(name) 0
+#endif
+
+#if ( defined(V16_ACCELERATION) || defined(VPIC_ISA_DISPATCH) ) && \
+    defined(HAS_V16_PIPELINE)
+# define PIPELINE_V16(name) name##_pipeline_v16
+#else
+# define PIPELINE_V16(name) 0
+#endif
+
+// Pick the highest variant not above pipeline_isa.  Missing variants are
+// null and fall through to the next lower tier.
+
+template<typename pipeline_t>
+static inline pipeline_t
+select_pipeline( pipeline_t scalar,
+                 pipeline_t v4,
+                 pipeline_t v8,
+                 pipeline_t v16 )
+{
+  if ( v16 && pipeline_isa >= PIPELINE_ISA_V16 ) return v16;
+  if ( v8  && pipeline_isa >= PIPELINE_ISA_V8  ) return v8;
+  if ( v4  && pipeline_isa >= PIPELINE_ISA_V4  ) return v4;
+  return scalar;
+}
+
+#define SELECT_PIPELINE(name)                                   \
+  select_pipeline<decltype(&name##_pipeline_scalar)>(           \
+    name##_pipeline_scalar, PIPELINE_V4(name),                  \
+    PIPELINE_V8(name),      PIPELINE_V16(name) )
+
 //----------------------------------------------------------------------------//
 // Make sure that pipelines_exec_pth.h and pipelines_exec_omp.h can only be
 // included via this header file.
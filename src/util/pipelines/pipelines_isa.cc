@@ -0,0 +1,95 @@
+#include "pipelines_exec.h"
+
+#include <string.h>
+
+int pipeline_isa = PIPELINE_ISA_SCALAR;
+
+static const char * isa_names[] = { "scalar", "v4", "v8", "v16" };
+
+const char *
+pipeline_isa_name( int isa )
+{
+  if ( isa < PIPELINE_ISA_SCALAR || isa > PIPELINE_ISA_V16 )
+    return "unknown";
+
+  return isa_names[isa];
+}
+
+// Highest tier whose pipelines are built into this binary.
+
+static int
+built_isa( void )
+{
+# if defined(VPIC_ISA_DISPATCH) || defined(V16_ACCELERATION)
+  return PIPELINE_ISA_V16;
+# elif defined(V8_ACCELERATION)
+  return PIPELINE_ISA_V8;
+# elif defined(V4_ACCELERATION)
+  return PIPELINE_ISA_V4;
+# else
+  return PIPELINE_ISA_SCALAR;
+# endif
+}
+
+// Highest tier the processor can execute.  Only builds carrying all the
+// tiers need to ask; a build configured for a single vector instruction set
+// is compiled for it throughout and cannot run on processors without it.
+// The v16 pipelines are compiled for the AVX-512 subset of Skylake-SP, the
+// v8 pipelines for AVX2 with FMA and the v4 pipelines for SSE.
+
+static int
+cpu_isa( void )
+{
+# if defined(VPIC_ISA_DISPATCH)
+  __builtin_cpu_init();
+
+  if ( __builtin_cpu_supports( "avx512f"  ) &&
+       __builtin_cpu_supports( "avx512cd" ) &&
+       __builtin_cpu_supports( "avx512dq" ) &&
+       __builtin_cpu_supports( "avx512bw" ) &&
+       __builtin_cpu_supports( "avx512vl" ) )
+    return PIPELINE_ISA_V16;
+
+  if ( __builtin_cpu_supports( "avx2" ) &&
+       __builtin_cpu_supports( "fma"  ) )
+    return PIPELINE_ISA_V8;
+
+  if ( __builtin_cpu_supports( "sse2" ) )
+    return PIPELINE_ISA_V4;
+
+  return PIPELINE_ISA_SCALAR;
+# else
+  return built_isa();
+# endif
+}
+
+void
+boot_pipeline_isa( int * pargc,
+                   char *** pargv )
+{
+  const char * request = strip_cmdline_string( pargc, pargv, "--isa", "auto" );
+  int max_isa = built_isa(), isa;
+
+  if ( cpu_isa() < max_isa ) max_isa = cpu_isa();
+
+  if ( !strcmp( request, "auto" ) )
+    isa = max_isa;
+
+  else
+  {
+    for( isa = PIPELINE_ISA_V16; isa >= PIPELINE_ISA_SCALAR; isa-- )
+      if ( !strcmp( request, isa_names[isa] ) ) break;
+
+    if ( isa < PIPELINE_ISA_SCALAR )
+      ERROR(( "Unknown --isa %s (use auto, scalar, v4, v8 or v16)", request ));
+
+    if ( isa > max_isa )
+      ERROR(( "--isa %s requested but only up to %s is %s",
+              request,
+              pipeline_isa_name( max_isa ),
+              max_isa < built_isa() ? "supported by this processor" :
+                                      "built into this binary" ));
+  }
+
+  pipeline_isa = isa;
+}
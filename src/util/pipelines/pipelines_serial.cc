@@ -18,8 +18,8 @@ restore_serial( void ) {
   int n_pipeline;
   RESTORE_VAL( int, n_pipeline );
   if( serial.n_pipeline!=n_pipeline )
-    ERROR(( "--serial.n_pipeline changed between checkpt (%i) and "
-            "restore (%i)", serial.n_pipeline, n_pipeline ));
+    MESSAGE(( "--serial.n_pipeline changed between checkpt (%i) and "
+              "restore (%i)", n_pipeline, serial.n_pipeline ));
   return &serial;
 }
 
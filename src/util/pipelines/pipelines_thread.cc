@@ -81,13 +81,17 @@ checkpt_thread( const pipeline_dispatcher_t * _thread ) {
   CHECKPT_VAL( int, thread.n_pipeline );
 }
 
+// The dispatcher booted for the restore is kept when --tpp changed
+// between checkpt and restore.  The per-pipeline state of the other
+// objects is resized for it on restore.
+
 pipeline_dispatcher_t *
 restore_thread( void ) {
   int n_pipeline;
   RESTORE_VAL( int, n_pipeline );
   if( thread.n_pipeline!=n_pipeline )
-    ERROR(( "--tpp changed between checkpt (%i) and restore (%i)",
-            n_pipeline, thread.n_pipeline ));
+    MESSAGE(( "--tpp changed between checkpt (%i) and restore (%i)",
+              n_pipeline, thread.n_pipeline ));
   return &thread;
 }
 
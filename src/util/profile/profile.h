@@ -9,9 +9,11 @@
 // timer name is printed on profile dumps.
 
 #define PROFILE_TIMERS(_) \
+  _( rebalance         ) \
   _( clear_accumulators ) \
   _( sort_p            ) \
   _( collision_model   ) \
+  _( average_interpolator ) \
   _( advance_p         ) \
   _( reduce_accumulators ) \
   _( emission_model    ) \
@@ -21,6 +23,7 @@
   _( synchronize_jf    ) \
   _( advance_b         ) \
   _( advance_e         ) \
+  _( advance_b_e_b     ) \
   _( clear_rhof        ) \
   _( accumulate_rho_p  ) \
   _( synchronize_rho   ) \
@@ -0,0 +1,269 @@
+#ifndef _crng_h_
+#define _crng_h_
+
+#include "../util_base.h"
+
+#include "../v4/v4.h"
+#include "../v8/v8.h"
+#include "../v16/v16.h"
+
+/* Counter based random number generator (Philox4x32-10; Salmon et al,
+   "Parallel random numbers: as easy as 1, 2, 3", SC11).  Unlike rng_t,
+   there is no generator state: the numbers are a pure function of a
+   64-bit key and a 128-bit counter.  A crng_t names a family of streams
+   by (seed, rank, stream, step), the key being (seed, rank) and the
+   counter (block, id, step, stream).  Within the family, each id (e.g.
+   a particle or voxel index) has its own stream and each draw of a
+   block gives 4 numbers of it.  Kernels can thus draw the numbers of the
+   particles or voxels they process without any per-thread state and the
+   results do not depend on how the work is split over pipelines.
+
+   Only the low 32 bits of step are used, so the streams of a family
+   repeat every 2^32 steps.  Blocks of a stream must be drawn at most
+   once per use (drawing a block twice gives the same numbers).
+
+   The lane variants draw the same block of the streams of n consecutive
+   ids and give the same numbers as drawing each stream on its own.  The
+   v4, v8 and v16 variants do this for 4, 8 and 16 ids at once. */
+
+typedef struct crng {
+  uint32_t key[2]; /* seed, rank */
+  uint32_t step;   /* Low 32 bits of the step */
+  uint32_t stream; /* Stream family (e.g. species id) */
+} crng_t;
+
+enum crng_constants {
+  CRNG_ROUNDS = 10
+};
+
+#define CRNG_M0 ((uint32_t)0xD2511F53)
+#define CRNG_M1 ((uint32_t)0xCD9E8D57)
+#define CRNG_W0 ((uint32_t)0x9E3779B9)
+#define CRNG_W1 ((uint32_t)0xBB67AE85)
+
+static inline crng_t
+crng_init( uint32_t seed,
+           uint32_t rank,
+           uint32_t stream,
+           int64_t  step ) {
+  crng_t r;
+  r.key[0] = seed;
+  r.key[1] = rank;
+  r.step   = (uint32_t)step;
+  r.stream = stream;
+  return r;
+}
+
+/* The Philox4x32 bijection of the counter c under the key k.  c is
+   overwritten with the result. */
+
+static inline void
+philox4x32( uint32_t * RESTRICT c,
+            const uint32_t * RESTRICT k ) {
+  uint32_t k0 = k[0], k1 = k[1], c0 = c[0], c1 = c[1], c2 = c[2], c3 = c[3];
+  for( int n=0; n<CRNG_ROUNDS; n++ ) {
+    uint64_t p0 = (uint64_t)CRNG_M0*c0, p1 = (uint64_t)CRNG_M1*c2;
+    c0 = (uint32_t)( p1>>32 ) ^ c1 ^ k0;
+    c1 = (uint32_t)p1;
+    c2 = (uint32_t)( p0>>32 ) ^ c3 ^ k1;
+    c3 = (uint32_t)p0;
+    k0 += CRNG_W0;
+    k1 += CRNG_W1;
+  }
+  c[0] = c0; c[1] = c1; c[2] = c2; c[3] = c3;
+}
+
+/* Conversions of the generated words.  crng_u32_to_f gives a uniform
+   rand on (0,1) rounded to the midpoints of 2^23 sub-intervals (like
+   frand).  crng_u32_to_fn turns two words into two normal rands
+   (Box-Muller). */
+
+static inline float
+crng_u32_to_f( uint32_t u ) {
+  return (float)( ( ( u>>9 )<<1 ) | 1 )*( 1.f/16777216.f );
+}
+
+static inline void
+crng_f_to_fn( float f0,
+              float f1,
+              float * RESTRICT z0,
+              float * RESTRICT z1 ) {
+  float r = sqrtf( -2.f*logf( f0 ) );
+  float t = (float)( 2*M_PI )*f1;
+  *z0 = r*cosf( t );
+  *z1 = r*sinf( t );
+}
+
+static inline void
+crng_u32_to_fn( uint32_t u0,
+                uint32_t u1,
+                float * RESTRICT z0,
+                float * RESTRICT z1 ) {
+  crng_f_to_fn( crng_u32_to_f( u0 ), crng_u32_to_f( u1 ), z0, z1 );
+}
+
+/* Block-th block of 4 words / uniforms / normals of the stream id. */
+
+static inline void
+crng_u32( const crng_t * RESTRICT r,
+          uint32_t id,
+          uint32_t block,
+          uint32_t * RESTRICT x ) {
+  x[0] = block; x[1] = id; x[2] = r->step; x[3] = r->stream;
+  philox4x32( x, r->key );
+}
+
+static inline void
+crng_frand( const crng_t * RESTRICT r,
+            uint32_t id,
+            uint32_t block,
+            float * RESTRICT x ) {
+  uint32_t u[4];
+  crng_u32( r, id, block, u );
+  for( int n=0; n<4; n++ ) x[n] = crng_u32_to_f( u[n] );
+}
+
+static inline void
+crng_frandn( const crng_t * RESTRICT r,
+             uint32_t id,
+             uint32_t block,
+             float * RESTRICT x ) {
+  uint32_t u[4];
+  crng_u32( r, id, block, u );
+  crng_u32_to_fn( u[0], u[1], x+0, x+1 );
+  crng_u32_to_fn( u[2], u[3], x+2, x+3 );
+}
+
+/* Block-th block of the streams id0:id0+n-1.  Word / number w of the
+   stream id0+l is stored in x[w*n+l] (so each word of the n streams is
+   contiguous). */
+
+static inline void
+crng_u32_lanes( const crng_t * RESTRICT r,
+                uint32_t id0,
+                uint32_t block,
+                int n,
+                uint32_t * RESTRICT x ) {
+  for( int l=0; l<n; l++ ) {
+    uint32_t c[4];
+    c[0] = block; c[1] = id0 + l; c[2] = r->step; c[3] = r->stream;
+    philox4x32( c, r->key );
+    x[l] = c[0]; x[n+l] = c[1]; x[2*n+l] = c[2]; x[3*n+l] = c[3];
+  }
+}
+
+static inline void
+crng_frand_lanes( const crng_t * RESTRICT r,
+                  uint32_t id0,
+                  uint32_t block,
+                  int n,
+                  float * RESTRICT x ) {
+  for( int l=0; l<n; l++ ) {
+    uint32_t c[4];
+    c[0] = block; c[1] = id0 + l; c[2] = r->step; c[3] = r->stream;
+    philox4x32( c, r->key );
+    x[l]     = crng_u32_to_f( c[0] ); x[n+l]   = crng_u32_to_f( c[1] );
+    x[2*n+l] = crng_u32_to_f( c[2] ); x[3*n+l] = crng_u32_to_f( c[3] );
+  }
+}
+
+static inline void
+crng_frandn_lanes( const crng_t * RESTRICT r,
+                   uint32_t id0,
+                   uint32_t block,
+                   int n,
+                   float * RESTRICT x ) {
+  for( int l=0; l<n; l++ ) {
+    uint32_t c[4];
+    c[0] = block; c[1] = id0 + l; c[2] = r->step; c[3] = r->stream;
+    philox4x32( c, r->key );
+    crng_u32_to_fn( c[0], c[1], x+l,     x+n+l   );
+    crng_u32_to_fn( c[2], c[3], x+2*n+l, x+3*n+l );
+  }
+}
+
+/* Vector variants.  Philox runs on all the lanes at once (mul_hi_lo
+   gives the 32x32 bit products).  crng_u32_vN gives the words 0, 1, 2
+   and 3 of the block-th block of the streams id0:id0+N-1 in c0, c1, c2
+   and c3 (lane l from stream id0+l).  crng_frand_vN and crng_frandn_vN
+   give the uniforms and normals in a, b, c and d.  The uniforms are made
+   from the bits directly: with m the top 23 bits of a word, the float
+   1+m/2^23 less 1-2^-24 is exactly (2m+1)/2^24, as in crng_u32_to_f.
+   The Box-Muller transform of the normals is done lane by lane (there is
+   no vector log, cos and sin); the numbers are the same as the scalar
+   ones. */
+
+#define CRNG_VECTOR( N, vi, vf )                                        \
+static inline void                                                      \
+crng_u32_v##N( const crng_t * RESTRICT r,                               \
+               uint32_t id0,                                            \
+               uint32_t block,                                          \
+               v##N::vi & c0, v##N::vi & c1,                            \
+               v##N::vi & c2, v##N::vi & c3 ) {                         \
+  const v##N::vi m0( (int)CRNG_M0 ), m1( (int)CRNG_M1 );                \
+  v##N::vi h0, l0, h1, l1;                                              \
+  c0 = v##N::vi( (int)block );                                          \
+  for( int l=0; l<N; l++ ) c1[l] = (int)( id0 + l );                    \
+  c2 = v##N::vi( (int)r->step );                                        \
+  c3 = v##N::vi( (int)r->stream );                                      \
+  for( int n=0; n<CRNG_ROUNDS; n++ ) {                                  \
+    mul_hi_lo( m0, c0, h0, l0 );                                        \
+    mul_hi_lo( m1, c2, h1, l1 );                                        \
+    c0 = h1 ^ c1 ^ v##N::vi( (int)( r->key[0] + n*CRNG_W0 ) );          \
+    c1 = l1;                                                            \
+    c2 = h0 ^ c3 ^ v##N::vi( (int)( r->key[1] + n*CRNG_W1 ) );          \
+    c3 = l0;                                                            \
+  }                                                                     \
+}                                                                       \
+                                                                        \
+static inline v##N::vf                                                  \
+crng_u32_to_f_v##N( const v##N::vi & u ) {                              \
+  const v##N::vi m = ( ( u >> v##N::vi( 9 ) ) & v##N::vi( 0x7fffff ) ) | \
+                     v##N::vi( 0x3f800000 );                            \
+  return v##N::vf( m ) - v##N::vf( 1.f - 1.f/16777216.f );              \
+}                                                                       \
+                                                                        \
+static inline void                                                      \
+crng_frand_v##N( const crng_t * RESTRICT r,                             \
+                 uint32_t id0,                                          \
+                 uint32_t block,                                        \
+                 v##N::vf & a, v##N::vf & b,                            \
+                 v##N::vf & c, v##N::vf & d ) {                         \
+  v##N::vi u0, u1, u2, u3;                                              \
+  crng_u32_v##N( r, id0, block, u0, u1, u2, u3 );                       \
+  a = crng_u32_to_f_v##N( u0 );                                         \
+  b = crng_u32_to_f_v##N( u1 );                                         \
+  c = crng_u32_to_f_v##N( u2 );                                         \
+  d = crng_u32_to_f_v##N( u3 );                                         \
+}                                                                       \
+                                                                        \
+static inline void                                                      \
+crng_frandn_v##N( const crng_t * RESTRICT r,                            \
+                  uint32_t id0,                                         \
+                  uint32_t block,                                       \
+                  v##N::vf & a, v##N::vf & b,                           \
+                  v##N::vf & c, v##N::vf & d ) {                        \
+  float z[4];                                                           \
+  crng_frand_v##N( r, id0, block, a, b, c, d );                         \
+  for( int l=0; l<N; l++ ) {                                            \
+    crng_f_to_fn( a[l], b[l], z+0, z+1 );                               \
+    crng_f_to_fn( c[l], d[l], z+2, z+3 );                               \
+    a[l] = z[0]; b[l] = z[1]; c[l] = z[2]; d[l] = z[3];                 \
+  }                                                                     \
+}
+
+#if defined(V4_ACCELERATION)
+CRNG_VECTOR( 4, v4int, v4float )
+#endif
+
+#if defined(V8_ACCELERATION)
+CRNG_VECTOR( 8, v8int, v8float )
+#endif
+
+#if defined(V16_ACCELERATION)
+CRNG_VECTOR( 16, v16int, v16float )
+#endif
+
+#undef CRNG_VECTOR
+
+#endif /* _crng_h_ */
@@ -43,6 +43,16 @@ seed_rng_pool( rng_pool_t * RESTRICT rp, /* Pool to seed */
                                             seed_rng) */
                int sync );               /* True for synchronized seeding */
 
+/* Grows the pool to n_rng generators (pools are never shrunk).  The
+   generators already in the pool are untouched and the new ones are
+   seeded deterministically from the state of the first one.  This is
+   used on restore when the number of pipelines changed since the
+   checkpt. */
+
+rng_pool_t *                               /* Returns rp */
+resize_rng_pool( rng_pool_t * RESTRICT rp, /* Pool to resize */
+                 int n_rng );              /* Number of generators wanted */
+
 /* In rng.c */
 
 rng_t *              /* New generator (already seeded via seed_rng) */
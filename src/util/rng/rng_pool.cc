@@ -1,4 +1,5 @@
-#include "rng.h"
+#define IN_rng
+#include "rng_private.h"
 #include "../checkpt/checkpt.h"
 
 /* Private API ***************************************************************/
@@ -60,3 +61,26 @@ seed_rng_pool( rng_pool_t * RESTRICT rp,
   return rp;
 }
 
+
+rng_pool_t *
+resize_rng_pool( rng_pool_t * RESTRICT rp,
+                 int n_rng ) {
+  rng_t ** rng, r[1];
+  int n;
+  if( !rp || n_rng<1 ) ERROR(( "Bad args" ));
+  if( n_rng<=rp->n_rng ) return rp;
+
+  /* The seeds of the new generators are drawn from a copy of the first
+     generator so the existing generators are left exactly as they were
+     (and, in a sync pool, the new generators are identically seeded on
+     all processes). */
+
+  *r = *rp->rng[0];
+  MALLOC( rng, n_rng );
+  for( n=0; n<rp->n_rng; n++ ) rng[n] = rp->rng[n];
+  for( ; n<n_rng; n++ ) rng[n] = new_rng( (int)uirand( r ) );
+  FREE( rp->rng );
+  rp->rng   = rng;
+  rp->n_rng = n_rng;
+  return rp;
+}
@@ -223,3 +223,109 @@ TEST_CASE("uirand", "[rng]") {
   REQUIRE_FALSE( i!=N );
   delete_rng(rng);
 } // TEST
+
+/* Known answers of Philox4x32-10 (from the Random123 distribution) */
+TEST_CASE("philox4x32", "[rng]") {
+
+  static const uint32_t kat[3][10] = {
+    { 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+      0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 },
+    { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff,
+      0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd },
+    { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344, 0xa4093822, 0x299f31d0,
+      0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 } };
+
+  for( int t=0; t<3; t++ ) {
+    uint32_t c[4] = { kat[t][0], kat[t][1], kat[t][2], kat[t][3] };
+    philox4x32( c, kat[t]+4 );
+    for( int n=0; n<4; n++ ) REQUIRE( c[n]==kat[t][6+n] );
+  }
+} // TEST
+
+/* Drawing many streams at once gives each stream's own numbers */
+TEST_CASE("crng_lanes", "[rng]") {
+
+  crng_t r = crng_init( 1234, 5, 2, 77 );
+  float x[4*16], y[4], z[4];
+  int ok = 1;
+
+  for( int n=1; n<=16; n++ )
+    for( uint32_t block=0; block<3; block++ ) {
+      crng_frand_lanes( &r, 1000, block, n, x );
+      for( int l=0; l<n; l++ ) {
+        crng_frand( &r, 1000+l, block, y );
+        for( int w=0; w<4; w++ ) if( x[w*n+l]!=y[w] ) ok = 0;
+      }
+      crng_frandn_lanes( &r, 1000, block, n, x );
+      for( int l=0; l<n; l++ ) {
+        crng_frandn( &r, 1000+l, block, y );
+        for( int w=0; w<4; w++ ) if( x[w*n+l]!=y[w] ) ok = 0;
+      }
+    }
+  REQUIRE( ok );
+
+  /* Streams of different ids, blocks, steps and families differ */
+
+  crng_t s = crng_init( 1234, 5, 3, 77 ), t = crng_init( 1234, 5, 2, 78 );
+  crng_frand( &r, 0, 0, y );
+  crng_frand( &r, 1, 0, z ); REQUIRE( y[0]!=z[0] );
+  crng_frand( &r, 0, 1, z ); REQUIRE( y[0]!=z[0] );
+  crng_frand( &s, 0, 0, z ); REQUIRE( y[0]!=z[0] );
+  crng_frand( &t, 0, 0, z ); REQUIRE( y[0]!=z[0] );
+
+  /* The vector variants (Philox across the lanes) give the same numbers */
+
+# define CHECK_VECTOR( N, vf ) do {                                   \
+    v##N::vf a, b, c, d;                                              \
+    for( uint32_t block=0; block<3; block++ ) {                       \
+      crng_frand_v##N( &r, 32, block, a, b, c, d );                   \
+      crng_frand_lanes( &r, 32, block, N, x );                        \
+      for( int l=0; l<N; l++ )                                        \
+        if( a[l]!=x[l]     || b[l]!=x[N+l] ||                         \
+            c[l]!=x[2*N+l] || d[l]!=x[3*N+l] ) ok = 0;                \
+      crng_frandn_v##N( &r, 32, block, a, b, c, d );                  \
+      crng_frandn_lanes( &r, 32, block, N, x );                       \
+      for( int l=0; l<N; l++ )                                        \
+        if( a[l]!=x[l]     || b[l]!=x[N+l] ||                         \
+            c[l]!=x[2*N+l] || d[l]!=x[3*N+l] ) ok = 0;                \
+    }                                                                 \
+  } while(0)
+
+#if defined(V4_ACCELERATION)
+  CHECK_VECTOR( 4, v4float );
+#endif
+#if defined(V8_ACCELERATION)
+  CHECK_VECTOR( 8, v8float );
+#endif
+#if defined(V16_ACCELERATION)
+  CHECK_VECTOR( 16, v16float );
+#endif
+  REQUIRE( ok );
+
+# undef CHECK_VECTOR
+} // TEST
+
+TEST_CASE("crng_moments", "[rng]") {
+
+  const int n = 1<<16;
+  crng_t r = crng_init( 42, 0, 0, 0 );
+  double su = 0, sn = 0, sn2 = 0;
+  float x[4];
+  int ok = 1;
+
+  for( int i=0; i<n; i++ ) {
+    crng_frand( &r, i, 0, x );
+    for( int w=0; w<4; w++ ) {
+      if( x[w]<=0 || x[w]>=1 ) ok = 0;
+      su += x[w];
+    }
+    crng_frandn( &r, i, 1, x );
+    for( int w=0; w<4; w++ ) sn += x[w], sn2 += x[w]*x[w];
+  }
+  REQUIRE( ok );
+
+  /* Within ~5 standard errors */
+  REQUIRE( fabs( su/(4.*n) - 0.5 ) < 5*sqrt( 1./12/(4.*n) ) );
+  REQUIRE( fabs( sn/(4.*n) )       < 5*sqrt( 1./(4.*n) ) );
+  REQUIRE( fabs( sn2/(4.*n) - 1 )  < 5*sqrt( 2./(4.*n) ) );
+} // TEST
@@ -116,7 +116,7 @@ void inline swap(int32_t & element) {
 	element = bswap_32(element);
 } // swap
 
-void inline swap(field_t & element) {
+void inline swap(field_dump_t & element) {
 	// electric field
 	utils::swap(element.ex);
 	utils::swap(element.ey);
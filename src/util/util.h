@@ -10,6 +10,7 @@
 #include "checkpt/checkpt.h"
 #include "mp/mp.h"
 #include "rng/rng.h"
+#include "rng/crng.h"
 #include "pipelines/pipelines.h"
 #include "profile/profile.h"
 
@@ -17,6 +17,11 @@
 
 #define ALWAYS_INLINE __attribute__((always_inline))
 
+// Internal linkage in the USE_ISA_DISPATCH pipelines (see v4_sse.h)
+#ifdef VPIC_ISA_LOCAL
+namespace {
+#endif
+
 namespace v16
 {
   class v16;
@@ -603,6 +608,26 @@ namespace v16
     a.i[15] = ((const int *)a15)[0];
   }
 
+  // Load the leading 2, 3 or 4 floats at an address into the low elements
+  // of a 128 bit register without reading any memory past them.  Used by the
+  // load_16xN_tr below, which only own N floats at each address.
+
+  inline __m128 load_tr_row_2( const void * ALIGNED(8) a )
+  {
+    return _mm_castpd_ps( _mm_load_sd( (const double *)a ) );
+  }
+
+  inline __m128 load_tr_row_3( const void * ALIGNED(8) a )
+  {
+    return _mm_movelh_ps( _mm_castpd_ps( _mm_load_sd( (const double *)a ) ),
+                          _mm_load_ss( (const float *)a + 2 ) );
+  }
+
+  inline __m128 load_tr_row_4( const void * ALIGNED(16) a )
+  {
+    return _mm_load_ps( (const float *)a );
+  }
+
   inline void load_16x2_tr( const void * ALIGNED(8) a00,
 			    const void * ALIGNED(8) a01,
 			    const void * ALIGNED(8) a02,
@@ -621,51 +646,36 @@ namespace v16
 			    const void * ALIGNED(8) a15,
 			    v16 &b00, v16 &b01 )
   {
-    __m512 t00, t01, t02,      t04,      t06,      t08, t09, t10,      t12,      t14;
-    __m512 u00, u01, u02, u03, u04, u05, u06, u07, u08, u09, u10, u11, u12, u13, u14, u15;
-
-    u00   = _mm512_load_ps( (const float *)a00 );                      //   0   1   2   3   4   5   6   7   8   9  10  11  12  13  14  15
-    u01   = _mm512_load_ps( (const float *)a01 );                      //  16  17  18  19  20  21  22  23  24  25  26  27  28  29  30  31
-    u02   = _mm512_load_ps( (const float *)a02 );                      //  32  33  34  35  36  37  38  39  40  41  42  43  44  45  46  47
-    u03   = _mm512_load_ps( (const float *)a03 );                      //  48  49  50  51  52  53  54  55  56  57  58  59  60  61  62  63
-    u04   = _mm512_load_ps( (const float *)a04 );                      //  64  65  66  67  68  69  70  71  72  73  74  75  76  77  78  79
-    u05   = _mm512_load_ps( (const float *)a05 );                      //  80  81  82  83  84  85  86  87  88  89  90  91  92  93  94  95
-    u06   = _mm512_load_ps( (const float *)a06 );                      //  96  97  98  99 100 101 102 103 104 105 106 107 108 109 110 111
-    u07   = _mm512_load_ps( (const float *)a07 );                      // 112 113 114 115 116 117 118 119 120 121 122 123 124 125 126 127
-    u08   = _mm512_load_ps( (const float *)a08 );                      // 128 129 130 131 132 133 134 135 136 137 138 139 140 141 142 143
-    u09   = _mm512_load_ps( (const float *)a09 );                      // 144 145 146 147 148 149 150 151 152 153 154 155 156 157 158 159
-    u10   = _mm512_load_ps( (const float *)a10 );                      // 160 161 162 163 164 165 166 167 168 169 170 171 172 173 174 175
-    u11   = _mm512_load_ps( (const float *)a11 );                      // 176 177 178 179 180 181 182 183 184 185 186 187 188 189 190 191
-    u12   = _mm512_load_ps( (const float *)a12 );                      // 192 193 194 195 196 197 198 199 200 201 202 203 204 205 206 207
-    u13   = _mm512_load_ps( (const float *)a13 );                      // 208 209 210 211 212 213 214 215 216 217 218 219 220 221 222 223
-    u14   = _mm512_load_ps( (const float *)a14 );                      // 224 225 226 227 228 229 230 231 232 233 234 235 236 237 238 239
-    u15   = _mm512_load_ps( (const float *)a15 );                      // 240 241 242 243 244 245 246 247 248 249 250 251 252 253 254 255
-
-    t00   = _mm512_unpacklo_ps( u00, u01 );                            //   0  16   1  17   4  20   5  21   8  24   9  25  12  28  13  29 
-    t02   = _mm512_unpacklo_ps( u02, u03 );                            //  32  48  33  49  36  52  37  53  40  56  41  57  44  60  45  61
-    t04   = _mm512_unpacklo_ps( u04, u05 );                            //  64  80  65  81  68  84  69  85  72  88  73  89  76  92  77  93
-    t06   = _mm512_unpacklo_ps( u06, u07 );                            //  96 112  97 113 100 116 101 117 104 120 105 121 108 124 109 125
-    t08   = _mm512_unpacklo_ps( u08, u09 );                            // 128 144 129 145 132 148 133 149 136 152 137 153 140 156 141 157
-    t10   = _mm512_unpacklo_ps( u10, u11 );                            // 160 176 161 177 164 180 165 181 168 184 169 185 172 188 173 189
-    t12   = _mm512_unpacklo_ps( u12, u13 );                            // 192 208 193 209 196 212 197 213 200 216 201 217 204 220 205 221
-    t14   = _mm512_unpacklo_ps( u14, u15 );                            // 224 240 225 241 228 244 229 245 232 248 233 249 236 252 237 253
-
-    u00   = _mm512_shuffle_ps( t00, t02, _MM_SHUFFLE( 1, 0, 1, 0 ) );  //   0  16  32  48   4  20  36  52   8  24  40  56  12  28  44  60
-    u01   = _mm512_shuffle_ps( t00, t02, _MM_SHUFFLE( 3, 2, 3, 2 ) );  //   1  17  33  49   5  21  37  53   9  25  41  57  13  29  45  61
-    u04   = _mm512_shuffle_ps( t04, t06, _MM_SHUFFLE( 1, 0, 1, 0 ) );  //  64  80  96 112  68  84 100 116  72  88 104 120  76  92 108 124
-    u05   = _mm512_shuffle_ps( t04, t06, _MM_SHUFFLE( 3, 2, 3, 2 ) );  //  65  81  97 113  69  85 101 117  73  89 105 121  77  93 109 125
-    u08   = _mm512_shuffle_ps( t08, t10, _MM_SHUFFLE( 1, 0, 1, 0 ) );  // 128 144 160 176 132 148 164 180 136 152 168 184 140 156 172 188
-    u09   = _mm512_shuffle_ps( t08, t10, _MM_SHUFFLE( 3, 2, 3, 2 ) );  // 129 145 161 177 133 149 165 181 137 153 169 185 141 157 173 189
-    u12   = _mm512_shuffle_ps( t12, t14, _MM_SHUFFLE( 1, 0, 1, 0 ) );  // 192 208 224 240 196 212 228 244 200 216 232 248 204 220 236 252
-    u13   = _mm512_shuffle_ps( t12, t14, _MM_SHUFFLE( 3, 2, 3, 2 ) );  // 193 209 225 241 197 213 229 245 201 217 233 249 205 221 237 253
-
-    t00   = _mm512_shuffle_f32x4( u00, u04, 0x88 );                    //   0  16  32  48   8  24  40  56  64  80  96 112  72  88 104 120
-    t01   = _mm512_shuffle_f32x4( u01, u05, 0x88 );                    //   1  17  33  49   9  25  41  57  65  81  97 113  73  89 105 121
-    t08   = _mm512_shuffle_f32x4( u08, u12, 0x88 );                    // 128 144 160 176 136 152 168 184 192 208 224 240 200 216 232 248
-    t09   = _mm512_shuffle_f32x4( u09, u13, 0x88 );                    // 129 145 161 177 137 153 169 185 193 209 225 241 201 217 233 249
-
-    b00.v = _mm512_shuffle_f32x4( t00, t08, 0x88 );                    //   0  16  32  48  64  80  96 112 128 144 160 176 192 208 224 240
-    b01.v = _mm512_shuffle_f32x4( t01, t09, 0x88 );                    //   1  17  33  49  66  81  97 113 129 145 161 177 193 209 225 241
+    __m512 t00, t01, t02, t03;
+    __m512 u00, u01, u02, u03;
+
+    // Gather the rows into lanes ordered a00-a03 | a04-a07 | a08-a11 |
+    // a12-a15 and transpose each lane as a 4x4 block.
+
+    u00   = _mm512_castps128_ps512( load_tr_row_2( a00 ) );
+    u00   = _mm512_insertf32x4( u00, load_tr_row_2( a04 ), 1 );
+    u00   = _mm512_insertf32x4( u00, load_tr_row_2( a08 ), 2 );
+    u00   = _mm512_insertf32x4( u00, load_tr_row_2( a12 ), 3 );
+    u01   = _mm512_castps128_ps512( load_tr_row_2( a01 ) );
+    u01   = _mm512_insertf32x4( u01, load_tr_row_2( a05 ), 1 );
+    u01   = _mm512_insertf32x4( u01, load_tr_row_2( a09 ), 2 );
+    u01   = _mm512_insertf32x4( u01, load_tr_row_2( a13 ), 3 );
+    u02   = _mm512_castps128_ps512( load_tr_row_2( a02 ) );
+    u02   = _mm512_insertf32x4( u02, load_tr_row_2( a06 ), 1 );
+    u02   = _mm512_insertf32x4( u02, load_tr_row_2( a10 ), 2 );
+    u02   = _mm512_insertf32x4( u02, load_tr_row_2( a14 ), 3 );
+    u03   = _mm512_castps128_ps512( load_tr_row_2( a03 ) );
+    u03   = _mm512_insertf32x4( u03, load_tr_row_2( a07 ), 1 );
+    u03   = _mm512_insertf32x4( u03, load_tr_row_2( a11 ), 2 );
+    u03   = _mm512_insertf32x4( u03, load_tr_row_2( a15 ), 3 );
+
+    t00   = _mm512_unpacklo_ps( u00, u01 );
+    t01   = _mm512_unpackhi_ps( u00, u01 );
+    t02   = _mm512_unpacklo_ps( u02, u03 );
+    t03   = _mm512_unpackhi_ps( u02, u03 );
+
+    b00.v = _mm512_shuffle_ps( t00, t02, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+    b01.v = _mm512_shuffle_ps( t00, t02, _MM_SHUFFLE( 3, 2, 3, 2 ) );
   }
 
   inline void load_16x2_bc( const void * ALIGNED(64) a00,
@@ -697,66 +707,37 @@ namespace v16
 			    const void * ALIGNED(64) a15,
 			    v16 &b00, v16 &b01, v16 &b02 )
   {
-    __m512 t00, t01, t02, t03, t04, t05, t06, t07, t08, t09, t10, t11, t12, t13, t14, t15;
-    __m512 u00, u01, u02, u03, u04, u05, u06, u07, u08, u09, u10, u11, u12, u13, u14, u15;
-
-    u00   = _mm512_load_ps( (const float *)a00 );                      //   0   1   2   3   4   5   6   7   8   9  10  11  12  13  14  15
-    u01   = _mm512_load_ps( (const float *)a01 );                      //  16  17  18  19  20  21  22  23  24  25  26  27  28  29  30  31
-    u02   = _mm512_load_ps( (const float *)a02 );                      //  32  33  34  35  36  37  38  39  40  41  42  43  44  45  46  47
-    u03   = _mm512_load_ps( (const float *)a03 );                      //  48  49  50  51  52  53  54  55  56  57  58  59  60  61  62  63
-    u04   = _mm512_load_ps( (const float *)a04 );                      //  64  65  66  67  68  69  70  71  72  73  74  75  76  77  78  79
-    u05   = _mm512_load_ps( (const float *)a05 );                      //  80  81  82  83  84  85  86  87  88  89  90  91  92  93  94  95
-    u06   = _mm512_load_ps( (const float *)a06 );                      //  96  97  98  99 100 101 102 103 104 105 106 107 108 109 110 111
-    u07   = _mm512_load_ps( (const float *)a07 );                      // 112 113 114 115 116 117 118 119 120 121 122 123 124 125 126 127
-    u08   = _mm512_load_ps( (const float *)a08 );                      // 128 129 130 131 132 133 134 135 136 137 138 139 140 141 142 143
-    u09   = _mm512_load_ps( (const float *)a09 );                      // 144 145 146 147 148 149 150 151 152 153 154 155 156 157 158 159
-    u10   = _mm512_load_ps( (const float *)a10 );                      // 160 161 162 163 164 165 166 167 168 169 170 171 172 173 174 175
-    u11   = _mm512_load_ps( (const float *)a11 );                      // 176 177 178 179 180 181 182 183 184 185 186 187 188 189 190 191
-    u12   = _mm512_load_ps( (const float *)a12 );                      // 192 193 194 195 196 197 198 199 200 201 202 203 204 205 206 207
-    u13   = _mm512_load_ps( (const float *)a13 );                      // 208 209 210 211 212 213 214 215 216 217 218 219 220 221 222 223
-    u14   = _mm512_load_ps( (const float *)a14 );                      // 224 225 226 227 228 229 230 231 232 233 234 235 236 237 238 239
-    u15   = _mm512_load_ps( (const float *)a15 );                      // 240 241 242 243 244 245 246 247 248 249 250 251 252 253 254 255
-
-    t00   = _mm512_unpacklo_ps( u00, u01 );                            //   0  16   1  17   4  20   5  21   8  24   9  25  12  28  13  29 
-    t01   = _mm512_unpackhi_ps( u00, u01 );                            //   2  18   3  19   6  22   7  23  10  26  11  27  14  30  15  31
-    t02   = _mm512_unpacklo_ps( u02, u03 );                            //  32  48  33  49  36  52  37  53  40  56  41  57  44  60  45  61
-    t03   = _mm512_unpackhi_ps( u02, u03 );                            //  34  50  35  51  38  54  39  55  42  58  43  59  46  62  47  63
-    t04   = _mm512_unpacklo_ps( u04, u05 );                            //  64  80  65  81  68  84  69  85  72  88  73  89  76  92  77  93
-    t05   = _mm512_unpackhi_ps( u04, u05 );                            //  66  82  67  83  70  86  71  87  74  90  75  91  78  94  79  95
-    t06   = _mm512_unpacklo_ps( u06, u07 );                            //  96 112  97 113 100 116 101 117 104 120 105 121 108 124 109 125
-    t07   = _mm512_unpackhi_ps( u06, u07 );                            //  98 114  99 115 102 118 103 119 106 122 107 123 110 126 111 127
-    t08   = _mm512_unpacklo_ps( u08, u09 );                            // 128 144 129 145 132 148 133 149 136 152 137 153 140 156 141 157
-    t09   = _mm512_unpackhi_ps( u08, u09 );                            // 130 146 131 147 134 150 135 151 138 154 139 155 142 158 143 159
-    t10   = _mm512_unpacklo_ps( u10, u11 );                            // 160 176 161 177 164 180 165 181 168 184 169 185 172 188 173 189
-    t11   = _mm512_unpackhi_ps( u10, u11 );                            // 162 178 163 179 166 182 167 183 170 186 171 187 174 190 175 191
-    t12   = _mm512_unpacklo_ps( u12, u13 );                            // 192 208 193 209 196 212 197 213 200 216 201 217 204 220 205 221
-    t13   = _mm512_unpackhi_ps( u12, u13 );                            // 194 210 195 211 198 214 199 215 202 218 203 219 206 222 207 223
-    t14   = _mm512_unpacklo_ps( u14, u15 );                            // 224 240 225 241 228 244 229 245 232 248 233 249 236 252 237 253
-    t15   = _mm512_unpackhi_ps( u14, u15 );                            // 226 242 227 243 230 246 231 247 234 250 235 251 238 254 239 255
-
-    u00   = _mm512_shuffle_ps( t00, t02, _MM_SHUFFLE( 1, 0, 1, 0 ) );  //   0  16  32  48   4  20  36  52   8  24  40  56  12  28  44  60
-    u01   = _mm512_shuffle_ps( t00, t02, _MM_SHUFFLE( 3, 2, 3, 2 ) );  //   1  17  33  49   5  21  37  53   9  25  41  57  13  29  45  61
-    u02   = _mm512_shuffle_ps( t01, t03, _MM_SHUFFLE( 1, 0, 1, 0 ) );  //   2  18  34  50   6  22  38  54  10  26  42  58  14  30  46  62
-    u04   = _mm512_shuffle_ps( t04, t06, _MM_SHUFFLE( 1, 0, 1, 0 ) );  //  64  80  96 112  68  84 100 116  72  88 104 120  76  92 108 124
-    u05   = _mm512_shuffle_ps( t04, t06, _MM_SHUFFLE( 3, 2, 3, 2 ) );  //  65  81  97 113  69  85 101 117  73  89 105 121  77  93 109 125
-    u06   = _mm512_shuffle_ps( t05, t07, _MM_SHUFFLE( 1, 0, 1, 0 ) );  //  66  82  98 114  70  86 102 118  74  90 106 122  78  94 110 126
-    u08   = _mm512_shuffle_ps( t08, t10, _MM_SHUFFLE( 1, 0, 1, 0 ) );  // 128 144 160 176 132 148 164 180 136 152 168 184 140 156 172 188
-    u09   = _mm512_shuffle_ps( t08, t10, _MM_SHUFFLE( 3, 2, 3, 2 ) );  // 129 145 161 177 133 149 165 181 137 153 169 185 141 157 173 189
-    u10   = _mm512_shuffle_ps( t09, t11, _MM_SHUFFLE( 1, 0, 1, 0 ) );  // 130 146 162 178 134 150 166 182 138 154 170 186 142 158 174 190
-    u12   = _mm512_shuffle_ps( t12, t14, _MM_SHUFFLE( 1, 0, 1, 0 ) );  // 192 208 224 240 196 212 228 244 200 216 232 248 204 220 236 252
-    u13   = _mm512_shuffle_ps( t12, t14, _MM_SHUFFLE( 3, 2, 3, 2 ) );  // 193 209 225 241 197 213 229 245 201 217 233 249 205 221 237 253
-    u14   = _mm512_shuffle_ps( t13, t15, _MM_SHUFFLE( 1, 0, 1, 0 ) );  // 194 210 226 242 198 214 230 246 202 218 234 250 206 222 238 254
-
-    t00   = _mm512_shuffle_f32x4( u00, u04, 0x88 );                    //   0  16  32  48   8  24  40  56  64  80  96 112  72  88 104 120
-    t01   = _mm512_shuffle_f32x4( u01, u05, 0x88 );                    //   1  17  33  49   9  25  41  57  65  81  97 113  73  89 105 121
-    t02   = _mm512_shuffle_f32x4( u02, u06, 0x88 );                    //   2  18  34  50  10  26  42  58  66  82  98 114  74  90 106 122
-    t08   = _mm512_shuffle_f32x4( u08, u12, 0x88 );                    // 128 144 160 176 136 152 168 184 192 208 224 240 200 216 232 248
-    t09   = _mm512_shuffle_f32x4( u09, u13, 0x88 );                    // 129 145 161 177 137 153 169 185 193 209 225 241 201 217 233 249
-    t10   = _mm512_shuffle_f32x4( u10, u14, 0x88 );                    // 130 146 162 178 138 154 170 186 194 210 226 242 202 218 234 250
-
-    b00.v = _mm512_shuffle_f32x4( t00, t08, 0x88 );                    //   0  16  32  48  64  80  96 112 128 144 160 176 192 208 224 240
-    b01.v = _mm512_shuffle_f32x4( t01, t09, 0x88 );                    //   1  17  33  49  66  81  97 113 129 145 161 177 193 209 225 241
-    b02.v = _mm512_shuffle_f32x4( t02, t10, 0x88 );                    //   2  18  34  50  67  82  98 114 130 146 162 178 194 210 226 242
+    __m512 t00, t01, t02, t03;
+    __m512 u00, u01, u02, u03;
+
+    // Gather the rows into lanes ordered a00-a03 | a04-a07 | a08-a11 |
+    // a12-a15 and transpose each lane as a 4x4 block.
+
+    u00   = _mm512_castps128_ps512( load_tr_row_3( a00 ) );
+    u00   = _mm512_insertf32x4( u00, load_tr_row_3( a04 ), 1 );
+    u00   = _mm512_insertf32x4( u00, load_tr_row_3( a08 ), 2 );
+    u00   = _mm512_insertf32x4( u00, load_tr_row_3( a12 ), 3 );
+    u01   = _mm512_castps128_ps512( load_tr_row_3( a01 ) );
+    u01   = _mm512_insertf32x4( u01, load_tr_row_3( a05 ), 1 );
+    u01   = _mm512_insertf32x4( u01, load_tr_row_3( a09 ), 2 );
+    u01   = _mm512_insertf32x4( u01, load_tr_row_3( a13 ), 3 );
+    u02   = _mm512_castps128_ps512( load_tr_row_3( a02 ) );
+    u02   = _mm512_insertf32x4( u02, load_tr_row_3( a06 ), 1 );
+    u02   = _mm512_insertf32x4( u02, load_tr_row_3( a10 ), 2 );
+    u02   = _mm512_insertf32x4( u02, load_tr_row_3( a14 ), 3 );
+    u03   = _mm512_castps128_ps512( load_tr_row_3( a03 ) );
+    u03   = _mm512_insertf32x4( u03, load_tr_row_3( a07 ), 1 );
+    u03   = _mm512_insertf32x4( u03, load_tr_row_3( a11 ), 2 );
+    u03   = _mm512_insertf32x4( u03, load_tr_row_3( a15 ), 3 );
+
+    t00   = _mm512_unpacklo_ps( u00, u01 );
+    t01   = _mm512_unpackhi_ps( u00, u01 );
+    t02   = _mm512_unpacklo_ps( u02, u03 );
+    t03   = _mm512_unpackhi_ps( u02, u03 );
+
+    b00.v = _mm512_shuffle_ps( t00, t02, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+    b01.v = _mm512_shuffle_ps( t00, t02, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+    b02.v = _mm512_shuffle_ps( t01, t03, _MM_SHUFFLE( 1, 0, 1, 0 ) );
   }
 
   inline void load_16x4_tr( const void * ALIGNED(64) a00,
@@ -777,73 +758,38 @@ namespace v16
 			    const void * ALIGNED(64) a15,
 			    v16 &b00, v16 &b01, v16 &b02, v16 &b03 )
   {
-    __m512 t00, t01, t02, t03, t04, t05, t06, t07, t08, t09, t10, t11, t12, t13, t14, t15;
-    __m512 u00, u01, u02, u03, u04, u05, u06, u07, u08, u09, u10, u11, u12, u13, u14, u15;
-
-    u00   = _mm512_load_ps( (const float *)a00 );                      //   0   1   2   3   4   5   6   7   8   9  10  11  12  13  14  15
-    u01   = _mm512_load_ps( (const float *)a01 );                      //  16  17  18  19  20  21  22  23  24  25  26  27  28  29  30  31
-    u02   = _mm512_load_ps( (const float *)a02 );                      //  32  33  34  35  36  37  38  39  40  41  42  43  44  45  46  47
-    u03   = _mm512_load_ps( (const float *)a03 );                      //  48  49  50  51  52  53  54  55  56  57  58  59  60  61  62  63
-    u04   = _mm512_load_ps( (const float *)a04 );                      //  64  65  66  67  68  69  70  71  72  73  74  75  76  77  78  79
-    u05   = _mm512_load_ps( (const float *)a05 );                      //  80  81  82  83  84  85  86  87  88  89  90  91  92  93  94  95
-    u06   = _mm512_load_ps( (const float *)a06 );                      //  96  97  98  99 100 101 102 103 104 105 106 107 108 109 110 111
-    u07   = _mm512_load_ps( (const float *)a07 );                      // 112 113 114 115 116 117 118 119 120 121 122 123 124 125 126 127
-    u08   = _mm512_load_ps( (const float *)a08 );                      // 128 129 130 131 132 133 134 135 136 137 138 139 140 141 142 143
-    u09   = _mm512_load_ps( (const float *)a09 );                      // 144 145 146 147 148 149 150 151 152 153 154 155 156 157 158 159
-    u10   = _mm512_load_ps( (const float *)a10 );                      // 160 161 162 163 164 165 166 167 168 169 170 171 172 173 174 175
-    u11   = _mm512_load_ps( (const float *)a11 );                      // 176 177 178 179 180 181 182 183 184 185 186 187 188 189 190 191
-    u12   = _mm512_load_ps( (const float *)a12 );                      // 192 193 194 195 196 197 198 199 200 201 202 203 204 205 206 207
-    u13   = _mm512_load_ps( (const float *)a13 );                      // 208 209 210 211 212 213 214 215 216 217 218 219 220 221 222 223
-    u14   = _mm512_load_ps( (const float *)a14 );                      // 224 225 226 227 228 229 230 231 232 233 234 235 236 237 238 239
-    u15   = _mm512_load_ps( (const float *)a15 );                      // 240 241 242 243 244 245 246 247 248 249 250 251 252 253 254 255
-
-    t00   = _mm512_unpacklo_ps( u00, u01 );                            //   0  16   1  17   4  20   5  21   8  24   9  25  12  28  13  29 
-    t01   = _mm512_unpackhi_ps( u00, u01 );                            //   2  18   3  19   6  22   7  23  10  26  11  27  14  30  15  31
-    t02   = _mm512_unpacklo_ps( u02, u03 );                            //  32  48  33  49  36  52  37  53  40  56  41  57  44  60  45  61
-    t03   = _mm512_unpackhi_ps( u02, u03 );                            //  34  50  35  51  38  54  39  55  42  58  43  59  46  62  47  63
-    t04   = _mm512_unpacklo_ps( u04, u05 );                            //  64  80  65  81  68  84  69  85  72  88  73  89  76  92  77  93
-    t05   = _mm512_unpackhi_ps( u04, u05 );                            //  66  82  67  83  70  86  71  87  74  90  75  91  78  94  79  95
-    t06   = _mm512_unpacklo_ps( u06, u07 );                            //  96 112  97 113 100 116 101 117 104 120 105 121 108 124 109 125
-    t07   = _mm512_unpackhi_ps( u06, u07 );                            //  98 114  99 115 102 118 103 119 106 122 107 123 110 126 111 127
-    t08   = _mm512_unpacklo_ps( u08, u09 );                            // 128 144 129 145 132 148 133 149 136 152 137 153 140 156 141 157
-    t09   = _mm512_unpackhi_ps( u08, u09 );                            // 130 146 131 147 134 150 135 151 138 154 139 155 142 158 143 159
-    t10   = _mm512_unpacklo_ps( u10, u11 );                            // 160 176 161 177 164 180 165 181 168 184 169 185 172 188 173 189
-    t11   = _mm512_unpackhi_ps( u10, u11 );                            // 162 178 163 179 166 182 167 183 170 186 171 187 174 190 175 191
-    t12   = _mm512_unpacklo_ps( u12, u13 );                            // 192 208 193 209 196 212 197 213 200 216 201 217 204 220 205 221
-    t13   = _mm512_unpackhi_ps( u12, u13 );                            // 194 210 195 211 198 214 199 215 202 218 203 219 206 222 207 223
-    t14   = _mm512_unpacklo_ps( u14, u15 );                            // 224 240 225 241 228 244 229 245 232 248 233 249 236 252 237 253
-    t15   = _mm512_unpackhi_ps( u14, u15 );                            // 226 242 227 243 230 246 231 247 234 250 235 251 238 254 239 255
-
-    u00   = _mm512_shuffle_ps( t00, t02, _MM_SHUFFLE( 1, 0, 1, 0 ) );  //   0  16  32  48   4  20  36  52   8  24  40  56  12  28  44  60
-    u01   = _mm512_shuffle_ps( t00, t02, _MM_SHUFFLE( 3, 2, 3, 2 ) );  //   1  17  33  49   5  21  37  53   9  25  41  57  13  29  45  61
-    u02   = _mm512_shuffle_ps( t01, t03, _MM_SHUFFLE( 1, 0, 1, 0 ) );  //   2  18  34  50   6  22  38  54  10  26  42  58  14  30  46  62
-    u03   = _mm512_shuffle_ps( t01, t03, _MM_SHUFFLE( 3, 2, 3, 2 ) );  //   3  19  35  51   7  23  39  55  11  27  43  59  15  31  47  63
-    u04   = _mm512_shuffle_ps( t04, t06, _MM_SHUFFLE( 1, 0, 1, 0 ) );  //  64  80  96 112  68  84 100 116  72  88 104 120  76  92 108 124
-    u05   = _mm512_shuffle_ps( t04, t06, _MM_SHUFFLE( 3, 2, 3, 2 ) );  //  65  81  97 113  69  85 101 117  73  89 105 121  77  93 109 125
-    u06   = _mm512_shuffle_ps( t05, t07, _MM_SHUFFLE( 1, 0, 1, 0 ) );  //  66  82  98 114  70  86 102 118  74  90 106 122  78  94 110 126
-    u07   = _mm512_shuffle_ps( t05, t07, _MM_SHUFFLE( 3, 2, 3, 2 ) );  //  67  83  99 115  71  87 103 119  75  91 107 123  79  95 111 127
-    u08   = _mm512_shuffle_ps( t08, t10, _MM_SHUFFLE( 1, 0, 1, 0 ) );  // 128 144 160 176 132 148 164 180 136 152 168 184 140 156 172 188
-    u09   = _mm512_shuffle_ps( t08, t10, _MM_SHUFFLE( 3, 2, 3, 2 ) );  // 129 145 161 177 133 149 165 181 137 153 169 185 141 157 173 189
-    u10   = _mm512_shuffle_ps( t09, t11, _MM_SHUFFLE( 1, 0, 1, 0 ) );  // 130 146 162 178 134 150 166 182 138 154 170 186 142 158 174 190
-    u11   = _mm512_shuffle_ps( t09, t11, _MM_SHUFFLE( 3, 2, 3, 2 ) );  // 131 147 163 179 135 151 167 183 139 155 171 187 143 159 175 191
-    u12   = _mm512_shuffle_ps( t12, t14, _MM_SHUFFLE( 1, 0, 1, 0 ) );  // 192 208 224 240 196 212 228 244 200 216 232 248 204 220 236 252
-    u13   = _mm512_shuffle_ps( t12, t14, _MM_SHUFFLE( 3, 2, 3, 2 ) );  // 193 209 225 241 197 213 229 245 201 217 233 249 205 221 237 253
-    u14   = _mm512_shuffle_ps( t13, t15, _MM_SHUFFLE( 1, 0, 1, 0 ) );  // 194 210 226 242 198 214 230 246 202 218 234 250 206 222 238 254
-    u15   = _mm512_shuffle_ps( t13, t15, _MM_SHUFFLE( 3, 2, 3, 2 ) );  // 195 211 227 243 199 215 231 247 203 219 235 251 207 223 239 255
-
-    t00   = _mm512_shuffle_f32x4( u00, u04, 0x88 );                    //   0  16  32  48   8  24  40  56  64  80  96 112  72  88 104 120
-    t01   = _mm512_shuffle_f32x4( u01, u05, 0x88 );                    //   1  17  33  49   9  25  41  57  65  81  97 113  73  89 105 121
-    t02   = _mm512_shuffle_f32x4( u02, u06, 0x88 );                    //   2  18  34  50  10  26  42  58  66  82  98 114  74  90 106 122
-    t03   = _mm512_shuffle_f32x4( u03, u07, 0x88 );                    //   3  19  35  51  11  27  43  59  67  83  99 115  75  91 107 123
-    t08   = _mm512_shuffle_f32x4( u08, u12, 0x88 );                    // 128 144 160 176 136 152 168 184 192 208 224 240 200 216 232 248
-    t09   = _mm512_shuffle_f32x4( u09, u13, 0x88 );                    // 129 145 161 177 137 153 169 185 193 209 225 241 201 217 233 249
-    t10   = _mm512_shuffle_f32x4( u10, u14, 0x88 );                    // 130 146 162 178 138 154 170 186 194 210 226 242 202 218 234 250
-    t11   = _mm512_shuffle_f32x4( u11, u15, 0x88 );                    // 131 147 163 179 139 155 171 187 195 211 227 243 203 219 235 251
-
-    b00.v = _mm512_shuffle_f32x4( t00, t08, 0x88 );                    //   0  16  32  48  64  80  96 112 128 144 160 176 192 208 224 240
-    b01.v = _mm512_shuffle_f32x4( t01, t09, 0x88 );                    //   1  17  33  49  66  81  97 113 129 145 161 177 193 209 225 241
-    b02.v = _mm512_shuffle_f32x4( t02, t10, 0x88 );                    //   2  18  34  50  67  82  98 114 130 146 162 178 194 210 226 242
-    b03.v = _mm512_shuffle_f32x4( t03, t11, 0x88 );                    //   3  19  35  51  68  83  99 115 131 147 163 179 195 211 227 243
+    __m512 t00, t01, t02, t03;
+    __m512 u00, u01, u02, u03;
+
+    // Gather the rows into lanes ordered a00-a03 | a04-a07 | a08-a11 |
+    // a12-a15 and transpose each lane as a 4x4 block.
+
+    u00   = _mm512_castps128_ps512( load_tr_row_4( a00 ) );
+    u00   = _mm512_insertf32x4( u00, load_tr_row_4( a04 ), 1 );
+    u00   = _mm512_insertf32x4( u00, load_tr_row_4( a08 ), 2 );
+    u00   = _mm512_insertf32x4( u00, load_tr_row_4( a12 ), 3 );
+    u01   = _mm512_castps128_ps512( load_tr_row_4( a01 ) );
+    u01   = _mm512_insertf32x4( u01, load_tr_row_4( a05 ), 1 );
+    u01   = _mm512_insertf32x4( u01, load_tr_row_4( a09 ), 2 );
+    u01   = _mm512_insertf32x4( u01, load_tr_row_4( a13 ), 3 );
+    u02   = _mm512_castps128_ps512( load_tr_row_4( a02 ) );
+    u02   = _mm512_insertf32x4( u02, load_tr_row_4( a06 ), 1 );
+    u02   = _mm512_insertf32x4( u02, load_tr_row_4( a10 ), 2 );
+    u02   = _mm512_insertf32x4( u02, load_tr_row_4( a14 ), 3 );
+    u03   = _mm512_castps128_ps512( load_tr_row_4( a03 ) );
+    u03   = _mm512_insertf32x4( u03, load_tr_row_4( a07 ), 1 );
+    u03   = _mm512_insertf32x4( u03, load_tr_row_4( a11 ), 2 );
+    u03   = _mm512_insertf32x4( u03, load_tr_row_4( a15 ), 3 );
+
+    t00   = _mm512_unpacklo_ps( u00, u01 );
+    t01   = _mm512_unpackhi_ps( u00, u01 );
+    t02   = _mm512_unpacklo_ps( u02, u03 );
+    t03   = _mm512_unpackhi_ps( u02, u03 );
+
+    b00.v = _mm512_shuffle_ps( t00, t02, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+    b01.v = _mm512_shuffle_ps( t00, t02, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+    b02.v = _mm512_shuffle_ps( t01, t03, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+    b03.v = _mm512_shuffle_ps( t01, t03, _MM_SHUFFLE( 3, 2, 3, 2 ) );
   }
 
   inline void load_16x8_tr( const void * ALIGNED(64) a00,
@@ -2014,6 +1960,8 @@ namespace v16
     // v16int miscellaneous friends
 
     friend inline v16int abs( const v16int &a ) ALWAYS_INLINE;
+    friend inline void mul_hi_lo( const v16int &a, const v16int &b,
+                                  v16int &hi, v16int &lo ) ALWAYS_INLINE;
     friend inline v16    czero( const v16int &c, const v16 &a ) ALWAYS_INLINE;
     friend inline v16 notczero( const v16int &c, const v16 &a ) ALWAYS_INLINE;
     // FIXME: cswap, notcswap!
@@ -2315,6 +2263,27 @@ namespace v16
     return b;
   }
 
+  // Unsigned 32x32 bit products of the lanes of a and b (high and low
+  // words)
+
+  inline void mul_hi_lo( const v16int &a, const v16int &b,
+                         v16int &hi, v16int &lo )
+  {
+    __m512i a_v = _mm512_castps_si512( a.v ), b_v = _mm512_castps_si512( b.v );
+
+    // 64 bit products of the even lanes and of the odd lanes (the
+    // shuffles stay within each 128 bit quarter)
+
+    __m512i p0 = _mm512_mul_epu32( a_v, b_v );
+    __m512i p1 = _mm512_mul_epu32( _mm512_srli_epi64( a_v, 32 ),
+                                   _mm512_srli_epi64( b_v, 32 ) );
+
+    lo.v = _mm512_castsi512_ps( _mm512_unpacklo_epi32( _mm512_shuffle_epi32( p0, (_MM_PERM_ENUM) _MM_SHUFFLE(0,0,2,0) ),
+                                                       _mm512_shuffle_epi32( p1, (_MM_PERM_ENUM) _MM_SHUFFLE(0,0,2,0) ) ) );
+    hi.v = _mm512_castsi512_ps( _mm512_unpacklo_epi32( _mm512_shuffle_epi32( p0, (_MM_PERM_ENUM) _MM_SHUFFLE(0,0,3,1) ),
+                                                       _mm512_shuffle_epi32( p1, (_MM_PERM_ENUM) _MM_SHUFFLE(0,0,3,1) ) ) );
+  }
+
   inline v16 czero( const v16int &c, const v16 &a )
   {
     v16 b;
@@ -2866,4 +2835,8 @@ namespace v16
 
 } // namespace v16
 
+#ifdef VPIC_ISA_LOCAL
+} // namespace
+#endif
+
 #endif // _v16_avx512_h_
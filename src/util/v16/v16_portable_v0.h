@@ -3007,6 +3007,8 @@ namespace v16
     // v16int miscellaneous friends
 
     friend inline v16int abs( const v16int &a ) ALWAYS_INLINE;
+    friend inline void mul_hi_lo( const v16int &a, const v16int &b,
+                                  v16int &hi, v16int &lo ) ALWAYS_INLINE;
     friend inline v16    czero( const v16int &c, const v16 &a ) ALWAYS_INLINE;
     friend inline v16 notczero( const v16int &c, const v16 &a ) ALWAYS_INLINE;
     // FIXME: cswap, notcswap!
@@ -3341,6 +3343,22 @@ namespace v16
     return b;
   }
 
+  // Unsigned 32x32 bit products of the lanes of a and b (high and low
+  // words)
+
+  inline void mul_hi_lo( const v16int &a, const v16int &b,
+                         v16int &hi, v16int &lo )
+  {
+    for( int j = 0; j < 16; j++ )
+    {
+      unsigned long long p = (unsigned long long) (unsigned int) a.i[j] *
+                             (unsigned int) b.i[j];
+
+      hi.i[j] = (int) ( p >> 32 );
+      lo.i[j] = (int) p;
+    }
+  }
+
   inline v16 czero( const v16int &c, const v16 &a )
   {
     v16 b;
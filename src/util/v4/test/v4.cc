@@ -57,6 +57,15 @@ TEST_CASE("TEST_CASE_splat", "[v4]") {
   REQUIRE( any( e==v4int(4,4,4,4) ) );
 } // TEST_CASE
 
+TEST_CASE("TEST_CASE_mul_hi_lo", "[v4]") {
+  v4int a( -1, 3, 0x7fffffff, (int)0x9e3779b9 );
+  v4int b( -1, -5, 0x7fffffff, (int)0xd2511f53 );
+  v4int hi, lo;
+  mul_hi_lo( a, b, hi, lo );
+  REQUIRE( all( hi==v4int( (int)0xfffffffe, 2, 0x3fffffff, (int)0x81fba4c3 ) ) );
+  REQUIRE( all( lo==v4int( 1, (int)0xfffffff1, 1, (int)0x4942ddfb ) ) );
+} // TEST_CASE
+
 TEST_CASE("TEST_CASE_shuffle", "[v4]") {
   v4int a( 0, 1, 2, 3), b( 4, 8,12,16), c( 5, 9,13,17), d( 6,10,14,18);
   v4int e( 7,11,15,19);
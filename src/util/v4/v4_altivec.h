@@ -550,6 +550,8 @@ namespace v4
     // v4int miscellaneous friends
 
     friend inline v4int abs( const v4int &a ) ALWAYS_INLINE;
+    friend inline void mul_hi_lo( const v4int &a, const v4int &b,
+                                  v4int &hi, v4int &lo ) ALWAYS_INLINE;
     friend inline v4    czero( const v4int &c, const v4 &a ) ALWAYS_INLINE;
     friend inline v4 notczero( const v4int &c, const v4 &a ) ALWAYS_INLINE;
     // FIXME: cswap, notcswap!
@@ -819,6 +821,30 @@ namespace v4
     return b;
   }
 
+  // Unsigned 32x32 bit products of the lanes of a and b (high and low
+  // words)
+
+  inline void mul_hi_lo( const v4int &a, const v4int &b,
+                         v4int &hi, v4int &lo )
+  {
+    union { int i[4]; _v4_float v; } ta, tb, th, tl;
+
+    ta.v = a.v;
+    tb.v = b.v;
+
+    for( int j = 0; j < 4; j++ )
+    {
+      unsigned long long p = (unsigned long long) (unsigned int) ta.i[j] *
+                             (unsigned int) tb.i[j];
+
+      th.i[j] = (int) ( p >> 32 );
+      tl.i[j] = (int) p;
+    }
+
+    hi.v = th.v;
+    lo.v = tl.v;
+  }
+
   inline v4 czero( const v4int &c, const v4 &a )
   {
     v4 b;
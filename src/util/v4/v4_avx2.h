@@ -612,6 +612,8 @@ namespace v4
     // v4int miscellaneous friends
 
     friend inline v4int abs( const v4int &a ) ALWAYS_INLINE;
+    friend inline void mul_hi_lo( const v4int &a, const v4int &b,
+                                  v4int &hi, v4int &lo ) ALWAYS_INLINE;
     friend inline v4    czero( const v4int &c, const v4 &a ) ALWAYS_INLINE;
     friend inline v4 notczero( const v4int &c, const v4 &a ) ALWAYS_INLINE;
     // FIXME: cswap, notcswap!
@@ -926,6 +928,26 @@ namespace v4
     return b;
   }
 
+  // Unsigned 32x32 bit products of the lanes of a and b (high and low
+  // words)
+
+  inline void mul_hi_lo( const v4int &a, const v4int &b,
+                         v4int &hi, v4int &lo )
+  {
+    __m128i a_v = _mm_castps_si128( a.v ), b_v = _mm_castps_si128( b.v );
+
+    // 64 bit products of the even lanes and of the odd lanes
+
+    __m128i p0 = _mm_mul_epu32( a_v, b_v );
+    __m128i p1 = _mm_mul_epu32( _mm_srli_epi64( a_v, 32 ),
+                                _mm_srli_epi64( b_v, 32 ) );
+
+    lo.v = _mm_castsi128_ps( _mm_unpacklo_epi32( _mm_shuffle_epi32( p0, PERM(0,2,0,0) ),
+                                                 _mm_shuffle_epi32( p1, PERM(0,2,0,0) ) ) );
+    hi.v = _mm_castsi128_ps( _mm_unpacklo_epi32( _mm_shuffle_epi32( p0, PERM(1,3,0,0) ),
+                                                 _mm_shuffle_epi32( p1, PERM(1,3,0,0) ) ) );
+  }
+
   inline v4 czero( const v4int &c, const v4 &a )
   {
     v4 b;
@@ -493,6 +493,8 @@ namespace v4
     // v4int miscellaneous friends
 
     friend inline v4int abs( const v4int &a ) ALWAYS_INLINE;
+    friend inline void mul_hi_lo( const v4int &a, const v4int &b,
+                                  v4int &hi, v4int &lo ) ALWAYS_INLINE;
     friend inline v4    czero( const v4int &c, const v4 &a ) ALWAYS_INLINE;
     friend inline v4 notczero( const v4int &c, const v4 &a ) ALWAYS_INLINE;
     // FIXME: cswap, notcswap!
@@ -730,6 +732,22 @@ namespace v4
     return b;
   }
 
+  // Unsigned 32x32 bit products of the lanes of a and b (high and low
+  // words)
+
+  inline void mul_hi_lo( const v4int &a, const v4int &b,
+                         v4int &hi, v4int &lo )
+  {
+    for( int j = 0; j < 4; j++ )
+    {
+      unsigned long long p = (unsigned long long) (unsigned int) a.i[j] *
+                             (unsigned int) b.i[j];
+
+      hi.i[j] = (int) ( p >> 32 );
+      lo.i[j] = (int) p;
+    }
+  }
+
   inline v4 czero( const v4int &c, const v4 &a )
   {
     v4 b;
@@ -772,6 +772,8 @@ namespace v8
     // v8int miscellaneous friends
 
     friend inline v8int abs( const v8int &a ) ALWAYS_INLINE;
+    friend inline void mul_hi_lo( const v8int &a, const v8int &b,
+                                  v8int &hi, v8int &lo ) ALWAYS_INLINE;
     friend inline v8    czero( const v8int &c, const v8 &a ) ALWAYS_INLINE;
     friend inline v8 notczero( const v8int &c, const v8 &a ) ALWAYS_INLINE;
     // FIXME: cswap, notcswap!
@@ -1115,6 +1117,41 @@ namespace v8
     return b;
   }
 
+  // Unsigned 32x32 bit products of the lanes of a and b (high and low
+  // words)
+
+  inline void mul_hi_lo( const v8int &a, const v8int &b,
+                         v8int &hi, v8int &lo )
+  {
+    // AVX has no 256 bit integer multiply, each 128 bit half is done
+    // with SSE2.  p0 and p1 get the 64 bit products of the even lanes and
+    // of the odd lanes.
+
+    __m128i a0 = _mm_castps_si128( _mm256_castps256_ps128( a.v ) );
+    __m128i a1 = _mm_castps_si128( _mm256_extractf128_ps( a.v, 1 ) );
+    __m128i b0 = _mm_castps_si128( _mm256_castps256_ps128( b.v ) );
+    __m128i b1 = _mm_castps_si128( _mm256_extractf128_ps( b.v, 1 ) );
+
+    __m128i p00 = _mm_mul_epu32( a0, b0 );
+    __m128i p01 = _mm_mul_epu32( _mm_srli_epi64( a0, 32 ), _mm_srli_epi64( b0, 32 ) );
+    __m128i p10 = _mm_mul_epu32( a1, b1 );
+    __m128i p11 = _mm_mul_epu32( _mm_srli_epi64( a1, 32 ), _mm_srli_epi64( b1, 32 ) );
+
+    __m128i l0 = _mm_unpacklo_epi32( _mm_shuffle_epi32( p00, _MM_SHUFFLE(0,0,2,0) ),
+                                     _mm_shuffle_epi32( p01, _MM_SHUFFLE(0,0,2,0) ) );
+    __m128i l1 = _mm_unpacklo_epi32( _mm_shuffle_epi32( p10, _MM_SHUFFLE(0,0,2,0) ),
+                                     _mm_shuffle_epi32( p11, _MM_SHUFFLE(0,0,2,0) ) );
+    __m128i h0 = _mm_unpacklo_epi32( _mm_shuffle_epi32( p00, _MM_SHUFFLE(0,0,3,1) ),
+                                     _mm_shuffle_epi32( p01, _MM_SHUFFLE(0,0,3,1) ) );
+    __m128i h1 = _mm_unpacklo_epi32( _mm_shuffle_epi32( p10, _MM_SHUFFLE(0,0,3,1) ),
+                                     _mm_shuffle_epi32( p11, _MM_SHUFFLE(0,0,3,1) ) );
+
+    lo.v = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_castsi128_ps( l0 ) ),
+                                 _mm_castsi128_ps( l1 ), 1 );
+    hi.v = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_castsi128_ps( h0 ) ),
+                                 _mm_castsi128_ps( h1 ), 1 );
+  }
+
   inline v8 czero( const v8int &c, const v8 &a )
   {
     v8 b;
@@ -24,6 +24,11 @@
         _mm256_insertf128_ps(_mm256_castps128_ps256(vb), va, 1)
 #endif
 
+// Internal linkage in the USE_ISA_DISPATCH pipelines (see v4_sse.h)
+#ifdef VPIC_ISA_LOCAL
+namespace {
+#endif
+
 namespace v8
 {
   class v8;
@@ -968,6 +973,8 @@ namespace v8
     // v8int miscellaneous friends
 
     friend inline v8int abs( const v8int &a ) ALWAYS_INLINE;
+    friend inline void mul_hi_lo( const v8int &a, const v8int &b,
+                                  v8int &hi, v8int &lo ) ALWAYS_INLINE;
     friend inline v8    czero( const v8int &c, const v8 &a ) ALWAYS_INLINE;
     friend inline v8 notczero( const v8int &c, const v8 &a ) ALWAYS_INLINE;
     // FIXME: cswap, notcswap!
@@ -1311,6 +1318,27 @@ namespace v8
     return b;
   }
 
+  // Unsigned 32x32 bit products of the lanes of a and b (high and low
+  // words)
+
+  inline void mul_hi_lo( const v8int &a, const v8int &b,
+                         v8int &hi, v8int &lo )
+  {
+    __m256i a_v = _mm256_castps_si256( a.v ), b_v = _mm256_castps_si256( b.v );
+
+    // 64 bit products of the even lanes and of the odd lanes (the
+    // shuffles stay within each 128 bit half)
+
+    __m256i p0 = _mm256_mul_epu32( a_v, b_v );
+    __m256i p1 = _mm256_mul_epu32( _mm256_srli_epi64( a_v, 32 ),
+                                   _mm256_srli_epi64( b_v, 32 ) );
+
+    lo.v = _mm256_castsi256_ps( _mm256_unpacklo_epi32( _mm256_shuffle_epi32( p0, _MM_SHUFFLE(0,0,2,0) ),
+                                                       _mm256_shuffle_epi32( p1, _MM_SHUFFLE(0,0,2,0) ) ) );
+    hi.v = _mm256_castsi256_ps( _mm256_unpacklo_epi32( _mm256_shuffle_epi32( p0, _MM_SHUFFLE(0,0,3,1) ),
+                                                       _mm256_shuffle_epi32( p1, _MM_SHUFFLE(0,0,3,1) ) ) );
+  }
+
   inline v8 czero( const v8int &c, const v8 &a )
   {
     v8 b;
@@ -1875,4 +1903,8 @@ namespace v8
 
 } // namespace v8
 
+#ifdef VPIC_ISA_LOCAL
+} // namespace
+#endif
+
 #endif // _v8_avx2_h_
@@ -807,6 +807,8 @@ namespace v8
     // v8int miscellaneous friends
 
     friend inline v8int abs( const v8int &a ) ALWAYS_INLINE;
+    friend inline void mul_hi_lo( const v8int &a, const v8int &b,
+                                  v8int &hi, v8int &lo ) ALWAYS_INLINE;
     friend inline v8    czero( const v8int &c, const v8 &a ) ALWAYS_INLINE;
     friend inline v8 notczero( const v8int &c, const v8 &a ) ALWAYS_INLINE;
     // FIXME: cswap, notcswap!
@@ -1038,6 +1040,23 @@ namespace v8
     return b;
   }
 
+  // Unsigned 32x32 bit products of the lanes of a and b (high and low
+  // words)
+
+  inline void mul_hi_lo( const v8int &a, const v8int &b,
+                         v8int &hi, v8int &lo )
+  {
+    ALWAYS_VECTORIZE
+    for( int j = 0; j < 8; j++ )
+    {
+      unsigned long long p = (unsigned long long) (unsigned int) a.i[j] *
+                             (unsigned int) b.i[j];
+
+      hi.i[j] = (int) ( p >> 32 );
+      lo.i[j] = (int) p;
+    }
+  }
+
   inline v8 czero( const v8int &c, const v8 &a )
   {
     v8 b;
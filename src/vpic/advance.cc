@@ -20,6 +20,13 @@ int vpic_simulation::advance(void) {
 
   if( num_step>0 && step()>=num_step ) return 0;
 
+  // Move the domain cuts to even out the work measured since the last
+  // rebalance.  The rebalance sorts the particles itself.
+
+  if( (rebalance_interval>0) && (step()>0) &&
+      ((step() % rebalance_interval)==0) )
+    TIC rebalance(); TOC( rebalance, 1 );
+
   // Sort the particles for performance if desired.
 
   LIST_FOR_EACH( sp, species_list )
@@ -40,14 +47,39 @@ int vpic_simulation::advance(void) {
   // when calling collision operators.
   // FIXME: Technically, this placement of the collision operators only
   // yields a first order accurate Trotter factorization (not a second
-  // order accurate factorization).
-
-  if( collision_op_list )
+  // order accurate factorization).  Collision operators and emitters only
+  // know about the AoS particle layout, so AoSoA species are converted
+  // around them.  The user hooks get the species in their own layout (see
+  // deck/wrapper.h); converting around hooks that are usually stubs would
+  // cost two transposes per AoSoA species every step.
+
+  if( collision_op_list ) {
+    std::vector<int> layout( num_species( species_list ) );
+    set_species_list_layout( species_list, PARTICLE_LAYOUT_AOS, layout.data() );
     TIC apply_collision_op_list( collision_op_list ); TOC( collision_model, 1 );
+    restore_species_list_layout( species_list, layout.data() );
+  }
   TIC user_particle_collisions(); TOC( user_particle_collisions, 1 );
 
-  LIST_FOR_EACH( sp, species_list )
-    TIC advance_p( sp, accumulator_array, interpolator_array ); TOC( advance_p, 1 );
+  // Subcycled species accumulate the time average of the interpolated
+  // fields over subcycle steps and are pushed on the last one.  The whole
+  // subcycle*dt displacement is deposited in that step, so the current
+  // still exactly conserves charge.
+
+  double t0 = wallclock();
+  LIST_FOR_EACH( sp, species_list ) {
+    if( sp->subcycle<=1 ) {
+      TIC advance_p( sp, accumulator_array, interpolator_array ); TOC( advance_p, 1 );
+    } else {
+      int n = ++sp->subcycle_phase;
+      TIC average_interpolator_array( sp->subcycle_ia, interpolator_array, n ); TOC( average_interpolator, 1 );
+      if( n==sp->subcycle ) {
+        TIC advance_p( sp, accumulator_array, sp->subcycle_ia ); TOC( advance_p, 1 );
+        sp->subcycle_phase = 0;
+      }
+    }
+  }
+  advance_p_time += wallclock() - t0;
 
   // Because the partial position push when injecting aged particles might
   // place those particles onto the guard list (boundary interaction) and
@@ -55,8 +87,12 @@ int vpic_simulation::advance(void) {
   // be done after advance_p and before guard list processing. Note:
   // user_particle_injection should be a stub if species_list is empty.
 
-  if( emitter_list )
+  if( emitter_list ) {
+    std::vector<int> layout( num_species( species_list ) );
+    set_species_list_layout( species_list, PARTICLE_LAYOUT_AOS, layout.data() );
     TIC apply_emitter_list( emitter_list ); TOC( emission_model, 1 );
+    restore_species_list_layout( species_list, layout.data() );
+  }
   TIC user_particle_injection(); TOC( user_particle_injection, 1 );
 
   // This should be after the emission and injection to allow for the
@@ -70,13 +106,33 @@ int vpic_simulation::advance(void) {
   // guard lists. Particles that absorbed are added to rhob (using a corrected
   // local accumulation).
 
-  TIC
-    for( int round=0; round<num_comm_round; round++ )
+  // Particles migrate directly to the node they end up on (see
+  // setup_particle_migration).  If they can migrate to every neighbor,
+  // no voxel has a particle boundary condition and no species is
+  // subcycled (subcycled moves can be longer than a voxel and hop), a
+  // single exchange completes all the moves.  Otherwise, up to
+  // num_comm_round rounds are done.  With stop_comm_round (the default),
+  // they stop as soon as no node has movers left, which takes a global
+  // sum per round.
+
+  int one_round = grid->migrate_all && !particle_bc_list;
+  LIST_FOR_EACH( sp, species_list ) if( sp->subcycle>1 ) one_round = 0;
+
+  int n_round = 0, n_mover = 1;
+  TIC {
+    while( n_mover && n_round<( one_round ? 1 : num_comm_round ) ) {
       boundary_p( particle_bc_list, species_list,
                   field_array, accumulator_array );
-  TOC( boundary_p, num_comm_round );
+      n_round++;
+      if( stop_comm_round && !one_round ) {
+        int nm = 0;
+        LIST_FOR_EACH( sp, species_list ) nm += sp->nm;
+        mp_allsum_i( &nm, &n_mover, 1 );
+      }
+    }
+  } TOC( boundary_p, n_round );
   LIST_FOR_EACH( sp, species_list ) {
-    if( sp->nm && verbose )
+    if( sp->nm )
       WARNING(( "Removing %i particles associated with unprocessed %s movers (increase num_comm_round)",
                 sp->nm, sp->name ));
     // Drop the particles that have unprocessed movers due to a user defined
@@ -85,16 +141,26 @@ int vpic_simulation::advance(void) {
     // 8*voxel + face. This is an incorrect voxel index and in many cases can
     // in fact go out of bounds of the voxel indexing space. Removal is in
     // reverse order for back filling. Particle charge is accumulated to the
-    // mesh before removing the particle.
+    // mesh before removing the particle. Particles migrating to another
+    // node are in a ghost voxel; the current they left in the ghost
+    // accumulators is discarded instead.
     int nm = sp->nm;
     particle_mover_t * RESTRICT ALIGNED(16)  pm = sp->pm + sp->nm - 1;
     particle_t * RESTRICT ALIGNED(128) p0 = sp->p;
+    DECLARE_ALIGNED_ARRAY( particle_t, 32, p, 1 );
     for (; nm; nm--, pm--) {
       int i = pm->i; // particle index we are removing
-      p0[i].i >>= 3; // shift particle voxel down
+      load_particle( p0, sp->layout, i, p );
+      int face = p->i & 7;
+      p->i >>= 3; // shift particle voxel down
       // accumulate the particle's charge to the mesh
-      accumulate_rhob( field_array->f, p0+i, sp->g, sp->q );
-      p0[i] = p0[sp->np-1]; // put the last particle into position i
+      if( face==MIGRATE_FACE )
+        discard_migrated_current( accumulator_array, p->i );
+      else
+        accumulate_rhob( field_array->f, p, sp->g, sp->q );
+      // put the last particle into position i
+      load_particle( p0, sp->layout, sp->np-1, p );
+      store_particle( p0, sp->layout, i, p );
       sp->np--; // decrement the number of particles
     }
     sp->nm = 0;
@@ -118,23 +184,39 @@ int vpic_simulation::advance(void) {
 
   TIC user_current_injection(); TOC( user_current_injection, 1 );
 
-  // Half advance the magnetic field from B_0 to B_{1/2}
+  t0 = wallclock();
+  if( fused_field_advance ) {
+
+    // Advance the fields from B_0, E_0 to B_1, E_1 in a single pass.  The
+    // user field injection comes after and has to account for the
+    // magnetic field already being at B_1.
+
+    TIC FAK->advance_b_e_b( field_array ); TOC( advance_b_e_b, 1 );
 
-  TIC FAK->advance_b( field_array, 0.5 ); TOC( advance_b, 1 );
+    TIC user_field_injection(); TOC( user_field_injection, 1 );
 
-  // Advance the electric field from E_0 to E_1
+  } else {
 
-  TIC FAK->advance_e( field_array, 1.0 ); TOC( advance_e, 1 );
+    // Half advance the magnetic field from B_0 to B_{1/2}
 
-  // Let the user add their own contributions to the electric field. It is the
-  // users responsibility to insure injected electric fields are consistent
-  // across domains.
+    TIC FAK->advance_b( field_array, 0.5 ); TOC( advance_b, 1 );
 
-  TIC user_field_injection(); TOC( user_field_injection, 1 );
+    // Advance the electric field from E_0 to E_1
 
-  // Half advance the magnetic field from B_{1/2} to B_1
+    TIC FAK->advance_e( field_array, 1.0 ); TOC( advance_e, 1 );
 
-  TIC FAK->advance_b( field_array, 0.5 ); TOC( advance_b, 1 );
+    // Let the user add their own contributions to the electric field. It is
+    // the users responsibility to insure injected electric fields are
+    // consistent across domains.
+
+    TIC user_field_injection(); TOC( user_field_injection, 1 );
+
+    // Half advance the magnetic field from B_{1/2} to B_1
+
+    TIC FAK->advance_b( field_array, 0.5 ); TOC( advance_b, 1 );
+
+  }
+  field_time += wallclock() - t0;
 
   // Divergence clean e
 
@@ -10,6 +10,7 @@
  */
 
 #include <cassert>
+#include <cstring>
 #include <unordered_map>
 
 #include "vpic.h"
@@ -32,6 +33,23 @@
 // global static it replaces
 std::unordered_map<species_id, size_t> tframe_map;
 
+// Field dumps write each voxel as a field_dump_t (the field values followed
+// by the material ids) such that the file formats do not depend on how the
+// field array stores the material ids.
+
+static inline field_dump_t
+dump_voxel( const field_t          * f,
+            const field_material_t * fm,
+            int v ) {
+  field_dump_t d;
+  memcpy( &d, f + v, sizeof(field_t) );
+  d.ematx = fm[v].ematx, d.ematy = fm[v].ematy, d.ematz = fm[v].ematz;
+  d.nmat  = fm[v].nmat;
+  d.fmatx = fm[v].fmatx, d.fmaty = fm[v].fmaty, d.fmatz = fm[v].fmatz;
+  d.cmat  = fm[v].cmat;
+  return d;
+}
+
 int vpic_simulation::dump_mkdir(const char * dname) {
         return FileUtils::makeDirectory(dname);
 } // dump_mkdir
@@ -207,8 +225,10 @@ vpic_simulation::dump_fields( const char *fbase,
   FileIOStatus status = fileIO.open(fname, io_write);
   if( status==fail ) ERROR(( "Could not open \"%s\".", fname ));
 
-  // default is to use VPIC native field data
+  // default is to use VPIC native field data (the material ids always
+  // come from the field array)
   if ( f == NULL ) f = field_array->f;
+  const field_material_t * fm = field_array->fm;
 
   /* IMPORTANT: these values are written in WRITE_HEADER_V0 */
   nxout = grid->nx;
@@ -223,8 +243,14 @@ vpic_simulation::dump_fields( const char *fbase,
   dim[0] = grid->nx+2;
   dim[1] = grid->ny+2;
   dim[2] = grid->nz+2;
-  WRITE_ARRAY_HEADER( f, 3, dim, fileIO );
-  fileIO.write( f, dim[0]*dim[1]*dim[2] );
+  field_dump_t * line;
+  MALLOC( line, dim[0] );
+  WRITE_ARRAY_HEADER( line, 3, dim, fileIO );
+  for( int v=0; v<dim[0]*dim[1]*dim[2]; v+=dim[0] ) {
+    for( int i=0; i<dim[0]; i++ ) line[i] = dump_voxel( f, fm, v+i );
+    fileIO.write( line, dim[0] );
+  }
+  FREE( line );
   if( fileIO.close() ) ERROR(( "File close failed on dump fields." ));
 }
 
@@ -365,7 +391,8 @@ vpic_simulation::dump_fields_hdf5( const char *fbase, int ftag )
             {                                                                                                     \
                 for (size_t k(1); k < grid->nz + 1; k++)                                                          \
                 {                                                                                                 \
-                    temp_buf[temp_buf_index] = FIELD_ARRAY_NAME->fpp(i, j, k).ATTRIBUTE_NAME;                     \
+                    temp_buf[temp_buf_index] = dump_voxel(FIELD_ARRAY_NAME->f, FIELD_ARRAY_NAME->fm,              \
+                                                          VOXEL(i, j, k, grid->nx, grid->ny, grid->nz)).ATTRIBUTE_NAME; \
                     temp_buf_index = temp_buf_index + 1;                                                          \
                 }                                                                                                 \
             }                                                                                                     \
@@ -911,6 +938,8 @@ vpic_simulation::dump_particles_hdf5( const char *sp_name,
     // make a copy of the part of particle data to be dumped
     double ec1 = uptime();
 
+    // The particle dump is written in the AoS layout
+    int sp_layout = set_species_layout(sp, PARTICLE_LAYOUT_AOS);
     int sp_np = sp->np;
     int sp_max_np = sp->max_np;
     particle_t *ALIGNED(128) p_buf = NULL;
@@ -1088,6 +1117,7 @@ _iy -= _iz*int(ny);   /* iy = iy */                         \
     sp->np = sp_np;
     sp->max_np = sp_max_np;
     FREE_ALIGNED(p_buf);
+    set_species_layout(sp, sp_layout);
 
     // Write metadata
     // Note that these are all "local" metadata for each rank. Global metadata
@@ -1226,6 +1256,9 @@ vpic_simulation::dump_particles( const char *sp_name,
   // FIXME: WITH A PIPELINED CENTER_P, PBUF NOMINALLY SHOULD BE QUITE
   // LARGE.
 
+  // The particle dump is written in the AoS layout.
+
+  int sp_layout     = set_species_layout( sp, PARTICLE_LAYOUT_AOS );
   particle_t * sp_p = sp->p;      sp->p      = p_buf;
   int sp_np         = sp->np;     sp->np     = 0;
   int sp_max_np     = sp->max_np; sp->max_np = PBUF_SIZE;
@@ -1238,6 +1271,7 @@ vpic_simulation::dump_particles( const char *sp_name,
   sp->p      = sp_p;
   sp->np     = sp_np;
   sp->max_np = sp_max_np;
+  set_species_layout( sp, sp_layout );
 
   if( fileIO.close() ) ERROR(("File close failed on dump particles!!!"));
 }
@@ -1472,8 +1506,10 @@ vpic_simulation::field_dump( DumpParameters & dumpParams,
   status = fileIO.open(filename, io_write);
   if( status==fail ) ERROR(( "Failed opening file: %s", filename ));
 
-  // default is to write field_array->f
+  // default is to write field_array->f (the material ids always come
+  // from the field array)
   if ( f==NULL ) f = field_array->f;
+  const field_material_t * fm = field_array->fm;
 
   // convenience
   const size_t istride(dumpParams.stride_x);
@@ -1491,7 +1527,7 @@ vpic_simulation::field_dump( DumpParameters & dumpParams,
   int dim[3];
 
   /* define to do C-style indexing */
-# define f(x,y,z) f[ VOXEL(x,y,z, grid->nx,grid->ny,grid->nz) ]
+# define f(x,y,z) dump_voxel( f, fm, VOXEL(x,y,z, grid->nx,grid->ny,grid->nz) )
 
   /* IMPORTANT: these values are written in WRITE_HEADER_V0 */
   nxout = (grid->nx)/istride;
@@ -1527,7 +1563,7 @@ vpic_simulation::field_dump( DumpParameters & dumpParams,
       std::cerr << "nz: " << grid->nz << std::endl;
     }
 
-    WRITE_ARRAY_HEADER(f, 3, dim, fileIO);
+    WRITE_ARRAY_HEADER(((field_dump_t *)NULL), 3, dim, fileIO);
 
     // Create a variable list of field values to output.
     size_t numvars = std::min(dumpParams.output_vars.bitsum(),
@@ -1548,7 +1584,8 @@ vpic_simulation::field_dump( DumpParameters & dumpParams,
       for(size_t k(0); k<nzout+2; k++) {
       for(size_t j(0); j<nyout+2; j++) {
       for(size_t i(0); i<nxout+2; i++) {
-              const uint32_t * fref = reinterpret_cast<uint32_t *>(&f(i,j,k));
+              const field_dump_t d = f(i,j,k);
+              const uint32_t * fref = reinterpret_cast<const uint32_t *>(&d);
               fileIO.write(&fref[varlist[v]], 1);
               if(rank()==VERBOSE_rank) printf("%f ", f(i,j,k).ex);
               if(rank()==VERBOSE_rank) std::cout << "(" << i << " " << j << " " << k << ")" << std::endl;
@@ -1564,7 +1601,8 @@ vpic_simulation::field_dump( DumpParameters & dumpParams,
       for(size_t k(0); k<nzout+2; k++) { const size_t koff = (k == 0) ? 0 : (k == nzout+1) ? grid->nz+1 : k*kstride-1;
       for(size_t j(0); j<nyout+2; j++) { const size_t joff = (j == 0) ? 0 : (j == nyout+1) ? grid->ny+1 : j*jstride-1;
       for(size_t i(0); i<nxout+2; i++) { const size_t ioff = (i == 0) ? 0 : (i == nxout+1) ? grid->nx+1 : i*istride-1;
-              const uint32_t * fref = reinterpret_cast<uint32_t *>(&f(ioff,joff,koff));
+              const field_dump_t d = f(ioff,joff,koff);
+              const uint32_t * fref = reinterpret_cast<const uint32_t *>(&d);
               fileIO.write(&fref[varlist[v]], 1);
               if(rank()==VERBOSE_rank) printf("%f ", f(ioff,joff,koff).ex);
               if(rank()==VERBOSE_rank) std::cout << "(" << ioff << " " << joff << " " << koff << ")" << std::endl;
@@ -1587,13 +1625,19 @@ vpic_simulation::field_dump( DumpParameters & dumpParams,
     dim[1] = nyout+2;
     dim[2] = nzout+2;
 
-    WRITE_ARRAY_HEADER(f, 3, dim, fileIO);
+    WRITE_ARRAY_HEADER(((field_dump_t *)NULL), 3, dim, fileIO);
 
     if ( istride == 1 &&
 	 jstride == 1 &&
 	 kstride == 1 )
     {
-      fileIO.write( f, dim[0] * dim[1] * dim[2] );
+      field_dump_t * line;
+      MALLOC( line, dim[0] );
+      for( int v=0; v<dim[0]*dim[1]*dim[2]; v+=dim[0] ) {
+        for( int i=0; i<dim[0]; i++ ) line[i] = dump_voxel( f, fm, v+i );
+        fileIO.write( line, dim[0] );
+      }
+      FREE( line );
     }
 
     else
@@ -1601,7 +1645,8 @@ vpic_simulation::field_dump( DumpParameters & dumpParams,
       for(size_t k(0); k<nzout+2; k++) { const size_t koff = (k == 0) ? 0 : (k == nzout+1) ? grid->nz+1 : k*kstride-1;
       for(size_t j(0); j<nyout+2; j++) { const size_t joff = (j == 0) ? 0 : (j == nyout+1) ? grid->ny+1 : j*jstride-1;
       for(size_t i(0); i<nxout+2; i++) { const size_t ioff = (i == 0) ? 0 : (i == nxout+1) ? grid->nx+1 : i*istride-1;
-            fileIO.write( &f( ioff, joff, koff ), 1 );
+            const field_dump_t d = f( ioff, joff, koff );
+            fileIO.write( &d, 1 );
       }
       }
       }
@@ -3,7 +3,8 @@
 
 void
 vpic_simulation::initialize( int argc,
-                             char **argv ) {
+                             char **argv,
+                             const char *remap_fbase ) {
   double err;
   species_t * sp;
 
@@ -11,6 +12,24 @@ vpic_simulation::initialize( int argc,
 
   TIC user_initialization( argc, argv ); TOC( user_initialization, 1 );
 
+  // Now that the grid and its boundary conditions are set up, find the
+  // neighboring domains particles can migrate to directly
+
+  setup_particle_migration( grid );
+  if( neighbor_collectives ) setup_neighbor_collectives( grid );
+  if( shared_memory_comm   ) setup_shared_memory_comm( grid );
+
+  // A remapped run continues from the fields and particles of the dump.
+  // These are already synchronized, cleaned and uncentered and the user
+  // diagnostics already ran on the dumped step.
+
+  if( remap_fbase ) {
+    remap( remap_fbase );
+    if( rank()==0 ) MESSAGE(( "Initialization complete" ));
+    update_profile( rank()==0 );
+    return;
+  }
+
   // Do some consistency checks on user initialized fields
 
   if( rank()==0 ) MESSAGE(( "Checking interdomain synchronization" ));
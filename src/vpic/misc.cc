@@ -71,7 +71,7 @@ vpic_simulation::inject_particle( species_t * sp,
   if( iz==nz ) iz = nz-1;             // On far wall ... conditional move
   iz++;                               // Adjust for mesh indexing
 
-  particle_t * p = sp->p + (sp->np++);
+  DECLARE_ALIGNED_ARRAY( particle_t, 32, p, 1 );
   p->dx = (float)x; // Note: Might be rounded to be on [-1,1]
   p->dy = (float)y; // Note: Might be rounded to be on [-1,1]
   p->dz = (float)z; // Note: Might be rounded to be on [-1,1]
@@ -80,6 +80,7 @@ vpic_simulation::inject_particle( species_t * sp,
   p->uy = (float)uy;
   p->uz = (float)uz;
   p->w  = w;
+  store_particle( sp->p, sp->layout, sp->np++, p );
 
   if( update_rhob ) accumulate_rhob( field_array->f, p, grid, -sp->q );
 
@@ -92,7 +93,9 @@ vpic_simulation::inject_particle( species_t * sp,
     pm->dispy = uy*age*grid->rdy;
     pm->dispz = uz*age*grid->rdz;
     pm->i     = sp->np-1;
-    sp->nm += move_p( sp->p, pm, accumulator_array->a, grid, sp->q );
+    sp->nm += sp->layout==PARTICLE_LAYOUT_AOSOA ?
+      move_p_aosoa( sp->p, pm, accumulator_array->a, grid, sp->q ) :
+      move_p      ( sp->p, pm, accumulator_array->a, grid, sp->q );
   }
 }
 
@@ -230,7 +233,10 @@ void vpic_simulation::checksum_species(const char * species, CheckSum & cs) {
     ERROR(("Invalid species name \"%s\".", species));
   } // if
 
+  // Checksum the AoS image of the particles regardless of storage layout
+  int layout = set_species_layout(sp, PARTICLE_LAYOUT_AOS);
   checkSumBuffer<particle_t>(sp->p, sp->np, cs, "sha1");
+  set_species_layout(sp, layout);
 
   if(nproc() > 1) {
     const unsigned int csels = cs.length*nproc();
@@ -258,7 +264,10 @@ void vpic_simulation::output_checksum_species(const char * species) {
   } // if
 
   CheckSum cs;
+  // Checksum the AoS image of the particles regardless of storage layout
+  int layout = set_species_layout(sp, PARTICLE_LAYOUT_AOS);
   checkSumBuffer<particle_t>(sp->p, sp->np, cs, "sha1");
+  set_species_layout(sp, layout);
 
   if(nproc() > 1) {
     const unsigned int csels = cs.length*nproc();
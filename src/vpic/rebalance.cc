@@ -0,0 +1,788 @@
+#include "vpic.h"
+
+// Dynamic load balancing.  The global box stays cut at voxel planes along
+// each axis (see repartition_box) so every domain keeps a single face
+// neighbor per face, but the planes are moved so each slab of domains
+// gets about the same share of the work.  Along an axis, the work of a
+// voxel plane is summed over the whole plane; cutting all the axes this
+// way balances separable loads exactly and others approximately.
+
+// In the global voxel indexing used below, the voxels of the box are
+// 1:gn along an axis and 0 and gn+1 are the ghost planes of the box.
+// The domain p of the cuts c holds the global voxels c[p]+1:c[p+1] at the
+// local indices 1:c[p+1]-c[p].  The box ghost planes belong to the end
+// domains.
+
+static inline void
+owned_range( const int * c,
+             int np,
+             int p,
+             int * lo,
+             int * hi ) {
+  *lo = p==0    ? 0        : c[p]+1;
+  *hi = p==np-1 ? c[p+1]+1 : c[p+1];
+}
+
+static inline int
+owner( const int * c,
+       int np,
+       int v ) {
+  int lo = 0, hi = np-1, m;
+  while( lo<hi ) {
+    m = ( lo + hi + 1 ) >> 1;
+    if( c[m]<v ) lo = m;
+    else         hi = m-1;
+  }
+  return lo;
+}
+
+typedef struct box {
+  int lo[3], hi[3];
+} box_t;
+
+typedef struct cuts {
+  const int * c[3]; // Cuts along each axis
+  int np[3];        // Number of domains along each axis
+} cuts_t;
+
+static void
+set_cuts( int gpx,
+          int gpy,
+          int gpz,
+          const int * cut,
+          cuts_t * c ) {
+  c->np[0] = gpx; c->c[0] = cut;
+  c->np[1] = gpy; c->c[1] = cut + gpx + 1;
+  c->np[2] = gpz; c->c[2] = cut + gpx + gpy + 2;
+}
+
+static void
+set_cuts( const grid_t * g,
+          const int * cut,
+          cuts_t * c ) {
+  set_cuts( g->gpx, g->gpy, g->gpz, cut, c );
+}
+
+static void
+rank_to_index( const cuts_t * c,
+               int rank,
+               int * p ) {
+  p[0] = rank % c->np[0]; rank /= c->np[0];
+  p[1] = rank % c->np[1]; rank /= c->np[1];
+  p[2] = rank;
+}
+
+// Voxels (ghosts included) domain src holds with the cuts oc that the
+// domain dst needs (ghosts included) with the cuts nc.  Returns the
+// number of voxels in the intersection b.
+
+static int64_t
+field_box( const cuts_t * oc,
+           const cuts_t * nc,
+           int src,
+           int dst,
+           box_t * b ) {
+  int ps[3], pd[3], a, lo, hi;
+  int64_t n = 1;
+
+  rank_to_index( oc, src, ps );
+  rank_to_index( nc, dst, pd );
+
+  for( a=0; a<3; a++ ) {
+    owned_range( oc->c[a], oc->np[a], ps[a], &lo, &hi );
+    b->lo[a] = lo > nc->c[a][pd[a]]     ? lo : nc->c[a][pd[a]];
+    b->hi[a] = hi < nc->c[a][pd[a]+1]+1 ? hi : nc->c[a][pd[a]+1]+1;
+    if( b->lo[a]>b->hi[a] ) return 0;
+    n *= b->hi[a] - b->lo[a] + 1;
+  }
+
+  return n;
+}
+
+// Copy the voxels of box b between the domain local field data f/fm
+// (whose global voxel 0 is at cuts base) and the packed buffer buf.
+
+static char *
+copy_field_box( const box_t * b,
+                const int * base,
+                const grid_t * g,
+                field_t * f,
+                field_material_t * fm,
+                char * buf,
+                int pack ) {
+  const int nx = b->hi[0] - b->lo[0] + 1;
+  for( int z=b->lo[2]; z<=b->hi[2]; z++ )
+    for( int y=b->lo[1]; y<=b->hi[1]; y++ ) {
+      int v = ( b->lo[0] - base[0] ) + g->sy*( y - base[1] ) +
+                                       g->sz*( z - base[2] );
+      if( pack ) {
+        memcpy( buf, f  + v, nx*sizeof(field_t)          ); buf += nx*sizeof(field_t);
+        memcpy( buf, fm + v, nx*sizeof(field_material_t) ); buf += nx*sizeof(field_material_t);
+      } else {
+        memcpy( f  + v, buf, nx*sizeof(field_t)          ); buf += nx*sizeof(field_t);
+        memcpy( fm + v, buf, nx*sizeof(field_material_t) ); buf += nx*sizeof(field_material_t);
+      }
+    }
+  return buf;
+}
+
+void
+vpic_simulation::balance_grid( double (*density)( double x,
+                                                  double y,
+                                                  double z,
+                                                  void * params ),
+                               void * params ) {
+  const int gnx = grid->gnx, gny = grid->gny, gnz = grid->gnz;
+  const int gn  = gnx + gny + gnz;
+  double * load, * sum;
+  int * cut;
+  cuts_t c;
+  int p[3];
+
+  if( !density ) ERROR(( "Bad args" ));
+  if( !grid->cut )
+    ERROR(( "Define your grid with a define_*_grid helper before "
+            "balancing it" ));
+  if( field_array || species_list )
+    ERROR(( "Balance your grid before defining the field array and "
+            "species" ));
+
+  set_cuts( grid, grid->cut, &c );
+  rank_to_index( &c, world_rank, p );
+
+  MALLOC( load, gn );
+  MALLOC( sum,  gn );
+  MALLOC( cut,  grid->gpx + grid->gpy + grid->gpz + 3 );
+  CLEAR( load, gn );
+
+  // Estimate the work of the global voxel planes from the density at the
+  // local voxel centers
+
+  for( int z=1; z<=grid->nz; z++ )
+    for( int y=1; y<=grid->ny; y++ )
+      for( int x=1; x<=grid->nx; x++ ) {
+        double w = density( grid->x0 + ( x - 0.5 )*grid->dx,
+                            grid->y0 + ( y - 0.5 )*grid->dy,
+                            grid->z0 + ( z - 0.5 )*grid->dz, params );
+        load[             c.c[0][p[0]] + x - 1 ] += w;
+        load[ gnx       + c.c[1][p[1]] + y - 1 ] += w;
+        load[ gnx + gny + c.c[2][p[2]] + z - 1 ] += w;
+      }
+
+  mp_allsum_d( load, sum, gn );
+
+  balance_cuts( sum,           gnx, grid->gpx, cut                               );
+  balance_cuts( sum + gnx,     gny, grid->gpy, cut + grid->gpx + 1               );
+  balance_cuts( sum + gnx+gny, gnz, grid->gpz, cut + grid->gpx + grid->gpy + 2   );
+
+  repartition_box( grid, cut );
+
+  FREE( cut );
+  FREE( sum );
+  FREE( load );
+}
+
+void
+vpic_simulation::rebalance( void ) {
+  const size_t field_size = sizeof(field_t) + sizeof(field_material_t);
+  grid_t * g = grid;
+  species_t * sp, ** sp_id;
+  cuts_t oc, nc;
+  box_t b;
+  int * cut, * ncut, * dest, * count, * pd;
+  int n_sp, n_cut, gn, x, y, z, r, s, base[3];
+  int64_t n, * scount, * rcount;
+  char * sbuf, * rbuf, * buf, * next, ** sp_buf;
+  double t[3], ts[3], tp, tv, * load, * sum;
+  float damp;
+
+  if( !g->cut )
+    ERROR(( "Only grids made by a define_*_grid helper can be rebalanced" ));
+  if( emitter_list )
+    ERROR(( "Simulations with emitters cannot be rebalanced" ));
+  damp = standard_field_array_damp( field_array );
+  if( damp<0 )
+    ERROR(( "Simulations with custom field arrays cannot be rebalanced" ));
+
+  // Subcycled species are only rebalanced when their field average
+  // restarts.  The rebalance is skipped otherwise (on all nodes).
+
+  LIST_FOR_EACH( sp, species_list ) if( sp->subcycle_phase ) return;
+
+  // Model the work of a voxel as the measured particle push time of the
+  // particles in it plus an even share of the measured field advance
+  // time.  Voxels weigh the same if nothing was measured yet.
+
+  t[0] = advance_p_time;
+  t[1] = field_time;
+  t[2] = 0;
+  LIST_FOR_EACH( sp, species_list ) t[2] += sp->np;
+  mp_allsum_d( t, ts, 3 );
+  tp = ts[2]>0 ? ts[0]/ts[2] : 0;
+  tv = ts[1]/( (double)g->gnx*(double)g->gny*(double)g->gnz );
+  if( tp<=0 && tv<=0 ) tv = 1;
+
+  advance_p_time = 0;
+  field_time     = 0;
+
+  std::vector<int> layout( num_species( species_list ) );
+  set_species_list_layout( species_list, PARTICLE_LAYOUT_AOS, layout.data() );
+
+  n_sp  = num_species( species_list );
+  n_cut = g->gpx + g->gpy + g->gpz + 3;
+  gn    = g->gnx + g->gny + g->gnz;
+
+  MALLOC( cut,  n_cut );
+  MALLOC( ncut, n_cut );
+  COPY( cut, g->cut, n_cut );
+  set_cuts( g, cut, &oc );
+  rank_to_index( &oc, world_rank, base );
+  for( int a=0; a<3; a++ ) base[a] = oc.c[a][base[a]];
+
+  // Sum the work of the global voxel planes and find the new cuts
+
+  MALLOC( count, g->nv );
+  CLEAR( count, g->nv );
+  LIST_FOR_EACH( sp, species_list )
+    for( int i=0; i<sp->np; i++ ) count[ sp->p[i].i ]++;
+
+  MALLOC( load, gn );
+  MALLOC( sum,  gn );
+  CLEAR( load, gn );
+  for( z=1; z<=g->nz; z++ )
+    for( y=1; y<=g->ny; y++ )
+      for( x=1; x<=g->nx; x++ ) {
+        double w = tp*count[ VOXEL(x,y,z, g->nx,g->ny,g->nz) ] + tv;
+        load[                   base[0] + x - 1 ] += w;
+        load[ g->gnx          + base[1] + y - 1 ] += w;
+        load[ g->gnx + g->gny + base[2] + z - 1 ] += w;
+      }
+  mp_allsum_d( load, sum, gn );
+
+  balance_cuts( sum,                 g->gnx, g->gpx, ncut                     );
+  balance_cuts( sum + g->gnx,        g->gny, g->gpy, ncut + g->gpx + 1        );
+  balance_cuts( sum + g->gnx+g->gny, g->gnz, g->gpz, ncut + g->gpx+g->gpy + 2 );
+
+  FREE( sum );
+  FREE( load );
+  FREE( count );
+
+  if( !memcmp( cut, ncut, n_cut*sizeof(int) ) ) {
+    restore_species_list_layout( species_list, layout.data() );
+    FREE( ncut );
+    FREE( cut );
+    return;
+  }
+
+  if( rank()==0 ) MESSAGE(( "Rebalancing domains" ));
+
+  set_cuts( g, ncut, &nc );
+
+  // Find where each particle goes.  dest holds the destination and the
+  // new local voxel of the particles of each species in turn.  The
+  // particles that stay on this node are not sent.
+
+  n = 0;
+  LIST_FOR_EACH( sp, species_list ) n += sp->np;
+  MALLOC( dest,   2*n+1 );
+  MALLOC( count,  world_size*n_sp );
+  MALLOC( scount, world_size );
+  MALLOC( rcount, world_size );
+  CLEAR( count, world_size*n_sp );
+
+  pd = dest;
+  LIST_FOR_EACH( sp, species_list )
+    for( int i=0; i<sp->np; i++, pd+=2 ) {
+      int v = sp->p[i].i, l[3], q[3];
+      l[0] = v % g->sy;
+      l[1] = ( v / g->sy ) % ( g->ny + 2 );
+      l[2] = v / g->sz;
+      for( int a=0; a<3; a++ ) {
+        int G = base[a] + l[a];
+        q[a] = owner( nc.c[a], nc.np[a], G );
+        l[a] = G - nc.c[a][q[a]];
+      }
+      pd[0] = q[0] + nc.np[0]*( q[1] + nc.np[1]*q[2] );
+      pd[1] = l[0] + ( nc.c[0][q[0]+1] - nc.c[0][q[0]] + 2 )*
+                   ( l[1] + ( nc.c[1][q[1]+1] - nc.c[1][q[1]] + 2 )*l[2] );
+      if( pd[0]!=world_rank ) count[ pd[0]*n_sp + sp->id ]++;
+    }
+
+  // Size and pack the messages.  The message to a node holds the field
+  // data it needs from this node, then the number of particles of each
+  // species sent to it and then the particles of each species in turn.
+
+  n = 0;
+  for( r=0; r<world_size; r++ ) {
+    int64_t m = field_box( &oc, &nc, world_rank, r, &b )*field_size +
+                n_sp*sizeof(int);
+    for( s=0; s<n_sp; s++ )
+      m += count[ r*n_sp + s ]*(int64_t)sizeof(particle_t);
+    scount[r] = m;
+    n += m;
+  }
+  mp_alltoall_i64( scount, rcount, 1 );
+
+  MALLOC( sbuf, n+1 );
+  MALLOC( sp_buf, world_size*n_sp );
+
+  buf = sbuf;
+  for( r=0; r<world_size; r++ ) {
+    next = buf + scount[r];
+    if( field_box( &oc, &nc, world_rank, r, &b ) )
+      buf = copy_field_box( &b, base, g, field_array->f, field_array->fm,
+                            buf, 1 );
+    memcpy( buf, count + r*n_sp, n_sp*sizeof(int) );
+    buf += n_sp*sizeof(int);
+    for( s=0; s<n_sp; s++ ) {
+      sp_buf[ r*n_sp + s ] = buf;
+      buf += count[ r*n_sp + s ]*sizeof(particle_t);
+    }
+    buf = next;
+  }
+
+  // The particles that stay are moved to the front of their array
+  // instead, in the same order.
+
+  pd = dest;
+  LIST_FOR_EACH( sp, species_list ) {
+    int np = 0;
+    for( int i=0; i<sp->np; i++, pd+=2 ) {
+      particle_t p = sp->p[i];
+      p.i = pd[1];
+      if( pd[0]==world_rank ) {
+        sp->p[ np++ ] = p;
+        continue;
+      }
+      memcpy( sp_buf[ pd[0]*n_sp + sp->id ], &p, sizeof(particle_t) );
+      sp_buf[ pd[0]*n_sp + sp->id ] += sizeof(particle_t);
+    }
+    sp->np = np;
+  }
+
+  n = 0;
+  for( r=0; r<world_size; r++ ) n += rcount[r];
+  MALLOC( rbuf, n+1 );
+
+  mp_alltoallv_c( sbuf, scount, rbuf, rcount );
+
+  FREE( sp_buf );
+  FREE( sbuf );
+  FREE( dest );
+
+  // Cut the box again and make the arrays for the new local domain
+
+  delete_hydro_array( hydro_array );
+  delete_accumulator_array( accumulator_array );
+  delete_interpolator_array( interpolator_array );
+  delete_field_array( field_array );
+
+  repartition_box( g, ncut );
+
+  field_array        = new_standard_field_array( g, material_list, damp );
+  interpolator_array = new_interpolator_array( g );
+  accumulator_array  = new_accumulator_array( g );
+  hydro_array        = new_hydro_array( g );
+
+  rank_to_index( &nc, world_rank, base );
+  for( int a=0; a<3; a++ ) base[a] = nc.c[a][base[a]];
+
+  // Make room for the incoming particles after the ones that stayed
+
+  CLEAR( count, n_sp );
+  buf = rbuf;
+  for( r=0; r<world_size; r++ ) {
+    const char * hdr = buf + field_box( &oc, &nc, r, world_rank, &b )*field_size;
+    for( s=0; s<n_sp; s++ ) {
+      int m;
+      memcpy( &m, hdr + s*sizeof(int), sizeof(int) );
+      count[s] += m;
+    }
+    buf += rcount[r];
+  }
+
+  MALLOC( sp_id, n_sp );
+  LIST_FOR_EACH( sp, species_list ) {
+    sp_id[ sp->id ] = sp;
+
+    FREE_ALIGNED( sp->partition );
+    MALLOC_ALIGNED( sp->partition, g->nv+1, 128 );
+    if( sp->subcycle_ia ) {
+      delete_interpolator_array( sp->subcycle_ia );
+      sp->subcycle_ia = new_interpolator_array( g );
+    }
+
+    n = sp->np + count[ sp->id ];
+    if( n>sp->max_np ) {
+      particle_t * p;
+      sp->max_np = n + n/4;
+      MALLOC_ALIGNED( p, sp->max_np, 128 );
+      COPY( p, sp->p, sp->np );
+      FREE_ALIGNED( sp->p );
+      sp->p = p;
+    }
+    sp->last_sorted = INT64_MIN;
+  }
+
+  // Unpack the messages
+
+  buf = rbuf;
+  for( r=0; r<world_size; r++ ) {
+    next = buf + rcount[r];
+    if( field_box( &oc, &nc, r, world_rank, &b ) )
+      buf = copy_field_box( &b, base, g, field_array->f, field_array->fm,
+                            buf, 0 );
+    memcpy( count, buf, n_sp*sizeof(int) );
+    buf += n_sp*sizeof(int);
+    for( s=0; s<n_sp; s++ ) {
+      sp = sp_id[s];
+      memcpy( sp->p + sp->np, buf, count[s]*sizeof(particle_t) );
+      sp->np += count[s];
+      buf    += count[s]*sizeof(particle_t);
+    }
+    buf = next;
+  }
+
+  FREE( sp_id );
+  FREE( rbuf );
+  FREE( rcount );
+  FREE( scount );
+  FREE( count );
+  FREE( ncut );
+  FREE( cut );
+
+  // Find the new neighbors and get the new domain ready to advance
+
+  setup_particle_migration( g );
+  if( neighbor_collectives ) setup_neighbor_collectives( g );
+  if( shared_memory_comm   ) setup_shared_memory_comm( g );
+
+  if( species_list ) load_interpolator_array( interpolator_array, field_array );
+  LIST_FOR_EACH( sp, species_list ) sort_p( sp );
+
+  restore_species_list_layout( species_list, layout.data() );
+}
+
+// Restarting on a different decomposition.  A checkpt holds the raw
+// objects of a node (pointers, domain sized arrays, neighbor ranks) and
+// can only be restored onto the decomposition it was made on.  A remap
+// dump holds just the state that has to move: the fields of the voxels a
+// domain owns (box ghost planes included), its particles and the cuts it
+// was made with.  A run started with "--remap fbase" initializes the deck
+// on whatever decomposition the deck now asks for and then takes the
+// fields and particles of its new domain from the dump files of the old
+// domains it overlaps.  checkpt writes a remap dump next to each checkpt
+// it can (see deck/main.cc).  The rest of the state is not carried over
+// (see remap).
+
+enum remap_enums {
+  REMAP_MAGIC   = 0x52454d50, // "REMP"
+  REMAP_VERSION = 0,
+  REMAP_BUFFER  = 32768       // Particles read at a time
+};
+
+typedef struct remap_header {
+  int magic, version;       // REMAP_MAGIC, REMAP_VERSION
+  int nproc, rank;          // Node count and rank of the dumping node
+  int gpx, gpy, gpz;        // Old decomposition (the cuts follow)
+  int gnx, gny, gnz;        // Global voxel mesh resolution
+  int n_sp;                 // Number of species dumped
+  int pad;
+  int64_t step;             // Step the dump was made on
+  double gx0, gy0, gz0;     // Global box
+  double gx1, gy1, gz1;
+} remap_header_t;
+
+void
+vpic_simulation::checkpt_remap( const char * fbase ) {
+  species_t * sp;
+  int ok = grid->cut!=NULL;
+  LIST_FOR_EACH( sp, species_list ) if( sp->subcycle_phase ) ok = 0;
+  if( ok ) dump_remap( fbase, 0 );
+  else if( rank()==0 )
+    MESSAGE(( "No remap dump \"%s\" (the run cannot be remapped on this "
+              "step, see dump_remap)", fbase ));
+}
+
+void
+vpic_simulation::dump_remap( const char * fbase,
+                             int ftag ) {
+  const size_t field_size = sizeof(field_t) + sizeof(field_material_t);
+  grid_t * g = grid;
+  remap_header_t h[1];
+  species_t * sp;
+  cuts_t c;
+  box_t b;
+  char fname[256], * buf;
+  FileIO fileIO;
+  int base[3], len;
+  int64_t n = 1;
+
+  if( !fbase ) ERROR(( "Invalid filename" ));
+  if( !g->cut )
+    ERROR(( "Only grids made by a define_*_grid helper can be remapped" ));
+  LIST_FOR_EACH( sp, species_list )
+    if( sp->subcycle_phase )
+      ERROR(( "Remap dumps can only be made on steps where the subcycled "
+              "species restart their field average" ));
+
+  if( rank()==0 ) MESSAGE(( "Dumping remap state to \"%s\"", fbase ));
+
+  if( ftag ) sprintf( fname, "%s.%li.%i", fbase, (long)step(), rank() );
+  else       sprintf( fname, "%s.%i", fbase, rank() );
+  FileIOStatus status = fileIO.open( fname, io_write );
+  if( status==fail ) ERROR(( "Could not open \"%s\"", fname ));
+
+  CLEAR( h, 1 );
+  h->magic   = REMAP_MAGIC;
+  h->version = REMAP_VERSION;
+  h->nproc   = world_size;
+  h->rank    = world_rank;
+  h->gpx = g->gpx; h->gpy = g->gpy; h->gpz = g->gpz;
+  h->gnx = g->gnx; h->gny = g->gny; h->gnz = g->gnz;
+  h->n_sp    = num_species( species_list );
+  h->step    = step();
+  h->gx0 = g->gx0; h->gy0 = g->gy0; h->gz0 = g->gz0;
+  h->gx1 = g->gx1; h->gy1 = g->gy1; h->gz1 = g->gz1;
+  fileIO.write( h, 1 );
+  fileIO.write( g->cut, g->gpx + g->gpy + g->gpz + 3 );
+
+  // The fields of the voxels this domain owns
+
+  set_cuts( g, g->cut, &c );
+  rank_to_index( &c, world_rank, base );
+  for( int a=0; a<3; a++ ) {
+    owned_range( c.c[a], c.np[a], base[a], &b.lo[a], &b.hi[a] );
+    base[a] = c.c[a][base[a]];
+    n *= b.hi[a] - b.lo[a] + 1;
+  }
+  MALLOC( buf, n*field_size );
+  copy_field_box( &b, base, g, field_array->f, field_array->fm, buf, 1 );
+  fileIO.write( buf, n*field_size );
+  FREE( buf );
+
+  // The particles of each species (in the AoS layout and with their
+  // voxel local to this domain)
+
+  LIST_FOR_EACH( sp, species_list ) {
+    int layout = set_species_layout( sp, PARTICLE_LAYOUT_AOS );
+    int64_t np = sp->np;
+    len = strlen( sp->name ) + 1;
+    fileIO.write( &len, 1 );
+    fileIO.write( sp->name, len );
+    fileIO.write( &np, 1 );
+    fileIO.write( sp->p, sp->np );
+    set_species_layout( sp, layout );
+  }
+
+  if( fileIO.close() ) ERROR(( "File close failed on dump remap!!!" ));
+}
+
+static void
+read_remap( FileIO & fileIO,
+            void * data,
+            size_t sz,
+            const char * fname ) {
+  if( fileIO.read( (char *)data, sz )!=sz )
+    ERROR(( "Read past the end of \"%s\"", fname ));
+}
+
+static void
+open_remap( FileIO & fileIO,
+            const char * fbase,
+            int rank,
+            remap_header_t * h,
+            char * fname ) {
+  sprintf( fname, "%s.%i", fbase, rank );
+  if( fileIO.open( fname, io_read )==fail )
+    ERROR(( "Could not open \"%s\"", fname ));
+  read_remap( fileIO, h, sizeof(*h), fname );
+  if( h->magic!=REMAP_MAGIC || h->version!=REMAP_VERSION || h->rank!=rank )
+    ERROR(( "\"%s\" is not a remap dump of rank %i", fname, rank ));
+}
+
+static void
+append_particle( species_t * sp,
+                 const particle_t * p ) {
+  if( sp->np==sp->max_np ) {
+    particle_t * ALIGNED(128) np;
+    sp->max_np += sp->max_np/4 + PARTICLE_BLOCK;
+    MALLOC_ALIGNED( np, sp->max_np, 128 );
+    COPY( np, sp->p, sp->np );
+    FREE_ALIGNED( sp->p );
+    sp->p = np;
+  }
+  sp->p[ sp->np++ ] = *p;
+}
+
+void
+vpic_simulation::remap( const char * fbase ) {
+  const size_t field_size = sizeof(field_t) + sizeof(field_material_t);
+  grid_t * g = grid;
+  remap_header_t h[1], hs[1];
+  species_t * sp;
+  particle_t * pbuf;
+  cuts_t oc, nc;
+  box_t b, bs;
+  char fname[256], name[256], * buf;
+  FileIO fileIO;
+  int * cut, n_cut, base[3], pd[3], ps[3], sbase[3], sn[3], len;
+  int64_t n, np;
+
+  if( !fbase ) ERROR(( "Invalid filename" ));
+  if( !g->cut )
+    ERROR(( "Only grids made by a define_*_grid helper can be remapped" ));
+  if( !field_array ) ERROR(( "Define the field array before remapping" ));
+
+  if( rank()==0 ) MESSAGE(( "Remapping from \"%s\"", fbase ));
+
+  // Only the fields, the particles and the step are carried over.  The
+  // rest is as the deck initialization left it.
+
+  if( rank()==0 ) {
+    MESSAGE(( "The user globals are as the deck initialization set them" ));
+    if( collision_op_list )
+      WARNING(( "The collision operators are not remapped (their random "
+                "number generators are reseeded)" ));
+    if( particle_bc_list )
+      WARNING(( "The particle boundary conditions are not remapped (their "
+                "random number generators are reseeded, tallies restart)" ));
+    if( emitter_list )
+      WARNING(( "The emitters are not remapped (they restart from the state "
+                "the deck initialization gave them)" ));
+  }
+
+  // Every dump file starts with the old decomposition
+
+  open_remap( fileIO, fbase, 0, h, fname );
+  if( h->gnx!=g->gnx || h->gny!=g->gny || h->gnz!=g->gnz ||
+      fabs( h->gx0-g->gx0 ) + fabs( h->gx1-g->gx1 ) > 1e-6*( g->gx1-g->gx0 ) ||
+      fabs( h->gy0-g->gy0 ) + fabs( h->gy1-g->gy1 ) > 1e-6*( g->gy1-g->gy0 ) ||
+      fabs( h->gz0-g->gz0 ) + fabs( h->gz1-g->gz1 ) > 1e-6*( g->gz1-g->gz0 ) )
+    ERROR(( "\"%s\" was dumped from a different global grid", fname ));
+  if( h->n_sp!=num_species( species_list ) )
+    ERROR(( "\"%s\" holds %i species (the deck defines %i)",
+            fname, h->n_sp, num_species( species_list ) ));
+  n_cut = h->gpx + h->gpy + h->gpz + 3;
+  MALLOC( cut, n_cut );
+  read_remap( fileIO, cut, n_cut*sizeof(int), fname );
+  if( fileIO.close() ) ERROR(( "File close failed on remap!!!" ));
+
+  if( rank()==0 )
+    MESSAGE(( "Remapping step %li from %i (%ix%ix%i) to %i (%ix%ix%i) domains",
+              (long)h->step, h->nproc, h->gpx, h->gpy, h->gpz,
+              world_size, g->gpx, g->gpy, g->gpz ));
+
+  set_cuts( h->gpx, h->gpy, h->gpz, cut, &oc );
+  set_cuts( g, g->cut, &nc );
+  rank_to_index( &nc, world_rank, pd );
+  for( int a=0; a<3; a++ ) base[a] = nc.c[a][pd[a]];
+
+  // Drop what the deck loaded
+
+  std::vector<int> layout( num_species( species_list ) );
+  set_species_list_layout( species_list, PARTICLE_LAYOUT_AOS, layout.data() );
+  LIST_FOR_EACH( sp, species_list ) {
+    sp->np          = 0;
+    sp->last_sorted = INT64_MIN;
+  }
+
+  MALLOC_ALIGNED( pbuf, REMAP_BUFFER, 128 );
+
+  // Read the old domains that overlap this domain (the particles of a
+  // domain are in the voxels it owns so these hold all the particles
+  // this domain gets too)
+
+  for( int src=0; src<h->nproc; src++ ) {
+    if( !field_box( &oc, &nc, src, world_rank, &b ) ) continue;
+
+    open_remap( fileIO, fbase, src, hs, fname );
+    if( hs->step!=h->step || hs->nproc!=h->nproc )
+      ERROR(( "\"%s\" is from a different dump", fname ));
+    std::vector<int> scut( n_cut );
+    read_remap( fileIO, scut.data(), n_cut*sizeof(int), fname );
+    if( memcmp( scut.data(), cut, n_cut*sizeof(int) ) )
+      ERROR(( "\"%s\" is from a different dump", fname ));
+
+    n = 1;
+    rank_to_index( &oc, src, ps );
+    for( int a=0; a<3; a++ ) {
+      owned_range( oc.c[a], oc.np[a], ps[a], &bs.lo[a], &bs.hi[a] );
+      sbase[a] = oc.c[a][ps[a]];
+      sn[a]    = oc.c[a][ps[a]+1] - sbase[a];
+      n *= bs.hi[a] - bs.lo[a] + 1;
+    }
+
+    // Copy the voxels of the old domain this domain needs.  The dump
+    // holds the old domain's voxels a row at a time, the fields of the
+    // row and then their materials.
+
+    MALLOC( buf, n*field_size );
+    read_remap( fileIO, buf, n*field_size, fname );
+    const int snx = bs.hi[0] - bs.lo[0] + 1, nx = b.hi[0] - b.lo[0] + 1;
+    for( int z=b.lo[2]; z<=b.hi[2]; z++ )
+      for( int y=b.lo[1]; y<=b.hi[1]; y++ ) {
+        const char * row = buf + ( ( z - bs.lo[2] )*( bs.hi[1] - bs.lo[1] + 1 ) +
+                                   ( y - bs.lo[1] ) )*snx*field_size;
+        int v = ( b.lo[0] - base[0] ) + g->sy*( y - base[1] ) +
+                                        g->sz*( z - base[2] );
+        memcpy( field_array->f + v,
+                row + ( b.lo[0] - bs.lo[0] )*sizeof(field_t),
+                nx*sizeof(field_t) );
+        memcpy( field_array->fm + v,
+                row + snx*sizeof(field_t) +
+                      ( b.lo[0] - bs.lo[0] )*sizeof(field_material_t),
+                nx*sizeof(field_material_t) );
+      }
+    FREE( buf );
+
+    // Keep the particles in the voxels this domain owns
+
+    for( int s=0; s<h->n_sp; s++ ) {
+      read_remap( fileIO, &len, sizeof(int), fname );
+      if( len<1 || len>(int)sizeof(name) )
+        ERROR(( "\"%s\" is corrupt", fname ));
+      read_remap( fileIO, name, len, fname );
+      name[len-1] = '\0';
+      sp = find_species_name( name, species_list );
+      if( !sp ) ERROR(( "The deck does not define the species \"%s\"", name ));
+      read_remap( fileIO, &np, sizeof(int64_t), fname );
+
+      for( int64_t i0=0; i0<np; i0+=REMAP_BUFFER ) {
+        int m = np-i0 < REMAP_BUFFER ? (int)( np-i0 ) : REMAP_BUFFER;
+        read_remap( fileIO, pbuf, m*sizeof(particle_t), fname );
+        for( int i=0; i<m; i++ ) {
+          int v = pbuf[i].i, l[3], a;
+          l[0] = v % ( sn[0] + 2 );
+          l[1] = ( v / ( sn[0] + 2 ) ) % ( sn[1] + 2 );
+          l[2] = v / ( ( sn[0] + 2 )*( sn[1] + 2 ) );
+          for( a=0; a<3; a++ ) {
+            l[a] += sbase[a]; // Global voxel
+            if( l[a]<=nc.c[a][pd[a]] || l[a]>nc.c[a][pd[a]+1] ) break;
+            l[a] -= base[a];
+          }
+          if( a<3 ) continue;
+          pbuf[i].i = VOXEL( l[0],l[1],l[2], g->nx,g->ny,g->nz );
+          append_particle( sp, pbuf + i );
+        }
+      }
+    }
+
+    if( fileIO.close() ) ERROR(( "File close failed on remap!!!" ));
+  }
+
+  FREE_ALIGNED( pbuf );
+  FREE( cut );
+
+  restore_species_list_layout( species_list, layout.data() );
+
+  // Continue from the dumped step.  The random number generators cannot
+  // be carried over to a different decomposition so they are reseeded
+  // from the dumped step and the deck's seeding (the same on all nodes).
+
+  g->step = h->step;
+  seed_entropy( (int)( ( uirand( sync_rng(0) ) ^ (uint32_t)h->step ) & 0xffff ) );
+
+  if( species_list ) load_interpolator_array( interpolator_array, field_array );
+  LIST_FOR_EACH( sp, species_list ) sort_p( sp );
+}
@@ -21,6 +21,32 @@
    to proper resize semantics so we could then create the objects during
    vpic_simulation construction (as opposed to after it). */
 
+// The rng pools hold one generator per pipeline and one for the host.
+
+static int
+vpic_n_rng( void ) {
+#if defined(VPIC_USE_PTHREADS)                         // Pthreads case.
+  int                              n_rng = serial.n_pipeline;
+  if ( n_rng < thread.n_pipeline ) n_rng = thread.n_pipeline;
+
+#elif defined(VPIC_USE_OPENMP)                         // OpenMP case.
+  int                              n_rng = omp_helper.n_pipeline;
+
+#else                                                  // Error case.
+  #error "VPIC_USE_OPENMP or VPIC_USE_PTHREADS must be specified"
+
+#endif
+
+  // int                           n_rng = serial.n_pipeline;
+  // if( n_rng<thread.n_pipeline ) n_rng = thread.n_pipeline;
+
+  // # if defined(CELL_PPU_BUILD) && defined(USE_CELL_SPUS)
+  //   if( n_rng<spu.n_pipeline    ) n_rng = spu.n_pipeline;
+  // # endif
+
+  return n_rng + 1;
+}
+
 void
 checkpt_vpic_simulation( const vpic_simulation * vpic ) {
   CHECKPT( vpic, 1 );
@@ -57,8 +83,13 @@ restore_vpic_simulation( void ) {
   return vpic;
 }
 
+// The rng pools are grown if there are more pipelines than at the
+// checkpt (the pipeline generators are restored as they were).
+
 void
 reanimate_vpic_simulation( vpic_simulation * vpic ) {
+  resize_rng_pool( vpic->entropy,      vpic_n_rng() );
+  resize_rng_pool( vpic->sync_entropy, vpic_n_rng() );
   REANIMATE_FPTR( vpic->material_list );
   REANIMATE_FPTR( vpic->field_array );
   REANIMATE_FPTR( vpic->interpolator_array );
@@ -77,29 +108,11 @@ vpic_simulation::vpic_simulation() {
   /* Set non-zero defaults */
   verbose = 1;
   num_comm_round = 3;
+  stop_comm_round = 1;
   num_div_e_round = 2;
   num_div_b_round = 2;
 
-#if defined(VPIC_USE_PTHREADS)                         // Pthreads case.
-  int                              n_rng = serial.n_pipeline;
-  if ( n_rng < thread.n_pipeline ) n_rng = thread.n_pipeline;
-
-#elif defined(VPIC_USE_OPENMP)                         // OpenMP case.
-  int                              n_rng = omp_helper.n_pipeline;
-
-#else                                                  // Error case.
-  #error "VPIC_USE_OPENMP or VPIC_USE_PTHREADS must be specified"
-
-#endif
-
-  // int                           n_rng = serial.n_pipeline;
-  // if( n_rng<thread.n_pipeline ) n_rng = thread.n_pipeline;
-
-  // # if defined(CELL_PPU_BUILD) && defined(USE_CELL_SPUS)
-  //   if( n_rng<spu.n_pipeline    ) n_rng = spu.n_pipeline;
-  // # endif
-
-  n_rng++;
+  int n_rng = vpic_n_rng();
 
   entropy      = new_rng_pool( n_rng, 0, 0 );
   sync_entropy = new_rng_pool( n_rng, 0, 1 );
@@ -259,24 +259,39 @@ class vpic_simulation {
 public:
   vpic_simulation();
   ~vpic_simulation();
-  void initialize( int argc, char **argv );
+  void initialize( int argc, char **argv, const char *remap_fbase = NULL );
   void modify( const char *fname );
   int advance( void );
   void finalize( void );
 
+  // Write the remap dump fbase of a checkpt (see dump_remap) if the run
+  // can be remapped on this step.  Called by checkpt.
+  void checkpt_remap( const char *fbase );
+
 protected:
 
   // Directly initialized by user
 
   int verbose;              // Should system be verbose
   int num_step;             // Number of steps to take
-  int num_comm_round;       // Num comm round
+  int num_comm_round;       // Max num comm rounds
+  int stop_comm_round;      // Stop the comm rounds once no node has movers
+                            // left (costs a global sum per round, on by
+                            // default)
   int status_interval;      // How often to print status messages
   int clean_div_e_interval; // How often to clean div e
   int num_div_e_round;      // How many clean div e rounds per div e interval
   int clean_div_b_interval; // How often to clean div b
   int num_div_b_round;      // How many clean div b rounds per div b interval
   int sync_shared_interval; // How often to synchronize shared faces
+  int fused_field_advance;  // Advance B, E and B in one pass (user field
+                            // injection then sees E_1 and B_1)
+  int neighbor_collectives; // Exchange the particle counts with MPI
+                            // neighborhood collectives
+  int shared_memory_comm;   // Exchange with the nodes on the same machine
+                            // through MPI shared memory windows
+  int rebalance_interval;   // How often to move the domain cuts to balance
+                            // the measured particle and field work
 
   // FIXME: THESE INTERVALS SHOULDN'T BE PART OF vpic_simulation
   // THE BIG LIST FOLLOWING IT SHOULD BE CLEANED UP TOO
@@ -334,6 +349,11 @@ protected:
                                              // emitter helpers
   collision_op_t       * collision_op_list;  // collision helpers
 
+  // Work measured since the last rebalance
+
+  double advance_p_time;    // Wallclock spent advancing particles
+  double field_time;        // Wallclock spent advancing fields
+
   // User defined checkpt preserved variables
   // Note: user_global is aliased with user_global_t (see deck_wrapper.cxx)
 
@@ -344,6 +364,28 @@ protected:
    ---------------------------------------------------------------------------*/
   double poynting_flux(double e0);
 
+  /*----------------------------------------------------------------------------
+   * Load balancing and remapping (see rebalance.cc)
+   ---------------------------------------------------------------------------*/
+
+  // Move the cuts of the domain decomposition so every domain gets about
+  // the same measured work and migrate the fields and particles to their
+  // new domains.  Called by advance every rebalance_interval steps.
+  // Domain specific user data (e.g. voxel lists or grid sized arrays the
+  // deck allocated) is not migrated.
+  void rebalance( void );
+
+  // Replace the fields and particles the deck loaded with those of the
+  // remap dump fbase (see dump_remap), which may have been made with a
+  // different number of nodes and decomposition of the same global grid.
+  // Continues from the dumped step with reseeded random number
+  // generators.  Called by initialize when restarting with --remap.
+  // Everything else (the user globals, the collision operators, emitters
+  // and particle boundary conditions with their random number generators
+  // and tallies) is as the deck's initialization left it; a warning lists
+  // what the deck defines of it.
+  void remap( const char *fbase );
+
   /*----------------------------------------------------------------------------
    * Check Sums
    ---------------------------------------------------------------------------*/
@@ -381,6 +423,9 @@ protected:
   void dump_particles( const char *sp_name,
 		       const char *fbase,
                        int fname_tag = 1 );
+  // Decomposition independent restart dump (see remap)
+  void dump_remap( const char *fbase,
+                   int fname_tag = 1 );
 #ifdef VPIC_ENABLE_HDF5
   void dump_particles_hdf5( const char *sp_name, const char *fbase,
                        int fname_tag = 1 );
@@ -450,6 +495,16 @@ protected:
     return field_array->f[ voxel(ix,iy,iz) ];
   }
 
+  inline field_material_t &
+  field_material( const int v ) {
+    return field_array->fm[ v ];
+  }
+
+  inline field_material_t &
+  field_material( const int ix, const int iy, const int iz ) {
+    return field_array->fm[ voxel(ix,iy,iz) ];
+  }
+
   inline interpolator_t &
   interpolator( const int v ) {
     return interpolator_array->i[ v ];
@@ -534,6 +589,17 @@ protected:
                          (int)gpx, (int)gpy, (int)gpz );
   }
 
+  // Cut the grid made by the above functions so every domain holds about
+  // the same amount of the given particle density (evaluated at voxel
+  // centers).  Along each axis, the domains still share their cuts (each
+  // slab of domains has the same resolution along the axis).  Call before
+  // defining the field array and species.
+
+  void
+  balance_grid( double (*density)( double x, double y, double z,
+                                   void * params ),
+                void * params = NULL );
+
   // The below macros allow custom domains to be created
 
   // Creates a particle reflecting metal box in the local domain
@@ -701,9 +767,10 @@ protected:
                        float dx, float dy, float dz, int32_t i,
                        float ux, float uy, float uz, float w )
   {
-    particle_t * RESTRICT p = sp->p + (sp->np++);
+    DECLARE_ALIGNED_ARRAY( particle_t, 32, p, 1 );
     p->dx = dx; p->dy = dy; p->dz = dz; p->i = i;
     p->ux = ux; p->uy = uy; p->uz = uz; p->w = w;
+    store_particle( sp->p, sp->layout, sp->np++, p );
   }
 
   // This variant does a raw inject and moves the particles
@@ -715,13 +782,16 @@ protected:
                        float dispx, float dispy, float dispz,
                        int update_rhob )
   {
-    particle_t       * RESTRICT p  = sp->p  + (sp->np++);
+    DECLARE_ALIGNED_ARRAY( particle_t, 32, p, 1 );
     particle_mover_t * RESTRICT pm = sp->pm + sp->nm;
     p->dx = dx; p->dy = dy; p->dz = dz; p->i = i;
     p->ux = ux; p->uy = uy; p->uz = uz; p->w = w;
+    store_particle( sp->p, sp->layout, sp->np++, p );
     pm->dispx = dispx; pm->dispy = dispy; pm->dispz = dispz; pm->i = sp->np-1;
     if( update_rhob ) accumulate_rhob( field_array->f, p, grid, -sp->q );
-    sp->nm += move_p( sp->p, pm, accumulator_array->a, grid, sp->q );
+    sp->nm += sp->layout==PARTICLE_LAYOUT_AOSOA ?
+      move_p_aosoa( sp->p, pm, accumulator_array->a, grid, sp->q ) :
+      move_p      ( sp->p, pm, accumulator_array->a, grid, sp->q );
   }
 
   //////////////////////////////////
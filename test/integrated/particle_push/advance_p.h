@@ -10,7 +10,7 @@ advance_p2_pipeline_scalar( advance_p_pipeline_args_t * args,
         int pipeline_rank,
         int n_pipeline ) {
     particle_t           * ALIGNED(128) p0 = args->p0;
-    accumulator_t        * ALIGNED(128) a0 = args->a0;
+    accumulator_tiles_t  *              at = args->at;
     const interpolator_t * ALIGNED(128) f0 = args->f0;
     const grid_t *                      g  = args->g;
 
@@ -56,12 +56,11 @@ advance_p2_pipeline_scalar( advance_p_pipeline_args_t * args,
     nm   = 0;
     int ignore = 0;
 
-    // Determine which accumulator array to use
-    // The host gets the first accumulator array
+    // Determine which accumulator tiles to use
+    // The host gets the tiles mapping the host accumulator
 
     if( pipeline_rank!=n_pipeline )
-        a0 += (1+pipeline_rank)*
-            POW2_CEIL((args->nx+2)*(args->ny+2)*(args->nz+2),2);
+        at += 1+pipeline_rank;
 
     // Process particles for this pipeline
 
@@ -139,7 +138,7 @@ advance_p2_pipeline_scalar( advance_p_pipeline_args_t * args,
             dy = v1;
             dz = v2;
             v5 = q*ux*uy*uz*one_third;              // Compute correction
-            a  = (float *)( a0 + ii );              // Get accumulator
+            a  = (float *) tile_accumulator( at, ii ); // Get accumulator
 
 #     define ACCUMULATE_J(X,Y,Z,offset)                                 \
             v4  = q*u##X;   /* v2 = q ux                            */        \
@@ -177,7 +176,7 @@ advance_p2_pipeline_scalar( advance_p_pipeline_args_t * args,
             // TODO: this could be something like i.. but that fails?!
             local_pm->i = i + itmp; //p_ - p0;
 
-            if( move_p( p0, local_pm, a0, g, qsp ) ) { // Unlikely
+            if( move_p_tiles( p0, local_pm, at, g, qsp ) ) { // Unlikely
                 if( nm<max_nm ) {
                     pm[nm++] = local_pm[0];
                 }
@@ -208,7 +207,7 @@ advance_p2( /**/  species_t            * RESTRICT sp,
 
     args->p0       = sp->p;
     args->pm       = sp->pm;
-    args->a0       = aa->a;
+    args->at       = aa->tiles;
     args->f0       = ia->i;
     args->seg      = seg;
     args->g        = sp->g;
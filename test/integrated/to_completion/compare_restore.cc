@@ -0,0 +1,81 @@
+// Compare the energies a restored run dumped to the energies of the run it
+// was restored from.
+//
+// Usage: compare_restore <energies> <reference energies> <tolerance>
+//
+// Each step in <energies> is compared to the first line of the same step
+// in <reference energies>.  This fails if <energies> has no steps, if a
+// step is missing from the reference or if any value differs by more
+// than the relative tolerance.
+
+#include <cmath>
+#include <vector>
+#include <sstream>
+
+#include "../../unit/energy_comparison/compare_energies.h"
+
+static std::vector< std::vector<double> >
+read_energies( const char * name ) {
+  std::vector< std::vector<double> > lines;
+  std::ifstream file( name );
+  std::string line;
+
+  if( !file.is_open() ) {
+    std::cerr << "Unable to open " << name << std::endl;
+    return lines;
+  }
+
+  while( getline( file, line ) ) {
+    if( line.empty() || line[0]=='%' ) continue;
+    std::stringstream tokens( line );
+    std::vector<double> values;
+    double value;
+    while( tokens >> value ) values.push_back( value );
+    lines.push_back( values );
+  }
+  return lines;
+}
+
+int
+main( int argc,
+      char ** argv ) {
+  if( argc!=4 ) {
+    std::cerr << "Usage: " << argv[0]
+              << " <energies> <reference energies> <tolerance>" << std::endl;
+    return 1;
+  }
+
+  std::vector< std::vector<double> > run = read_energies( argv[1] );
+  std::vector< std::vector<double> > ref = read_energies( argv[2] );
+  const double tolerance = std::stod( argv[3] );
+  bool match = !run.empty();
+
+  if( run.empty() ) std::cerr << "No energies in " << argv[1] << std::endl;
+
+  for( const auto & a : run ) {
+    const std::vector<double> * b = nullptr;
+    for( const auto & r : ref )
+      if( !r.empty() && r[0]==a[0] ) { b = &r; break; }
+
+    if( !b || b->size()!=a.size() ) {
+      std::cerr << "No matching step " << a[0] << " in " << argv[2]
+                << std::endl;
+      match = false;
+      continue;
+    }
+
+    for( size_t n=1; n<a.size(); n++ ) {
+      std::pair<bool, double> err =
+        test_utils::compare_error( a[n], (*b)[n], tolerance );
+      if( !err.first ) {
+        std::cerr << "Step " << a[0] << " value " << n << ": " << a[n]
+                  << " vs " << (*b)[n] << " (error " << err.second << ")"
+                  << std::endl;
+        match = false;
+      }
+    }
+  }
+
+  if( match ) std::cout << argv[1] << " matches " << argv[2] << std::endl;
+  return match ? 0 : 1;
+}
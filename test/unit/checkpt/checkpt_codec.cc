@@ -0,0 +1,159 @@
+//#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#define CATCH_CONFIG_RUNNER // We will provide a custom main
+#include "catch.hpp"
+
+#include "src/species_advance/species_advance.h"
+#include "src/util/rng/rng.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <vector>
+
+#define IN_checkpt
+#include "src/util/checkpt/checkpt_private.h"
+
+// The checkpt data codec must give back exactly what it was given for
+// data that compresses and data that does not, for strided records and
+// for delta coded fields.  Run with --checkpt.compress 1, a checkpt of
+// sorted particles must come back bit for bit and be markedly smaller
+// than the particles.
+
+static void
+round_trip( const std::vector<unsigned char> & src ) {
+  std::vector<unsigned char> coded( checkpt_compress_bound( src.size() ) );
+  std::vector<unsigned char> back( src.size() );
+  std::vector<int> table( 1<<16 );
+  size_t n = checkpt_compress( src.data(), src.size(), coded.data(),
+                               table.data() );
+  if( n ) {
+    REQUIRE( n<src.size() );
+    checkpt_decompress( coded.data(), n, back.data(), back.size() );
+    REQUIRE( back==src );
+  }
+}
+
+TEST_CASE( "LZ codec round trips", "[checkpt]" )
+{
+  rng_t * r = new_rng( 7 );
+
+  for( size_t sz : { 1, 4, 5, 17, 100, 4096, 70000, 300000 } ) {
+    std::vector<unsigned char> noise( sz ), runs( sz ), mixed( sz );
+    for( size_t k=0; k<sz; k++ ) {
+      noise[k] = (unsigned char)uirand( r );
+      runs [k] = (unsigned char)( k/1000 );
+      mixed[k] = ( k/64 )%3 ? (unsigned char)( k%7 ) : noise[k];
+    }
+    round_trip( noise );
+    round_trip( runs );
+    round_trip( mixed );
+  }
+
+  // Runs do compress (and with overlapping matches)
+  std::vector<unsigned char> zeros( 100000, 0 ), coded( 200000 );
+  std::vector<int> table( 1<<16 );
+  REQUIRE( checkpt_compress( zeros.data(), zeros.size(), coded.data(),
+                             table.data() )<1000 );
+
+  delete_rng( r );
+}
+
+TEST_CASE( "record shuffle round trips with strides and deltas", "[checkpt]" )
+{
+  const size_t n = 1000, sz = 32, str = 48;
+  std::vector<unsigned char> src( n*str ), mid( n*sz ), back( n*str, 0 );
+  rng_t * r = new_rng( 11 );
+
+  for( size_t k=0; k<src.size(); k++ ) src[k] = (unsigned char)uirand( r );
+  checkpt_shuffle(   src.data(), mid.data(),  n, sz, str, 0x89 );
+  checkpt_unshuffle( mid.data(),  back.data(), n, sz, str, 0x89 );
+  for( size_t k=0; k<n; k++ )
+    REQUIRE( memcmp( &src[k*str], &back[k*str], sz )==0 );
+
+  delete_rng( r );
+}
+
+// A checkpointed object holding a sorted particle array
+
+typedef struct test_particles {
+  particle_t * p;
+  int np, max_np;
+} test_particles_t;
+
+static test_particles_t particles[1], restored[1];
+
+void
+checkpt_test_particles( const test_particles_t * tp ) {
+  CHECKPT_VAL( int, tp->np );
+  CHECKPT_VAL( int, tp->max_np );
+  checkpt_records( tp->p, sizeof(particle_t), sizeof(particle_t),
+                   tp->np, tp->max_np, 128,
+                   1u << ( offsetof(particle_t,i)/4 ) );
+}
+
+test_particles_t *
+restore_test_particles( void ) {
+  RESTORE_VAL( int, restored->np );
+  RESTORE_VAL( int, restored->max_np );
+  restored->p = (particle_t *)restore_data();
+  return restored;
+}
+
+TEST_CASE( "compressed checkpts restore exactly", "[checkpt]" )
+{
+  const int np = 200000;
+  const char * name = "checkpt_codec.ckpt";
+  rng_t * r = new_rng( 13 );
+  FILE * f;
+  long sz;
+
+  particles->np = np;
+  particles->max_np = np + 100;
+  MALLOC_ALIGNED( particles->p, particles->max_np, 128 );
+  for( int k=0; k<np; k++ ) {
+    particle_t * p = particles->p + k;
+    p->dx = frand_c0( r ); p->dy = frand_c0( r ); p->dz = frand_c0( r );
+    p->i  = 1000 + k/37;
+    p->ux = frandn( r ); p->uy = frandn( r ); p->uz = frandn( r );
+    p->w  = 0.125f;
+  }
+  delete_rng( r ); // Only the particles go in the checkpt
+
+  REGISTER_OBJECT( particles, checkpt_test_particles, restore_test_particles,
+                   NULL );
+  checkpt_objects( name );
+  UNREGISTER_OBJECT( particles );
+
+  f = fopen( name, "rb" );
+  REQUIRE( f );
+  fseek( f, 0, SEEK_END );
+  sz = ftell( f );
+  fclose( f );
+  REQUIRE( sz<(long)( 0.75*np*sizeof(particle_t) ) );
+
+  restore_objects( name );
+  reanimate_objects();
+  remove( name );
+
+  REQUIRE( object_id( restored ) );
+  REQUIRE( restored->np==np );
+  REQUIRE( restored->max_np==np + 100 );
+  REQUIRE( memcmp( restored->p, particles->p, np*sizeof(particle_t) )==0 );
+
+  UNREGISTER_OBJECT( restored );
+  FREE_ALIGNED( restored->p );
+  FREE_ALIGNED( particles->p );
+}
+
+// Manually implement catch main
+int main( int argc, char* argv[] )
+{
+  // Setup
+  boot_services( &argc, &argv );
+
+  int result = Catch::Session().run( argc, argv );
+
+  // clean-up...
+  halt_services();
+
+  return result;
+}
@@ -0,0 +1,148 @@
+//#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#define CATCH_CONFIG_RUNNER // We will provide a custom main
+#include "catch.hpp"
+
+#include "deck/wrapper.h"
+
+#include <math.h>
+
+#include "src/vpic/vpic.h"
+
+// Random fields and material ids on a periodic grid with an odd number of
+// voxels are advanced a few steps with advance_b, advance_e and advance_b on
+// one field array and with advance_b_e_b on another.  The fields have to be
+// identical with the scalar pipelines and agree up to roundoff otherwise
+// (the vector pipelines use fused multiply adds).  This is done with several
+// materials and with a single material (the vacuum kernels).  The deck then
+// runs a few steps with the fused field advance.
+
+static int n_checked = 0, n_failed = 0;
+
+static void
+fill( field_array_t * fa, rng_t * r, int n_mat )
+{
+  float * p = (float *) fa->f;
+  for( int v=0; v<fa->g->nv; v++ ) {
+    for( int k=0; k<16; k++ ) p[k] = 2*frand( r ) - 1;
+    fa->fm[v].ematx = u32rand( r ) % n_mat;
+    fa->fm[v].ematy = u32rand( r ) % n_mat;
+    fa->fm[v].ematz = u32rand( r ) % n_mat;
+    fa->fm[v].fmatx = u32rand( r ) % n_mat;
+    fa->fm[v].fmaty = u32rand( r ) % n_mat;
+    fa->fm[v].fmatz = u32rand( r ) % n_mat;
+    p += sizeof(field_t)/sizeof(float);
+  }
+}
+
+static void
+check( grid_t * g, const material_t * m_list, int n_mat, float damp )
+{
+  field_array_t * a = new_standard_field_array( g, m_list, damp );
+  field_array_t * b = new_standard_field_array( g, m_list, damp );
+  rng_t * r = new_rng( 2718 );
+
+  fill( a, r, n_mat );
+  COPY( b->f, a->f, g->nv );
+  COPY( b->fm, a->fm, g->nv );
+
+  for( int n=0; n<3; n++ ) {
+    a->kernel->advance_b( a, 0.5 );
+    a->kernel->advance_e( a, 1 );
+    a->kernel->advance_b( a, 0.5 );
+
+    b->kernel->advance_b_e_b( b );
+  }
+
+  int ok = 1;
+  for( int v=0; v<g->nv; v++ ) {
+    const float * fa = (const float *)( a->f + v );
+    const float * fb = (const float *)( b->f + v );
+    for( int k=0; k<16; k++ ) {
+      if( pipeline_isa==PIPELINE_ISA_SCALAR ? fa[k]!=fb[k] :
+          fabsf( fa[k]-fb[k] ) > 1e-5f*( 1+fabsf( fa[k] ) ) ) ok = 0;
+    }
+  }
+
+  n_checked++;
+  if( !ok ) n_failed++;
+
+  delete_rng( r );
+  b->kernel->delete_fa( b );
+  a->kernel->delete_fa( a );
+}
+
+begin_initialization {
+  double L  = 1;
+  int    nx = 13, ny = 7, nz = 9;
+
+  num_step             = 4;
+  status_interval      = 0;
+  sync_shared_interval = 0;
+  clean_div_e_interval = 0;
+  clean_div_b_interval = 0;
+  fused_field_advance  = 1;
+
+  define_units( 1, 1 );
+  define_timestep( 0.99*courant_length( L, L, L, nx, ny, nz ) );
+  define_periodic_grid( 0, 0, 0,      // Grid low corner
+                        L, L, L,      // Grid high corner
+                        nx, ny, nz,   // Grid resolution
+                        1, 1, 1 );    // Processor configuration
+  define_material( "vacuum", 1 );
+  define_material( "dielectric", 2, 1.5, 0.1 );
+  define_field_array( NULL, 0.01 );
+
+  check( grid, material_list, 2, 0.01 );
+
+  material_t * vacuum = NULL;
+  append_material( material( "vacuum", 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0 ),
+                   &vacuum );
+  check( grid, vacuum, 1, 0.01 );
+  delete_material_list( vacuum );
+
+  set_region_field( everywhere, 0, 0, 0, 0.1, 0, 0 );
+}
+
+begin_diagnostics {
+}
+
+begin_particle_injection {
+}
+
+begin_current_injection {
+}
+
+begin_field_injection {
+}
+
+begin_particle_collisions {
+}
+
+TEST_CASE( "fused field advance matches advance_b, advance_e, advance_b",
+           "[field_advance]" )
+{
+  vpic_simulation simulation = vpic_simulation();
+
+  simulation.initialize( 0, NULL );
+
+  while( simulation.advance() );
+
+  simulation.finalize();
+
+  REQUIRE( n_checked==2 );
+  REQUIRE( n_failed==0 );
+}
+
+// Manually implement catch main
+int main( int argc, char* argv[] )
+{
+  // Setup
+  boot_services( &argc, &argv );
+
+  int result = Catch::Session().run( argc, argv );
+
+  // clean-up...
+  halt_services();
+
+  return result;
+}
@@ -0,0 +1,171 @@
+//#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#define CATCH_CONFIG_RUNNER // We will provide a custom main
+#include "catch.hpp"
+
+#include "deck/wrapper.h"
+
+#include <math.h>
+
+#include "src/vpic/vpic.h"
+
+// A medium fills a periodic domain except for a small block of vacuum near
+// one corner.  Far from the block, advance_e has to run the uniform material
+// kernels, so E there has to match a field array made of the medium alone
+// (exactly with the scalar pipelines).  Everywhere, a full field advance has
+// to agree with advance_b_e_b, which uses the general kernel throughout.
+
+static int n_checked = 0, n_failed = 0;
+
+static const int nx = 24, ny = 20, nz = 20;
+
+static int
+in_block( int x, int y, int z )
+{
+  return x>=3 && x<=6 && y>=3 && y<=6 && z>=3 && z<=6;
+}
+
+static void
+fill( field_array_t * fa )
+{
+  rng_t * r = new_rng( 1618 );
+  for( int z=0; z<=nz+1; z++ )
+    for( int y=0; y<=ny+1; y++ )
+      for( int x=0; x<=nx+1; x++ ) {
+        field_material_t * fm = fa->fm + VOXEL( x, y, z, nx, ny, nz );
+        float * p = (float *)( fa->f + VOXEL( x, y, z, nx, ny, nz ) );
+        material_id m = in_block( x, y, z ) ? 1 : 0;
+        for( int k=0; k<16; k++ ) p[k] = 2*frand( r ) - 1;
+        fm->ematx = fm->ematy = fm->ematz = fm->nmat = m;
+        fm->fmatx = fm->fmaty = fm->fmatz = fm->cmat = m;
+      }
+  delete_rng( r );
+}
+
+static int
+agree( const field_t * a, const field_t * b, int exact )
+{
+  const float * fa = (const float *) a;
+  const float * fb = (const float *) b;
+  for( int k=0; k<16; k++ )
+    if( exact ? fa[k]!=fb[k] : fabsf( fa[k]-fb[k] ) > 1e-5f*( 1+fabsf( fa[k] ) ) )
+      return 0;
+  return 1;
+}
+
+static void
+check( grid_t * g, const material_t * m_list, const material_t * medium )
+{
+  field_array_t * a = new_standard_field_array( g, m_list, 0.01 );
+  field_array_t * b = new_standard_field_array( g, medium, 0.01 );
+  const int exact = pipeline_isa==PIPELINE_ISA_SCALAR;
+
+  // Far from the block, E matches the medium alone
+
+  fill( a );
+  COPY( b->f, a->f, g->nv );
+  a->kernel->advance_e( a, 1 );
+  b->kernel->advance_e( b, 1 );
+
+  int ok = 1;
+  for( int z=12; z<=nz; z++ )
+    for( int y=12; y<=ny; y++ )
+      for( int x=2; x<=nx; x++ )
+        if( !agree( a->f + VOXEL( x, y, z, nx, ny, nz ),
+                    b->f + VOXEL( x, y, z, nx, ny, nz ), exact ) ) ok = 0;
+  n_checked++;
+  if( !ok ) n_failed++;
+
+  // Everywhere, a few steps agree with the general kernel
+
+  fill( a );
+  field_array_t * c = new_standard_field_array( g, m_list, 0.01 );
+  COPY( c->f, a->f, g->nv );
+  COPY( c->fm, a->fm, g->nv );
+
+  for( int n=0; n<3; n++ ) {
+    a->kernel->advance_b( a, 0.5 );
+    a->kernel->advance_e( a, 1 );
+    a->kernel->advance_b( a, 0.5 );
+    c->kernel->advance_b_e_b( c );
+  }
+
+  ok = 1;
+  for( int v=0; v<g->nv; v++ )
+    if( !agree( a->f + v, c->f + v, 0 ) ) ok = 0;
+  n_checked++;
+  if( !ok ) n_failed++;
+
+  c->kernel->delete_fa( c );
+  b->kernel->delete_fa( b );
+  a->kernel->delete_fa( a );
+}
+
+begin_initialization {
+  double L = 1;
+
+  num_step             = 1;
+  status_interval      = 0;
+  sync_shared_interval = 0;
+  clean_div_e_interval = 0;
+  clean_div_b_interval = 0;
+
+  define_units( 1, 1 );
+  define_timestep( 0.5*courant_length( L, L, L, nx, ny, nz ) );
+  define_periodic_grid( 0, 0, 0,      // Grid low corner
+                        L, L, L,      // Grid high corner
+                        nx, ny, nz,   // Grid resolution
+                        1, 1, 1 );    // Processor configuration
+  define_material( "medium", 2, 1.7, 0.05 );
+  define_material( "vacuum", 1 );
+  define_field_array( NULL, 0.01 );
+
+  material_t * medium = NULL;
+  append_material( material( "medium", 2, 2, 2, 1.7, 1.7, 1.7,
+                             0.05, 0.05, 0.05, 0, 0, 0 ), &medium );
+  check( grid, material_list, medium );
+  delete_material_list( medium );
+}
+
+begin_diagnostics {
+}
+
+begin_particle_injection {
+}
+
+begin_current_injection {
+}
+
+begin_field_injection {
+}
+
+begin_particle_collisions {
+}
+
+TEST_CASE( "advance_e uses the uniform material kernels where it can",
+           "[field_advance]" )
+{
+  vpic_simulation simulation = vpic_simulation();
+
+  simulation.initialize( 0, NULL );
+
+  while( simulation.advance() );
+
+  simulation.finalize();
+
+  REQUIRE( n_checked==2 );
+  REQUIRE( n_failed==0 );
+}
+
+// Manually implement catch main
+int main( int argc, char* argv[] )
+{
+  // Setup
+  boot_services( &argc, &argv );
+
+  int result = Catch::Session().run( argc, argv );
+
+  // clean-up...
+  halt_services();
+
+  return result;
+}
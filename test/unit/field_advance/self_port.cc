@@ -0,0 +1,176 @@
+//#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#define CATCH_CONFIG_RUNNER // We will provide a custom main
+#include "catch.hpp"
+
+#include "deck/wrapper.h"
+
+#include "src/vpic/vpic.h"
+
+// A periodic domain on one node has every face port joined to itself, so
+// its ghost exchanges are done without message passing.  After
+// synchronize_jf, the current on the periodic images of an edge must be
+// identical and, away from the other faces, be the sum of the currents
+// the two images had (i.e. each image received the other's values and not
+// its own).  synchronize_rho is checked the same way.  The domain has a
+// different resolution along each axis to catch exchanges sized for the
+// wrong port.
+
+static int n_checked = 0, n_failed = 0;
+
+static const int nx = 6, ny = 5, nz = 4;
+
+static void
+fill( field_array_t * fa )
+{
+  rng_t * r = new_rng( 2718 );
+  for( int v=0; v<fa->g->nv; v++ ) {
+    float * p = (float *)( fa->f + v );
+    for( int k=0; k<16; k++ ) p[k] = 2*frand( r ) - 1;
+  }
+  delete_rng( r );
+}
+
+#define f(x,y,z)   fa->f[ VOXEL( x, y, z, nx, ny, nz ) ]
+#define ref(x,y,z) ref[ VOXEL( x, y, z, nx, ny, nz ) ]
+
+static void
+check_jf( field_array_t * fa )
+{
+  field_t * ref;
+  int ok = 1;
+
+  MALLOC_ALIGNED( ref, fa->g->nv, 128 );
+  fill( fa );
+  COPY( ref, fa->f, fa->g->nv );
+  fa->kernel->synchronize_jf( fa );
+
+  for( int z=1; z<=nz+1; z++ )
+    for( int y=1; y<=ny; y++ ) {
+      if( f(1,y,z).jfy!=f(nx+1,y,z).jfy ) ok = 0;
+      if( z>1 && z<=nz &&
+          f(1,y,z).jfy!=ref(1,y,z).jfy+ref(nx+1,y,z).jfy ) ok = 0;
+    }
+
+  for( int z=1; z<=nz; z++ )
+    for( int x=1; x<=nx; x++ ) {
+      if( f(x,1,z).jfz!=f(x,ny+1,z).jfz ) ok = 0;
+      if( x>1 && x<=nx &&
+          f(x,1,z).jfz!=ref(x,1,z).jfz+ref(x,ny+1,z).jfz ) ok = 0;
+    }
+
+  for( int y=1; y<=ny+1; y++ )
+    for( int x=1; x<=nx; x++ ) {
+      if( f(x,y,1).jfx!=f(x,y,nz+1).jfx ) ok = 0;
+      if( y>1 && y<=ny &&
+          f(x,y,1).jfx!=ref(x,y,1).jfx+ref(x,y,nz+1).jfx ) ok = 0;
+    }
+
+  FREE_ALIGNED( ref );
+  n_checked++;
+  if( !ok ) n_failed++;
+}
+
+static void
+check_rho( field_array_t * fa )
+{
+  field_t * ref;
+  int ok = 1;
+
+  MALLOC_ALIGNED( ref, fa->g->nv, 128 );
+  fill( fa );
+  COPY( ref, fa->f, fa->g->nv );
+  fa->kernel->synchronize_rho( fa );
+
+  for( int z=2; z<=nz; z++ )
+    for( int y=2; y<=ny; y++ ) {
+      if( f(1,y,z).rhof!=f(nx+1,y,z).rhof ) ok = 0;
+      if( f(1,y,z).rhof!=ref(1,y,z).rhof+ref(nx+1,y,z).rhof ) ok = 0;
+    }
+
+  for( int z=2; z<=nz; z++ )
+    for( int x=2; x<=nx; x++ ) {
+      if( f(x,1,z).rhof!=f(x,ny+1,z).rhof ) ok = 0;
+      if( f(x,1,z).rhof!=ref(x,1,z).rhof+ref(x,ny+1,z).rhof ) ok = 0;
+    }
+
+  for( int y=2; y<=ny; y++ )
+    for( int x=2; x<=nx; x++ ) {
+      if( f(x,y,1).rhof!=f(x,y,nz+1).rhof ) ok = 0;
+      if( f(x,y,1).rhof!=ref(x,y,1).rhof+ref(x,y,nz+1).rhof ) ok = 0;
+    }
+
+  FREE_ALIGNED( ref );
+  n_checked++;
+  if( !ok ) n_failed++;
+}
+
+#undef ref
+#undef f
+
+begin_initialization {
+  double L = 1;
+
+  num_step             = 1;
+  status_interval      = 0;
+  sync_shared_interval = 0;
+  clean_div_e_interval = 0;
+  clean_div_b_interval = 0;
+
+  define_units( 1, 1 );
+  define_timestep( 0.5*courant_length( L, L, L, nx, ny, nz ) );
+  define_periodic_grid( 0, 0, 0,      // Grid low corner
+                        L, L, L,      // Grid high corner
+                        nx, ny, nz,   // Grid resolution
+                        1, 1, 1 );    // Processor configuration
+  define_material( "vacuum", 1 );
+  define_field_array( NULL, 0 );
+
+  check_jf( field_array );
+  check_rho( field_array );
+
+  field_array->kernel->clear_jf( field_array );
+  CLEAR( field_array->f, grid->nv );
+}
+
+begin_diagnostics {
+}
+
+begin_particle_injection {
+}
+
+begin_current_injection {
+}
+
+begin_field_injection {
+}
+
+begin_particle_collisions {
+}
+
+TEST_CASE( "ghost exchanges through self joined ports", "[field_advance]" )
+{
+  vpic_simulation simulation = vpic_simulation();
+
+  simulation.initialize( 0, NULL );
+
+  while( simulation.advance() );
+
+  simulation.finalize();
+
+  REQUIRE( n_checked==2 );
+  REQUIRE( n_failed==0 );
+}
+
+// Manually implement catch main
+int main( int argc, char* argv[] )
+{
+  // Setup
+  boot_services( &argc, &argv );
+
+  int result = Catch::Session().run( argc, argv );
+
+  // clean-up...
+  halt_services();
+
+  return result;
+}
@@ -0,0 +1,119 @@
+//#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#define CATCH_CONFIG_RUNNER // We will provide a custom main
+#include "catch.hpp"
+
+#include "deck/wrapper.h"
+
+#include "src/species_advance/species_advance.h"
+#include "src/vpic/vpic.h"
+
+// Two species are loaded with identical particles, one of them stored in the
+// AoSoA layout.  Both see the same fields, so after every step (push,
+// boundary handling and periodic sorts) their particle lists must agree.
+// The AoS species pushes its final incomplete block with the scalar
+// pipeline while the AoSoA species pushes it with the vector one, so only
+// agreement to roundoff is required.
+
+static bool
+same( float a, float b ) {
+  return fabs( a-b )<=1e-5*( 1+fabs( a ) );
+}
+
+static int n_checked = 0, n_failed = 0;
+
+void vpic_simulation::user_diagnostics() {
+  species_t * aos   = find_species_name( "aos",   species_list );
+  species_t * aosoa = find_species_name( "aosoa", species_list );
+  particle_t p, q;
+
+  n_checked++;
+  if( aosoa->layout!=PARTICLE_LAYOUT_AOSOA || aos->np!=aosoa->np ) n_failed++;
+  else
+    for( int n=0; n<aos->np; n++ ) {
+      load_particle( aos->p,   aos->layout,   n, &p );
+      load_particle( aosoa->p, aosoa->layout, n, &q );
+      if( p.i!=q.i ||
+          !same( p.dx, q.dx ) || !same( p.dy, q.dy ) || !same( p.dz, q.dz ) ||
+          !same( p.ux, q.ux ) || !same( p.uy, q.uy ) || !same( p.uz, q.uz ) ||
+          p.w!=q.w ) { n_failed++; break; }
+    }
+}
+
+begin_initialization {
+  double L     = 1;
+  int    nx    = 8;
+  int    npart = 16*nx*nx*nx + 5; // Leave the last tile partially filled
+  double vth   = 0.3;
+
+  num_step             = 40;
+  status_interval      = 0;
+  sync_shared_interval = 0;
+  clean_div_e_interval = 0;
+  clean_div_b_interval = 0;
+
+  define_units( 1, 1 );
+  define_timestep( 0.99*courant_length( L, L, L, nx, nx, nx ) );
+  define_periodic_grid( 0, 0, 0,      // Grid low corner
+                        L, L, L,      // Grid high corner
+                        nx, nx, nx,   // Grid resolution
+                        1, 1, 1 );    // Processor configuration
+  define_material( "vacuum", 1 );
+  define_field_array( NULL, 0 );
+
+  species_t * aos   = define_species( "aos",   -1, 1, 2*npart, -1, 7, 0 );
+  species_t * aosoa = define_species( "aosoa", -1, 1, 2*npart, -1, 7, 0 );
+
+  set_species_layout( aosoa, PARTICLE_LAYOUT_AOSOA );
+
+  repeat( npart ) {
+    double x  = uniform( rng(0), 0, L );
+    double y  = uniform( rng(0), 0, L );
+    double z  = uniform( rng(0), 0, L );
+    double ux = normal( rng(0), 0, vth );
+    double uy = normal( rng(0), 0, vth );
+    double uz = normal( rng(0), 0, vth );
+
+    inject_particle( aos,   x, y, z, ux, uy, uz, 1./npart, 0, 0 );
+    inject_particle( aosoa, x, y, z, ux, uy, uz, 1./npart, 0, 0 );
+  }
+}
+
+begin_particle_injection {
+}
+
+begin_current_injection {
+}
+
+begin_field_injection {
+}
+
+begin_particle_collisions {
+}
+
+TEST_CASE( "AoSoA particle layout matches the AoS layout", "[particle_push]" )
+{
+  vpic_simulation simulation = vpic_simulation();
+
+  simulation.initialize( 0, NULL );
+
+  while( simulation.advance() );
+
+  simulation.finalize();
+
+  REQUIRE( n_checked>0 );
+  REQUIRE( n_failed==0 );
+}
+
+// Manually implement catch main
+int main( int argc, char* argv[] )
+{
+  // Setup
+  boot_services( &argc, &argv );
+
+  int result = Catch::Session().run( argc, argv );
+
+  // clean-up...
+  halt_services();
+
+  return result;
+}
@@ -59,22 +59,25 @@ vpic_simulation::user_initialization( int num_cmdline_arguments,
   // Create a second accumulator_array
   accumulator_array_t* accumulator_array2 = new_accumulator_array( grid );
 
-  clear_accumulator_array(accumulator_array);
-  clear_accumulator_array(accumulator_array2);
-
   // Hack into vpic internals
   int failed = 0;
   load_interpolator_array( interpolator_array, field_array );
   for( int n=0; n<nstep; n++ ) {
 
+    clear_accumulator_array(accumulator_array);
+    clear_accumulator_array(accumulator_array2);
+
     advance_p( sp, accumulator_array, interpolator_array );
     advance_p2( sp2, accumulator_array2, interpolator_array );
 
-    // This is how many pipelines there are inside the array
-    for (int n = 0; n < accumulator_array->n_pipeline+1; n++)
+    // The pipelines only own the tiles they deposit to, so compare the
+    // accumulators once the tiles are reduced into the host accumulator
+    reduce_accumulator_array(accumulator_array);
+    reduce_accumulator_array(accumulator_array2);
+
     {
-        accumulator_t* a = accumulator_array->a + (n * accumulator_array2->stride);
-        accumulator_t* a2 = accumulator_array2->a + (n * accumulator_array2->stride);
+        accumulator_t* a = accumulator_array->a;
+        accumulator_t* a2 = accumulator_array2->a;
         for (int i = 0; i < grid->nv; i++)
         {
             if (
@@ -0,0 +1,250 @@
+//#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#define CATCH_CONFIG_RUNNER // We will provide a custom main
+#include "catch.hpp"
+
+#include "deck/wrapper.h"
+
+#include <string.h>
+
+#define IN_boundary
+#include "src/boundary/boundary_private.h"
+#include "src/species_advance/species_advance.h"
+#include "src/vpic/vpic.h"
+
+// Two species, one of them stored in the AoSoA layout, in an absorbing box
+// whose +x face reflects particles through a user-defined boundary
+// condition.  Before each particle exchange, the particles, movers and
+// rhob are copied and a serial reference exchange (the particles are
+// processed one mover at a time in reverse order) is run on the copies.
+// The particles and rhob left by the actual exchange must be bitwise
+// identical to the reference.
+
+static int n_checked = 0, n_failed = 0, n_mirrored = 0;
+
+// Mirror the particle back into the domain.
+
+static int
+mirror_x( void                * RESTRICT params,
+          species_t           * RESTRICT sp,
+          particle_t          * RESTRICT p,
+          particle_mover_t    * RESTRICT pm,
+          particle_injector_t * RESTRICT pi,
+          int                            max_pi,
+          int                            face ) {
+  pi->dx    =  p->dx;  pi->dy    = p->dy;  pi->dz    = p->dz;  pi->i = p->i;
+  pi->ux    = -p->ux;  pi->uy    = p->uy;  pi->uz    = p->uz;  pi->w = p->w;
+  pi->dispx = -pm->dispx; pi->dispy = pm->dispy; pi->dispz = pm->dispz;
+  pi->sp_id = sp->id;
+  return 1;
+}
+
+// Reference copies of the particles and of rhob.
+
+static const int n_sp = 2;
+
+static particle_t          * ref_p[n_sp];
+static particle_mover_t    * ref_pm[n_sp];
+static int                   ref_np[n_sp];
+static field_t             * ref_f  = NULL;
+static accumulator_array_t * ref_aa = NULL;
+
+static void
+reference_boundary_p( species_t * sp_list, grid_t * g, particle_bc_t * pbc ) {
+  particle_injector_t * ci;
+  particle_t p;
+  species_t * sp;
+  int n_ci = 0, nm_total = 0;
+
+  LIST_FOR_EACH( sp, sp_list ) nm_total += sp->nm;
+  MALLOC( ci, nm_total+1 );
+
+  LIST_FOR_EACH( sp, sp_list ) {
+    particle_t       * p0 = ref_p [sp->id];
+    particle_mover_t * pm = ref_pm[sp->id];
+    int np = sp->np;
+    for( int k=sp->nm-1; k>=0; k-- ) {
+      int i = pm[k].i;
+      load_particle( p0, sp->layout, i, &p );
+      int face = p.i & 7;
+      p.i >>= 3;
+      int64_t nn = g->neighbor[ 6*p.i + face ];
+      if( nn==absorb_particles )  accumulate_rhob( ref_f, &p, g, sp->q );
+      else if( nn==pbc->id )      n_ci += mirror_x( NULL, sp, &p, pm+k, ci+n_ci, 1, face );
+      else                        n_failed++; // Nothing else expected here
+      np--;
+      load_particle ( p0, sp->layout, np, &p );
+      store_particle( p0, sp->layout, i,  &p );
+    }
+    ref_np[sp->id] = np;
+  }
+
+  // Inject in reverse order and drop the particles whose move is still
+  // not complete (as advance does after the last exchange).
+
+  int nm[n_sp] = { 0, 0 };
+  species_t * sp_by_id[n_sp];
+  LIST_FOR_EACH( sp, sp_list ) sp_by_id[sp->id] = sp;
+
+  for( int n=n_ci-1; n>=0; n-- ) {
+    const particle_injector_t * pi = ci + n;
+    int id = pi->sp_id;
+    sp = sp_by_id[id];
+    particle_mover_t * m = ref_pm[id] + nm[id];
+    p.dx = pi->dx; p.dy = pi->dy; p.dz = pi->dz; p.i = pi->i;
+    p.ux = pi->ux; p.uy = pi->uy; p.uz = pi->uz; p.w = pi->w;
+    store_particle( ref_p[id], sp->layout, ref_np[id], &p );
+    m->dispx = pi->dispx; m->dispy = pi->dispy; m->dispz = pi->dispz;
+    m->i = ref_np[id]++;
+    nm[id] += sp->layout==PARTICLE_LAYOUT_AOSOA ?
+              move_p_aosoa( ref_p[id], m, ref_aa->a, g, sp->q ) :
+              move_p      ( ref_p[id], m, ref_aa->a, g, sp->q );
+  }
+
+  LIST_FOR_EACH( sp, sp_list )
+    for( int k=nm[sp->id]-1; k>=0; k-- ) {
+      int i = ref_pm[sp->id][k].i;
+      load_particle( ref_p[sp->id], sp->layout, i, &p );
+      p.i >>= 3;
+      accumulate_rhob( ref_f, &p, g, sp->q );
+      load_particle ( ref_p[sp->id], sp->layout, --ref_np[sp->id], &p );
+      store_particle( ref_p[sp->id], sp->layout, i, &p );
+    }
+
+  n_mirrored += n_ci;
+
+  FREE( ci );
+}
+
+begin_globals {
+  particle_bc_t * mirror;
+};
+
+begin_initialization {
+  double L     = 1;
+  int    nx    = 8;
+  int    npart = 16*nx*nx*nx + 5;
+  double vth   = 0.3;
+
+  num_step             = 16;
+  num_comm_round       = 1;
+  status_interval      = 0;
+  sync_shared_interval = 0;
+  clean_div_e_interval = 0;
+  clean_div_b_interval = 0;
+
+  define_units( 1, 1 );
+  define_timestep( 0.99*courant_length( L, L, L, nx, nx, nx ) );
+  define_absorbing_grid( 0, 0, 0,      // Grid low corner
+                         L, L, L,      // Grid high corner
+                         nx, nx, nx,   // Grid resolution
+                         1, 1, 1,      // Processor configuration
+                         absorb_particles );
+  global->mirror = define_particle_bc(
+    new_particle_bc_internal( NULL, mirror_x,
+                              delete_particle_bc_internal,
+                              NULL, NULL, NULL ) );
+  set_domain_particle_bc( BOUNDARY(1,0,0), get_particle_bc_id( global->mirror ) );
+  define_material( "vacuum", 1 );
+  define_field_array( NULL, 0 );
+
+  species_t * aos   = define_species( "aos",   -1, 1, 2*npart, -1, 1, 0 );
+  species_t * aosoa = define_species( "aosoa",  1, 1, 2*npart, -1, 1, 0 );
+
+  set_species_layout( aosoa, PARTICLE_LAYOUT_AOSOA );
+
+  repeat( npart ) {
+    inject_particle( aos,
+                     uniform( rng(0), 0, L ), uniform( rng(0), 0, L ),
+                     uniform( rng(0), 0, L ), normal( rng(0), 0, vth ),
+                     normal( rng(0), 0, vth ), normal( rng(0), 0, vth ),
+                     1./npart, 0, 0 );
+    inject_particle( aosoa,
+                     uniform( rng(0), 0, L ), uniform( rng(0), 0, L ),
+                     uniform( rng(0), 0, L ), normal( rng(0), 0, vth ),
+                     normal( rng(0), 0, vth ), normal( rng(0), 0, vth ),
+                     1./npart, 0, 0 );
+  }
+
+  for( int n=0; n<n_sp; n++ ) {
+    MALLOC_ALIGNED( ref_p [n], 4*npart, 128 );
+    MALLOC_ALIGNED( ref_pm[n], 4*npart, 128 );
+  }
+  MALLOC_ALIGNED( ref_f, grid->nv, 128 );
+  ref_aa = new_accumulator_array( grid );
+}
+
+begin_diagnostics {
+}
+
+// Right before the exchange, run the reference exchange.
+
+begin_particle_injection {
+  species_t * sp;
+  LIST_FOR_EACH( sp, species_list ) {
+    COPY( ref_p [sp->id], sp->p,  PARTICLE_BLOCK_CEIL( sp->np ) );
+    COPY( ref_pm[sp->id], sp->pm, sp->nm );
+  }
+  COPY( ref_f, field_array->f, grid->nv );
+  reference_boundary_p( species_list, grid, global->mirror );
+}
+
+begin_current_injection {
+  species_t * sp;
+  particle_t p, q;
+  LIST_FOR_EACH( sp, species_list ) {
+    n_checked++;
+    if( sp->np!=ref_np[sp->id] || sp->nm ) { n_failed++; continue; }
+    for( int n=0; n<sp->np; n++ ) {
+      load_particle( sp->p,          sp->layout, n, &p );
+      load_particle( ref_p[sp->id], sp->layout, n, &q );
+      if( memcmp( &p, &q, sizeof(p) ) ) { n_failed++; break; }
+    }
+  }
+  for( int v=0; v<grid->nv; v++ )
+    if( memcmp( &field_array->f[v].rhob, &ref_f[v].rhob, sizeof(float) ) ) {
+      n_failed++;
+      break;
+    }
+}
+
+begin_field_injection {
+}
+
+begin_particle_collisions {
+}
+
+TEST_CASE( "boundary_p matches a serial exchange", "[particle_push]" )
+{
+  vpic_simulation simulation = vpic_simulation();
+
+  simulation.initialize( 0, NULL );
+
+  while( simulation.advance() );
+
+  simulation.finalize();
+
+  delete_accumulator_array( ref_aa );
+  for( int n=0; n<n_sp; n++ ) {
+    FREE_ALIGNED( ref_p [n] );
+    FREE_ALIGNED( ref_pm[n] );
+  }
+  FREE_ALIGNED( ref_f );
+
+  REQUIRE( n_checked>0 );
+  REQUIRE( n_mirrored>0 );
+  REQUIRE( n_failed==0 );
+}
+
+// Manually implement catch main
+int main( int argc, char* argv[] )
+{
+  // Setup
+  boot_services( &argc, &argv );
+
+  int result = Catch::Session().run( argc, argv );
+
+  // clean-up...
+  halt_services();
+
+  return result;
+}
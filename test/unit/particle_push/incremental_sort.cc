@@ -0,0 +1,161 @@
+//#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#define CATCH_CONFIG_RUNNER // We will provide a custom main
+#include "catch.hpp"
+
+#include "deck/wrapper.h"
+
+#include <string.h>
+
+#include "src/species_advance/species_advance.h"
+#include "src/vpic/vpic.h"
+
+// Two species sorted incrementally every step, one of them stored in the
+// AoSoA layout.  Particles leave through the absorbing boundaries (which
+// back fills the particle arrays) and new particles are injected every step,
+// so the sorts see migrants of every kind.  Right after each sort, the
+// partitioning must be exact, the sort must only have permuted the
+// particles and, every few steps, a full sort must agree with it.
+
+static int n_checked = 0, n_failed = 0;
+
+// Order independent checksum of the bits of a particle list.
+
+static uint64_t
+checksum( species_t * sp ) {
+  particle_t p;
+  uint32_t b[8];
+  uint64_t sum = 0;
+  for( int n=0; n<sp->np; n++ ) {
+    load_particle( sp->p, sp->layout, n, &p );
+    memcpy( b, &p, sizeof(b) );
+    for( int k=0; k<8; k++ ) sum += (uint64_t)b[k]*( 2*k+1 );
+  }
+  return sum;
+}
+
+static uint64_t sum[2];
+
+static void
+check_sorted( species_t * sp, uint64_t sum_before ) {
+  const grid_t * g = sp->g;
+  const int * partition = sp->partition;
+  int vl = VOXEL( 1, 1, 1, g->nx, g->ny, g->nz );
+  int vh = VOXEL( g->nx, g->ny, g->nz, g->nx, g->ny, g->nz );
+
+  n_checked++;
+  if( sp->last_sorted!=g->step || partition[vl]!=0 || partition[vh+1]!=sp->np ||
+      checksum( sp )!=sum_before ) { n_failed++; return; }
+
+  for( int v=vl; v<=vh; v++ )
+    for( int n=partition[v]; n<partition[v+1]; n++ )
+      if( *particle_voxel( sp->p, sp->layout, n )!=v ) { n_failed++; return; }
+
+  if( g->step%4 ) return;
+
+  // A full sort has to give the same partitioning.
+
+  int * incremental;
+  MALLOC( incremental, g->nv );
+  COPY( incremental, partition, g->nv );
+  sort_p_pipeline( sp );
+  for( int v=0; v<g->nv; v++ )
+    if( incremental[v]!=partition[v] ) { n_failed++; break; }
+  FREE( incremental );
+}
+
+void vpic_simulation::user_diagnostics() {
+  sum[0] = checksum( find_species_name( "aos",   species_list ) );
+  sum[1] = checksum( find_species_name( "aosoa", species_list ) );
+}
+
+begin_initialization {
+  double L     = 1;
+  int    nx    = 8;
+  int    npart = 16*nx*nx*nx + 5;
+  double vth   = 0.3;
+
+  num_step             = 24;
+  status_interval      = 0;
+  sync_shared_interval = 0;
+  clean_div_e_interval = 0;
+  clean_div_b_interval = 0;
+
+  define_units( 1, 1 );
+  define_timestep( 0.99*courant_length( L, L, L, nx, nx, nx ) );
+  define_absorbing_grid( 0, 0, 0,      // Grid low corner
+                         L, L, L,      // Grid high corner
+                         nx, nx, nx,   // Grid resolution
+                         1, 1, 1,      // Processor configuration
+                         absorb_particles );
+  define_material( "vacuum", 1 );
+  define_field_array( NULL, 0 );
+
+  species_t * aos   = define_species( "aos",   -1, 1, 4*npart, -1, 1, 0 );
+  species_t * aosoa = define_species( "aosoa", -1, 1, 4*npart, -1, 1, 0 );
+
+  set_species_sort_incremental( aos,   1 );
+  set_species_sort_incremental( aosoa, 1 );
+  set_species_layout( aosoa, PARTICLE_LAYOUT_AOSOA );
+
+  repeat( npart ) {
+    inject_particle( aos,
+                     uniform( rng(0), 0, L ), uniform( rng(0), 0, L ),
+                     uniform( rng(0), 0, L ), normal( rng(0), 0, vth ),
+                     normal( rng(0), 0, vth ), normal( rng(0), 0, vth ),
+                     1./npart, 0, 0 );
+    inject_particle( aosoa,
+                     uniform( rng(0), 0, L ), uniform( rng(0), 0, L ),
+                     uniform( rng(0), 0, L ), normal( rng(0), 0, vth ),
+                     normal( rng(0), 0, vth ), normal( rng(0), 0, vth ),
+                     1./npart, 0, 0 );
+  }
+}
+
+begin_particle_injection {
+  species_t * sp;
+  LIST_FOR_EACH( sp, species_list )
+    repeat( 37 )
+      inject_particle( sp,
+                       uniform( rng(0), 0, 1 ), uniform( rng(0), 0, 1 ),
+                       uniform( rng(0), 0, 1 ), 0, 0, 0, 1e-4, 0, 0 );
+}
+
+begin_current_injection {
+}
+
+begin_field_injection {
+}
+
+begin_particle_collisions {
+  if( step()==0 ) return; // The first sort is a full sort
+  check_sorted( find_species_name( "aos",   species_list ), sum[0] );
+  check_sorted( find_species_name( "aosoa", species_list ), sum[1] );
+}
+
+TEST_CASE( "incremental sort gives an exact partitioning", "[particle_push]" )
+{
+  vpic_simulation simulation = vpic_simulation();
+
+  simulation.initialize( 0, NULL );
+
+  while( simulation.advance() );
+
+  simulation.finalize();
+
+  REQUIRE( n_checked>0 );
+  REQUIRE( n_failed==0 );
+}
+
+// Manually implement catch main
+int main( int argc, char* argv[] )
+{
+  // Setup
+  boot_services( &argc, &argv );
+
+  int result = Catch::Session().run( argc, argv );
+
+  // clean-up...
+  halt_services();
+
+  return result;
+}
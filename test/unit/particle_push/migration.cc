@@ -0,0 +1,167 @@
+//#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#define CATCH_CONFIG_RUNNER // We will provide a custom main
+#include "catch.hpp"
+
+#include "deck/wrapper.h"
+
+#include "src/species_advance/species_advance.h"
+#include "src/vpic/vpic.h"
+
+// A hot plasma in a periodic box split over 2x2x2 domains, small enough
+// that many particles cross domain edges and corners every step.  With a
+// single exchange round, these particles must migrate directly to the
+// domain they end up in.  No particle may be lost and Gauss's law must
+// keep holding to roundoff, which checks the current the migrating
+// particles deposit in the ghost voxels is shipped with them.  Built with
+// NEIGHBOR_COLLECTIVES, the exchange counts go through a neighborhood
+// collective (every neighbor is joined through several ports here).
+// Built with SHARED_MEMORY_COMM, the exchanges go through the shared
+// memory window (all the nodes run on the same machine here).  Built
+// with SUBCYCLE, the species are pushed every 4 steps, so many moves are
+// longer than a voxel.  Those leaving the ghost voxel shell (e.g. through
+// a corner ghost voxel into the next one) hop as usual over more rounds.
+
+static int n_checked = 0, n_failed = 0, n_migrated = 0;
+static double max_err = 0;
+static double np_total = 0;
+
+static double
+count_particles( species_t * sp_list ) {
+  species_t * sp;
+  double np_local = 0, np_global;
+  LIST_FOR_EACH( sp, sp_list ) np_local += sp->np + sp->nm;
+  mp_allsum_d( &np_local, &np_global, 1 );
+  return np_global;
+}
+
+void vpic_simulation::user_diagnostics() {
+  species_t * sp;
+
+  field_array->kernel->clear_rhof( field_array );
+  LIST_FOR_EACH( sp, species_list ) accumulate_rho_p( field_array, sp );
+  field_array->kernel->synchronize_rho( field_array );
+  field_array->kernel->compute_div_e_err( field_array );
+  double err = field_array->kernel->compute_rms_div_e_err( field_array );
+  if( err>max_err ) max_err = err;
+
+  n_checked++;
+}
+
+begin_initialization {
+  double L     = 1;
+  int    nx    = 8;
+  int    npart = 16*nx*nx*nx;
+  double vth   = 0.5;
+
+  num_step             = 20;
+  num_comm_round       = 1;
+#ifdef SUBCYCLE
+  num_comm_round       = 4;
+#endif
+  status_interval      = 0;
+  sync_shared_interval = 0;
+  clean_div_e_interval = 0;
+  clean_div_b_interval = 0;
+#ifdef NEIGHBOR_COLLECTIVES
+  neighbor_collectives = 1;
+#endif
+#ifdef SHARED_MEMORY_COMM
+  shared_memory_comm   = 1;
+#endif
+
+  define_units( 1, 1 );
+  define_timestep( 0.99*courant_length( L, L, L, nx, nx, nx ) );
+  define_periodic_grid( 0, 0, 0,      // Grid low corner
+                        L, L, L,      // Grid high corner
+                        nx, nx, nx,   // Grid resolution
+                        2, 2, 2 );    // Processor configuration
+  define_material( "vacuum", 1 );
+  define_field_array( NULL, 0 );
+
+  species_t * electron = define_species( "electron", -1, 1, 4*npart, -1, 0, 0 );
+  species_t * ion      = define_species( "ion",       1, 1, 4*npart, -1, 0, 0 );
+
+  set_species_layout( ion, PARTICLE_LAYOUT_AOSOA );
+#ifdef SUBCYCLE
+  set_species_subcycle( electron, 4 );
+  set_species_subcycle( ion,      4 );
+#endif
+
+  repeat( npart/nproc() ) {
+    double x  = uniform( rng(0), grid->x0, grid->x1 );
+    double y  = uniform( rng(0), grid->y0, grid->y1 );
+    double z  = uniform( rng(0), grid->z0, grid->z1 );
+
+    inject_particle( electron, x, y, z,
+                     normal( rng(0), 0, vth ),
+                     normal( rng(0), 0, vth ),
+                     normal( rng(0), 0, vth ), 1./npart, 0, 0 );
+
+    inject_particle( ion, x, y, z,
+                     normal( rng(0), 0, vth ),
+                     normal( rng(0), 0, vth ),
+                     normal( rng(0), 0, vth ), 1./npart, 0, 0 );
+  }
+
+  np_total = count_particles( species_list );
+}
+
+// Right before the exchange, count the particles migrating directly.
+
+begin_particle_injection {
+  species_t * sp;
+  particle_t p;
+  int n_local = 0, n_global;
+  LIST_FOR_EACH( sp, species_list )
+    for( int k=0; k<sp->nm; k++ ) {
+      load_particle( sp->p, sp->layout, sp->pm[k].i, &p );
+      if( ( p.i & 7 )==MIGRATE_FACE ) n_local++;
+    }
+  mp_allsum_i( &n_local, &n_global, 1 );
+  n_migrated += n_global;
+}
+
+begin_current_injection {
+  if( count_particles( species_list )!=np_total ) n_failed++;
+#ifdef NEIGHBOR_COLLECTIVES
+  if( !mp_has_neighbors( grid->mp ) ) n_failed++;
+#endif
+}
+
+begin_field_injection {
+}
+
+begin_particle_collisions {
+}
+
+TEST_CASE( "particles migrate directly to edge and corner neighbors", "[particle_push]" )
+{
+  REQUIRE( world_size==8 );
+
+  vpic_simulation simulation = vpic_simulation();
+
+  simulation.initialize( 0, NULL );
+
+  while( simulation.advance() );
+
+  simulation.finalize();
+
+  REQUIRE( n_checked>0 );
+  REQUIRE( n_migrated>0 );
+  REQUIRE( n_failed==0 );
+  REQUIRE( max_err<1e-4 );
+}
+
+// Manually implement catch main
+int main( int argc, char* argv[] )
+{
+  // Setup
+  boot_services( &argc, &argv );
+
+  int result = Catch::Session().run( argc, argv );
+
+  // clean-up...
+  halt_services();
+
+  return result;
+}
@@ -0,0 +1,165 @@
+//#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#define CATCH_CONFIG_RUNNER // We will provide a custom main
+#include "catch.hpp"
+
+#include "deck/wrapper.h"
+
+#include "src/species_advance/species_advance.h"
+#include "src/vpic/vpic.h"
+
+// Particles sorted along a Hilbert curve through a non-cubic local domain,
+// with a full sort for one species and an incremental sort for the other.
+// Right after each sort, the particles of each voxel v must be found in
+// sp->partition[g->sfc[v]] to sp->partition[g->sfc[v]+1]-1.
+
+static int n_checked = 0, n_failed = 0, curve_ok = 0;
+
+static void
+check_sorted( species_t * sp ) {
+  const grid_t * g = sp->g;
+  const int * partition = sp->partition;
+  int vl = VOXEL( 1, 1, 1, g->nx, g->ny, g->nz );
+  int vh = VOXEL( g->nx, g->ny, g->nz, g->nx, g->ny, g->nz );
+
+  n_checked++;
+  if( sp->last_sorted!=g->step || partition[vl]!=0 || partition[vh+1]!=sp->np ) {
+    n_failed++;
+    return;
+  }
+
+  for( int v=0; v<g->nv; v++ )
+    for( int n=partition[g->sfc[v]]; n<partition[g->sfc[v]+1]; n++ )
+      if( *particle_voxel( sp->p, sp->layout, n )!=v ) { n_failed++; return; }
+}
+
+// The curve has to be a permutation of the voxels with the non-ghost voxels
+// at positions [VOXEL(1,1,1),VOXEL(1,1,1)+nx*ny*nz).  Consecutive positions
+// of a Hilbert curve through a cube are face neighbors.
+
+static int
+check_curve( const grid_t * g, int hilbert ) {
+  int vl = VOXEL( 1, 1, 1, g->nx, g->ny, g->nz ), nn = g->nx*g->ny*g->nz;
+  std::vector<int> voxel( g->nv, -1 );
+
+  for( int z=0; z<=g->nz+1; z++ )
+    for( int y=0; y<=g->ny+1; y++ )
+      for( int x=0; x<=g->nx+1; x++ ) {
+        int v = VOXEL( x, y, z, g->nx, g->ny, g->nz ), k = g->sfc[v];
+        int ghost = x==0 || x==g->nx+1 || y==0 || y==g->ny+1 ||
+                    z==0 || z==g->nz+1;
+        if( k<0 || k>=g->nv || voxel[k]!=-1 ) return 0;
+        if( ghost==( k>=vl && k<vl+nn ) ) return 0;
+        voxel[k] = v;
+      }
+
+  if( hilbert )
+    for( int k=vl+1; k<vl+nn; k++ ) {
+      int d = abs( voxel[k]-voxel[k-1] );
+      if( d!=1 && d!=g->sy && d!=g->sz ) return 0;
+    }
+
+  return 1;
+}
+
+begin_initialization {
+  double L     = 1;
+  int    nx    = 12, ny = 5, nz = 7;
+  int    npart = 8*nx*ny*nz;
+  double vth   = 0.3;
+
+  num_step             = 12;
+  status_interval      = 0;
+  sync_shared_interval = 0;
+  clean_div_e_interval = 0;
+  clean_div_b_interval = 0;
+
+  define_units( 1, 1 );
+  define_timestep( 0.99*courant_length( L, L, L, nx, ny, nz ) );
+  define_periodic_grid( 0, 0, 0,      // Grid low corner
+                        L, L, L,      // Grid high corner
+                        nx, ny, nz,   // Grid resolution
+                        1, 1, 1 );    // Processor configuration
+  define_material( "vacuum", 1 );
+  define_field_array( NULL, 0 );
+
+  set_sfc( grid, hilbert_order );
+
+  species_t * full        = define_species( "full",        -1, 1, 2*npart, -1, 1, 0 );
+  species_t * incremental = define_species( "incremental", -1, 1, 2*npart, -1, 1, 0 );
+
+  set_species_sort_incremental( incremental, 1 );
+  set_species_layout( incremental, PARTICLE_LAYOUT_AOSOA );
+
+  repeat( npart ) {
+    inject_particle( full,
+                     uniform( rng(0), 0, L ), uniform( rng(0), 0, L ),
+                     uniform( rng(0), 0, L ), normal( rng(0), 0, vth ),
+                     normal( rng(0), 0, vth ), normal( rng(0), 0, vth ),
+                     1./npart, 0, 0 );
+    inject_particle( incremental,
+                     uniform( rng(0), 0, L ), uniform( rng(0), 0, L ),
+                     uniform( rng(0), 0, L ), normal( rng(0), 0, vth ),
+                     normal( rng(0), 0, vth ), normal( rng(0), 0, vth ),
+                     1./npart, 0, 0 );
+  }
+}
+
+begin_diagnostics {
+}
+
+begin_particle_injection {
+}
+
+begin_current_injection {
+}
+
+begin_field_injection {
+}
+
+begin_particle_collisions {
+  if( step()==0 ) curve_ok = check_curve( grid, 0 );
+  check_sorted( find_species_name( "full",        species_list ) );
+  check_sorted( find_species_name( "incremental", species_list ) );
+}
+
+TEST_CASE( "particles are sorted along the space filling curve", "[particle_push]" )
+{
+  grid_t * g = new_grid();
+
+  size_grid( g, 8, 8, 8 );
+  set_sfc( g, hilbert_order );
+  REQUIRE( check_curve( g, 1 ) );
+  set_sfc( g, morton_order );
+  REQUIRE( check_curve( g, 0 ) );
+  size_grid( g, 9, 3, 5 );
+  REQUIRE( check_curve( g, 0 ) );
+  set_sfc( g, hilbert_order );
+  REQUIRE( check_curve( g, 0 ) );
+  delete_grid( g );
+
+  vpic_simulation simulation = vpic_simulation();
+
+  simulation.initialize( 0, NULL );
+
+  while( simulation.advance() );
+
+  simulation.finalize();
+
+  REQUIRE( curve_ok );
+  REQUIRE( n_checked>0 );
+  REQUIRE( n_failed==0 );
+}
+
+// Manually implement catch main
+int main( int argc, char* argv[] )
+{
+  // Setup
+  boot_services( &argc, &argv );
+
+  int result = Catch::Session().run( argc, argv );
+
+  // clean-up...
+  halt_services();
+
+  return result;
+}
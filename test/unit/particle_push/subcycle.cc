@@ -0,0 +1,145 @@
+//#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#define CATCH_CONFIG_RUNNER // We will provide a custom main
+#include "catch.hpp"
+
+#include "deck/wrapper.h"
+
+#include "src/species_advance/species_advance.h"
+#include "src/vpic/vpic.h"
+
+// A light species pushed every step and a heavy species pushed every
+// fourth step share a periodic box.  The heavy species deposits the whole
+// of its subcycled displacement in the step of its push, so Gauss's law
+// must keep holding to roundoff after every step.  The heavy species is a
+// cold beam along x; it must only move on the steps it is pushed and then
+// by subcycle*dt worth of drift (measured with the circular mean of the
+// particle x positions to be insensitive to the periodic wrap).  The
+// subcycle is set again mid cycle, after which the heavy species must be
+// pushed every fourth step counted from then.
+
+static int n_checked = 0, n_failed = 0;
+static double max_err = 0;
+static double phase = 0;
+static int64_t reset_step = 0;
+
+void vpic_simulation::user_diagnostics() {
+  species_t * heavy = find_species_name( "heavy", species_list ), * sp;
+  double c = 0, s = 0;
+
+  for( int n=0; n<heavy->np; n++ ) {
+    const particle_t * p = heavy->p + n;
+    int ix = p->i % ( grid->nx+2 );
+    double x = grid->x0 + ( ix - 1 + 0.5*( p->dx + 1 ) )*grid->dx;
+    c += cos( 2*M_PI*x/( grid->nx*grid->dx ) );
+    s += sin( 2*M_PI*x/( grid->nx*grid->dx ) );
+  }
+
+  double dphase = remainder( atan2( s, c ) - phase, 2*M_PI );
+  phase = atan2( s, c );
+
+  // The beam slows down as it builds up its own fields, hence the loose
+  // tolerance on the drift (which is still far tighter than the factor
+  // of subcycle an unscaled push would be off by).
+
+  if( step()>0 ) {
+    double u = heavy->p[0].ux, v = u/sqrt( 1+u*u );
+    double drift = 2*M_PI*v*grid->dt*heavy->subcycle/( grid->nx*grid->dx );
+    if( ( ( step()-reset_step ) % heavy->subcycle )==0 ?
+        fabs( dphase-drift )>0.05*drift : dphase!=0 ) n_failed++;
+  }
+
+  if( step()==10 ) {
+    set_species_subcycle( heavy, 4 );
+    reset_step = step();
+  }
+
+  field_array->kernel->clear_rhof( field_array );
+  LIST_FOR_EACH( sp, species_list ) accumulate_rho_p( field_array, sp );
+  field_array->kernel->synchronize_rho( field_array );
+  field_array->kernel->compute_div_e_err( field_array );
+  double err = field_array->kernel->compute_rms_div_e_err( field_array );
+  if( err>max_err ) max_err = err;
+
+  n_checked++;
+}
+
+begin_initialization {
+  double L     = 1;
+  int    nx    = 8;
+  int    npart = 32*nx*nx*nx;
+  double vth   = 0.1;
+
+  num_step             = 40;
+  status_interval      = 0;
+  sync_shared_interval = 0;
+  clean_div_e_interval = 0;
+  clean_div_b_interval = 0;
+
+  define_units( 1, 1 );
+  define_timestep( 0.99*courant_length( L, L, L, nx, nx, nx ) );
+  define_periodic_grid( 0, 0, 0,      // Grid low corner
+                        L, L, L,      // Grid high corner
+                        nx, nx, nx,   // Grid resolution
+                        1, 1, 1 );    // Processor configuration
+  define_material( "vacuum", 1 );
+  define_field_array( NULL, 0 );
+
+  species_t * light = define_species( "light", -1, 1,   2*npart, -1, 0, 0 );
+  species_t * heavy = define_species( "heavy",  1, 100, 2*npart, -1, 0, 0 );
+
+  set_species_subcycle( heavy, 4 );
+
+  repeat( npart ) {
+    double x  = uniform( rng(0), 0, L );
+    double y  = uniform( rng(0), 0, L );
+    double z  = uniform( rng(0), 0, L );
+
+    inject_particle( light, x, y, z,
+                     normal( rng(0), 0, vth ),
+                     normal( rng(0), 0, vth ),
+                     normal( rng(0), 0, vth ), 1./npart, 0, 0 );
+
+    inject_particle( heavy, x, y, z, 0.3, 0, 0, 1./npart, 0, 0 );
+  }
+}
+
+begin_particle_injection {
+}
+
+begin_current_injection {
+}
+
+begin_field_injection {
+}
+
+begin_particle_collisions {
+}
+
+TEST_CASE( "subcycled species conserve charge", "[particle_push]" )
+{
+  vpic_simulation simulation = vpic_simulation();
+
+  simulation.initialize( 0, NULL );
+
+  while( simulation.advance() );
+
+  simulation.finalize();
+
+  REQUIRE( n_checked>0 );
+  REQUIRE( n_failed==0 );
+  REQUIRE( max_err<1e-4 );
+}
+
+// Manually implement catch main
+int main( int argc, char* argv[] )
+{
+  // Setup
+  boot_services( &argc, &argv );
+
+  int result = Catch::Session().run( argc, argv );
+
+  // clean-up...
+  halt_services();
+
+  return result;
+}
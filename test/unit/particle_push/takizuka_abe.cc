@@ -0,0 +1,263 @@
+//#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#define CATCH_CONFIG_RUNNER // We will provide a custom main
+#include "catch.hpp"
+
+#include "deck/wrapper.h"
+
+#include <algorithm>
+
+#include "src/species_advance/species_advance.h"
+#include "src/vpic/vpic.h"
+
+#define IN_collision
+#include "src/collision/pipeline/collision_pipeline.h"
+
+// Electrons with an anisotropic temperature and a third as many heavier,
+// triply charged ions drifting through them, collided with themselves and
+// with each other by Takizuka-Abe.  The electron-ion pairing then pairs
+// each ion with several electrons.  The collisions must conserve the momentum and the kinetic
+// energy (all the weights are equal) and must relax the anisotropy.  The
+// vectorized pair batches must give the same momenta as colliding the
+// pairs one at a time.  The pipelines get contiguous voxel ranges holding
+// about the same number of particles each.
+
+static int n_checked = 0;
+static double mom_before[3], en_before, max_dmom = 0, max_den = 0;
+static double aniso0 = 0, aniso1 = 0, cvar = 0;
+static species_t * electron = NULL, * ion = NULL;
+static rng_pool_t * pool = NULL;
+
+// Momentum and (non-relativistic) kinetic energy of the particles.
+
+static void
+moments( species_t * sp_list, double * mom, double * en ) {
+  species_t * sp;
+  double local[4] = { 0, 0, 0, 0 }, all[4];
+  LIST_FOR_EACH( sp, sp_list )
+    for( int k=0; k<sp->np; k++ ) {
+      const particle_t * p = sp->p + k;
+      local[0] += sp->m*p->w*p->ux;
+      local[1] += sp->m*p->w*p->uy;
+      local[2] += sp->m*p->w*p->uz;
+      local[3] += 0.5*sp->m*p->w*( p->ux*p->ux + p->uy*p->uy + p->uz*p->uz );
+    }
+  mp_allsum_d( local, all, 4 );
+  mom[0] = all[0]; mom[1] = all[1]; mom[2] = all[2]; *en = all[3];
+}
+
+static double
+anisotropy( species_t * sp ) {
+  double t[2] = { 0, 0 };
+  for( int k=0; k<sp->np; k++ ) {
+    t[0] += sp->p[k].ux*sp->p[k].ux;
+    t[1] += 0.5*( sp->p[k].uy*sp->p[k].uy + sp->p[k].uz*sp->p[k].uz );
+  }
+  return t[0]/t[1];
+}
+
+void vpic_simulation::user_diagnostics() {
+  moments( species_list, mom_before, &en_before );
+}
+
+begin_initialization {
+  double L     = 1;
+  int    nx    = 4;
+  int    nppc  = 96;
+  double vth   = 0.02;
+  double w     = 1./( nppc*nx*nx*nx );  // Unit electron density
+
+  num_step             = 8;
+  status_interval      = 0;
+  sync_shared_interval = 0;
+  clean_div_e_interval = 0;
+  clean_div_b_interval = 0;
+
+  define_units( 1, 1 );
+  define_timestep( 0.99*courant_length( L, L, L, nx, nx, nx ) );
+  define_periodic_grid( 0, 0, 0,      // Grid low corner
+                        L, L, L,      // Grid high corner
+                        nx, nx, nx,   // Grid resolution
+                        1, 1, 1 );    // Processor configuration
+  define_material( "vacuum", 1 );
+  define_field_array( NULL, 0 );
+
+  electron = define_species( "electron", -1, 1, 2*nppc*nx*nx*nx, -1, 1, 0 );
+  ion      = define_species( "ion",       3, 4, 2*nppc*nx*nx*nx, -1, 1, 0 );
+
+  pool = entropy;
+  cvar = 1e-2/w; // A few collision times per run
+
+  define_collision_op( takizuka_abe( "ee", electron, electron, entropy, cvar, 1 ) );
+  define_collision_op( takizuka_abe( "ei", electron, ion,      entropy, cvar, 1 ) );
+
+  for( int n=0; n<nppc*nx*nx*nx; n++ ) {
+    double x = uniform( rng(0), grid->x0, grid->x1 );
+    double y = uniform( rng(0), grid->y0, grid->y1 );
+    double z = uniform( rng(0), grid->z0, grid->z1 );
+
+    inject_particle( electron, x, y, z,
+                     normal( rng(0), 0, 2*vth ),
+                     normal( rng(0), 0, vth ),
+                     normal( rng(0), 0, vth ), w, 0, 0 );
+
+    if( n%3==0 )
+      inject_particle( ion, x, y, z,
+                       normal( rng(0), vth, 0.5*vth ),
+                       normal( rng(0), 0,   0.5*vth ),
+                       normal( rng(0), 0,   0.5*vth ), w, 0, 0 );
+  }
+
+  aniso0 = anisotropy( electron );
+}
+
+// The collision operators have just been applied and the particles have
+// not moved since the diagnostics of the last step.
+
+begin_particle_collisions {
+  double mom[3], en, scale = 0;
+
+  moments( species_list, mom, &en );
+  for( int n=0; n<3; n++ ) scale += mom_before[n]*mom_before[n];
+  scale = sqrt( scale ) + sqrt( en_before );
+  for( int n=0; n<3; n++ ) {
+    double d = fabs( mom[n] - mom_before[n] )/scale;
+    if( d>max_dmom ) max_dmom = d;
+  }
+  if( fabs( en - en_before )/en_before>max_den )
+    max_den = fabs( en - en_before )/en_before;
+
+  aniso1 = anisotropy( electron );
+  n_checked++;
+}
+
+begin_particle_injection {
+}
+
+begin_current_injection {
+}
+
+begin_field_injection {
+}
+
+// Collide the electron-ion pairs of the current step with the scalar and
+// the widest vector pipeline and compare.
+
+static void
+compare_pipelines( void ( *pipeline )( takizuka_abe_t * RESTRICT, int, int ) ) {
+  takizuka_abe_t cm;
+  particle_t * e0, * i0;
+  double err = 0;
+
+  cm.name     = NULL;
+  cm.spi      = electron;
+  cm.spj      = ion;
+  cm.rp       = pool;
+  cm.seed     = 12345;
+  cm.interval = 1;
+  cm.cvar0    = cvar;
+
+  sort_p( electron );
+  sort_p( ion );
+
+  MALLOC_ALIGNED( e0, electron->np, 128 );
+  MALLOC_ALIGNED( i0, ion->np,      128 );
+  COPY( e0, electron->p, electron->np );
+  COPY( i0, ion->p,      ion->np      );
+
+  takizuka_abe_pipeline_scalar( &cm, 0, 1 );
+
+  std::swap( e0, electron->p );
+  std::swap( i0, ion->p );
+
+  pipeline( &cm, 0, 1 );
+
+  for( int k=0; k<electron->np; k++ )
+    err = std::max( err, (double)fabsf( electron->p[k].ux - e0[k].ux ) +
+                                 fabsf( electron->p[k].uy - e0[k].uy ) +
+                                 fabsf( electron->p[k].uz - e0[k].uz ) );
+  for( int k=0; k<ion->np; k++ )
+    err = std::max( err, (double)fabsf( ion->p[k].ux - i0[k].ux ) +
+                                 fabsf( ion->p[k].uy - i0[k].uy ) +
+                                 fabsf( ion->p[k].uz - i0[k].uz ) );
+
+  FREE_ALIGNED( e0 );
+  FREE_ALIGNED( i0 );
+
+  REQUIRE( err<1e-6 );
+}
+
+TEST_CASE( "Takizuka-Abe collisions conserve and relax", "[collision]" )
+{
+  vpic_simulation simulation = vpic_simulation();
+
+  simulation.initialize( 0, NULL );
+
+  while( simulation.advance() );
+
+  REQUIRE( n_checked==8 );
+  REQUIRE( max_dmom<1e-5 );
+  REQUIRE( max_den<1e-5 );
+  REQUIRE( aniso0>3 );
+  REQUIRE( aniso1<0.5*aniso0 );
+
+#if defined(V16_ACCELERATION)
+  compare_pipelines( takizuka_abe_pipeline_v16 );
+#elif defined(V8_ACCELERATION)
+  compare_pipelines( takizuka_abe_pipeline_v8 );
+#elif defined(V4_ACCELERATION)
+  compare_pipelines( takizuka_abe_pipeline_v4 );
+#endif
+
+  simulation.finalize();
+}
+
+// A clustered partition: a few dense voxels in a sparse background.  The
+// voxel ranges of the pipelines must tile the voxels in order and each
+// must hold at most its share of the particles plus one voxel's worth.
+
+TEST_CASE( "collision voxel ranges balance the particles", "[collision]" )
+{
+  const int nv = 1000, vl = 10, vh = 990;
+  int pi[ nv+1 ], pj[ nv+1 ];
+
+  pi[0] = pj[0] = 0;
+  for( int v=0; v<nv; v++ ) {
+    pi[v+1] = pi[v] + ( v%97==5 ? 2000 : v%3 );
+    pj[v+1] = pj[v] + ( v>600 && v<620 ? 500 : 1 );
+  }
+
+  for( int n_pipeline=1; n_pipeline<=16; n_pipeline*=2 )
+    for( int both=0; both<2; both++ ) {
+      const int * q = both ? pj : NULL;
+      int v0, v1, v_next = vl, max_voxel = 0;
+      double total = pi[vh] - pi[vl] + ( q ? q[vh] - q[vl] : 0 );
+
+      for( int v=vl; v<vh; v++ )
+        max_voxel = std::max( max_voxel, pi[v+1] - pi[v] +
+                                         ( q ? q[v+1] - q[v] : 0 ) );
+
+      for( int p=0; p<n_pipeline; p++ ) {
+        collision_voxels( pi, q, vl, vh, p, n_pipeline, &v0, &v1 );
+        REQUIRE( v0==v_next );
+        REQUIRE( v1>=v0 );
+        REQUIRE( pi[v1] - pi[v0] + ( q ? q[v1] - q[v0] : 0 ) <=
+                 total/n_pipeline + max_voxel );
+        v_next = v1;
+      }
+      REQUIRE( v_next==vh );
+    }
+}
+
+// Manually implement catch main
+int main( int argc, char* argv[] )
+{
+  // Setup
+  boot_services( &argc, &argv );
+
+  int result = Catch::Session().run( argc, argv );
+
+  // clean-up...
+  halt_services();
+
+  return result;
+}
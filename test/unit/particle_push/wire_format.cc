@@ -0,0 +1,188 @@
+//#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#define CATCH_CONFIG_RUNNER // We will provide a custom main
+#include "catch.hpp"
+
+#include "deck/wrapper.h"
+
+#include <string.h>
+
+#include "src/species_advance/species_advance.h"
+#include "src/vpic/vpic.h"
+
+// Three species, one of them stored in the AoSoA layout, in a periodic box
+// split over 2x2x1 domains.  One species is a beam drifting across the x
+// and y faces.  The particles are sent packed (runs of species, the
+// coordinate along the face normal omitted), so the exchange must give
+// every particle back its species, momentum and weight bitwise and put it
+// on the receiver's side of the face it crossed.  A checksum of the
+// momentum and weight of the particles of each species is thus unchanged
+// by the exchange, no particle may be lost and Gauss's law must keep
+// holding to roundoff.
+
+static int n_checked = 0, n_failed = 0;
+static double max_err = 0;
+
+static const int n_sp = 3;
+
+static double sum_before[ n_sp ], np_before[ n_sp ];
+
+// Order independent checksum (exact in double) of the momentum and weight
+// of the particles of each species, counting the particles too.
+
+static void
+checksum( species_t * sp_list,
+          double * sum,
+          double * np )
+{
+  double local[ 2*n_sp ], all[ 2*n_sp ];
+  species_t * sp;
+  particle_t p;
+  uint32_t b[4], h;
+
+  for( int s=0; s<2*n_sp; s++ ) local[s] = 0;
+
+  LIST_FOR_EACH( sp, sp_list ) {
+    for( int k=0; k<sp->np; k++ ) {
+      load_particle( sp->p, sp->layout, k, &p );
+      memcpy( b, &p.ux, sizeof(b) );
+      h = b[0]*2654435761u ^ b[1]*2246822519u ^ b[2]*3266489917u ^ b[3];
+      local[ sp->id ] += h & 0xfffff;
+    }
+    local[ n_sp + sp->id ] = sp->np;
+  }
+
+  mp_allsum_d( local, all, 2*n_sp );
+
+  for( int s=0; s<n_sp; s++ ) {
+    sum[s] = all[s];
+    np [s] = all[ n_sp + s ];
+  }
+}
+
+void vpic_simulation::user_diagnostics() {
+  species_t * sp;
+
+  field_array->kernel->clear_rhof( field_array );
+  LIST_FOR_EACH( sp, species_list ) accumulate_rho_p( field_array, sp );
+  field_array->kernel->synchronize_rho( field_array );
+  field_array->kernel->compute_div_e_err( field_array );
+  double err = field_array->kernel->compute_rms_div_e_err( field_array );
+  if( err>max_err ) max_err = err;
+}
+
+begin_initialization {
+  double L     = 1;
+  int    nx    = 8;
+  int    npart = 8*nx*nx*nx;
+  double vth   = 0.2;
+
+  num_step             = 16;
+  status_interval      = 0;
+  sync_shared_interval = 0;
+  clean_div_e_interval = 0;
+  clean_div_b_interval = 0;
+
+  define_units( 1, 1 );
+  define_timestep( 0.99*courant_length( L, L, L, nx, nx, nx ) );
+  define_periodic_grid( 0, 0, 0,      // Grid low corner
+                        L, L, L,      // Grid high corner
+                        nx, nx, nx,   // Grid resolution
+                        2, 2, 1 );    // Processor configuration
+  define_material( "vacuum", 1 );
+  define_field_array( NULL, 0 );
+
+  species_t * electron = define_species( "electron", -1, 1, 4*npart, -1, 0, 0 );
+  species_t * ion      = define_species( "ion",       1, 1, 4*npart, -1, 0, 0 );
+  species_t * beam     = define_species( "beam",     -1, 1, 4*npart, -1, 0, 0 );
+
+  set_species_layout( ion, PARTICLE_LAYOUT_AOSOA );
+
+  repeat( npart/nproc() ) {
+    double x  = uniform( rng(0), grid->x0, grid->x1 );
+    double y  = uniform( rng(0), grid->y0, grid->y1 );
+    double z  = uniform( rng(0), grid->z0, grid->z1 );
+
+    inject_particle( electron, x, y, z,
+                     normal( rng(0), 0, vth ),
+                     normal( rng(0), 0, vth ),
+                     normal( rng(0), 0, vth ), 1./npart, 0, 0 );
+
+    inject_particle( ion, x, y, z,
+                     normal( rng(0), 0, vth ),
+                     normal( rng(0), 0, vth ),
+                     normal( rng(0), 0, vth ), 1./npart, 0, 0 );
+
+    inject_particle( beam, x, y, z,
+                     normal( rng(0), 1, 0.1*vth ),
+                     normal( rng(0), 0.5, 0.1*vth ),
+                     normal( rng(0), 0, 0.1*vth ), 0.5/npart, 0, 0 );
+  }
+}
+
+// Right before the exchange, take the checksums of all particles (the
+// movers' particles are still in the particle arrays).
+
+begin_particle_injection {
+  checksum( species_list, sum_before, np_before );
+}
+
+begin_current_injection {
+  double sum[ n_sp ], np[ n_sp ];
+  species_t * sp;
+  particle_t p;
+
+  checksum( species_list, sum, np );
+
+  for( int s=0; s<n_sp; s++ )
+    if( sum[s]!=sum_before[s] || np[s]!=np_before[s] ) n_failed++;
+
+  LIST_FOR_EACH( sp, species_list ) {
+    if( sp->nm ) n_failed++;
+    for( int k=0; k<sp->np; k++ ) {
+      load_particle( sp->p, sp->layout, k, &p );
+      if( p.dx<-1 || p.dx>1 || p.dy<-1 || p.dy>1 || p.dz<-1 || p.dz>1 ) {
+        n_failed++;
+        break;
+      }
+    }
+  }
+
+  n_checked++;
+}
+
+begin_field_injection {
+}
+
+begin_particle_collisions {
+}
+
+TEST_CASE( "particles survive the packed wire format", "[particle_push]" )
+{
+  REQUIRE( world_size==4 );
+
+  vpic_simulation simulation = vpic_simulation();
+
+  simulation.initialize( 0, NULL );
+
+  while( simulation.advance() );
+
+  simulation.finalize();
+
+  REQUIRE( n_checked>0 );
+  REQUIRE( n_failed==0 );
+  REQUIRE( max_err<1e-4 );
+}
+
+// Manually implement catch main
+int main( int argc, char* argv[] )
+{
+  // Setup
+  boot_services( &argc, &argv );
+
+  int result = Catch::Session().run( argc, argv );
+
+  // clean-up...
+  halt_services();
+
+  return result;
+}